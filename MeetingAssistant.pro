@@ -6,12 +6,35 @@ CONFIG += c++17
 
 # Windows specific
 win32 {
-    LIBS += -lole32 -loleaut32 -lmmdevapi
+    LIBS += -lole32 -loleaut32 -lmmdevapi -lpsapi
+    # Speech SDK 延迟加载：只有第一次调用 SDK（点击开始/测试）时才加载 DLL
+    LIBS += -ldelayimp
+    QMAKE_LFLAGS += /DELAYLOAD:Microsoft.CognitiveServices.Speech.core.dll
+    SOURCES += src/wasapiaudiocapture.cpp
+    HEADERS += src/wasapiaudiocapture.h
+    # Windows 调试帮助库（崩溃转储）
+    LIBS += -ldbghelp
+    # MMCSS（采集线程的音频调度优先级）
+    LIBS += -lavrt
+}
+
+# Linux：PulseAudio/PipeWire 采集，POSIX 共享内存
+unix:!macx {
+    SOURCES += src/pulseaudiocapture.cpp
+    HEADERS += src/pulseaudiocapture.h
+    LIBS += -lpulse-simple -lpulse -lrt
+    # Linux 版 Speech SDK 的 .so 放在 lib/x64 下，运行时从程序目录查找
+    LIBS += -L$$PWD/third_party/azure_speech_sdk/lib/x64
+    QMAKE_LFLAGS += -rdynamic -Wl,-rpath,\'\$$ORIGIN\'
 }
 
 # 添加调试信息
-QMAKE_CXXFLAGS_RELEASE += /Zi
-QMAKE_LFLAGS_RELEASE += /DEBUG /OPT:REF /OPT:ICF
+msvc {
+    QMAKE_CXXFLAGS_RELEASE += /Zi
+    QMAKE_LFLAGS_RELEASE += /DEBUG /OPT:REF /OPT:ICF
+} else {
+    QMAKE_CXXFLAGS_RELEASE += -g
+}
 
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
@@ -21,16 +44,81 @@ SOURCES += \
     src/main.cpp \
     src/mainwindow.cpp \
     src/audioprocessor.cpp \
+    src/audiocapture.cpp \
+    src/audioformat.cpp \
     src/azurespeechapi.cpp \
+    src/speechengine.cpp \
+    src/localspeechengine.cpp \
+    src/batchtranscriber.cpp \
+    src/silencesplitter.cpp \
+    src/splittranscriber.cpp \
+    src/ingestserver.cpp \
+    src/ingestloadtest.cpp \
+    src/texttranslator.cpp \
+    src/latencyprofile.cpp \
+    src/captionthrottle.cpp \
+    src/captionring.cpp \
+    src/glossary.cpp \
+    src/glossaryprocessor.cpp \
+    src/latencybenchmark.cpp \
+    src/soaktest.cpp \
+    src/capturetest.cpp \
+    src/capturescheduler.cpp \
+    src/sessiontrace.cpp \
+    src/sessionreplay.cpp \
+    src/memoryaccounting.cpp \
+    src/memorypanel.cpp \
+    src/audioring.cpp \
+    src/speechhost.cpp \
+    src/hostedspeechengine.cpp \
+    src/regionprobe.cpp \
+    src/subtitleoverlay.cpp \
+    src/overlaybenchmark.cpp \
     src/logger.cpp \
-    src/wasapiaudiocapture.cpp
+    src/flightrecorder.cpp \
+    src/metrics.cpp \
+    src/metricsexporter.cpp \
+    src/startuptimer.cpp
 
 HEADERS += \
     src/mainwindow.h \
     src/audioprocessor.h \
+    src/audiocapture.h \
+    src/audioformat.h \
     src/azurespeechapi.h \
+    src/speechengine.h \
+    src/lockfreequeue.h \
+    src/localspeechengine.h \
+    src/batchtranscriber.h \
+    src/silencesplitter.h \
+    src/splittranscriber.h \
+    src/ingestserver.h \
+    src/ingestloadtest.h \
+    src/texttranslator.h \
+    src/latencyprofile.h \
+    src/captionthrottle.h \
+    src/captionring.h \
+    src/glossary.h \
+    src/glossaryprocessor.h \
+    src/latencybenchmark.h \
+    src/soaktest.h \
+    src/capturetest.h \
+    src/capturescheduler.h \
+    src/sessiontrace.h \
+    src/sessionreplay.h \
+    src/memoryaccounting.h \
+    src/memorypanel.h \
+    src/audioring.h \
+    src/speechhost.h \
+    src/hostedspeechengine.h \
+    src/regionprobe.h \
+    src/subtitleoverlay.h \
+    src/overlaybenchmark.h \
     src/logger.h \
-    src/wasapiaudiocapture.h
+    src/flightrecorder.h \
+    src/metrics.h \
+    src/metricsexporter.h \
+    src/startuptimer.h
 
 FORMS += \
     src/mainwindow.ui
@@ -68,6 +156,3 @@ win32 {
     $$quote(cmd /c copy /Y \"$$PWD\\third_party\\azure_speech_sdk\\bin\\Microsoft.CognitiveServices.Speech.extension.kws.ort.dll\" \"$$OUT_PWD\\release\\Microsoft.CognitiveServices.Speech.extension.kws.ort.dll\") && \
     $$quote(cmd /c copy /Y \"$$PWD\\third_party\\azure_speech_sdk\\bin\\Microsoft.CognitiveServices.Speech.extension.lu.dll\" \"$$OUT_PWD\\release\\Microsoft.CognitiveServices.Speech.extension.lu.dll\")
 }
-
-# 添加 Windows 调试帮助库
-LIBS += -ldbghelp 
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include "audiocapture.h"
+#include "metrics.h"
+#ifdef Q_OS_WIN
+#include "wasapiaudiocapture.h"
+#else
+#include "pulseaudiocapture.h"
+#endif
+
+AudioCapture::AudioCapture(QObject *parent)
+    : QObject(parent)
+    , latencyPackets(0)
+    , latencyTotalUs(0)
+    , latencyMaxUs(0)
+{
+}
+
+AudioCapture *AudioCapture::create(QObject *parent)
+{
+#ifdef Q_OS_WIN
+    return new WasapiAudioCapture(parent);
+#else
+    return new PulseAudioCapture(parent);
+#endif
+}
+
+CaptureLatencyStats AudioCapture::latencyStats() const
+{
+    CaptureLatencyStats stats;
+    stats.packets = latencyPackets.load();
+    if (stats.packets > 0) {
+        stats.averageMs = latencyTotalUs.load() / 1000.0 / stats.packets;
+    }
+    stats.maxMs = latencyMaxUs.load() / 1000.0;
+    return stats;
+}
+
+void AudioCapture::resetLatencyStats()
+{
+    latencyPackets = 0;
+    latencyTotalUs = 0;
+    latencyMaxUs = 0;
+}
+
+QString describeGlitchStats(const CaptureGlitchStats &stats)
+{
+    return QString("采集：唤醒 %1 次（事件 %2，超时 %3，迟到 %4），数据不连续 %5 次，迟到数据包 %6 个，静音段 %7 个共 %8 秒")
+            .arg(stats.wakeups)
+            .arg(stats.eventWakeups)
+            .arg(stats.timeoutWakeups)
+            .arg(stats.lateWakeups)
+            .arg(stats.discontinuities)
+            .arg(stats.latePackets)
+            .arg(stats.silentSpans)
+            .arg(stats.silentMs / 1000.0, 0, 'f', 1);
+}
+
+void AudioCapture::recordLatencyUs(quint64 latencyUs)
+{
+    static MetricHistogram &latencyHistogram = Metrics::histogram(
+            "capture_packet_latency_ms", "数据包从设备写入到被采集线程取走的延迟（毫秒）",
+            {1, 2, 5, 10, 20, 50, 100, 200, 500});
+    latencyHistogram.observe(latencyUs / 1000.0);
+    latencyPackets.fetch_add(1, std::memory_order_relaxed);
+    latencyTotalUs.fetch_add(latencyUs, std::memory_order_relaxed);
+    quint64 previousMax = latencyMaxUs.load(std::memory_order_relaxed);
+    while (latencyUs > previousMax
+           && !latencyMaxUs.compare_exchange_weak(previousMax, latencyUs, std::memory_order_relaxed)) {
+    }
+}
+
+void AudioCapture::countPacket(quint64 frames, bool silent)
+{
+    static MetricCounter &packets = Metrics::counter("capture_packets_total", "采集到的数据包数");
+    static MetricCounter &frameCount = Metrics::counter("capture_frames_total", "采集到的音频帧数");
+    static MetricCounter &silentPackets = Metrics::counter("capture_silent_packets_total", "标记为静音的数据包数");
+    packets.add();
+    frameCount.add(frames);
+    if (silent) {
+        silentPackets.add();
+    }
+}
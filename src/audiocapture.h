@@ -0,0 +1,70 @@
+#ifndef AUDIOCAPTURE_H
+#define AUDIOCAPTURE_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+#include <atomic>
+#include "latencyprofile.h"
+#include "capturescheduler.h"
+
+// 采集延迟统计：从设备记录采样到数据发出的时间
+struct CaptureLatencyStats {
+    quint64 packets = 0;
+    double averageMs = 0;
+    double maxMs = 0;
+};
+
+// 系统声音采集的公共接口，输出固定为 16kHz/16bit/单声道 PCM。
+// Windows 为 WASAPI 回环（WasapiAudioCapture），
+// Linux 为 PulseAudio/PipeWire 默认输出的 monitor 源（PulseAudioCapture）。
+// audioDataReceived 和 error 在采集线程中发出。
+class AudioCapture : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AudioCapture(QObject *parent = nullptr);
+    ~AudioCapture() override = default;
+
+    // 创建当前平台的采集实现
+    static AudioCapture *create(QObject *parent = nullptr);
+
+    virtual bool startCapture() = 0;
+    virtual void stopCapture() = 0;
+    virtual bool isCapturing() const = 0;
+
+    // 轮询间隔和缓冲区时长，下次 startCapture 时生效
+    virtual void setLatencyProfile(const LatencyProfile &profile) = 0;
+
+    // 采集设备名称，空表示默认输出设备；下次 startCapture 时生效
+    void setDeviceName(const QString &name) { deviceName = name; }
+
+    CaptureLatencyStats latencyStats() const;
+    void resetLatencyStats();
+
+    // 本次（或上一次）采集的唤醒、静音段、不连续和迟到统计，可在任意线程读取
+    CaptureGlitchStats glitchStats() const { return scheduler.stats(); }
+
+signals:
+    void audioDataReceived(const QByteArray &data);
+    void error(const QString &message);
+
+protected:
+    // 采集线程中调用：记录一个数据包的延迟和计数指标
+    void recordLatencyUs(quint64 latencyUs);
+    void countPacket(quint64 frames, bool silent);
+
+    QString deviceName;
+    CaptureScheduler scheduler;
+
+private:
+    std::atomic<quint64> latencyPackets;
+    std::atomic<quint64> latencyTotalUs;
+    std::atomic<quint64> latencyMaxUs;
+};
+
+// 采集统计的一行中文摘要，用于状态栏和日志
+QString describeGlitchStats(const CaptureGlitchStats &stats);
+
+#endif // AUDIOCAPTURE_H
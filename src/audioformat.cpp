@@ -0,0 +1,121 @@
+#include "audioformat.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace audioformat;
+
+namespace {
+
+// 根据有效位数生成掩码，丢弃容器中无效的低位
+uint32_t validBitsMask(int containerBits, int validBits)
+{
+    const int fullBits = containerBits == 16 ? 16 : 32;
+    if (validBits <= 0 || validBits >= containerBits) {
+        return fullBits == 16 ? 0xFFFFu : 0xFFFFFFFFu;
+    }
+    // 采样左对齐存放在容器中（24-bit packed 在 load 时已左对齐到 32 位）
+    uint32_t mask = ~((1u << (fullBits - validBits)) - 1u);
+    return fullBits == 16 ? (mask & 0xFFFFu) : mask;
+}
+
+template <typename Sample>
+SampleConverter::ConvertFn selectLayout(int channels)
+{
+    switch (channels) {
+    case 1:  return &convertToMono16<Sample, 1>;
+    case 2:  return &convertToMono16<Sample, 2>;
+    default: return &convertToMono16<Sample, 0>;
+    }
+}
+
+} // namespace
+
+SampleConverter SampleConverter::create(const AudioStreamFormat &format)
+{
+    SampleConverter converter;
+    converter.m_format = format;
+    if (format.channels <= 0) {
+        return converter;
+    }
+
+    converter.m_mask = validBitsMask(format.containerBits, format.validBits);
+    switch (format.sampleType) {
+    case SampleType::Int16:
+        converter.m_convert = selectLayout<Int16Sample>(format.channels);
+        break;
+    case SampleType::Int24Packed:
+        converter.m_convert = selectLayout<Int24PackedSample>(format.channels);
+        break;
+    case SampleType::Int32:
+        converter.m_convert = selectLayout<Int32Sample>(format.channels);
+        break;
+    case SampleType::Float32:
+        converter.m_convert = selectLayout<Float32Sample>(format.channels);
+        break;
+    case SampleType::Unsupported:
+        break;
+    }
+    return converter;
+}
+
+void SampleConverter::convert(const uint8_t* data, uint32_t numFrames, bool silent, std::vector<int16_t> &out) const
+{
+    out.resize(numFrames);
+    convert(data, numFrames, silent, out.data());
+}
+
+void SampleConverter::convert(const uint8_t* data, uint32_t numFrames, bool silent, int16_t* out) const
+{
+    if (numFrames == 0) {
+        return;
+    }
+    if (silent || !m_convert || !data) {
+        std::fill(out, out + numFrames, 0);
+        return;
+    }
+    m_convert(data, numFrames, m_format.channels, m_mask, out);
+}
+
+void resampleLinear(const std::vector<int16_t> &in, int inRate, int outRate, std::vector<int16_t> &out)
+{
+    out.resize(resampledLength(in.size(), inRate, outRate));
+    out.resize(resampleLinear(in.data(), in.size(), inRate, outRate, out.data()));
+}
+
+size_t resampledLength(size_t inCount, int inRate, int outRate)
+{
+    if (inCount == 0 || inRate <= 0 || outRate <= 0) {
+        return 0;
+    }
+    const double ratio = static_cast<double>(outRate) / inRate;
+    return static_cast<size_t>(std::ceil(inCount * ratio));
+}
+
+size_t resampleLinear(const int16_t* in, size_t inCount, int inRate, int outRate, int16_t* out)
+{
+    const size_t newSize = resampledLength(inCount, inRate, outRate);
+    if (newSize == 0) {
+        return 0;
+    }
+
+    const double ratio = static_cast<double>(outRate) / inRate;
+    for (size_t i = 0; i < newSize; ++i) {
+        double pos = i / ratio;
+        size_t pos1 = static_cast<size_t>(std::floor(pos));
+        size_t pos2 = pos1 + 1;
+        double frac = pos - pos1;
+
+        // 边界检查
+        if (pos1 >= inCount) {
+            pos1 = inCount - 1;
+        }
+        if (pos2 >= inCount) {
+            pos2 = inCount - 1;
+        }
+
+        // 线性插值
+        double sample = in[pos1] * (1.0 - frac) + in[pos2] * frac;
+        out[i] = static_cast<int16_t>(std::round(sample));
+    }
+    return newSize;
+}
@@ -0,0 +1,136 @@
+#ifndef AUDIOFORMAT_H
+#define AUDIOFORMAT_H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// 设备采样类型（与平台无关的描述）
+enum class SampleType {
+    Unsupported,
+    Int16,
+    Int24Packed,
+    Int32,
+    Float32
+};
+
+// 设备流格式，由各采集后端在建立流时填写
+struct AudioStreamFormat {
+    SampleType sampleType = SampleType::Unsupported;
+    int channels = 0;
+    int sampleRate = 0;
+    int containerBits = 0;   // 每个采样占用的位数
+    int validBits = 0;       // 有效位数（WAVEFORMATEXTENSIBLE::wValidBitsPerSample）
+};
+
+namespace audioformat {
+
+// 各采样类型的读取方式，统一返回 16-bit 量程的整数
+struct Int16Sample {
+    static constexpr int kBytes = 2;
+    static inline int32_t load(const uint8_t* p, uint32_t mask) {
+        int16_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return static_cast<int16_t>(static_cast<uint16_t>(v) & mask);
+    }
+};
+
+struct Int24PackedSample {
+    static constexpr int kBytes = 3;
+    static inline int32_t load(const uint8_t* p, uint32_t mask) {
+        // 小端 3 字节，左对齐到 32 位后算术右移
+        uint32_t u = (uint32_t(p[0]) << 8) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 24);
+        return static_cast<int32_t>(u & mask) >> 16;
+    }
+};
+
+struct Int32Sample {
+    static constexpr int kBytes = 4;
+    static inline int32_t load(const uint8_t* p, uint32_t mask) {
+        uint32_t u;
+        std::memcpy(&u, p, sizeof(u));
+        return static_cast<int32_t>(u & mask) >> 16;
+    }
+};
+
+struct Float32Sample {
+    static constexpr int kBytes = 4;
+    static inline int32_t load(const uint8_t* p, uint32_t) {
+        float f;
+        std::memcpy(&f, p, sizeof(f));
+        // 裁剪到 [-1.0, 1.0] 范围
+        if (f > 1.f)  f = 1.f;
+        if (f < -1.f) f = -1.f;
+        return static_cast<int32_t>(f * 32767);
+    }
+};
+
+// Channels > 0 时声道数在编译期确定，Channels == 0 时使用运行期声道数
+template <typename Sample, int Channels>
+void convertToMono16(const uint8_t* data, uint32_t numFrames, int channels, uint32_t mask, int16_t* out)
+{
+    const int ch = Channels > 0 ? Channels : channels;
+    const int frameBytes = Sample::kBytes * ch;
+    for (uint32_t i = 0; i < numFrames; ++i, data += frameBytes) {
+        if (Channels == 1) {
+            out[i] = static_cast<int16_t>(Sample::load(data, mask));
+        } else {
+            int32_t sum = 0;
+            for (int c = 0; c < ch; ++c) {
+                sum += Sample::load(data + c * Sample::kBytes, mask);
+            }
+            out[i] = static_cast<int16_t>(sum / ch);
+        }
+    }
+}
+
+// 16-bit 单声道无需转换，直接复制
+template <>
+inline void convertToMono16<Int16Sample, 1>(const uint8_t* data, uint32_t numFrames, int, uint32_t mask, int16_t* out)
+{
+    if (mask == 0xFFFFu) {
+        std::memcpy(out, data, numFrames * sizeof(int16_t));
+        return;
+    }
+    for (uint32_t i = 0; i < numFrames; ++i) {
+        out[i] = static_cast<int16_t>(Int16Sample::load(data + i * 2, mask));
+    }
+}
+
+} // namespace audioformat
+
+// 把设备格式的交错采样转换为单声道 16-bit PCM。
+// 具体的模板实例在 create() 中根据流格式选定一次，之后每个数据包只做一次间接调用。
+class SampleConverter
+{
+public:
+    using ConvertFn = void (*)(const uint8_t* data, uint32_t numFrames, int channels, uint32_t mask, int16_t* out);
+
+    SampleConverter() = default;
+
+    static SampleConverter create(const AudioStreamFormat &format);
+
+    bool isValid() const { return m_convert != nullptr; }
+    const AudioStreamFormat &format() const { return m_format; }
+    int bytesPerFrame() const { return m_format.channels * m_format.containerBits / 8; }
+
+    // silent 为 true 时（AUDCLNT_BUFFERFLAGS_SILENT）不读取 data，直接输出静音
+    void convert(const uint8_t* data, uint32_t numFrames, bool silent, std::vector<int16_t> &out) const;
+    // 写入调用方提供的缓冲区（至少 numFrames 个采样），便于使用 MemoryArena 等自管内存
+    void convert(const uint8_t* data, uint32_t numFrames, bool silent, int16_t* out) const;
+
+private:
+    AudioStreamFormat m_format;
+    ConvertFn m_convert = nullptr;
+    uint32_t m_mask = 0;
+};
+
+// 线性插值重采样（单声道 16-bit）
+void resampleLinear(const std::vector<int16_t> &in, int inRate, int outRate, std::vector<int16_t> &out);
+
+// 重采样后的采样数，调用方据此准备输出缓冲区
+size_t resampledLength(size_t inCount, int inRate, int outRate);
+// 写入调用方提供的缓冲区（至少 resampledLength() 个采样），返回写入的采样数
+size_t resampleLinear(const int16_t* in, size_t inCount, int inRate, int outRate, int16_t* out);
+
+#endif // AUDIOFORMAT_H
@@ -1,24 +1,42 @@
 #include "audioprocessor.h"
-#include <QNetworkRequest>
-#include <QNetworkReply>
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonArray>
-#include <QUrlQuery>
-#include <QEventLoop>
+#include "sessiontrace.h"
 
 AudioProcessor::AudioProcessor(QObject *parent)
     : QObject(parent)
-    , networkManager(new QNetworkAccessManager(this))
-    , audioCapture(new WasapiAudioCapture(this))
+    , audioCapture(AudioCapture::create(this))
+    , sessionTrace(nullptr)
     , isRecording(false)
 {
-    connect(networkManager, &QNetworkAccessManager::finished,
-            this, &AudioProcessor::handleTranslationResponse);
-    connect(audioCapture, &WasapiAudioCapture::audioDataReceived,
+    connectCapture();
+}
+
+AudioProcessor::AudioProcessor(AudioCapture *capture, QObject *parent)
+    : QObject(parent)
+    , audioCapture(capture)
+    , sessionTrace(nullptr)
+    , isRecording(false)
+{
+    audioCapture->setParent(this);
+    connectCapture();
+}
+
+void AudioProcessor::connectCapture()
+{
+    connect(audioCapture, &AudioCapture::audioDataReceived,
             this, &AudioProcessor::handleAudioData);
-    connect(audioCapture, &WasapiAudioCapture::error,
+    connect(audioCapture, &AudioCapture::error,
             this, &AudioProcessor::error);
+    // 直接连接：在采集线程中写入，时间戳就是数据包离开采集线程的时刻
+    connect(audioCapture, &AudioCapture::audioDataReceived, audioCapture, [this](const QByteArray &data) {
+        if (sessionTrace) {
+            sessionTrace->writeAudio(data.constData(), static_cast<size_t>(data.size()));
+        }
+    }, Qt::DirectConnection);
+}
+
+void AudioProcessor::setSessionTrace(SessionTraceWriter *trace)
+{
+    sessionTrace = trace;
 }
 
 AudioProcessor::~AudioProcessor()
@@ -26,20 +44,9 @@ AudioProcessor::~AudioProcessor()
     if (isRecording) {
         stopRecording();
     }
-    delete networkManager;
     delete audioCapture;
 }
 
-void AudioProcessor::setAppId(const QString &id)
-{
-    appId = id;
-}
-
-void AudioProcessor::setApiKey(const QString &key)
-{
-    apiKey = key;
-}
-
 bool AudioProcessor::startRecording()
 {
     if (isRecording) {
@@ -64,29 +71,34 @@ void AudioProcessor::stopRecording()
     isRecording = false;
 }
 
+void AudioProcessor::setLatencyProfile(const LatencyProfile &profile)
+{
+    audioCapture->setLatencyProfile(profile);
+}
+
+void AudioProcessor::setDeviceName(const QString &name)
+{
+    audioCapture->setDeviceName(name);
+}
+
+CaptureLatencyStats AudioProcessor::latencyStats() const
+{
+    return audioCapture->latencyStats();
+}
+
+void AudioProcessor::resetLatencyStats()
+{
+    audioCapture->resetLatencyStats();
+}
+
+CaptureGlitchStats AudioProcessor::glitchStats() const
+{
+    return audioCapture->glitchStats();
+}
+
 void AudioProcessor::handleAudioData(const QByteArray &data)
 {
     if (!data.isEmpty()) {
         emit audioDataReceived(data);
     }
 }
-
-void AudioProcessor::handleTranslationResponse(QNetworkReply *reply)
-{
-    if (reply->error() == QNetworkReply::NoError) {
-        QByteArray response = reply->readAll();
-        QJsonDocument doc = QJsonDocument::fromJson(response);
-        QJsonObject obj = doc.object();
-        
-        if (obj.contains("result")) {
-            QString text = obj["result"].toArray().first().toString();
-            emit newTranslation(text);
-        } else if (obj.contains("error_msg")) {
-            emit error(obj["error_msg"].toString());
-        }
-    } else {
-        emit error(reply->errorString());
-    }
-    
-    reply->deleteLater();
-} 
\ No newline at end of file
@@ -2,8 +2,9 @@
 #define AUDIOPROCESSOR_H
 
 #include <QObject>
-#include <QNetworkAccessManager>
-#include "wasapiaudiocapture.h"
+#include "audiocapture.h"
+
+class SessionTraceWriter;
 
 class AudioProcessor : public QObject
 {
@@ -11,27 +12,34 @@ class AudioProcessor : public QObject
 
 public:
     explicit AudioProcessor(QObject *parent = nullptr);
+    // 使用指定的采集实现（如会话回放），取得其所有权
+    explicit AudioProcessor(AudioCapture *capture, QObject *parent = nullptr);
     ~AudioProcessor();
 
-    void setAppId(const QString &id);
-    void setApiKey(const QString &key);
     bool startRecording();
     void stopRecording();
 
+    void setLatencyProfile(const LatencyProfile &profile);
+    void setDeviceName(const QString &name);
+    CaptureLatencyStats latencyStats() const;
+    void resetLatencyStats();
+    CaptureGlitchStats glitchStats() const;
+
+    // 采集线程发出的每个数据包原样写入会话轨迹；在开始采集之前设置
+    void setSessionTrace(SessionTraceWriter *trace);
+
 signals:
     void audioDataReceived(const QByteArray &data);
-    void newTranslation(const QString &text);
     void error(const QString &message);
 
 private slots:
-    void handleTranslationResponse(QNetworkReply *reply);
     void handleAudioData(const QByteArray &data);
 
 private:
-    QString appId;
-    QString apiKey;
-    QNetworkAccessManager *networkManager;
-    WasapiAudioCapture *audioCapture;
+    void connectCapture();
+
+    AudioCapture *audioCapture;
+    SessionTraceWriter *sessionTrace;
     bool isRecording;
 };
 
@@ -0,0 +1,444 @@
+#include "audioring.h"
+#include "captionring.h"
+#include <cstring>
+#include <string>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const size_t kRecordSize = sizeof(AudioRingRecord);
+
+uint32_t roundUpPowerOfTwo(uint32_t v)
+{
+    uint32_t result = 1024;
+    while (result < v && result < (1u << 28)) {
+        result <<= 1;
+    }
+    return result;
+}
+
+size_t align8(size_t v)
+{
+    return (v + 7) & ~static_cast<size_t>(7);
+}
+
+uint32_t currentPid()
+{
+#ifdef _WIN32
+    return static_cast<uint32_t>(GetCurrentProcessId());
+#else
+    return static_cast<uint32_t>(getpid());
+#endif
+}
+
+} // namespace
+
+// 平台相关的命名共享内存，双方都是读写映射
+class AudioRingMapping
+{
+public:
+    ~AudioRingMapping() { unmap(); }
+
+    bool create(const char *name, size_t size)
+    {
+#ifdef _WIN32
+        const std::wstring wideName = L"Local\\" + widen(name);
+        handle = CreateFileMappingW(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                                    0, static_cast<DWORD>(size), wideName.c_str());
+        if (!handle) {
+            return false;
+        }
+        if (GetLastError() == ERROR_ALREADY_EXISTS) {
+            // 名称包含进程号，已存在说明有别的进程占用
+            CloseHandle(handle);
+            handle = NULL;
+            return false;
+        }
+        view = MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, size);
+#else
+        path = std::string("/") + name;
+        // 名称包含进程号，残留的同名对象只可能来自已退出的进程
+        shm_unlink(path.c_str());
+        const int fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0) {
+            path.clear();
+            return false;
+        }
+        if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            ::close(fd);
+            shm_unlink(path.c_str());
+            path.clear();
+            return false;
+        }
+        view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (view == MAP_FAILED) {
+            view = nullptr;
+        }
+        owner = true;
+#endif
+        mappedSize = size;
+        return view != nullptr;
+    }
+
+    bool open(const char *name)
+    {
+#ifdef _WIN32
+        const std::wstring wideName = L"Local\\" + widen(name);
+        handle = OpenFileMappingW(FILE_MAP_ALL_ACCESS, FALSE, wideName.c_str());
+        if (!handle) {
+            return false;
+        }
+        view = MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+        if (view) {
+            MEMORY_BASIC_INFORMATION info;
+            if (VirtualQuery(view, &info, sizeof(info)) == sizeof(info)) {
+                mappedSize = info.RegionSize;
+            }
+        }
+        return view != nullptr;
+#else
+        const std::string shmPath = std::string("/") + name;
+        const int fd = shm_open(shmPath.c_str(), O_RDWR, 0);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(AudioRingHeader))) {
+            ::close(fd);
+            return false;
+        }
+        mappedSize = static_cast<size_t>(st.st_size);
+        view = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (view == MAP_FAILED) {
+            view = nullptr;
+        }
+        return view != nullptr;
+#endif
+    }
+
+    void *data() const { return view; }
+    size_t size() const { return mappedSize; }
+
+private:
+    void unmap()
+    {
+#ifdef _WIN32
+        if (view) {
+            UnmapViewOfFile(view);
+        }
+        if (handle) {
+            CloseHandle(handle);
+        }
+        handle = NULL;
+#else
+        if (view) {
+            munmap(view, mappedSize);
+        }
+        if (owner && !path.empty()) {
+            shm_unlink(path.c_str());
+        }
+        owner = false;
+        path.clear();
+#endif
+        view = nullptr;
+        mappedSize = 0;
+    }
+
+#ifdef _WIN32
+    static std::wstring widen(const char *utf8)
+    {
+        wchar_t buffer[256];
+        const int n = MultiByteToWideChar(CP_UTF8, 0, utf8, -1, buffer, 256);
+        return n > 0 ? std::wstring(buffer) : std::wstring();
+    }
+
+    HANDLE handle = NULL;
+#else
+    std::string path;
+    bool owner = false;
+#endif
+    void *view = nullptr;
+    size_t mappedSize = 0;
+};
+
+AudioRingWriter::AudioRingWriter()
+    : mapping(nullptr)
+    , header(nullptr)
+    , data(nullptr)
+    , mask(0)
+{
+}
+
+AudioRingWriter::~AudioRingWriter()
+{
+    close();
+}
+
+bool AudioRingWriter::create(const char *name, uint32_t capacity)
+{
+    close();
+    const uint32_t size = roundUpPowerOfTwo(capacity);
+    mapping = new AudioRingMapping;
+    if (!mapping->create(name, sizeof(AudioRingHeader) + size)) {
+        delete mapping;
+        mapping = nullptr;
+        return false;
+    }
+
+    header = static_cast<AudioRingHeader *>(mapping->data());
+    header->version = kAudioRingVersion;
+    header->headerSize = sizeof(AudioRingHeader);
+    header->capacity = size;
+    header->writerPid = currentPid();
+    header->writePos.store(0, std::memory_order_relaxed);
+    header->readPos.store(0, std::memory_order_relaxed);
+    header->droppedBytes.store(0, std::memory_order_relaxed);
+    header->readerWaiting.store(0, std::memory_order_relaxed);
+    header->commitIndex.store(0, std::memory_order_relaxed);
+    std::memset(header->commits, 0, sizeof(header->commits));
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(header->magic, "MAAR", 4);
+
+    data = reinterpret_cast<char *>(header) + sizeof(AudioRingHeader);
+    mask = size - 1;
+    return true;
+}
+
+void AudioRingWriter::close()
+{
+    delete mapping;
+    mapping = nullptr;
+    header = nullptr;
+    data = nullptr;
+    mask = 0;
+}
+
+bool AudioRingWriter::write(const char *pcm, size_t bytes, bool &wakeReader)
+{
+    wakeReader = false;
+    if (!header || bytes == 0) {
+        return false;
+    }
+    const uint64_t capacity = mask + 1;
+    const size_t need = kRecordSize + align8(bytes);
+    uint64_t writePos = header->writePos.load(std::memory_order_relaxed);
+    const uint64_t readPos = header->readPos.load(std::memory_order_acquire);
+
+    // 数据区末尾放不下时先跳到开头，跳过的部分也占用空间
+    const uint64_t offset = writePos & mask;
+    const uint64_t tail = capacity - offset;
+    const uint64_t skip = tail < need ? tail : 0;
+    if (need > capacity / 2 || (writePos - readPos) + skip + need > capacity) {
+        header->droppedBytes.fetch_add(bytes, std::memory_order_relaxed);
+        return false;
+    }
+
+    if (skip > 0) {
+        if (skip >= kRecordSize) {
+            AudioRingRecord wrap = {0, kAudioRingWrap, 0};
+            std::memcpy(data + offset, &wrap, kRecordSize);
+        }
+        writePos += skip;
+    }
+
+    AudioRingRecord record = {static_cast<uint32_t>(bytes), 0, captionRingNowUs()};
+    char *out = data + (writePos & mask);
+    std::memcpy(out, &record, kRecordSize);
+    std::memcpy(out + kRecordSize, pcm, bytes);
+
+    // 先发布数据，再检查读取方是否在等待（与 prepareWait 的顺序相反，两边都用 seq_cst）
+    header->writePos.store(writePos + need, std::memory_order_seq_cst);
+    if (header->readerWaiting.load(std::memory_order_seq_cst) != 0) {
+        wakeReader = header->readerWaiting.exchange(0, std::memory_order_seq_cst) != 0;
+    }
+    return true;
+}
+
+uint64_t AudioRingWriter::position() const
+{
+    return header ? header->writePos.load(std::memory_order_relaxed) : 0;
+}
+
+uint64_t AudioRingWriter::droppedBytes() const
+{
+    return header ? header->droppedBytes.load(std::memory_order_relaxed) : 0;
+}
+
+uint64_t AudioRingWriter::backlogBytes() const
+{
+    if (!header) {
+        return 0;
+    }
+    return header->writePos.load(std::memory_order_relaxed) - header->readPos.load(std::memory_order_relaxed);
+}
+
+AudioRingReader::AudioRingReader()
+    : mapping(nullptr)
+    , header(nullptr)
+    , data(nullptr)
+    , mask(0)
+    , pendingEnd(0)
+    , cursor(0)
+    , cursorPcmBytes(0)
+{
+}
+
+AudioRingReader::~AudioRingReader()
+{
+    close();
+}
+
+bool AudioRingReader::open(const char *name)
+{
+    close();
+    mapping = new AudioRingMapping;
+    if (!mapping->open(name)) {
+        delete mapping;
+        mapping = nullptr;
+        return false;
+    }
+    AudioRingHeader *candidate = static_cast<AudioRingHeader *>(mapping->data());
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (std::memcmp(candidate->magic, "MAAR", 4) != 0 || candidate->version != kAudioRingVersion
+        || candidate->headerSize != sizeof(AudioRingHeader)
+        || mapping->size() < sizeof(AudioRingHeader) + candidate->capacity) {
+        delete mapping;
+        mapping = nullptr;
+        return false;
+    }
+    header = candidate;
+    data = reinterpret_cast<const char *>(header) + sizeof(AudioRingHeader);
+    mask = header->capacity - 1;
+    rewind();
+    return true;
+}
+
+void AudioRingReader::close()
+{
+    delete mapping;
+    mapping = nullptr;
+    header = nullptr;
+    data = nullptr;
+    mask = 0;
+    cursor = 0;
+    cursorPcmBytes = 0;
+}
+
+bool AudioRingReader::peek(AudioRingChunk &chunk)
+{
+    if (!header) {
+        return false;
+    }
+    const uint64_t capacity = mask + 1;
+    uint64_t readPos = cursor;
+    const uint64_t writePos = header->writePos.load(std::memory_order_acquire);
+    if (readPos == writePos) {
+        return false;
+    }
+
+    uint64_t offset = readPos & mask;
+    AudioRingRecord record;
+    if (capacity - offset < kRecordSize) {
+        readPos += capacity - offset;
+    } else {
+        std::memcpy(&record, data + offset, kRecordSize);
+        if (record.flags & kAudioRingWrap) {
+            readPos += capacity - offset;
+        }
+    }
+    if (readPos == writePos) {
+        // 只有跳转记录：直接推进游标，下次从开头读
+        cursor = readPos;
+        return false;
+    }
+
+    offset = readPos & mask;
+    std::memcpy(&record, data + offset, kRecordSize);
+    chunk.pcm = data + offset + kRecordSize;
+    chunk.bytes = record.length;
+    chunk.writeTimeUs = record.writeTimeUs;
+    pendingEnd = readPos + kRecordSize + align8(record.length);
+    return true;
+}
+
+void AudioRingReader::release(const AudioRingChunk &chunk)
+{
+    if (!header) {
+        return;
+    }
+    cursorPcmBytes += chunk.bytes;
+    cursor = pendingEnd;
+}
+
+void AudioRingReader::commit(uint64_t position, uint64_t pcmBytes)
+{
+    if (!header || position > cursor || position < committed().position) {
+        return;
+    }
+    publish(position, pcmBytes);
+}
+
+void AudioRingReader::publish(uint64_t position, uint64_t pcmBytes)
+{
+    // 只有读取方写槽位。在任何一步崩溃，新进程读到的都是完整的一对：
+    // 切换之前是旧槽位，切换之后是新槽位
+    const uint32_t next = header->commitIndex.load(std::memory_order_relaxed) ^ 1u;
+    header->commits[next].position = position;
+    header->commits[next].pcmBytes = pcmBytes;
+    header->commitIndex.store(next, std::memory_order_release);
+    header->readPos.store(position, std::memory_order_release);
+}
+
+AudioRingCommit AudioRingReader::committed() const
+{
+    return header->commits[header->commitIndex.load(std::memory_order_acquire) & 1u];
+}
+
+void AudioRingReader::rewind()
+{
+    if (!header) {
+        return;
+    }
+    const AudioRingCommit last = committed();
+    // 上一个进程可能在切换槽位之后、推进 readPos 之前崩溃
+    header->readPos.store(last.position, std::memory_order_release);
+    cursor = last.position;
+    cursorPcmBytes = last.pcmBytes;
+}
+
+void AudioRingReader::restartAt(uint64_t position)
+{
+    if (!header) {
+        return;
+    }
+    publish(position, 0);
+    cursor = position;
+    cursorPcmBytes = 0;
+}
+
+uint64_t AudioRingReader::consumedPcmBytes() const
+{
+    return header ? committed().pcmBytes : 0;
+}
+
+bool AudioRingReader::prepareWait()
+{
+    if (!header) {
+        return false;
+    }
+    header->readerWaiting.store(1, std::memory_order_seq_cst);
+    if (header->writePos.load(std::memory_order_seq_cst) != cursor) {
+        header->readerWaiting.store(0, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,161 @@
+#ifndef AUDIORING_H
+#define AUDIORING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// 音频共享内存环：界面进程把 16kHz/16bit/单声道 PCM 写入一块命名共享内存，
+// 语音服务辅助进程（--speech-host）直接在映射中读取并交给识别器，
+// 音频不经过管道或套接字，也不在辅助进程中再复制一份。单写单读，双方都不加锁。
+// 本头文件不依赖 Qt。
+//
+// 共享内存名称同 captionring.h：Windows 为 "Local\<name>"，其他系统为 "/<name>"。
+//
+// 布局（版本 2，小端）：
+//   [0, 128)               AudioRingHeader
+//   [128, 128 + capacity)  数据区，capacity 为 2 的幂
+//
+// writePos/readPos 是只增的字节位置，数据区偏移为 pos & (capacity - 1)。
+// 每个数据块以 AudioRingRecord 开头，后跟 PCM，整体按 8 字节对齐。数据区末尾放不下
+// 整个数据块时，写入方在末尾写一个 kAudioRingWrap 记录（剩余不足 16 字节时省略），从头继续。
+// 写入方写完数据后才推进 writePos（release）。读取方在本进程内另有读取游标，
+// 交给识别器只推进游标；readPos 是已提交的位置，只有识别器对这段音频给出最终结果后
+// 才推进（commit），之前的音频仍留在环中。空间不足时写入方丢弃整个数据块
+// 并计入 droppedBytes，不覆盖 readPos 之后的数据。
+//
+// 读取方没有数据可读时置 readerWaiting，写入方推进 writePos 后若发现该标志，
+// 清除它并通过控制通道唤醒读取方；读取方置标志后会再检查一次，避免错过唤醒。
+//
+// 辅助进程重启后从已提交的位置重新读取：已交给识别器但还没有最终结果的音频会再识别一次，
+// 期间写入的音频也不会丢失（不超过容量时）。提交的位置和它之前的 PCM 字节数必须成对，
+// 新进程据此换算识别结果在整个流中的位置；辅助进程可能在提交中途崩溃，所以两者写在
+// commits 的两个槽位中轮换，先写好不在用的槽位再切换 commitIndex（一次原子写入），
+// 之后才推进 readPos。readPos 只给写入方判断空间，可能短暂落后于当前槽位。
+
+const uint32_t kAudioRingVersion = 2;
+const uint32_t kAudioRingDefaultCapacity = 1u << 20;   // 约 32 秒音频
+const uint32_t kAudioRingWrap = 1;
+
+// 已提交的读取位置和它之前的 PCM 字节数
+struct AudioRingCommit {
+    uint64_t position;
+    uint64_t pcmBytes;
+};
+
+struct AudioRingHeader {
+    char magic[4];                              // "MAAR"
+    uint32_t version;
+    uint32_t headerSize;                        // 128
+    uint32_t capacity;
+    uint32_t writerPid;
+    uint32_t reserved0;
+    std::atomic<uint64_t> writePos;
+    std::atomic<uint64_t> readPos;              // 写入方不能覆盖这之后的数据
+    std::atomic<uint64_t> droppedBytes;
+    std::atomic<uint32_t> readerWaiting;
+    std::atomic<uint32_t> commitIndex;          // commits 中当前有效的槽位
+    uint64_t reserved1;
+    AudioRingCommit commits[2];
+    uint64_t reserved2[4];
+};
+static_assert(sizeof(AudioRingHeader) == 128, "AudioRingHeader 布局变化需要同步修改版本号");
+
+struct AudioRingRecord {
+    uint32_t length;            // PCM 字节数
+    uint32_t flags;             // kAudioRingWrap 表示跳到数据区开头
+    uint64_t writeTimeUs;       // captionRingNowUs()，读取方据此计算经过共享内存的延迟
+};
+static_assert(sizeof(AudioRingRecord) == 16, "AudioRingRecord 布局变化需要同步修改版本号");
+
+class AudioRingMapping;
+
+// 写入方（界面进程）：创建共享内存，write 只能在一个线程中调用
+class AudioRingWriter
+{
+public:
+    AudioRingWriter();
+    ~AudioRingWriter();
+
+    // capacity 向上取整为 2 的幂
+    bool create(const char *name, uint32_t capacity = kAudioRingDefaultCapacity);
+    void close();
+    bool isOpen() const { return header != nullptr; }
+
+    // 空间不足时丢弃并返回 false。wakeReader 为 true 时调用方需要唤醒读取方
+    bool write(const char *pcm, size_t bytes, bool &wakeReader);
+
+    // 当前写入位置，开始新会话时告诉读取方从这里读起
+    uint64_t position() const;
+    uint64_t droppedBytes() const;
+    // 尚未被读取的字节数
+    uint64_t backlogBytes() const;
+
+private:
+    AudioRingWriter(const AudioRingWriter &) = delete;
+    AudioRingWriter &operator=(const AudioRingWriter &) = delete;
+
+    AudioRingMapping *mapping;
+    AudioRingHeader *header;
+    char *data;
+    uint64_t mask;
+};
+
+// 读取到的数据块，pcm 指向共享内存，在 release() 之前有效
+struct AudioRingChunk {
+    const char *pcm = nullptr;
+    size_t bytes = 0;
+    uint64_t writeTimeUs = 0;
+};
+
+// 读取方（辅助进程）：映射写入方创建的共享内存
+class AudioRingReader
+{
+public:
+    AudioRingReader();
+    ~AudioRingReader();
+
+    bool open(const char *name);
+    void close();
+    bool isOpen() const { return header != nullptr; }
+
+    // 取游标处的下一个数据块但不推进游标；没有数据时返回 false
+    bool peek(AudioRingChunk &chunk);
+    // 数据块已交给识别器，推进游标（不推进 readPos）
+    void release(const AudioRingChunk &chunk);
+
+    // 游标位置和游标之前的 PCM 字节数，commit 时成对传回
+    uint64_t position() const { return cursor; }
+    uint64_t pcmBytes() const { return cursorPcmBytes; }
+    // 这之前的音频已有最终结果，写入方可以覆盖；position 不能超过游标
+    void commit(uint64_t position, uint64_t pcmBytes);
+    // 游标回到已提交的位置（重启后继续上次的会话）
+    void rewind();
+
+    // 从 position 开始读（新会话），并把已消费的 PCM 计数清零
+    void restartAt(uint64_t position);
+    // 已提交位置之前的 PCM 字节数
+    uint64_t consumedPcmBytes() const;
+    uint64_t capacity() const { return mask + 1; }
+
+    // 准备等待唤醒：置 readerWaiting 后再检查一次，返回 false 表示已有数据，不应等待
+    bool prepareWait();
+
+private:
+    AudioRingReader(const AudioRingReader &) = delete;
+    AudioRingReader &operator=(const AudioRingReader &) = delete;
+
+    // 写入不在用的槽位后切换，再推进 readPos
+    void publish(uint64_t position, uint64_t pcmBytes);
+    AudioRingCommit committed() const;
+
+    AudioRingMapping *mapping;
+    AudioRingHeader *header;
+    const char *data;
+    uint64_t mask;
+    uint64_t pendingEnd;        // peek 得到的数据块结束位置
+    uint64_t cursor;            // 本进程的读取位置，不早于已提交的位置
+    uint64_t cursorPcmBytes;
+};
+
+#endif // AUDIORING_H
@@ -1,11 +1,36 @@
 #include "azurespeechapi.h"
+#include "flightrecorder.h"
+#include "metrics.h"
+#include "memoryaccounting.h"
+#include <atomic>
+#include <stdexcept>
 
 using namespace Microsoft::CognitiveServices::Speech;
 using namespace Microsoft::CognitiveServices::Speech::Translation;
 using namespace Microsoft::CognitiveServices::Speech::Audio;
 
+namespace {
+
+// SDK 的偏移和时长以 100ns 为单位
+qint64 ticksToMs(uint64_t ticks)
+{
+    return static_cast<qint64>(ticks / 10000);
+}
+
+// 切换语言期间最多缓冲 10 秒音频
+const qint64 kMaxSwitchBufferBytes = 10 * 32000;
+
+} // namespace
+
 AzureSpeechAPI::AzureSpeechAPI(QObject *parent)
-    : QObject(parent)
+    : SpeechEngine(parent)
+    , generation(0)
+    , streamBytes(0)
+    , switching(false)
+    , switchBufferBytes(0)
+    , switchDroppedBytes(0)
+    , hasPendingSwitch(false)
+    , finishPending(false)
     , isInitialized(false)
     , logger(std::make_unique<Logger>())
 {
@@ -28,8 +53,10 @@ void AzureSpeechAPI::initialize(const QString &subscriptionKey, const QString &r
         
         // 设置语音识别和翻译的默认参数
         speechConfig->SetSpeechRecognitionLanguage("zh-CN");
-        speechConfig->SetProperty(PropertyId::SpeechServiceConnection_InitialSilenceTimeoutMs, "5000");
-        speechConfig->SetProperty(PropertyId::SpeechServiceConnection_EndSilenceTimeoutMs, "1000");
+        speechConfig->SetProperty(PropertyId::SpeechServiceConnection_InitialSilenceTimeoutMs,
+                                  std::to_string(latencyProfile.initialSilenceTimeoutMs));
+        speechConfig->SetProperty(PropertyId::SpeechServiceConnection_EndSilenceTimeoutMs,
+                                  std::to_string(latencyProfile.endSilenceTimeoutMs));
         
         isInitialized = true;
         LOG_INFO("Azure Speech 服务初始化成功");
@@ -42,6 +69,156 @@ void AzureSpeechAPI::initialize(const QString &subscriptionKey, const QString &r
     }
 }
 
+std::shared_ptr<AzureSpeechAPI::Pipeline> AzureSpeechAPI::buildPipeline(
+        const std::string &key, const std::string &region,
+        const QString &sourceLanguage, const QString &targetLanguage,
+        const LatencyProfile &profile, quint64 pipelineGeneration, qint64 baseOffsetMs)
+{
+    auto next = std::make_shared<Pipeline>();
+
+    // 创建翻译配置
+    next->translationConfig = SpeechTranslationConfig::FromSubscription(key, region);
+    if (!next->translationConfig) {
+        throw std::runtime_error("创建翻译配置失败");
+    }
+
+    next->translationConfig->SetSpeechRecognitionLanguage(sourceLanguage.toStdString());
+    next->translationConfig->AddTargetLanguage(targetLanguage.toStdString());
+    // 翻译配置是重新创建的，不会继承 speechConfig 上的属性
+    next->translationConfig->SetProperty(PropertyId::SpeechServiceConnection_InitialSilenceTimeoutMs,
+                                         std::to_string(profile.initialSilenceTimeoutMs));
+    next->translationConfig->SetProperty(PropertyId::SpeechServiceConnection_EndSilenceTimeoutMs,
+                                         std::to_string(profile.endSilenceTimeoutMs));
+
+    // 创建音频流
+    next->audioStream = PushAudioInputStream::Create();
+    if (!next->audioStream) {
+        throw std::runtime_error("创建音频流失败");
+    }
+
+    // 创建音频配置
+    auto audioConfig = AudioConfig::FromStreamInput(next->audioStream);
+    if (!audioConfig) {
+        throw std::runtime_error("创建音频配置失败");
+    }
+
+    // 创建识别器
+    next->recognizer = TranslationRecognizer::FromConfig(next->translationConfig, audioConfig);
+    if (!next->recognizer) {
+        throw std::runtime_error("创建识别器失败");
+    }
+
+    // 设置事件处理
+    // 目标语言键在管线建立时确定一次，按值捕获，回调线程不再读取成员变量
+    const std::string targetKey = targetLanguage.toStdString();
+
+    next->recognizer->Recognized.Connect([this, targetKey, baseOffsetMs](const TranslationRecognitionEventArgs& e) {
+        try {
+            if (e.Result->Reason == ResultReason::TranslatedSpeech) {
+                FlightRecorder::record(FlightEventType::Counter, "result.final", static_cast<int64_t>(e.Result->Text.size()));
+                RecognitionEvent event;
+                event.kind = RecognitionEvent::Final;
+                event.offsetMs = baseOffsetMs + ticksToMs(e.Result->Offset());
+                event.durationMs = ticksToMs(e.Result->Duration());
+                event.text = QString::fromStdString(e.Result->Text);
+                const auto& translations = e.Result->Translations;
+                auto it = translations.find(targetKey);
+                if (it != translations.end()) {
+                    event.translation = QString::fromStdString(it->second);
+                    event.hasTranslation = true;
+                }
+                postResult(std::move(event));
+            } else if (e.Result->Reason == ResultReason::NoMatch) {
+                LOG_INFO("未检测到语音");
+            } else if (e.Result->Reason == ResultReason::Canceled) {
+                LOG_ERROR("识别被取消");
+            }
+        } catch (const std::exception& ex) {
+            LOG_ERROR(QString("处理识别结果时发生异常: %1").arg(ex.what()));
+            emit error(QString("处理识别结果时发生异常: %1").arg(ex.what()));
+        }
+    });
+
+    // Recognizing 事件
+    next->recognizer->Recognizing.Connect([this, targetKey](const TranslationRecognitionEventArgs& e) {
+        if (e.Result->Reason == ResultReason::TranslatingSpeech) {
+            FlightRecorder::record(FlightEventType::Counter, "result.partial", static_cast<int64_t>(e.Result->Text.size()));
+            RecognitionEvent event;
+            event.kind = RecognitionEvent::Partial;
+            event.text = QString::fromStdString(e.Result->Text);
+            const auto& translations = e.Result->Translations;
+            auto it = translations.find(targetKey);
+            if (it != translations.end()) {
+                event.translation = QString::fromStdString(it->second);
+                event.hasTranslation = true;
+            }
+            postResult(std::move(event));
+        }
+    });
+
+    next->recognizer->Canceled.Connect([this](const TranslationRecognitionCanceledEventArgs& e) {
+        if (e.Reason == CancellationReason::EndOfStream) {
+            LOG_INFO("音频流已结束");
+            return;
+        }
+        static MetricCounter &cancellations = Metrics::counter("sdk_cancellations_total", "因错误取消的识别次数");
+        cancellations.add();
+        LOG_ERROR(QString("识别取消: %1").arg(QString::fromStdString(e.ErrorDetails)));
+        emit error(QString("识别取消: %1").arg(QString::fromStdString(e.ErrorDetails)));
+    });
+
+    // 连接状态：管线内第二次及以后的连接计为重连
+    next->connection = Connection::FromRecognizer(next->recognizer);
+    auto connectedOnce = std::make_shared<std::atomic<bool>>(false);
+    next->connection->Connected.Connect([connectedOnce](const ConnectionEventArgs&) {
+        static MetricGauge &connected = Metrics::gauge("sdk_connected", "与语音服务的连接状态（1 为已连接）");
+        static MetricCounter &reconnects = Metrics::counter("sdk_reconnects_total", "与语音服务的重连次数");
+        connected.set(1);
+        if (connectedOnce->exchange(true)) {
+            reconnects.add();
+            LOG_INFO("已重新连接语音服务");
+        }
+    });
+    next->connection->Disconnected.Connect([](const ConnectionEventArgs&) {
+        static MetricGauge &connected = Metrics::gauge("sdk_connected", "与语音服务的连接状态（1 为已连接）");
+        static MetricCounter &disconnects = Metrics::counter("sdk_disconnects_total", "与语音服务断开的次数");
+        connected.set(0);
+        disconnects.add();
+    });
+
+    next->recognizer->SessionStarted.Connect([](const SessionEventArgs&) {
+        static MetricCounter &sessions = Metrics::counter("sdk_sessions_total", "开始的识别会话数");
+        sessions.add();
+        FlightRecorder::record(FlightEventType::State, "session.started");
+        LOG_INFO("识别会话开始");
+    });
+
+    // 切换语言后旧管线的会话结束不代表整个会话结束
+    next->recognizer->SessionStopped.Connect([this, pipelineGeneration](const SessionEventArgs&) {
+        FlightRecorder::record(FlightEventType::State, "session.stopped");
+        LOG_INFO("识别会话结束");
+        if (pipelineGeneration == generation.load()) {
+            emit sessionFinished();
+        }
+    });
+
+    // 开始连续识别
+    next->recognizer->StartContinuousRecognitionAsync().wait();
+    return next;
+}
+
+void AzureSpeechAPI::stopPipeline(const std::shared_ptr<Pipeline> &stopping)
+{
+    if (!stopping || !stopping->recognizer) {
+        return;
+    }
+    try {
+        stopping->recognizer->StopContinuousRecognitionAsync().wait();
+    } catch (const std::exception& e) {
+        LOG_ERROR(QString("停止旧识别器失败: %1").arg(e.what()));
+    }
+}
+
 void AzureSpeechAPI::startRecognitionAndTranslation(const QString &sourceLanguage, const QString &targetLanguage)
 {
     if (!isInitialized) {
@@ -57,122 +234,183 @@ void AzureSpeechAPI::startRecognitionAndTranslation(const QString &sourceLanguag
 
         currentSourceLanguage = sourceLanguage;
         currentTargetLanguage = targetLanguage;
+        streamBytes = 0;
+        finishPending = false;
 
-        // 创建翻译配置
-        translationConfig = SpeechTranslationConfig::FromSubscription(speechConfig->GetSubscriptionKey(), speechConfig->GetRegion());
-        if (!translationConfig) {
-            LOG_ERROR("创建翻译配置失败");
-            emit error("创建翻译配置失败");
-            return;
+        pipeline = buildPipeline(speechConfig->GetSubscriptionKey(), speechConfig->GetRegion(),
+                                 sourceLanguage, targetLanguage, latencyProfile, ++generation, 0);
+        LOG_INFO("开始语音识别和翻译");
+        emit statusChanged("开始语音识别和翻译");
+    }
+    catch (const std::exception& e) {
+        pipeline.reset();
+        LOG_ERROR(QString("启动识别失败: %1").arg(e.what()));
+        emit error(QString("启动识别失败: %1").arg(e.what()));
+    }
+}
+
+void AzureSpeechAPI::reconfigure(const QString &sourceLanguage, const QString &targetLanguage)
+{
+    if (!pipeline && !switching) {
+        startRecognitionAndTranslation(sourceLanguage, targetLanguage);
+        return;
+    }
+    if (switching) {
+        // 只保留最新的一次请求，当前切换完成后再执行
+        hasPendingSwitch = true;
+        pendingSourceLanguage = sourceLanguage;
+        pendingTargetLanguage = targetLanguage;
+        return;
+    }
+
+    LOG_INFO(QString("切换语言: %1 -> %2 改为 %3 -> %4")
+             .arg(currentSourceLanguage, currentTargetLanguage, sourceLanguage, targetLanguage));
+    currentSourceLanguage = sourceLanguage;
+    currentTargetLanguage = targetLanguage;
+
+    switching = true;
+    switchTimer.start();
+    clearSwitchBuffer();
+    switchDroppedBytes = 0;
+
+    // 旧管线不再接收音频，关闭推流后它会处理完已收到的部分并给出最后的结果
+    const quint64 nextGeneration = ++generation;
+    pipeline->audioStream->Close();
+    QList<std::shared_ptr<Pipeline>> toStop = retiredPipelines;
+    retiredPipelines = {pipeline};
+    pipeline.reset();
+
+    joinBuilder();
+    const std::string key = speechConfig->GetSubscriptionKey();
+    const std::string region = speechConfig->GetRegion();
+    const LatencyProfile profile = latencyProfile;
+    const qint64 baseOffsetMs = streamBytes / 32;   // 16kHz/16bit/单声道：每毫秒 32 字节
+    builder = std::thread([this, key, region, sourceLanguage, targetLanguage, profile,
+                           nextGeneration, baseOffsetMs, toStop]() {
+        // 更早的旧管线此时早已输出完结果，顺便在后台停止
+        for (const auto &old : toStop) {
+            stopPipeline(old);
         }
 
-        translationConfig->SetSpeechRecognitionLanguage(sourceLanguage.toStdString());
-        translationConfig->AddTargetLanguage(targetLanguage.toStdString());
-        
-        // 创建音频流
-        audioStream = PushAudioInputStream::Create();
-        if (!audioStream) {
-            LOG_ERROR("创建音频流失败");
-            emit error("创建音频流失败");
-            return;
+        std::shared_ptr<Pipeline> next;
+        QString failure;
+        try {
+            next = buildPipeline(key, region, sourceLanguage, targetLanguage, profile, nextGeneration, baseOffsetMs);
+        } catch (const std::exception& e) {
+            failure = QString::fromUtf8(e.what());
         }
-        
-        // 创建音频配置
-        auto audioConfig = AudioConfig::FromStreamInput(audioStream);
-        if (!audioConfig) {
-            LOG_ERROR("创建音频配置失败");
-            emit error("创建音频配置失败");
-            return;
+        {
+            std::lock_guard<std::mutex> lock(builderMutex);
+            builtPipeline = next;
+            buildError = failure;
         }
-        
-        // 创建识别器
-        recognizer = TranslationRecognizer::FromConfig(translationConfig, audioConfig);
-        if (!recognizer) {
-            LOG_ERROR("创建识别器失败");
-            emit error("创建识别器失败");
-            return;
+        QMetaObject::invokeMethod(this, &AzureSpeechAPI::finishSwitch, Qt::QueuedConnection);
+    });
+}
+
+void AzureSpeechAPI::finishSwitch()
+{
+    if (!switching) {
+        return;
+    }
+    joinBuilder();
+
+    std::shared_ptr<Pipeline> next;
+    QString failure;
+    {
+        std::lock_guard<std::mutex> lock(builderMutex);
+        next = std::move(builtPipeline);
+        failure = buildError;
+        builtPipeline.reset();
+    }
+
+    switching = false;
+    const qint64 buildMs = switchTimer.elapsed();
+    if (!next) {
+        clearSwitchBuffer();
+        LOG_ERROR(QString("切换语言失败: %1").arg(failure));
+        emit error(QString("切换语言失败: %1").arg(failure));
+        if (finishPending) {
+            // 没有管线可以关闭，直接结束，等待结尾结果的调用方不必等到超时
+            finishPending = false;
+            hasPendingSwitch = false;
+            emit sessionFinished();
         }
-        
-        // 设置事件处理
-        recognizer->Recognized.Connect([this](const TranslationRecognitionEventArgs& e) {
-            try {
-                if (e.Result->Reason == ResultReason::TranslatedSpeech) {
-                    // 最终英文
-                    QString text = QString::fromStdString(e.Result->Text);
-                    emit recognitionResult(text);
-                    // 最终中文
-                    auto translations = e.Result->Translations;
-                    if (translations.find(currentTargetLanguage.toStdString()) != translations.end()) {
-                        QString translatedText = QString::fromStdString(translations[currentTargetLanguage.toStdString()]);
-                        emit translationResult(translatedText);
-                        emit finalTranslationResult(translatedText);
-                    }
-                } else if (e.Result->Reason == ResultReason::NoMatch) {
-                    LOG_INFO("未检测到语音");
-                } else if (e.Result->Reason == ResultReason::Canceled) {
-                    LOG_ERROR("识别被取消");
-                }
-            } catch (const std::exception& ex) {
-                LOG_ERROR(QString("处理识别结果时发生异常: %1").arg(ex.what()));
-                emit error(QString("处理识别结果时发生异常: %1").arg(ex.what()));
-            }
-        });
-
-        // Recognizing 事件
-        recognizer->Recognizing.Connect([this](const TranslationRecognitionEventArgs& e) {
-            if (e.Result->Reason == ResultReason::TranslatingSpeech) {
-                // 实时英文
-                QString partialText = QString::fromStdString(e.Result->Text);
-                emit recognitionResult(partialText);
-                // 实时中文
-                auto translations = e.Result->Translations;
-                if (translations.find(currentTargetLanguage.toStdString()) != translations.end()) {
-                    QString translatedText = QString::fromStdString(translations[currentTargetLanguage.toStdString()]);
-                    emit translationResult(translatedText);
-                }
-            }
-        });
+        return;
+    }
 
-        recognizer->Canceled.Connect([this](const TranslationRecognitionCanceledEventArgs& e) {
-            LOG_ERROR(QString("识别取消: %1").arg(QString::fromStdString(e.ErrorDetails)));
-            emit error(QString("识别取消: %1").arg(QString::fromStdString(e.ErrorDetails)));
-        });
+    // 先补送切换期间缓冲的音频，之后的音频直接写入新管线
+    pipeline = next;
+    for (const QByteArray &chunk : switchBuffer) {
+        writeAudio(chunk);
+    }
+    const qint64 bufferedMs = switchBufferBytes / 32;
+    clearSwitchBuffer();
 
-        recognizer->SessionStarted.Connect([this](const SessionEventArgs&) {
-            LOG_INFO("识别会话开始");
-        });
+    static MetricHistogram &switchHistogram = Metrics::histogram(
+            "engine_switch_ms", "切换语言时建立新识别器的耗时（毫秒）", {100, 250, 500, 1000, 2000, 5000});
+    static MetricCounter &switchDropped = Metrics::counter(
+            "engine_switch_dropped_seconds_total", "切换缓冲溢出丢弃的音频时长（秒）", 1.0 / 32000);
+    switchHistogram.observe(buildMs);
+    switchDropped.add(switchDroppedBytes);
 
-        recognizer->SessionStopped.Connect([this](const SessionEventArgs&) {
-            LOG_INFO("识别会话结束");
-        });
+    LOG_INFO(QString("语言切换完成：新识别器准备耗时 %1 ms，补送缓冲音频 %2 ms，丢弃 %3 ms")
+             .arg(buildMs)
+             .arg(bufferedMs)
+             .arg(switchDroppedBytes / 32));
+    emit statusChanged(QString("已切换到 %1 -> %2").arg(currentSourceLanguage, currentTargetLanguage));
 
-        // 开始连续识别
-        try {
-            recognizer->StartContinuousRecognitionAsync().wait();
-            LOG_INFO("开始语音识别和翻译");
-            emit statusChanged("开始语音识别和翻译");
-        } catch (const std::exception& e) {
-            LOG_ERROR(QString("启动连续识别失败: %1").arg(e.what()));
-            emit error(QString("启动连续识别失败: %1").arg(e.what()));
-        }
+    if (finishPending) {
+        // 输入已经结束：补送的音频就是全部，关闭推流，新管线给出最后的结果后结束会话
+        finishPending = false;
+        hasPendingSwitch = false;
+        LOG_INFO("关闭音频流（切换期间已请求结束）");
+        pipeline->audioStream->Close();
+        return;
     }
-    catch (const std::exception& e) {
-        LOG_ERROR(QString("启动识别失败: %1").arg(e.what()));
-        emit error(QString("启动识别失败: %1").arg(e.what()));
+    if (hasPendingSwitch) {
+        hasPendingSwitch = false;
+        reconfigure(pendingSourceLanguage, pendingTargetLanguage);
+    }
+}
+
+void AzureSpeechAPI::joinBuilder()
+{
+    if (builder.joinable()) {
+        builder.join();
     }
 }
 
 void AzureSpeechAPI::stopRecognitionAndTranslation()
 {
-    if (recognizer) {
+    // 等待进行中的切换结束，把它建好的管线一并停止
+    joinBuilder();
+    {
+        std::lock_guard<std::mutex> lock(builderMutex);
+        if (builtPipeline) {
+            retiredPipelines.append(builtPipeline);
+            builtPipeline.reset();
+        }
+    }
+    switching = false;
+    hasPendingSwitch = false;
+    finishPending = false;
+    clearSwitchBuffer();
+
+    for (const auto &old : retiredPipelines) {
+        stopPipeline(old);
+    }
+    retiredPipelines.clear();
+
+    if (pipeline) {
         try {
             LOG_INFO("停止语音识别和翻译");
-            recognizer->StopContinuousRecognitionAsync().wait();
-            recognizer.reset();
-            audioStream.reset();
+            pipeline->recognizer->StopContinuousRecognitionAsync().wait();
+            pipeline.reset();
             emit statusChanged("停止语音识别和翻译");
         }
         catch (const std::exception& e) {
+            pipeline.reset();
             QString errorMsg = QString("停止识别失败: %1").arg(e.what());
             LOG_ERROR(errorMsg);
             emit error(errorMsg);
@@ -182,123 +420,75 @@ void AzureSpeechAPI::stopRecognitionAndTranslation()
 
 void AzureSpeechAPI::processAudioData(const QByteArray &audioData)
 {
-    if (!audioStream) {
-        // 停止后收到的音频数据，直接忽略，不报错
-        return;
-    }
-
-    try {
-        // 将QByteArray转换为std::vector<uint8_t>
-        std::vector<uint8_t> audioBuffer(audioData.begin(), audioData.end());
-        
-        // 写入音频数据，确保大小不超过uint32_t的最大值
-        if (audioBuffer.size() > UINT32_MAX) {
-            LOG_ERROR("音频数据块太大");
-            emit error("音频数据块太大");
-            return;
-        }
-        
-        // 使用静态计数器来减少日志输出频率
-        static int logCounter = 0;
-        if (++logCounter % 10 == 0) {  // 每10个数据块记录一次
-            LOG_INFO(QString("处理音频数据，大小: %1 字节").arg(audioBuffer.size()));
-        }
-        
-        // 写入音频数据
-        try {
-            audioStream->Write(audioBuffer.data(), static_cast<uint32_t>(audioBuffer.size()));
-            if (logCounter % 10 == 0) {
-                LOG_INFO("音频数据写入成功");
-            }
-        } catch (const std::exception& e) {
-            LOG_ERROR(QString("写入音频数据失败: %1").arg(e.what()));
-            emit error(QString("写入音频数据失败: %1").arg(e.what()));
+    if (switching) {
+        // 新识别器建立期间缓冲音频，超过上限时丢弃最早的部分
+        // 数据可能直接指向共享内存，缓冲时复制一份
+        switchBuffer.append(QByteArray(audioData.constData(), audioData.size()));
+        switchBufferBytes += audioData.size();
+        MemoryAccounting::adjust(MemoryTag::Push, audioData.size());
+        streamBytes += audioData.size();
+        while (switchBufferBytes > kMaxSwitchBufferBytes && !switchBuffer.isEmpty()) {
+            switchBufferBytes -= switchBuffer.first().size();
+            MemoryAccounting::adjust(MemoryTag::Push, -switchBuffer.first().size());
+            switchDroppedBytes += switchBuffer.first().size();
+            switchBuffer.removeFirst();
         }
+        return;
     }
-    catch (const std::exception& e) {
-        LOG_ERROR(QString("处理音频数据失败: %1").arg(e.what()));
-        emit error(QString("处理音频数据失败: %1").arg(e.what()));
+    if (!pipeline) {
+        // 停止后收到的音频数据，直接忽略，不报错
+        return;
     }
+    streamBytes += audioData.size();
+    writeAudio(audioData);
 }
 
-void AzureSpeechAPI::testConnection(const QString &key, const QString &region)
+void AzureSpeechAPI::clearSwitchBuffer()
 {
-    try {
-        LOG_INFO(QString("开始测试连接，区域: %1").arg(region));
-        
-        // 1. 构造配置
-        auto config = SpeechConfig::FromSubscription(
-            key.toStdString(),
-            region.toStdString()
-        );
-
-        if (!config) {
-            QString errorMsg = "Failed to create speech config";
-            LOG_ERROR(errorMsg);
-            emit error(errorMsg);
-            return;
-        }
-        LOG_INFO("Speech config created successfully");
+    MemoryAccounting::adjust(MemoryTag::Push, -switchBufferBytes);
+    switchBuffer.clear();
+    switchBufferBytes = 0;
+}
 
-        // 创建音频流
-        auto audioStream = PushAudioInputStream::Create();
-        if (!audioStream) {
-            QString errorMsg = "Failed to create audio stream";
-            LOG_ERROR(errorMsg);
-            emit error(errorMsg);
-            return;
-        }
-        LOG_INFO("Audio stream created successfully");
+void AzureSpeechAPI::writeAudio(const QByteArray &audioData)
+{
+    // 写入音频数据，确保大小不超过uint32_t的最大值
+    if (static_cast<quint64>(audioData.size()) > UINT32_MAX) {
+        LOG_ERROR("音频数据块太大");
+        emit error("音频数据块太大");
+        return;
+    }
 
-        // 创建音频配置
-        auto audioConfig = AudioConfig::FromStreamInput(audioStream);
-        if (!audioConfig) {
-            QString errorMsg = "Failed to create audio config";
-            LOG_ERROR(errorMsg);
-            emit error(errorMsg);
-            return;
-        }
+    static MetricCounter &pushedBytes = Metrics::counter("sdk_pushed_bytes_total", "送入语音服务的音频字节数");
+    // 16kHz/16bit/单声道：每秒 32000 字节，按送入的音频时长计费
+    static MetricCounter &billedSeconds = Metrics::counter(
+            "sdk_billed_audio_seconds_total", "送入语音服务的音频时长（秒）", 1.0 / 32000);
+    static MetricCounter &pushedChunks = Metrics::counter("sdk_pushed_chunks_total", "送入语音服务的音频块数");
 
-        // 生成100ms的静音数据
-        std::vector<uint8_t> silenceData(16000 * 2 * 0.1); // 16kHz, 16-bit, 100ms
-        audioStream->Write(silenceData.data(), static_cast<uint32_t>(silenceData.size()));
-        audioStream->Close();
-        LOG_INFO("Silence data written to stream");
+    try {
+        FlightRecorder::record(FlightEventType::Counter, "push.bytes", static_cast<int64_t>(audioData.size()));
+        pipeline->audioStream->Write(reinterpret_cast<uint8_t *>(const_cast<char *>(audioData.constData())),
+                                     static_cast<uint32_t>(audioData.size()));
+        pushedBytes.add(audioData.size());
+        billedSeconds.add(audioData.size());
+        pushedChunks.add();
+        // 推流会复制一份交给 SDK 的内部队列
+        MemoryAccounting::transient(MemoryTag::Push, audioData.size());
+    } catch (const std::exception& e) {
+        LOG_ERROR(QString("写入音频数据失败: %1").arg(e.what()));
+        emit error(QString("写入音频数据失败: %1").arg(e.what()));
+    }
+}
 
-        // 创建识别器
-        auto recognizer = SpeechRecognizer::FromConfig(config, audioConfig);
-        if (!recognizer) {
-            QString errorMsg = "Failed to create speech recognizer";
-            LOG_ERROR(errorMsg);
-            emit error(errorMsg);
-            return;
-        }
-        LOG_INFO("Speech recognizer created successfully");
-
-        // 进行识别
-        auto result = recognizer->RecognizeOnceAsync().get();
-        if (result->Reason == ResultReason::RecognizedSpeech || result->Reason == ResultReason::NoMatch) {
-            LOG_INFO("Connection test successful");
-            emit statusChanged("连接测试成功");
-        } else {
-            QString reasonStr;
-            switch (result->Reason) {
-                case ResultReason::RecognizedSpeech: reasonStr = "RecognizedSpeech"; break;
-                case ResultReason::NoMatch: reasonStr = "NoMatch"; break;
-                case ResultReason::Canceled: reasonStr = "Canceled"; break;
-                default: reasonStr = QString::number(static_cast<int>(result->Reason)); break;
-            }
-            QString errorMsg = QString("Connection test failed: %1, Text: %2")
-                .arg(reasonStr)
-                .arg(QString::fromStdString(result->Text));
-            LOG_ERROR(errorMsg);
-            emit error(errorMsg);
-        }
+void AzureSpeechAPI::finishAudioInput()
+{
+    if (switching) {
+        // 新管线还没建好，关闭推流要等切换完成并补送缓冲的音频之后
+        finishPending = true;
+        return;
     }
-    catch (const std::exception &e) {
-        QString msg = QString("连接测试异常: %1").arg(e.what());
-        LOG_ERROR(msg);
-        emit statusChanged(msg);
-        emit error(msg);
+    if (pipeline) {
+        LOG_INFO("关闭音频流");
+        pipeline->audioStream->Close();
     }
-} 
\ No newline at end of file
+}
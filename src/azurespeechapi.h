@@ -5,15 +5,21 @@
 #include <QString>
 #include <QByteArray>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <QList>
+#include <QElapsedTimer>
 #include <speechapi_cxx.h>
 #include <speechapi_cxx_translation_recognizer.h>
+#include "speechengine.h"
 #include "logger.h"
 
 using namespace Microsoft::CognitiveServices::Speech;
 using namespace Microsoft::CognitiveServices::Speech::Translation;
 using namespace Microsoft::CognitiveServices::Speech::Audio;
 
-class AzureSpeechAPI : public QObject
+class AzureSpeechAPI : public SpeechEngine
 {
     Q_OBJECT
 
@@ -22,32 +28,66 @@ public:
     ~AzureSpeechAPI();
 
     // 初始化Azure Speech服务
-    void initialize(const QString &subscriptionKey, const QString &region);
+    void initialize(const QString &subscriptionKey, const QString &region) override;
     
     // 开始语音识别和翻译
-    void startRecognitionAndTranslation(const QString &sourceLanguage, const QString &targetLanguage);
+    void startRecognitionAndTranslation(const QString &sourceLanguage, const QString &targetLanguage) override;
     
     // 停止语音识别和翻译
-    void stopRecognitionAndTranslation();
+    void stopRecognitionAndTranslation() override;
     
     // 处理音频数据
-    void processAudioData(const QByteArray &audioData);
+    void processAudioData(const QByteArray &audioData) override;
 
-    void testConnection(const QString &key, const QString &region);
+    // 关闭音频流，服务端处理完剩余音频后会话结束
+    void finishAudioInput() override;
 
-signals:
-    void recognitionResult(const QString &text);
-    void translationResult(const QString &text);
-    void finalTranslationResult(const QString &text);
-    void error(const QString &message);
-    void statusChanged(const QString &status);
+    // 不停止采集切换语言：旧识别器关闭推流后处理完已收到的音频，新识别器在后台建立，
+    // 期间的音频进入有界缓冲，新识别器就绪后切换并补送缓冲的音频
+    void reconfigure(const QString &sourceLanguage, const QString &targetLanguage) override;
 
 private:
+    // 一套识别管线，切换语言时整体替换
+    struct Pipeline {
+        std::shared_ptr<SpeechTranslationConfig> translationConfig;
+        std::shared_ptr<PushAudioInputStream> audioStream;
+        std::shared_ptr<TranslationRecognizer> recognizer;
+        std::shared_ptr<Connection> connection;
+    };
+
+    // 创建并启动一套管线，可在后台线程调用；失败时抛出异常。
+    // generation 用于识别旧管线的回调，baseOffsetMs 是该管线音频在整个流中的起点
+    std::shared_ptr<Pipeline> buildPipeline(const std::string &key, const std::string &region,
+                                            const QString &sourceLanguage, const QString &targetLanguage,
+                                            const LatencyProfile &profile,
+                                            quint64 pipelineGeneration, qint64 baseOffsetMs);
+    static void stopPipeline(const std::shared_ptr<Pipeline> &stopping);
+    void finishSwitch();
+    void writeAudio(const QByteArray &audioData);
+    void clearSwitchBuffer();
+    void joinBuilder();
+
     std::shared_ptr<SpeechConfig> speechConfig;
-    std::shared_ptr<SpeechTranslationConfig> translationConfig;
-    std::shared_ptr<TranslationRecognizer> recognizer;
-    std::shared_ptr<PushAudioInputStream> audioStream;
-    
+    std::shared_ptr<Pipeline> pipeline;
+    QList<std::shared_ptr<Pipeline>> retiredPipelines;  // 已关闭推流、仍在输出最后结果的旧管线
+    std::atomic<quint64> generation;
+    qint64 streamBytes;                 // 整个流（含切换缓冲）已收到的音频字节数
+
+    // 切换状态（只在引擎线程访问，后台线程的结果经 builderMutex 交接）
+    bool switching;
+    QList<QByteArray> switchBuffer;
+    qint64 switchBufferBytes;
+    qint64 switchDroppedBytes;
+    QElapsedTimer switchTimer;
+    bool hasPendingSwitch;
+    bool finishPending;                 // 切换期间收到 finishAudioInput，新管线就绪后关闭推流
+    QString pendingSourceLanguage;
+    QString pendingTargetLanguage;
+    std::thread builder;
+    std::mutex builderMutex;
+    std::shared_ptr<Pipeline> builtPipeline;
+    QString buildError;
+
     bool isInitialized;
     QString currentSourceLanguage;
     QString currentTargetLanguage;
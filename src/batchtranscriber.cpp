@@ -0,0 +1,336 @@
+#include "batchtranscriber.h"
+#include "speechengine.h"
+#include "logger.h"
+#include <QAudioDecoder>
+#include <QAudioBuffer>
+#include <QAudioFormat>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QTime>
+#include <QUrl>
+
+namespace {
+
+const int kSpeechSampleRate = 16000;
+
+QString formatTimestamp(qint64 ms)
+{
+    return QTime(0, 0).addMSecs(static_cast<int>(ms)).toString("hh:mm:ss.zzz");
+}
+
+AudioStreamFormat describeAudioFormat(const QAudioFormat &format)
+{
+    AudioStreamFormat result;
+    result.channels = format.channelCount();
+    result.sampleRate = format.sampleRate();
+    result.containerBits = format.bytesPerSample() * 8;
+    result.validBits = result.containerBits;
+    switch (format.sampleFormat()) {
+    case QAudioFormat::Int16: result.sampleType = SampleType::Int16; break;
+    case QAudioFormat::Int32: result.sampleType = SampleType::Int32; break;
+    case QAudioFormat::Float: result.sampleType = SampleType::Float32; break;
+    default: break;
+    }
+    return result;
+}
+
+} // namespace
+
+struct BatchTranscriber::Job {
+    int id = 0;
+    QString inputPath;
+    QString outputPath;
+    QAudioDecoder *decoder = nullptr;
+    SpeechEngine *engine = nullptr;
+    SampleConverter converter;
+    QList<TranscriptSegment> segments;
+    qint64 pushedSamples = 0;
+    QElapsedTimer timer;
+    bool finished = false;
+};
+
+bool writeTranscriptFile(const QString &path, const QList<TranscriptSegment> &segments, QString *errorMessage)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        if (errorMessage) {
+            *errorMessage = file.errorString();
+        }
+        return false;
+    }
+
+    QTextStream out(&file);
+    for (const TranscriptSegment &segment : segments) {
+        out << "[" << formatTimestamp(segment.offsetMs) << " --> "
+            << formatTimestamp(segment.offsetMs + segment.durationMs) << "] "
+            << segment.text << "\n";
+        if (!segment.translation.isEmpty()) {
+            out << "    " << segment.translation << "\n";
+        }
+    }
+    out.flush();
+    return true;
+}
+
+QByteArray convertToSpeechPcm(const QAudioBuffer &buffer, SampleConverter &converter)
+{
+    const QAudioFormat format = buffer.format();
+    if (format.sampleRate() == kSpeechSampleRate && format.channelCount() == 1
+        && format.sampleFormat() == QAudioFormat::Int16) {
+        return QByteArray(buffer.constData<char>(), static_cast<int>(buffer.byteCount()));
+    }
+
+    // 解码器输出格式只在流开始时确定，格式不变时复用已选定的转换函数
+    AudioStreamFormat streamFormat = describeAudioFormat(format);
+    if (!converter.isValid()
+        || converter.format().sampleType != streamFormat.sampleType
+        || converter.format().channels != streamFormat.channels) {
+        converter = SampleConverter::create(streamFormat);
+        if (!converter.isValid()) {
+            return QByteArray();
+        }
+    }
+
+    std::vector<int16_t> mono;
+    converter.convert(buffer.constData<uint8_t>(), static_cast<uint32_t>(buffer.frameCount()), false, mono);
+    std::vector<int16_t> resampled;
+    if (format.sampleRate() != kSpeechSampleRate) {
+        resampleLinear(mono, format.sampleRate(), kSpeechSampleRate, resampled);
+    } else {
+        resampled = std::move(mono);
+    }
+    return QByteArray(reinterpret_cast<const char *>(resampled.data()),
+                      static_cast<int>(resampled.size() * sizeof(int16_t)));
+}
+
+QStringList collectAudioFiles(const QStringList &inputs)
+{
+    static const QStringList audioFilters = {
+        "*.wav", "*.mp3", "*.m4a", "*.wma", "*.flac", "*.aac", "*.ogg"
+    };
+
+    QStringList files;
+    for (const QString &input : inputs) {
+        QFileInfo info(input);
+        if (info.isDir()) {
+            QDirIterator it(input, audioFilters, QDir::Files, QDirIterator::Subdirectories);
+            QStringList found;
+            while (it.hasNext()) {
+                found << it.next();
+            }
+            found.sort();
+            files << found;
+        } else if (info.isFile()) {
+            files << info.absoluteFilePath();
+        } else {
+            LOG_ERROR(QString("输入不存在: %1").arg(input));
+        }
+    }
+    return files;
+}
+
+QString transcriptPathFor(const QString &inputPath, const QString &outputDir)
+{
+    QFileInfo info(inputPath);
+    QString dir = outputDir.isEmpty() ? info.absolutePath() : outputDir;
+    return QDir(dir).filePath(info.completeBaseName() + ".txt");
+}
+
+BatchTranscriber::BatchTranscriber(const BatchOptions &options, QObject *parent)
+    : QObject(parent)
+    , options(options)
+    , totalAudioSeconds(0)
+    , completedCount(0)
+    , failedCount(0)
+    , nextJobId(0)
+{
+    if (this->options.maxParallel < 1) {
+        this->options.maxParallel = 1;
+    }
+}
+
+BatchTranscriber::~BatchTranscriber()
+{
+    for (Job *job : runningJobs) {
+        delete job->decoder;
+        delete job->engine;
+        delete job;
+    }
+}
+
+bool BatchTranscriber::start()
+{
+    pendingFiles = collectAudioFiles(options.inputs);
+    if (pendingFiles.isEmpty()) {
+        LOG_ERROR("没有找到可转写的音频文件");
+        return false;
+    }
+
+    if (!options.outputDir.isEmpty()) {
+        QDir().mkpath(options.outputDir);
+    }
+
+    LOG_INFO(QString("批量转写开始：%1 个文件，并发数 %2，引擎 %3")
+             .arg(pendingFiles.size())
+             .arg(options.maxParallel)
+             .arg(options.engineName));
+    wallClock.start();
+    startPendingJobs();
+    return true;
+}
+
+void BatchTranscriber::startPendingJobs()
+{
+    while (runningJobs.size() < options.maxParallel && !pendingFiles.isEmpty()) {
+        startJob(pendingFiles.takeFirst());
+    }
+
+    if (runningJobs.isEmpty() && pendingFiles.isEmpty()) {
+        reportSummary();
+        emit finished(failedCount);
+    }
+}
+
+void BatchTranscriber::startJob(const QString &inputPath)
+{
+    Job *job = new Job;
+    job->id = ++nextJobId;
+    job->inputPath = inputPath;
+    job->outputPath = transcriptPathFor(inputPath, options.outputDir);
+    job->timer.start();
+    runningJobs.append(job);
+
+    LOG_INFO(QString("开始转写: %1").arg(inputPath));
+
+    // 引擎信号可能来自 SDK 线程并排队送达，此时任务可能已经结束，因此按 id 查找
+    const int id = job->id;
+    job->engine = SpeechEngine::create(options.engineName);
+    connect(job->engine, &SpeechEngine::finalSegment, this,
+            [this, id](qint64 offsetMs, qint64 durationMs, const QString &text, const QString &translation) {
+        if (Job *job = findJob(id)) {
+            job->segments.append({offsetMs, durationMs, text, translation});
+        }
+    });
+    // 结束和错误总是排队处理，避免在 start 调用内部销毁任务
+    connect(job->engine, &SpeechEngine::sessionFinished, this, [this, id]() {
+        if (Job *job = findJob(id)) {
+            finishJob(job);
+        }
+    }, Qt::QueuedConnection);
+    connect(job->engine, &SpeechEngine::error, this, [this, id](const QString &message) {
+        if (Job *job = findJob(id)) {
+            finishJob(job, message);
+        }
+    }, Qt::QueuedConnection);
+
+    job->engine->initialize(options.subscriptionKey, options.region);
+    job->engine->startRecognitionAndTranslation(options.sourceLanguage, options.targetLanguage);
+
+    // 请求解码器直接输出识别所需格式；后端不支持时在 convertToSpeechPcm 中转换
+    QAudioFormat format;
+    format.setSampleRate(kSpeechSampleRate);
+    format.setChannelCount(1);
+    format.setSampleFormat(QAudioFormat::Int16);
+
+    job->decoder = new QAudioDecoder;
+    job->decoder->setAudioFormat(format);
+    job->decoder->setSource(QUrl::fromLocalFile(inputPath));
+    connect(job->decoder, &QAudioDecoder::bufferReady, this, [this, job]() {
+        onBufferReady(job);
+    });
+    connect(job->decoder, &QAudioDecoder::finished, this, [job]() {
+        // 所有音频已送入，等待引擎处理完剩余部分
+        job->engine->finishAudioInput();
+    });
+    connect(job->decoder, QOverload<QAudioDecoder::Error>::of(&QAudioDecoder::error), this,
+            [this, job](QAudioDecoder::Error) {
+        finishJob(job, QString("解码失败: %1").arg(job->decoder->errorString()));
+    });
+    job->decoder->start();
+}
+
+BatchTranscriber::Job *BatchTranscriber::findJob(int id) const
+{
+    for (Job *job : runningJobs) {
+        if (job->id == id) {
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+void BatchTranscriber::onBufferReady(Job *job)
+{
+    while (job->decoder->bufferAvailable()) {
+        QAudioBuffer buffer = job->decoder->read();
+        if (!buffer.isValid()) {
+            continue;
+        }
+        QByteArray pcm = convertToSpeechPcm(buffer, job->converter);
+        if (pcm.isEmpty()) {
+            continue;
+        }
+        job->pushedSamples += pcm.size() / static_cast<int>(sizeof(int16_t));
+        job->engine->processAudioData(pcm);
+    }
+}
+
+void BatchTranscriber::finishJob(Job *job, const QString &errorMessage)
+{
+    if (job->finished) {
+        return;
+    }
+    job->finished = true;
+
+    const double audioSeconds = job->pushedSamples / static_cast<double>(kSpeechSampleRate);
+    const double elapsedSeconds = job->timer.elapsed() / 1000.0;
+
+    QString writeError;
+    if (errorMessage.isEmpty() && !writeTranscriptFile(job->outputPath, job->segments, &writeError)) {
+        LOG_ERROR(QString("写入转写结果失败: %1, %2").arg(job->outputPath, writeError));
+        ++failedCount;
+    } else if (!errorMessage.isEmpty()) {
+        LOG_ERROR(QString("转写失败: %1, %2").arg(job->inputPath, errorMessage));
+        ++failedCount;
+    } else {
+        ++completedCount;
+        totalAudioSeconds += audioSeconds;
+        LOG_INFO(QString("转写完成: %1，音频 %2 秒，耗时 %3 秒，%4 段 -> %5")
+                 .arg(job->inputPath)
+                 .arg(audioSeconds, 0, 'f', 1)
+                 .arg(elapsedSeconds, 0, 'f', 1)
+                 .arg(job->segments.size())
+                 .arg(job->outputPath));
+    }
+
+    runningJobs.removeOne(job);
+    if (job->decoder) {
+        job->decoder->disconnect(this);
+        job->decoder->stop();
+        job->decoder->deleteLater();
+    }
+    job->engine->disconnect(this);
+    job->engine->stopRecognitionAndTranslation();
+    job->engine->deleteLater();
+    delete job;
+
+    startPendingJobs();
+}
+
+void BatchTranscriber::reportSummary()
+{
+    const double wallSeconds = wallClock.elapsed() / 1000.0;
+    const double throughput = wallSeconds > 0 ? totalAudioSeconds / wallSeconds : 0.0;
+
+    QString summary = QString("批量转写结束：成功 %1，失败 %2，音频 %3 小时，耗时 %4 小时，吞吐 %5 音频小时/小时")
+            .arg(completedCount)
+            .arg(failedCount)
+            .arg(totalAudioSeconds / 3600.0, 0, 'f', 3)
+            .arg(wallSeconds / 3600.0, 0, 'f', 3)
+            .arg(throughput, 0, 'f', 1);
+    LOG_INFO(summary);
+    QTextStream(stdout) << summary << Qt::endl;
+}
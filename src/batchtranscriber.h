@@ -0,0 +1,77 @@
+#ifndef BATCHTRANSCRIBER_H
+#define BATCHTRANSCRIBER_H
+
+#include <QObject>
+#include <QStringList>
+#include <QList>
+#include <QElapsedTimer>
+#include "audioformat.h"
+
+class QAudioBuffer;
+
+// 转写结果中的一段（时间以毫秒计，相对于文件开头）
+struct TranscriptSegment {
+    qint64 offsetMs = 0;
+    qint64 durationMs = 0;
+    QString text;
+    QString translation;
+};
+
+// 写出带时间戳的转写文件
+bool writeTranscriptFile(const QString &path, const QList<TranscriptSegment> &segments, QString *errorMessage = nullptr);
+
+// 把解码器输出的音频缓冲区转换为 16kHz/16bit/单声道 PCM
+QByteArray convertToSpeechPcm(const QAudioBuffer &buffer, SampleConverter &converter);
+
+// 展开输入中的目录（递归查找常见音频格式），文件按名称排序
+QStringList collectAudioFiles(const QStringList &inputs);
+// 转写结果的路径：outputDir 为空时写到音频文件旁边
+QString transcriptPathFor(const QString &inputPath, const QString &outputDir);
+
+struct BatchOptions {
+    QStringList inputs;                 // 音频文件或目录
+    QString outputDir;                  // 为空时写到音频文件旁边
+    QString engineName = "azure";
+    QString subscriptionKey;
+    QString region;
+    QString sourceLanguage = "en-US";
+    QString targetLanguage = "zh-CN";
+    int maxParallel = 2;
+};
+
+// 无界面批量转写：并发处理多个录音文件，每个文件以解码速度（而不是实时速度）送入识别引擎
+class BatchTranscriber : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit BatchTranscriber(const BatchOptions &options, QObject *parent = nullptr);
+    ~BatchTranscriber();
+
+    // 展开输入并开始处理，没有可处理的文件时返回 false
+    bool start();
+
+signals:
+    void finished(int failedCount);
+
+private:
+    struct Job;
+
+    void startPendingJobs();
+    void startJob(const QString &inputPath);
+    Job *findJob(int id) const;
+    void onBufferReady(Job *job);
+    void finishJob(Job *job, const QString &errorMessage = QString());
+    void reportSummary();
+
+    BatchOptions options;
+    QStringList pendingFiles;
+    QList<Job *> runningJobs;
+    QElapsedTimer wallClock;
+    double totalAudioSeconds;
+    int completedCount;
+    int failedCount;
+    int nextJobId;
+};
+
+#endif // BATCHTRANSCRIBER_H
@@ -0,0 +1,457 @@
+#include "captionring.h"
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <string>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// 截断到不超过 maxLength 字节，且不切断 UTF-8 多字节字符
+size_t truncateUtf8(const char *text, size_t length, size_t maxLength)
+{
+    if (length <= maxLength) {
+        return length;
+    }
+    size_t cut = maxLength;
+    while (cut > 0 && (static_cast<unsigned char>(text[cut]) & 0xC0) == 0x80) {
+        --cut;
+    }
+    return cut;
+}
+
+uint32_t roundUpPowerOfTwo(uint32_t v)
+{
+    uint32_t result = 1;
+    while (result < v && result < (1u << 20)) {
+        result <<= 1;
+    }
+    return result;
+}
+
+size_t mappingSize(uint32_t slotCount)
+{
+    return sizeof(CaptionRingHeader) + static_cast<size_t>(slotCount) * sizeof(CaptionSlot);
+}
+
+uint32_t currentPid()
+{
+#ifdef _WIN32
+    return static_cast<uint32_t>(GetCurrentProcessId());
+#else
+    return static_cast<uint32_t>(getpid());
+#endif
+}
+
+} // namespace
+
+// 平台相关的命名共享内存
+class CaptionRingMapping
+{
+public:
+    ~CaptionRingMapping() { unmap(); }
+
+    bool create(const char *name, size_t size)
+    {
+#ifdef _WIN32
+        const std::wstring wideName = L"Local\\" + widen(name);
+        handle = CreateFileMappingW(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                                    0, static_cast<DWORD>(size), wideName.c_str());
+        if (!handle) {
+            return false;
+        }
+        const bool existed = GetLastError() == ERROR_ALREADY_EXISTS;
+        view = MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, size);
+        if (view && existed) {
+            // 读取方还开着上次的共享内存。只有原写入方已经退出时才接管
+            const CaptionRingHeader *old = static_cast<const CaptionRingHeader *>(view);
+            if (old->writerPid != 0 && processAlive(old->writerPid)) {
+                UnmapViewOfFile(view);
+                view = nullptr;
+            }
+        }
+        if (!view) {
+            CloseHandle(handle);
+            handle = NULL;
+            return false;
+        }
+#else
+        path = std::string("/") + name;
+        int fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd < 0 && errno == EEXIST && !ownerAlive(path.c_str())) {
+            // 上次的写入方异常退出，留下了共享内存
+            shm_unlink(path.c_str());
+            fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        }
+        if (fd < 0) {
+            path.clear();
+            return false;
+        }
+        if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            ::close(fd);
+            shm_unlink(path.c_str());
+            path.clear();
+            return false;
+        }
+        view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (view == MAP_FAILED) {
+            view = nullptr;
+        }
+        owner = true;
+#endif
+        mappedSize = size;
+        return view != nullptr;
+    }
+
+    // 只读映射整个区域，大小由写入方决定
+    bool openReadOnly(const char *name)
+    {
+#ifdef _WIN32
+        const std::wstring wideName = L"Local\\" + widen(name);
+        handle = OpenFileMappingW(FILE_MAP_READ, FALSE, wideName.c_str());
+        if (!handle) {
+            return false;
+        }
+        view = MapViewOfFile(handle, FILE_MAP_READ, 0, 0, 0);
+        if (view) {
+            MEMORY_BASIC_INFORMATION info;
+            if (VirtualQuery(view, &info, sizeof(info)) == sizeof(info)) {
+                mappedSize = info.RegionSize;
+            }
+        }
+        return view != nullptr;
+#else
+        const std::string shmPath = std::string("/") + name;
+        const int fd = shm_open(shmPath.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(CaptionRingHeader))) {
+            ::close(fd);
+            return false;
+        }
+        mappedSize = static_cast<size_t>(st.st_size);
+        view = mmap(nullptr, mappedSize, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (view == MAP_FAILED) {
+            view = nullptr;
+        }
+        return view != nullptr;
+#endif
+    }
+
+    void *data() const { return view; }
+    size_t size() const { return mappedSize; }
+
+private:
+    void unmap()
+    {
+#ifdef _WIN32
+        if (view) {
+            UnmapViewOfFile(view);
+        }
+        if (handle) {
+            CloseHandle(handle);
+        }
+        handle = NULL;
+#else
+        if (view) {
+            munmap(view, mappedSize);
+        }
+        // 已打开的读取方仍保留各自的映射，直到它们关闭
+        if (owner && !path.empty()) {
+            shm_unlink(path.c_str());
+        }
+        owner = false;
+        path.clear();
+#endif
+        view = nullptr;
+        mappedSize = 0;
+    }
+
+#ifdef _WIN32
+    static std::wstring widen(const char *utf8)
+    {
+        wchar_t buffer[256];
+        const int n = MultiByteToWideChar(CP_UTF8, 0, utf8, -1, buffer, 256);
+        return n > 0 ? std::wstring(buffer) : std::wstring();
+    }
+
+    static bool processAlive(uint32_t pid)
+    {
+        HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+        if (!process) {
+            return GetLastError() == ERROR_ACCESS_DENIED;
+        }
+        DWORD exitCode = 0;
+        const bool alive = GetExitCodeProcess(process, &exitCode) && exitCode == STILL_ACTIVE;
+        CloseHandle(process);
+        return alive;
+    }
+
+    HANDLE handle = NULL;
+#else
+    static bool ownerAlive(const char *shmPath)
+    {
+        const int fd = shm_open(shmPath, O_RDONLY, 0);
+        if (fd < 0) {
+            return false;
+        }
+        CaptionRingHeader header;
+        const ssize_t n = pread(fd, &header, sizeof(header), 0);
+        ::close(fd);
+        if (n != static_cast<ssize_t>(sizeof(header)) || header.writerPid == 0) {
+            return false;
+        }
+        return kill(static_cast<pid_t>(header.writerPid), 0) == 0 || errno == EPERM;
+    }
+
+    std::string path;
+    bool owner = false;
+#endif
+    void *view = nullptr;
+    size_t mappedSize = 0;
+};
+
+uint64_t captionRingNowUs()
+{
+#ifdef _WIN32
+    static const double ticksPerUs = []() {
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+        return frequency.QuadPart / 1e6;
+    }();
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return static_cast<uint64_t>(counter.QuadPart / ticksPerUs);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000u + static_cast<uint64_t>(ts.tv_nsec) / 1000u;
+#endif
+}
+
+CaptionRingWriter::CaptionRingWriter()
+    : mapping(nullptr)
+    , header(nullptr)
+    , slotArray(nullptr)
+    , mask(0)
+    , nextSequence(0)
+{
+}
+
+CaptionRingWriter::~CaptionRingWriter()
+{
+    close();
+}
+
+bool CaptionRingWriter::create(const char *name, uint32_t slotCount)
+{
+    close();
+    slotCount = roundUpPowerOfTwo(slotCount);
+
+    CaptionRingMapping *created = new CaptionRingMapping;
+    if (!created->create(name, mappingSize(slotCount))) {
+        delete created;
+        return false;
+    }
+    mapping = created;
+
+    std::memset(mapping->data(), 0, mapping->size());
+    header = static_cast<CaptionRingHeader *>(mapping->data());
+    slotArray = reinterpret_cast<CaptionSlot *>(static_cast<char *>(mapping->data()) + sizeof(CaptionRingHeader));
+    mask = slotCount - 1;
+    nextSequence = 0;
+
+    header->version = kCaptionRingVersion;
+    header->headerSize = sizeof(CaptionRingHeader);
+    header->slotSize = sizeof(CaptionSlot);
+    header->slotCount = slotCount;
+    header->writerPid = currentPid();
+    header->startTimeUnixMs = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count());
+    header->published.store(0, std::memory_order_relaxed);
+    // 魔数最后写入，读取方看到魔数即可认为头部完整
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(header->magic, "MACR", 4);
+    return true;
+}
+
+void CaptionRingWriter::close()
+{
+    if (header) {
+        header->writerPid = 0;
+    }
+    delete mapping;
+    mapping = nullptr;
+    header = nullptr;
+    slotArray = nullptr;
+}
+
+uint64_t CaptionRingWriter::publish(CaptionKind kind, const char *text, size_t textLength,
+                                    const char *translation, size_t translationLength,
+                                    int64_t offsetMs, int64_t durationMs)
+{
+    if (!header) {
+        return 0;
+    }
+    const uint64_t sequence = nextSequence++;
+    CaptionSlot &slot = slotArray[sequence & mask];
+
+    slot.sequence.store(2 * sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    // 两段都放不下时，原文最多占一半空间
+    const size_t translationReserve = translationLength < kCaptionSlotDataSize / 2
+            ? translationLength : kCaptionSlotDataSize / 2;
+    const size_t textCopied = text ? truncateUtf8(text, textLength, kCaptionSlotDataSize - translationReserve) : 0;
+    const size_t translationCopied = translation
+            ? truncateUtf8(translation, translationLength, kCaptionSlotDataSize - textCopied) : 0;
+    if (textCopied > 0) {
+        std::memcpy(slot.data, text, textCopied);
+    }
+    if (translationCopied > 0) {
+        std::memcpy(slot.data + textCopied, translation, translationCopied);
+    }
+    slot.textLength = static_cast<uint16_t>(textCopied);
+    slot.translationLength = static_cast<uint16_t>(translationCopied);
+    slot.kind = static_cast<uint32_t>(kind);
+    slot.offsetMs = offsetMs;
+    slot.durationMs = durationMs;
+    slot.publishTimeUs = captionRingNowUs();
+
+    slot.sequence.store(2 * sequence + 2, std::memory_order_release);
+    header->published.store(sequence + 1, std::memory_order_release);
+    return sequence;
+}
+
+CaptionRingReader::CaptionRingReader()
+    : mapping(nullptr)
+    , header(nullptr)
+    , slotArray(nullptr)
+    , mask(0)
+    , slotCount(0)
+    , nextSequence(0)
+    , droppedCount(0)
+{
+}
+
+CaptionRingReader::~CaptionRingReader()
+{
+    close();
+}
+
+bool CaptionRingReader::open(const char *name, bool fromOldest)
+{
+    close();
+
+    CaptionRingMapping *opened = new CaptionRingMapping;
+    if (!opened->openReadOnly(name)) {
+        delete opened;
+        return false;
+    }
+    const CaptionRingHeader *h = static_cast<const CaptionRingHeader *>(opened->data());
+    const bool valid = std::memcmp(h->magic, "MACR", 4) == 0
+            && h->version == kCaptionRingVersion
+            && h->headerSize == sizeof(CaptionRingHeader)
+            && h->slotSize == sizeof(CaptionSlot)
+            && h->slotCount > 0 && (h->slotCount & (h->slotCount - 1)) == 0
+            && opened->size() >= mappingSize(h->slotCount);
+    if (!valid) {
+        delete opened;
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    mapping = opened;
+    header = h;
+    slotArray = reinterpret_cast<const CaptionSlot *>(static_cast<const char *>(mapping->data()) + sizeof(CaptionRingHeader));
+    slotCount = h->slotCount;
+    mask = slotCount - 1;
+    droppedCount = 0;
+
+    const uint64_t published = header->published.load(std::memory_order_acquire);
+    if (fromOldest) {
+        nextSequence = published > slotCount ? published - slotCount : 0;
+    } else {
+        nextSequence = published;
+    }
+    return true;
+}
+
+void CaptionRingReader::close()
+{
+    delete mapping;
+    mapping = nullptr;
+    header = nullptr;
+    slotArray = nullptr;
+}
+
+bool CaptionRingReader::next(CaptionRecord &out)
+{
+    if (!header) {
+        return false;
+    }
+    for (;;) {
+        const uint64_t published = header->published.load(std::memory_order_acquire);
+        if (published < nextSequence) {
+            // 写入方重新创建了环
+            nextSequence = published;
+        }
+        if (nextSequence == published) {
+            return false;
+        }
+        if (published - nextSequence > slotCount) {
+            droppedCount += published - slotCount - nextSequence;
+            nextSequence = published - slotCount;
+        }
+
+        const CaptionSlot &slot = slotArray[nextSequence & mask];
+        const uint64_t expected = 2 * nextSequence + 2;
+        const uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before == expected) {
+            out.publishTimeUs = slot.publishTimeUs;
+            out.offsetMs = slot.offsetMs;
+            out.durationMs = slot.durationMs;
+            out.kind = slot.kind;
+            out.textLength = slot.textLength;
+            out.translationLength = slot.translationLength;
+            const size_t length = static_cast<size_t>(out.textLength) + out.translationLength;
+            std::memcpy(out.data, slot.data, length <= kCaptionSlotDataSize ? length : kCaptionSlotDataSize);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const uint64_t after = slot.sequence.load(std::memory_order_relaxed);
+            if (after == before && length <= kCaptionSlotDataSize) {
+                out.sequence = nextSequence++;
+                return true;
+            }
+        } else if (before < expected) {
+            // 编号已发布但内容还不可见（不应发生），下次再读
+            return false;
+        }
+        // 复制过程中或之前被新记录覆盖
+        ++droppedCount;
+        ++nextSequence;
+    }
+}
+
+uint64_t CaptionRingReader::published() const
+{
+    return header ? header->published.load(std::memory_order_acquire) : 0;
+}
+
+uint32_t CaptionRingReader::writerPid() const
+{
+    return header ? header->writerPid : 0;
+}
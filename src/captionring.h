@@ -0,0 +1,150 @@
+#ifndef CAPTIONRING_H
+#define CAPTIONRING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// 字幕共享内存环：程序把部分/最终字幕发布到一块命名共享内存中，
+// 本机其他进程（直播叠加层、笔记工具、录制程序等）直接映射读取，不经过程序转发，
+// 读者数量不限，读写双方都不加锁。本头文件和 captionring.cpp 不依赖 Qt，
+// 外部程序编译这两个文件即可作为读取库使用（示例见 tools/captionfeed）。
+//
+// 共享内存名称：Windows 为 "Local\<name>"（CreateFileMapping），
+// 其他系统为 "/<name>"（shm_open），默认 name 为 kCaptionRingDefaultName。
+//
+// 布局（版本 1，小端，所有偏移以字节计）：
+//   [0, 64)            CaptionRingHeader
+//   [64, 64 + N*1024)  N 个 CaptionSlot，N = slotCount，为 2 的幂
+//
+// 第 n 条记录（n 从 0 开始）写在 slot[n % N]。每个槽位是一个顺序锁：
+//   sequence == 2n+1  正在写入第 n 条
+//   sequence == 2n+2  第 n 条已写完
+//   sequence == 0     从未写入
+// 写入方（只有一个）先把 sequence 置为奇数，写内容，再置为偶数，最后把 header.published 加一。
+// 读取方读 sequence、复制内容、再读一次 sequence，两次相同且等于 2n+2 才算读到完整记录，
+// 否则说明该槽位已被新记录覆盖（读取方落后超过 N 条），计为丢失并跳过。
+//
+// publishTimeUs 是发布时刻的单调时钟（Windows 为 QueryPerformanceCounter，其他系统为
+// CLOCK_MONOTONIC，均为系统范围），读取方用 captionRingNowUs() 计算发布到读取的延迟。
+
+const char kCaptionRingDefaultName[] = "MeetingAssistantCaptions";
+const uint32_t kCaptionRingVersion = 1;
+const uint32_t kCaptionRingDefaultSlots = 256;
+const int kCaptionSlotSize = 1024;
+const int kCaptionSlotDataSize = kCaptionSlotSize - 40;
+
+enum class CaptionKind : uint32_t {
+    Partial = 0,    // 识别中的部分结果，后续会被同一句的新结果取代
+    Final = 1       // 一句的最终结果
+};
+
+struct CaptionRingHeader {
+    char magic[4];                      // "MACR"，写入方初始化完成后最后写入
+    uint32_t version;                   // kCaptionRingVersion
+    uint32_t headerSize;                // 64
+    uint32_t slotSize;                  // kCaptionSlotSize
+    uint32_t slotCount;
+    uint32_t writerPid;
+    uint64_t startTimeUnixMs;           // 写入方创建共享内存时的系统时间
+    std::atomic<uint64_t> published;    // 已发布的记录数
+    char reserved[24];
+};
+static_assert(sizeof(CaptionRingHeader) == 64, "CaptionRingHeader 布局变化需要同步修改版本号");
+
+// 记录内容：text 和 translation 都是 UTF-8，依次存放在 data 中，不以 0 结尾
+struct CaptionRecord {
+    uint64_t sequence;          // 记录编号 n
+    uint64_t publishTimeUs;
+    int64_t offsetMs;           // 最终结果在音频流中的位置，部分结果为 0
+    int64_t durationMs;
+    uint32_t kind;              // CaptionKind
+    uint16_t textLength;
+    uint16_t translationLength;
+    char data[kCaptionSlotDataSize];
+
+    const char *text() const { return data; }
+    const char *translation() const { return data + textLength; }
+};
+
+struct CaptionSlot {
+    std::atomic<uint64_t> sequence;
+    uint64_t publishTimeUs;
+    int64_t offsetMs;
+    int64_t durationMs;
+    uint32_t kind;
+    uint16_t textLength;
+    uint16_t translationLength;
+    char data[kCaptionSlotDataSize];
+};
+static_assert(sizeof(CaptionSlot) == kCaptionSlotSize, "CaptionSlot 布局变化需要同步修改版本号");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "共享内存中的原子变量必须是无锁的");
+
+// 系统范围的单调时钟（微秒），与 publishTimeUs 可比
+uint64_t captionRingNowUs();
+
+class CaptionRingMapping;
+
+// 写入方：同一时刻只能有一个进程创建同名的环，publish 只能在一个线程中调用
+class CaptionRingWriter
+{
+public:
+    CaptionRingWriter();
+    ~CaptionRingWriter();
+
+    // slotCount 向上取整为 2 的幂。同名的环已被其他进程占用时返回 false
+    bool create(const char *name = kCaptionRingDefaultName, uint32_t slotCount = kCaptionRingDefaultSlots);
+    void close();
+    bool isOpen() const { return header != nullptr; }
+
+    // 超出槽位容量的文本按 UTF-8 字符边界截断；返回记录编号
+    uint64_t publish(CaptionKind kind, const char *text, size_t textLength,
+                     const char *translation, size_t translationLength,
+                     int64_t offsetMs = 0, int64_t durationMs = 0);
+
+private:
+    CaptionRingWriter(const CaptionRingWriter &) = delete;
+    CaptionRingWriter &operator=(const CaptionRingWriter &) = delete;
+
+    CaptionRingMapping *mapping;
+    CaptionRingHeader *header;
+    CaptionSlot *slotArray;
+    uint64_t mask;
+    uint64_t nextSequence;
+};
+
+// 读取方：只读映射，轮询 next() 取新记录
+class CaptionRingReader
+{
+public:
+    CaptionRingReader();
+    ~CaptionRingReader();
+
+    // 写入方尚未创建或布局版本不符时返回 false，可稍后重试。
+    // 默认从打开之后发布的记录开始读，fromOldest 为 true 时从环中最早的记录开始
+    bool open(const char *name = kCaptionRingDefaultName, bool fromOldest = false);
+    void close();
+    bool isOpen() const { return header != nullptr; }
+
+    // 有新记录时复制到 out 并返回 true；落后太多被覆盖的记录计入 dropped()
+    bool next(CaptionRecord &out);
+
+    uint64_t dropped() const { return droppedCount; }
+    uint64_t published() const;
+    // 写入方关闭后为 0，此时应 close() 并定期重新 open()
+    uint32_t writerPid() const;
+
+private:
+    CaptionRingReader(const CaptionRingReader &) = delete;
+    CaptionRingReader &operator=(const CaptionRingReader &) = delete;
+
+    CaptionRingMapping *mapping;
+    const CaptionRingHeader *header;
+    const CaptionSlot *slotArray;
+    uint64_t mask;
+    uint64_t slotCount;
+    uint64_t nextSequence;
+    uint64_t droppedCount;
+};
+
+#endif // CAPTIONRING_H
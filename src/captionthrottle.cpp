@@ -0,0 +1,109 @@
+#include "captionthrottle.h"
+#include "metrics.h"
+
+namespace {
+
+MetricCounter &updatesCounter()
+{
+    static MetricCounter &updates = Metrics::counter("caption_updates_total", "实时字幕的界面刷新次数");
+    return updates;
+}
+
+} // namespace
+
+CaptionThrottle::CaptionThrottle(QObject *parent)
+    : QObject(parent)
+    , intervalMs(0)
+    , hasPending(false)
+    , suspended(false)
+    , emitted(0)
+    , coalesced(0)
+    , totalDelay(0)
+    , maxDelay(0)
+{
+    timer.setSingleShot(true);
+    connect(&timer, &QTimer::timeout, this, &CaptionThrottle::emitPending);
+}
+
+void CaptionThrottle::setInterval(int ms)
+{
+    intervalMs = qMax(0, ms);
+    if (intervalMs == 0 && hasPending) {
+        timer.stop();
+        emitPending();
+    }
+}
+
+void CaptionThrottle::setSuspended(bool value)
+{
+    if (suspended == value) {
+        return;
+    }
+    suspended = value;
+    timer.stop();
+    if (!suspended && hasPending) {
+        emitPending();
+    }
+}
+
+void CaptionThrottle::submit(const QString &text)
+{
+    if (intervalMs == 0 && !suspended) {
+        ++emitted;
+        updatesCounter().add();
+        emit textReady(text);
+        return;
+    }
+
+    pendingText = text;
+    if (hasPending) {
+        static MetricCounter &coalescedCounter = Metrics::counter("caption_coalesced_total", "节流合并掉的字幕更新数");
+        coalescedCounter.add();
+        ++coalesced;
+        return;
+    }
+
+    hasPending = true;
+    pendingSince.start();
+    if (suspended) {
+        return;
+    }
+    const qint64 elapsed = sinceLastEmit.isValid() ? sinceLastEmit.elapsed() : intervalMs;
+    if (elapsed >= intervalMs) {
+        emitPending();
+    } else {
+        timer.start(static_cast<int>(intervalMs - elapsed));
+    }
+}
+
+void CaptionThrottle::emitPending()
+{
+    if (!hasPending || suspended) {
+        return;
+    }
+    hasPending = false;
+
+    const double delay = pendingSince.nsecsElapsed() / 1e6;
+    totalDelay += delay;
+    maxDelay = qMax(maxDelay, delay);
+    ++emitted;
+    updatesCounter().add();
+    sinceLastEmit.start();
+
+    const QString text = pendingText;
+    pendingText.clear();
+    emit textReady(text);
+}
+
+double CaptionThrottle::averageDelayMs() const
+{
+    return emitted > 0 ? totalDelay / emitted : 0.0;
+}
+
+void CaptionThrottle::resetStats()
+{
+    emitted = 0;
+    coalesced = 0;
+    totalDelay = 0;
+    maxDelay = 0;
+}
@@ -0,0 +1,49 @@
+#ifndef CAPTIONTHROTTLE_H
+#define CAPTIONTHROTTLE_H
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QElapsedTimer>
+
+// 实时字幕刷新节流：间隔内到达的多次更新合并为一次，只显示最新文本
+class CaptionThrottle : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit CaptionThrottle(QObject *parent = nullptr);
+
+    // 0 表示不节流，每次提交都立即输出
+    void setInterval(int ms);
+    void submit(const QString &text);
+    // 暂停期间只保留最新文本，恢复时输出一次（窗口最小化时不刷新看不见的文本框）
+    void setSuspended(bool suspended);
+
+    // 统计：文本从提交到显示的等待时间，以及被合并掉的更新数
+    double averageDelayMs() const;
+    double maxDelayMs() const { return maxDelay; }
+    int coalescedCount() const { return coalesced; }
+    void resetStats();
+
+signals:
+    void textReady(const QString &text);
+
+private:
+    void emitPending();
+
+    int intervalMs;
+    QTimer timer;
+    QString pendingText;
+    bool hasPending;
+    bool suspended;
+    QElapsedTimer sinceLastEmit;
+    QElapsedTimer pendingSince;
+
+    int emitted;
+    int coalesced;
+    double totalDelay;
+    double maxDelay;
+};
+
+#endif // CAPTIONTHROTTLE_H
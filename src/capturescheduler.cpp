@@ -0,0 +1,200 @@
+#include "capturescheduler.h"
+#include "metrics.h"
+#include <algorithm>
+
+CaptureScheduler::CaptureScheduler(const CaptureSchedulerConfig &config)
+    : config(config)
+    , timeoutMs(config.activeTimeoutMs)
+    , idle(false)
+    , inSilence(false)
+    , silenceStartUs(0)
+    , wakeups(0)
+    , eventWakeups(0)
+    , timeoutWakeups(0)
+    , lateWakeups(0)
+    , latePackets(0)
+    , packets(0)
+    , discontinuities(0)
+    , timestampErrors(0)
+    , silentSpans(0)
+    , silentMs(0)
+    , publishedTimeoutMs(config.activeTimeoutMs)
+{
+}
+
+void CaptureScheduler::setConfig(const CaptureSchedulerConfig &newConfig)
+{
+    config = newConfig;
+    config.activeTimeoutMs = std::max(1, config.activeTimeoutMs);
+    config.maxIdleTimeoutMs = std::max(config.activeTimeoutMs, config.maxIdleTimeoutMs);
+}
+
+void CaptureScheduler::reset(uint64_t nowUs)
+{
+    timeoutMs = config.activeTimeoutMs;
+    idle = false;
+    inSilence = false;
+    silenceStartUs = nowUs;
+    wakeups = 0;
+    eventWakeups = 0;
+    timeoutWakeups = 0;
+    lateWakeups = 0;
+    latePackets = 0;
+    packets = 0;
+    discontinuities = 0;
+    timestampErrors = 0;
+    silentSpans = 0;
+    silentMs = 0;
+    publishedTimeoutMs = timeoutMs;
+}
+
+void CaptureScheduler::onWake(uint64_t waitStartUs, uint64_t nowUs, bool signaled)
+{
+    static MetricCounter &eventCounter = Metrics::counter("capture_event_wakeups_total", "采集线程被缓冲区事件唤醒的次数");
+    static MetricCounter &timeoutCounter = Metrics::counter("capture_timeout_wakeups_total", "采集线程等待超时醒来的次数");
+    static MetricCounter &lateCounter = Metrics::counter("capture_late_wakeups_total", "采集线程比预期晚醒来的次数");
+
+    wakeups.fetch_add(1, std::memory_order_relaxed);
+    if (signaled) {
+        eventWakeups.fetch_add(1, std::memory_order_relaxed);
+        eventCounter.add();
+        return;
+    }
+
+    timeoutWakeups.fetch_add(1, std::memory_order_relaxed);
+    timeoutCounter.add();
+    // 超时醒来的时间应接近等待超时，明显更晚说明线程没有及时得到调度
+    const uint64_t elapsedUs = nowUs > waitStartUs ? nowUs - waitStartUs : 0;
+    const uint64_t deadlineUs = static_cast<uint64_t>(timeoutMs + config.lateWakeSlackMs) * 1000;
+    if (elapsedUs > deadlineUs) {
+        lateWakeups.fetch_add(1, std::memory_order_relaxed);
+        lateCounter.add();
+    }
+}
+
+void CaptureScheduler::onPacket(const CapturePacket &packet, uint64_t nowUs)
+{
+    static MetricCounter &discontinuityCounter = Metrics::counter(
+            "capture_discontinuities_total", "数据不连续（采集线程来不及取走而丢失）的数据包数");
+    static MetricCounter &timestampErrorCounter = Metrics::counter("capture_timestamp_errors_total", "时间戳错误的数据包数");
+    static MetricCounter &latePacketCounter = Metrics::counter(
+            "capture_late_packets_total", "取走时已超过迟到阈值的数据包数");
+
+    packets.fetch_add(1, std::memory_order_relaxed);
+    if (packet.discontinuity) {
+        discontinuities.fetch_add(1, std::memory_order_relaxed);
+        discontinuityCounter.add();
+    }
+    if (packet.timestampError) {
+        timestampErrors.fetch_add(1, std::memory_order_relaxed);
+        timestampErrorCounter.add();
+    }
+    if (packet.latencyUs > static_cast<int64_t>(config.latePacketMs) * 1000) {
+        latePackets.fetch_add(1, std::memory_order_relaxed);
+        latePacketCounter.add();
+    }
+
+    if (packet.silent) {
+        enterSilence(nowUs);
+    } else {
+        leaveSilence(nowUs);
+    }
+    updateTimeout(nowUs);
+}
+
+void CaptureScheduler::onNoData(uint64_t nowUs)
+{
+    enterSilence(nowUs);
+    updateTimeout(nowUs);
+}
+
+void CaptureScheduler::finish(uint64_t nowUs)
+{
+    leaveSilence(nowUs);
+    timeoutMs = config.activeTimeoutMs;
+    idle = false;
+    publishedTimeoutMs = timeoutMs;
+}
+
+void CaptureScheduler::enterSilence(uint64_t nowUs)
+{
+    static MetricCounter &spanCounter = Metrics::counter("capture_silent_spans_total", "采集中出现的静音段数");
+    if (inSilence) {
+        return;
+    }
+    inSilence = true;
+    silenceStartUs = nowUs;
+    silentSpans.fetch_add(1, std::memory_order_relaxed);
+    spanCounter.add();
+}
+
+void CaptureScheduler::leaveSilence(uint64_t nowUs)
+{
+    static MetricCounter &silentMsCounter = Metrics::counter(
+            "capture_silent_seconds_total", "静音段累计时长（秒）", 0.001);
+    if (!inSilence) {
+        return;
+    }
+    inSilence = false;
+    const uint64_t spanMs = nowUs > silenceStartUs ? (nowUs - silenceStartUs) / 1000 : 0;
+    silentMs.fetch_add(spanMs, std::memory_order_relaxed);
+    silentMsCounter.add(spanMs);
+}
+
+void CaptureScheduler::updateTimeout(uint64_t nowUs)
+{
+    if (!inSilence) {
+        // 一有声音立即回到活跃超时；事件驱动下数据到达本来就会立即唤醒，这里只影响兜底
+        idle = false;
+        timeoutMs = config.activeTimeoutMs;
+    } else if (nowUs - silenceStartUs >= static_cast<uint64_t>(config.idleAfterMs) * 1000) {
+        // 静音持续一段时间后每次唤醒把超时翻倍，直到上限
+        timeoutMs = idle ? std::min(timeoutMs * 2, config.maxIdleTimeoutMs) : config.activeTimeoutMs;
+        idle = true;
+    }
+    publishedTimeoutMs.store(timeoutMs, std::memory_order_relaxed);
+}
+
+CaptureGlitchStats CaptureScheduler::stats() const
+{
+    CaptureGlitchStats s;
+    s.wakeups = wakeups.load(std::memory_order_relaxed);
+    s.eventWakeups = eventWakeups.load(std::memory_order_relaxed);
+    s.timeoutWakeups = timeoutWakeups.load(std::memory_order_relaxed);
+    s.lateWakeups = lateWakeups.load(std::memory_order_relaxed);
+    s.latePackets = latePackets.load(std::memory_order_relaxed);
+    s.packets = packets.load(std::memory_order_relaxed);
+    s.discontinuities = discontinuities.load(std::memory_order_relaxed);
+    s.timestampErrors = timestampErrors.load(std::memory_order_relaxed);
+    s.silentSpans = silentSpans.load(std::memory_order_relaxed);
+    s.silentMs = silentMs.load(std::memory_order_relaxed);
+    s.currentTimeoutMs = publishedTimeoutMs.load(std::memory_order_relaxed);
+    return s;
+}
+
+void runCaptureLoop(CaptureClock &clock, CaptureSource &source, CaptureScheduler &scheduler,
+                    const std::atomic<bool> &running)
+{
+    scheduler.reset(clock.nowUs());
+    CapturePacket packet;
+    while (running.load(std::memory_order_relaxed)) {
+        const uint64_t waitStartUs = clock.nowUs();
+        const bool signaled = source.waitForData(scheduler.waitTimeoutMs());
+        scheduler.onWake(waitStartUs, clock.nowUs(), signaled);
+
+        // 一次唤醒取完所有积压的数据包，线程被延迟调度时也不会越积越多
+        int read = 0;
+        while (running.load(std::memory_order_relaxed)) {
+            packet = CapturePacket();
+            if (!source.readPacket(packet)) {
+                break;
+            }
+            scheduler.onPacket(packet, clock.nowUs());
+            ++read;
+        }
+        if (read == 0) {
+            scheduler.onNoData(clock.nowUs());
+        }
+    }
+    scheduler.finish(clock.nowUs());
+}
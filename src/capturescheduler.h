@@ -0,0 +1,108 @@
+#ifndef CAPTURESCHEDULER_H
+#define CAPTURESCHEDULER_H
+
+#include <atomic>
+#include <cstdint>
+
+// 采集线程的调度：等待音频引擎的缓冲区事件（带超时兜底），取完所有数据包，
+// 流中持续静音时逐步放宽超时，减少空闲唤醒；同时统计数据不连续、静音段和迟到唤醒。
+// 时钟和数据来源都是接口，WASAPI 实现使用 QPC 和缓冲区事件，
+// tests/capturescheduletest 使用模拟时钟和脚本化的数据来源。本头文件不依赖 Qt。
+
+class CaptureClock
+{
+public:
+    virtual ~CaptureClock() = default;
+    virtual uint64_t nowUs() = 0;
+};
+
+struct CapturePacket {
+    uint32_t frames = 0;
+    bool silent = false;
+    bool discontinuity = false;
+    bool timestampError = false;
+    int64_t latencyUs = -1;     // 设备记录采样到被取走的时间，未知为 -1
+};
+
+class CaptureSource
+{
+public:
+    virtual ~CaptureSource() = default;
+    // 等待数据就绪事件，最多 timeoutMs 毫秒；事件触发返回 true，超时返回 false
+    virtual bool waitForData(int timeoutMs) = 0;
+    // 取出并处理下一个数据包；没有待取的数据时返回 false
+    virtual bool readPacket(CapturePacket &packet) = 0;
+};
+
+struct CaptureSchedulerConfig {
+    int activeTimeoutMs = 20;       // 有声音时的等待超时（事件丢失时兜底）
+    int maxIdleTimeoutMs = 200;     // 静音时超时逐步放宽到的上限
+    int idleAfterMs = 500;          // 连续静音多久后开始放宽
+    int lateWakeSlackMs = 15;       // 超时唤醒比预期晚这么多算迟到
+    int latePacketMs = 100;         // 数据包延迟超过这么多算迟到（线程没有及时被调度）
+};
+
+struct CaptureGlitchStats {
+    uint64_t wakeups = 0;
+    uint64_t eventWakeups = 0;
+    uint64_t timeoutWakeups = 0;
+    uint64_t lateWakeups = 0;
+    uint64_t latePackets = 0;
+    uint64_t packets = 0;
+    uint64_t discontinuities = 0;
+    uint64_t timestampErrors = 0;
+    uint64_t silentSpans = 0;
+    uint64_t silentMs = 0;          // 已结束的静音段总时长
+    int currentTimeoutMs = 0;
+};
+
+// 状态只在采集线程中修改，统计可以在任意线程读取
+class CaptureScheduler
+{
+public:
+    explicit CaptureScheduler(const CaptureSchedulerConfig &config = CaptureSchedulerConfig());
+
+    void setConfig(const CaptureSchedulerConfig &config);
+    void reset(uint64_t nowUs);
+
+    int waitTimeoutMs() const { return timeoutMs; }
+    bool isIdle() const { return idle; }
+
+    void onWake(uint64_t waitStartUs, uint64_t nowUs, bool signaled);
+    void onPacket(const CapturePacket &packet, uint64_t nowUs);
+    // 一次唤醒没有取到任何数据包（回环流在没有声音播放时不产生数据）
+    void onNoData(uint64_t nowUs);
+    // 采集结束时结算未结束的静音段
+    void finish(uint64_t nowUs);
+
+    CaptureGlitchStats stats() const;
+
+private:
+    void enterSilence(uint64_t nowUs);
+    void leaveSilence(uint64_t nowUs);
+    void updateTimeout(uint64_t nowUs);
+
+    CaptureSchedulerConfig config;
+    int timeoutMs;
+    bool idle;
+    bool inSilence;
+    uint64_t silenceStartUs;
+
+    std::atomic<uint64_t> wakeups;
+    std::atomic<uint64_t> eventWakeups;
+    std::atomic<uint64_t> timeoutWakeups;
+    std::atomic<uint64_t> lateWakeups;
+    std::atomic<uint64_t> latePackets;
+    std::atomic<uint64_t> packets;
+    std::atomic<uint64_t> discontinuities;
+    std::atomic<uint64_t> timestampErrors;
+    std::atomic<uint64_t> silentSpans;
+    std::atomic<uint64_t> silentMs;
+    std::atomic<int> publishedTimeoutMs;
+};
+
+// 采集线程主循环，直到 running 变为 false
+void runCaptureLoop(CaptureClock &clock, CaptureSource &source, CaptureScheduler &scheduler,
+                    const std::atomic<bool> &running);
+
+#endif // CAPTURESCHEDULER_H
@@ -0,0 +1,147 @@
+#include "capturetest.h"
+#include "audioprocessor.h"
+#include "capturescheduler.h"
+#include "logger.h"
+#include <QTextStream>
+#include <QtEndian>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+const int kSampleRate = 16000;
+
+double toDb(double amplitude)
+{
+    return amplitude > 0 ? 20.0 * std::log10(amplitude / 32768.0) : -120.0;
+}
+
+} // namespace
+
+CaptureTest::CaptureTest(const CaptureTestOptions &options, QObject *parent)
+    : QObject(parent)
+    , options(options)
+    , audioProcessor(nullptr)
+    , samples(0)
+    , packets(0)
+    , peak(0)
+    , sumSquares(0)
+{
+    stopTimer.setSingleShot(true);
+    connect(&stopTimer, &QTimer::timeout, this, &CaptureTest::finish);
+}
+
+CaptureTest::~CaptureTest()
+{
+    if (audioProcessor) {
+        audioProcessor->stopRecording();
+    }
+}
+
+bool CaptureTest::start()
+{
+    if (!options.outputWav.isEmpty()) {
+        wavFile.setFileName(options.outputWav);
+        if (!wavFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            LOG_ERROR(QString("无法写入 %1").arg(options.outputWav));
+            return false;
+        }
+        writeWavHeader(0);
+    }
+
+    audioProcessor = new AudioProcessor(this);
+    audioProcessor->setDeviceName(options.deviceName);
+    audioProcessor->setLatencyProfile(LatencyProfile::byName("live"));
+    connect(audioProcessor, &AudioProcessor::audioDataReceived, this, &CaptureTest::onAudioData);
+
+    LOG_INFO(QString("开始采集自检，时长 %1 秒").arg(options.durationSeconds));
+    if (!audioProcessor->startRecording()) {
+        return false;
+    }
+    clock.start();
+    stopTimer.start(options.durationSeconds * 1000);
+    return true;
+}
+
+void CaptureTest::onAudioData(const QByteArray &data)
+{
+    const int count = data.size() / static_cast<int>(sizeof(int16_t));
+    const char *p = data.constData();
+    for (int i = 0; i < count; ++i) {
+        int16_t sample;
+        std::memcpy(&sample, p + i * sizeof(int16_t), sizeof(sample));
+        const int magnitude = std::abs(static_cast<int>(sample));
+        peak = qMax(peak, magnitude);
+        sumSquares += static_cast<double>(sample) * sample;
+    }
+    samples += static_cast<quint64>(count);
+    ++packets;
+    if (wavFile.isOpen()) {
+        wavFile.write(data);
+    }
+}
+
+void CaptureTest::writeWavHeader(quint32 dataBytes)
+{
+    char header[44];
+    auto put32 = [&header](int offset, quint32 v) { qToLittleEndian(v, header + offset); };
+    auto put16 = [&header](int offset, quint16 v) { qToLittleEndian(v, header + offset); };
+    std::memcpy(header, "RIFF", 4);
+    put32(4, 36 + dataBytes);
+    std::memcpy(header + 8, "WAVEfmt ", 8);
+    put32(16, 16);
+    put16(20, 1);                       // PCM
+    put16(22, 1);                       // 单声道
+    put32(24, kSampleRate);
+    put32(28, kSampleRate * 2);
+    put16(32, 2);
+    put16(34, 16);
+    std::memcpy(header + 36, "data", 4);
+    put32(40, dataBytes);
+    wavFile.seek(0);
+    wavFile.write(header, sizeof(header));
+}
+
+void CaptureTest::finish()
+{
+    audioProcessor->stopRecording();
+    const double wallSeconds = clock.elapsed() / 1000.0;
+    const double audioSeconds = samples / static_cast<double>(kSampleRate);
+    const double ratio = wallSeconds > 0 ? audioSeconds / wallSeconds : 0;
+    const double rms = samples > 0 ? std::sqrt(sumSquares / samples) : 0;
+    const CaptureLatencyStats latency = audioProcessor->latencyStats();
+
+    if (wavFile.isOpen()) {
+        writeWavHeader(static_cast<quint32>(samples * sizeof(int16_t)));
+        wavFile.close();
+    }
+
+    // 数据按实时速度到达（允许启动时的少量缺口），且确实采到了声音
+    const bool realtime = ratio >= 0.9 && ratio <= 1.1;
+    const bool audible = toDb(peak) > options.minimumPeakDb;
+    const bool passed = realtime && audible;
+
+    QTextStream out(stdout);
+    out << QString("采集时长 %1 秒，收到音频 %2 秒（%3 倍实时），%4 个数据包\n")
+           .arg(wallSeconds, 0, 'f', 1).arg(audioSeconds, 0, 'f', 1).arg(ratio, 0, 'f', 3).arg(packets);
+    out << QString("电平：峰值 %1 dBFS，RMS %2 dBFS\n")
+           .arg(toDb(peak), 0, 'f', 1).arg(toDb(rms), 0, 'f', 1);
+    out << QString("采集延迟：平均 %1 ms，最大 %2 ms（%3 个样本）\n")
+           .arg(latency.averageMs, 0, 'f', 1).arg(latency.maxMs, 0, 'f', 1).arg(latency.packets);
+    out << describeGlitchStats(audioProcessor->glitchStats()) << "\n";
+    if (!options.outputWav.isEmpty()) {
+        out << QString("已写出 %1\n").arg(options.outputWav);
+    }
+    const QString summary = QString("采集自检%1%2%3")
+            .arg(passed ? "通过" : "失败")
+            .arg(realtime ? "" : "：数据没有按实时速度到达")
+            .arg(audible ? "" : "：没有采到声音（请确认正在播放）");
+    out << summary << "\n";
+    out.flush();
+    if (passed) {
+        LOG_INFO(summary);
+    } else {
+        LOG_ERROR(summary);
+    }
+    emit finished(passed);
+}
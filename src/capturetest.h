@@ -0,0 +1,49 @@
+#ifndef CAPTURETEST_H
+#define CAPTURETEST_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTimer>
+
+class AudioProcessor;
+
+struct CaptureTestOptions {
+    int durationSeconds = 10;
+    QString outputWav;          // 非空时把采集到的 16kHz 单声道音频写成 WAV
+    QString deviceName;         // 空表示默认输出设备
+    double minimumPeakDb = -50; // 峰值低于此值视为没有采到声音
+};
+
+// 采集自检（--capture-test）：只运行采集后端，检查数据是否按实时速度到达、是否有声音，
+// 报告采集延迟和调度统计，可选写出 WAV 供回听。在 Linux 上可用 null sink 加 paplay 回放 WAV 验证。
+class CaptureTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit CaptureTest(const CaptureTestOptions &options, QObject *parent = nullptr);
+    ~CaptureTest();
+
+    bool start();
+
+signals:
+    void finished(bool passed);
+
+private:
+    void onAudioData(const QByteArray &data);
+    void finish();
+    void writeWavHeader(quint32 dataBytes);
+
+    CaptureTestOptions options;
+    AudioProcessor *audioProcessor;
+    QTimer stopTimer;
+    QElapsedTimer clock;
+    QFile wavFile;
+    quint64 samples;
+    quint64 packets;
+    int peak;
+    double sumSquares;
+};
+
+#endif // CAPTURETEST_H
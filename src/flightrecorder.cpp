@@ -0,0 +1,198 @@
+#include "flightrecorder.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <thread>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// 内存中的槽位：sequence 最后写入，读取时据此判断内容是否完整
+struct Slot {
+    std::atomic<uint64_t> sequence{0};
+    uint64_t timestampUs;
+    uint32_t threadId;
+    uint16_t type;
+    uint16_t length;
+    int64_t value;
+    char text[kFlightTextSize];
+};
+
+Slot g_slots[kFlightCapacity];
+std::atomic<uint64_t> g_nextSequence{0};
+const std::chrono::steady_clock::time_point g_startTime = std::chrono::steady_clock::now();
+const uint64_t g_startUnixMs = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+
+uint32_t currentThreadId()
+{
+#ifdef _WIN32
+    return static_cast<uint32_t>(GetCurrentThreadId());
+#else
+    static thread_local uint32_t id = static_cast<uint32_t>(
+            std::hash<std::thread::id>()(std::this_thread::get_id()));
+    return id;
+#endif
+}
+
+// 截断到不超过 maxLength 字节，且不切断 UTF-8 多字节字符
+size_t truncateUtf8(const char *text, size_t length, size_t maxLength)
+{
+    if (length <= maxLength) {
+        return length;
+    }
+    size_t cut = maxLength;
+    while (cut > 0 && (static_cast<unsigned char>(text[cut]) & 0xC0) == 0x80) {
+        --cut;
+    }
+    return cut;
+}
+
+class DumpFile
+{
+public:
+    explicit DumpFile(const char *utf8Path)
+    {
+#ifdef _WIN32
+        wchar_t widePath[1024];
+        if (MultiByteToWideChar(CP_UTF8, 0, utf8Path, -1, widePath, 1024) > 0) {
+            handle = CreateFileW(widePath, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+        }
+#else
+        // 崩溃处理函数中也会调用，只能用异步信号安全的系统调用，不能用 stdio
+        handle = ::open(utf8Path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+    }
+
+    ~DumpFile()
+    {
+#ifdef _WIN32
+        if (handle != INVALID_HANDLE_VALUE) {
+            CloseHandle(handle);
+        }
+#else
+        if (handle >= 0) {
+            ::close(handle);
+        }
+#endif
+    }
+
+    bool isOpen() const
+    {
+#ifdef _WIN32
+        return handle != INVALID_HANDLE_VALUE;
+#else
+        return handle >= 0;
+#endif
+    }
+
+    bool write(const void *data, size_t size)
+    {
+#ifdef _WIN32
+        DWORD written = 0;
+        return WriteFile(handle, data, static_cast<DWORD>(size), &written, NULL) && written == size;
+#else
+        const char *bytes = static_cast<const char *>(data);
+        while (size > 0) {
+            const ssize_t written = ::write(handle, bytes, size);
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            if (written <= 0) {
+                return false;
+            }
+            bytes += written;
+            size -= static_cast<size_t>(written);
+        }
+        return true;
+#endif
+    }
+
+private:
+#ifdef _WIN32
+    HANDLE handle = INVALID_HANDLE_VALUE;
+#else
+    int handle = -1;
+#endif
+};
+
+} // namespace
+
+void FlightRecorder::recordText(FlightEventType type, const char *text, size_t length, int64_t value)
+{
+    const uint64_t sequence = g_nextSequence.fetch_add(1, std::memory_order_relaxed);
+    Slot &slot = g_slots[sequence & (kFlightCapacity - 1)];
+
+    // 先清除序号，表示槽位正在写入
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.timestampUs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - g_startTime).count());
+    slot.threadId = currentThreadId();
+    slot.type = static_cast<uint16_t>(type);
+    slot.value = value;
+    const size_t copied = text ? truncateUtf8(text, length, kFlightTextSize) : 0;
+    if (copied > 0) {
+        std::memcpy(slot.text, text, copied);
+    }
+    slot.length = static_cast<uint16_t>(copied);
+
+    slot.sequence.store(sequence + 1, std::memory_order_release);
+}
+
+void FlightRecorder::record(FlightEventType type, const char *text, int64_t value)
+{
+    recordText(type, text, text ? std::strlen(text) : 0, value);
+}
+
+bool FlightRecorder::dumpToFile(const char *utf8Path)
+{
+    DumpFile file(utf8Path);
+    if (!file.isOpen()) {
+        return false;
+    }
+
+    FlightDumpHeader header;
+    std::memcpy(header.magic, "MAFR", 4);
+    header.version = kFlightFormatVersion;
+    header.recordSize = sizeof(FlightRecord);
+    header.capacity = kFlightCapacity;
+    header.nextSequence = g_nextSequence.load(std::memory_order_acquire);
+    header.startTimeUnixMs = g_startUnixMs;
+    if (!file.write(&header, sizeof(header))) {
+        return false;
+    }
+
+    // 分块复制到栈上再写出，写入过程中被覆盖的槽位标记为空
+    const uint32_t kChunk = 32;
+    FlightRecord chunk[kChunk];
+    for (uint32_t base = 0; base < kFlightCapacity; base += kChunk) {
+        for (uint32_t i = 0; i < kChunk; ++i) {
+            const Slot &slot = g_slots[base + i];
+            FlightRecord &out = chunk[i];
+            const uint64_t before = slot.sequence.load(std::memory_order_acquire);
+            out.timestampUs = slot.timestampUs;
+            out.threadId = slot.threadId;
+            out.type = slot.type;
+            out.length = slot.length <= kFlightTextSize ? slot.length : 0;
+            out.value = slot.value;
+            std::memcpy(out.text, slot.text, kFlightTextSize);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const uint64_t after = slot.sequence.load(std::memory_order_relaxed);
+            out.sequence = before == after ? before : 0;
+        }
+        if (!file.write(chunk, sizeof(chunk))) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,55 @@
+#ifndef FLIGHTRECORDER_H
+#define FLIGHTRECORDER_H
+
+#include <cstddef>
+#include <cstdint>
+
+// 飞行记录器：固定大小的内存环形缓冲区，保存最近的日志、状态变化和计数事件。
+// 写入无锁、不分配内存，平时几乎没有开销；程序崩溃时与转储文件一起写到磁盘，
+// 用 tools/flightdecode 解码。本头文件不依赖 Qt，解码工具直接包含它来读取文件格式。
+
+enum class FlightEventType : uint16_t {
+    Log = 1,        // 普通日志
+    Error = 2,      // 错误日志
+    State = 3,      // 状态变化（开始/停止、会话事件等）
+    Counter = 4     // 计数（value 为数量）
+};
+
+const int kFlightTextSize = 96;
+const uint32_t kFlightCapacity = 4096;   // 必须是 2 的幂
+const uint32_t kFlightFormatVersion = 1;
+
+// 磁盘上的记录格式（与内存中的槽位内容一致）
+struct FlightRecord {
+    uint64_t sequence;      // 全局序号 + 1，0 表示空槽或写入未完成
+    uint64_t timestampUs;   // 相对记录器启动的单调时间
+    uint32_t threadId;
+    uint16_t type;          // FlightEventType
+    uint16_t length;        // text 中有效字节数（UTF-8）
+    int64_t value;
+    char text[kFlightTextSize];
+};
+static_assert(sizeof(FlightRecord) == 128, "FlightRecord 布局变化需要同步修改版本号");
+
+// 转储文件头，后面紧跟 capacity 条 FlightRecord
+struct FlightDumpHeader {
+    char magic[4];          // "MAFR"
+    uint32_t version;
+    uint32_t recordSize;
+    uint32_t capacity;
+    uint64_t nextSequence;      // 已写入的事件总数
+    uint64_t startTimeUnixMs;   // 记录器启动时的系统时间
+};
+
+class FlightRecorder
+{
+public:
+    static void record(FlightEventType type, const char *text, int64_t value = 0);
+    // text 不要求以 0 结尾，超过 kFlightTextSize 字节时截断
+    static void recordText(FlightEventType type, const char *text, size_t length, int64_t value = 0);
+
+    // 把当前缓冲区写入文件（UTF-8 路径）；只使用栈内存和系统调用（POSIX 上为 open/write/close），可以在崩溃处理中调用
+    static bool dumpToFile(const char *utf8Path);
+};
+
+#endif // FLIGHTRECORDER_H
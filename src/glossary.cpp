@@ -0,0 +1,291 @@
+#include "glossary.h"
+#include <QHash>
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+inline char16_t foldChar(QChar c)
+{
+    return c.toCaseFolded().unicode();
+}
+
+// 需要单词边界的字符：拉丁等有空格分词的文字中的字母和数字。中日韩文字不分词，不做边界检查
+inline bool isWordChar(QChar c)
+{
+    return c.unicode() < 0x2E80 && c.isLetterOrNumber();
+}
+
+QString foldTerm(const QString &term)
+{
+    QString folded;
+    folded.reserve(term.size());
+    for (QChar c : term) {
+        folded.append(QChar(foldChar(c)));
+    }
+    return folded;
+}
+
+void appendEscaped(QString &out, const QString &text, int from, int length)
+{
+    const QChar *p = text.constData() + from;
+    const QChar *end = p + length;
+    for (; p != end; ++p) {
+        switch (p->unicode()) {
+        case '<': out += QLatin1String("&lt;"); break;
+        case '>': out += QLatin1String("&gt;"); break;
+        case '&': out += QLatin1String("&amp;"); break;
+        case '"': out += QLatin1String("&quot;"); break;
+        case '\n': out += QLatin1String("<br>"); break;
+        default: out += *p; break;
+        }
+    }
+}
+
+} // namespace
+
+QVector<GlossaryEntry> parseGlossary(const QString &text)
+{
+    QVector<GlossaryEntry> entries;
+    const QStringList lines = text.split('\n');
+    entries.reserve(lines.size());
+    for (const QString &rawLine : lines) {
+        const QString line = rawLine.trimmed();
+        if (line.isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+        GlossaryEntry entry;
+        const int arrow = line.indexOf(QLatin1String("=>"));
+        if (arrow >= 0) {
+            entry.term = line.left(arrow).trimmed();
+            entry.replacement = line.mid(arrow + 2).trimmed();
+        } else {
+            entry.term = line;
+        }
+        if (!entry.term.isEmpty()) {
+            entries.append(entry);
+        }
+    }
+    return entries;
+}
+
+// 状态机只依赖术语集合（大小写折叠后），替换内容变化时可以直接复用
+struct GlossaryAutomaton::Trie {
+    struct Node {
+        std::vector<std::pair<char16_t, int>> edges;  // 按字符排序
+        int fail = 0;
+        int dictLink = -1;   // 沿失败链最近的、有模式结束的结点
+        int pattern = -1;
+        int depth = 0;
+    };
+
+    std::vector<Node> nodes;
+    QStringList patterns;                // 折叠后的术语，按模式编号
+    std::vector<uint8_t> boundary;       // bit0: 要求左边界，bit1: 要求右边界
+    int maxLength = 0;
+
+    int child(int node, char16_t c) const
+    {
+        const auto &edges = nodes[node].edges;
+        auto it = std::lower_bound(edges.begin(), edges.end(), c,
+                                   [](const std::pair<char16_t, int> &e, char16_t key) { return e.first < key; });
+        return (it != edges.end() && it->first == c) ? it->second : -1;
+    }
+
+    int step(int node, char16_t c) const
+    {
+        for (;;) {
+            const int next = child(node, c);
+            if (next >= 0) {
+                return next;
+            }
+            if (node == 0) {
+                return 0;
+            }
+            node = nodes[node].fail;
+        }
+    }
+
+    void build(const QStringList &folded, const QStringList &original)
+    {
+        patterns = folded;
+        nodes.clear();
+        nodes.emplace_back();
+        boundary.assign(folded.size(), 0);
+
+        for (int p = 0; p < folded.size(); ++p) {
+            const QString &term = folded[p];
+            int node = 0;
+            for (QChar qc : term) {
+                const char16_t c = qc.unicode();
+                auto &edges = nodes[node].edges;
+                auto it = std::lower_bound(edges.begin(), edges.end(), c,
+                                           [](const std::pair<char16_t, int> &e, char16_t key) { return e.first < key; });
+                if (it != edges.end() && it->first == c) {
+                    node = it->second;
+                    continue;
+                }
+                const int created = static_cast<int>(nodes.size());
+                edges.insert(it, std::make_pair(c, created));
+                nodes.emplace_back();
+                nodes.back().depth = nodes[node].depth + 1;
+                node = created;
+            }
+            nodes[node].pattern = p;
+            maxLength = std::max(maxLength, static_cast<int>(term.size()));
+            const QString &term0 = original[p];
+            boundary[p] = (isWordChar(term0.front()) ? 1 : 0) | (isWordChar(term0.back()) ? 2 : 0);
+        }
+
+        // 按层次遍历计算失败链和输出链
+        std::vector<int> queue;
+        queue.reserve(nodes.size());
+        for (const auto &edge : nodes[0].edges) {
+            queue.push_back(edge.second);
+        }
+        for (size_t head = 0; head < queue.size(); ++head) {
+            const int node = queue[head];
+            for (const auto &edge : nodes[node].edges) {
+                const int next = edge.second;
+                int fail = nodes[node].fail;
+                int target = child(fail, edge.first);
+                while (target < 0 && fail != 0) {
+                    fail = nodes[fail].fail;
+                    target = child(fail, edge.first);
+                }
+                nodes[next].fail = target >= 0 ? target : 0;
+                const Node &failNode = nodes[nodes[next].fail];
+                nodes[next].dictLink = failNode.pattern >= 0 ? nodes[next].fail : failNode.dictLink;
+                queue.push_back(next);
+            }
+        }
+    }
+};
+
+std::shared_ptr<const GlossaryAutomaton> GlossaryAutomaton::build(const QVector<GlossaryEntry> &entries,
+                                                                  const GlossaryAutomaton *previous)
+{
+    std::shared_ptr<GlossaryAutomaton> automaton(new GlossaryAutomaton);
+    automaton->entryList = entries;
+
+    // 折叠后相同的术语只保留最后一条
+    QHash<QString, int> byTerm;
+    byTerm.reserve(entries.size());
+    for (int i = 0; i < entries.size(); ++i) {
+        byTerm.insert(foldTerm(entries[i].term), i);
+    }
+    QStringList folded = byTerm.keys();
+    std::sort(folded.begin(), folded.end());
+
+    if (previous && previous->trie && previous->trie->patterns == folded) {
+        automaton->trie = previous->trie;
+        automaton->reused = true;
+    } else {
+        QStringList original;
+        original.reserve(folded.size());
+        for (const QString &term : folded) {
+            original.append(entries[byTerm.value(term)].term);
+        }
+        auto trie = std::make_shared<Trie>();
+        trie->build(folded, original);
+        automaton->trie = trie;
+    }
+
+    automaton->patternEntry.resize(folded.size());
+    for (int p = 0; p < folded.size(); ++p) {
+        automaton->patternEntry[p] = byTerm.value(folded[p]);
+    }
+    return automaton;
+}
+
+void GlossaryAutomaton::findMatches(const QString &text, std::vector<GlossaryMatch> &out) const
+{
+    out.clear();
+    if (!trie || trie->patterns.isEmpty()) {
+        return;
+    }
+    const Trie &t = *trie;
+    const int n = text.size();
+    const QChar *data = text.constData();
+
+    // 最左最长：以 i 结尾的匹配扫描到 i 才出现，所以从 s 开始的最长匹配要到 s + maxLength - 1 才能确定。
+    // 每个起点目前最长的匹配记在环形缓冲中（只需 maxLength 个位置），起点确定后再按从左到右决定取舍
+    const int window = t.maxLength;
+    thread_local std::vector<GlossaryMatch> longest;
+    longest.assign(static_cast<size_t>(window), GlossaryMatch{-1, 0, -1});
+    int cursor = 0;     // 下一个待决定的起点，之前的文本已经处理完
+    auto settle = [&](int last) {
+        while (cursor <= last) {
+            const GlossaryMatch &candidate = longest[static_cast<size_t>(cursor % window)];
+            if (candidate.start == cursor) {
+                out.push_back(candidate);
+                cursor += candidate.length;
+            } else {
+                ++cursor;
+            }
+        }
+    };
+    int state = 0;
+
+    for (int i = 0; i < n; ++i) {
+        state = t.step(state, foldChar(data[i]));
+
+        // 输出链从长到短，起点依次右移
+        int node = t.nodes[state].pattern >= 0 ? state : t.nodes[state].dictLink;
+        for (; node >= 0; node = t.nodes[node].dictLink) {
+            const int p = t.nodes[node].pattern;
+            const int length = t.nodes[node].depth;
+            const int start = i - length + 1;
+            if (start < cursor) {
+                continue;   // 与已确认的匹配重叠
+            }
+            if ((t.boundary[p] & 1) && start > 0 && isWordChar(data[start - 1])) {
+                continue;
+            }
+            if ((t.boundary[p] & 2) && i + 1 < n && isWordChar(data[i + 1])) {
+                continue;
+            }
+            // 同一起点后出现的匹配结尾更靠后，一定更长
+            longest[static_cast<size_t>(start % window)] = GlossaryMatch{start, length, patternEntry[p]};
+        }
+
+        settle(i - window + 1);
+    }
+    settle(n - 1);
+}
+
+QString GlossaryAutomaton::renderHtml(const QString &text, const QString &highlightColor, QString *plain) const
+{
+    thread_local std::vector<GlossaryMatch> matches;
+    findMatches(text, matches);
+
+    QString html;
+    html.reserve(text.size() + static_cast<int>(matches.size()) * 48 + 16);
+    if (plain) {
+        plain->clear();
+        plain->reserve(text.size() + 16);
+    }
+    const QString openTag = QString("<span style=\"color:%1;font-weight:bold\">").arg(highlightColor);
+    int pos = 0;
+    for (const GlossaryMatch &m : matches) {
+        appendEscaped(html, text, pos, m.start - pos);
+        html += openTag;
+        const GlossaryEntry &e = entryList[m.entry];
+        if (e.replacement.isEmpty()) {
+            appendEscaped(html, text, m.start, m.length);
+        } else {
+            appendEscaped(html, e.replacement, 0, e.replacement.size());
+        }
+        html += QLatin1String("</span>");
+        if (plain) {
+            plain->append(QStringView(text).mid(pos, m.start - pos));
+            plain->append(e.replacement.isEmpty() ? QStringView(text).mid(m.start, m.length) : QStringView(e.replacement));
+        }
+        pos = m.start + m.length;
+    }
+    appendEscaped(html, text, pos, text.size() - pos);
+    if (plain) {
+        plain->append(QStringView(text).mid(pos));
+    }
+    return html;
+}
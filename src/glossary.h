@@ -0,0 +1,57 @@
+#ifndef GLOSSARY_H
+#define GLOSSARY_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <memory>
+#include <vector>
+
+// 术语表中的一条：匹配 term（不区分大小写），有 replacement 时替换，否则只高亮
+struct GlossaryEntry {
+    QString term;
+    QString replacement;
+};
+
+// 解析术语表文本：每行一条，"术语" 或 "术语 => 替换"，# 开头为注释
+QVector<GlossaryEntry> parseGlossary(const QString &text);
+
+struct GlossaryMatch {
+    int start;
+    int length;
+    int entry;
+};
+
+// 多模式匹配（Aho-Corasick）。每次更新只对文本做一次线性扫描，
+// 取最左最长、互不重叠的匹配；两端是字母或数字的术语要求在单词边界上。
+// 构建后只读，可在多个线程间共享。
+class GlossaryAutomaton
+{
+public:
+    // previous 的术语集合与 entries 相同时复用其状态机，只更新替换内容
+    static std::shared_ptr<const GlossaryAutomaton> build(const QVector<GlossaryEntry> &entries,
+                                                          const GlossaryAutomaton *previous = nullptr);
+
+    bool isEmpty() const { return entryList.isEmpty(); }
+    int size() const { return entryList.size(); }
+    const GlossaryEntry &entry(int index) const { return entryList[index]; }
+    bool reusedTrie() const { return reused; }
+
+    void findMatches(const QString &text, std::vector<GlossaryMatch> &out) const;
+
+    // 一次扫描完成替换和高亮，输出 HTML（其余文本做转义）；
+    // plain 不为空时同时输出只做替换的纯文本，供不显示富文本的地方使用
+    QString renderHtml(const QString &text, const QString &highlightColor, QString *plain = nullptr) const;
+
+private:
+    struct Trie;
+
+    GlossaryAutomaton() = default;
+
+    std::shared_ptr<const Trie> trie;
+    QVector<GlossaryEntry> entryList;
+    QVector<int> patternEntry;      // 状态机中的模式编号 -> 条目编号
+    bool reused = false;
+};
+
+#endif // GLOSSARY_H
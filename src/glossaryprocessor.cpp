@@ -0,0 +1,163 @@
+#include "glossaryprocessor.h"
+#include "metrics.h"
+#include "logger.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QTimer>
+
+namespace {
+
+// 编辑器保存时常常先删除再写入，合并短时间内的多次变化
+const int kReloadDelayMs = 200;
+
+MetricHistogram &updateHistogram()
+{
+    static MetricHistogram &histogram = Metrics::histogram(
+        "glossary_update_seconds", "每条字幕更新的术语处理耗时",
+        {0.000005, 0.00001, 0.00002, 0.00005, 0.0001, 0.0002, 0.0005, 0.001, 0.005});
+    return histogram;
+}
+
+} // namespace
+
+GlossaryProcessor::GlossaryProcessor(QObject *parent)
+    : QObject(parent)
+    , color("#d35400")
+    , watcher(nullptr)
+    , reloadTimer(nullptr)
+    , loadedSize(-1)
+    , automaton(GlossaryAutomaton::build({}))
+{
+    buildPool.setMaxThreadCount(1);
+}
+
+GlossaryProcessor::~GlossaryProcessor()
+{
+    // 等后台重建结束，之后投递到本对象的替换事件随对象一起丢弃
+    buildPool.waitForDone();
+}
+
+void GlossaryProcessor::setGlossaryFile(const QString &path, const QString &highlightColor)
+{
+    if (!watcher) {
+        watcher = new QFileSystemWatcher(this);
+        reloadTimer = new QTimer(this);
+        reloadTimer->setSingleShot(true);
+        reloadTimer->setInterval(kReloadDelayMs);
+        connect(reloadTimer, &QTimer::timeout, this, &GlossaryProcessor::reload);
+        connect(watcher, &QFileSystemWatcher::fileChanged, this, &GlossaryProcessor::scheduleReload);
+        // 文件被替换后监视会丢失，同时监视所在目录以便重新加上
+        connect(watcher, &QFileSystemWatcher::directoryChanged, this, &GlossaryProcessor::scheduleReload);
+    }
+    if (!filePath.isEmpty()) {
+        watcher->removePath(filePath);
+        watcher->removePath(QFileInfo(filePath).absolutePath());
+    }
+
+    filePath = path;
+    loadedModified = QDateTime();
+    loadedSize = -1;
+    if (!highlightColor.isEmpty()) {
+        color = highlightColor;
+    }
+    watcher->addPath(QFileInfo(filePath).absolutePath());
+    reload();
+}
+
+void GlossaryProcessor::processRecognition(const QString &text)
+{
+    QString plain;
+    emit recognitionReady(render(text, &plain));
+    emit recognitionTextReady(plain);
+}
+
+void GlossaryProcessor::processTranslation(const QString &text)
+{
+    QString plain;
+    emit translationReady(render(text, &plain));
+    emit translationTextReady(plain);
+}
+
+void GlossaryProcessor::processFinalTranslation(const QString &text)
+{
+    emit finalTranslationReady(render(text));
+}
+
+void GlossaryProcessor::processFinalSegment(qint64 offsetMs, qint64 durationMs,
+                                            const QString &text, const QString &translation)
+{
+    QString plainText;
+    QString plainTranslation;
+    render(text, &plainText);
+    if (!translation.isEmpty()) {
+        render(translation, &plainTranslation);
+    }
+    emit finalSegmentReady(offsetMs, durationMs, plainText, plainTranslation);
+}
+
+QString GlossaryProcessor::render(const QString &text, QString *plain)
+{
+    QElapsedTimer timer;
+    timer.start();
+    QString html = automaton->renderHtml(text, color, plain);
+    updateHistogram().observe(timer.nsecsElapsed() / 1e9);
+    return html;
+}
+
+void GlossaryProcessor::scheduleReload()
+{
+    reloadTimer->start();
+}
+
+void GlossaryProcessor::reload()
+{
+    const QFileInfo info(filePath);
+    if (!info.exists()) {
+        return;
+    }
+    if (!watcher->files().contains(filePath)) {
+        watcher->addPath(filePath);
+    }
+    // 目录中其他文件的变化也会触发，文件本身没变时不重新加载
+    if (info.lastModified() == loadedModified && info.size() == loadedSize) {
+        return;
+    }
+    loadedModified = info.lastModified();
+    loadedSize = info.size();
+
+    // 读文件和建状态机都在后台线程进行，工作线程继续处理字幕
+    const QString path = filePath;
+    std::shared_ptr<const GlossaryAutomaton> previous = automaton;
+    buildPool.start([this, path, previous]() {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            return;
+        }
+        const QVector<GlossaryEntry> entries = parseGlossary(QString::fromUtf8(file.readAll()));
+
+        QElapsedTimer timer;
+        timer.start();
+        std::shared_ptr<const GlossaryAutomaton> built = GlossaryAutomaton::build(entries, previous.get());
+        const qint64 buildUs = timer.nsecsElapsed() / 1000;
+
+        QMetaObject::invokeMethod(this, [this, built, buildUs]() {
+            install(built, buildUs);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void GlossaryProcessor::install(std::shared_ptr<const GlossaryAutomaton> built, qint64 buildUs)
+{
+    static MetricCounter &rebuilds = Metrics::counter("glossary_rebuilds_total", "术语表重新加载次数");
+    static MetricGauge &entries = Metrics::gauge("glossary_entries", "当前术语表条目数");
+    rebuilds.add();
+    entries.set(built->size());
+
+    automaton = std::move(built);
+    LOG_INFO(QString("术语表已加载：%1 条，%2，耗时 %3 us")
+             .arg(automaton->size())
+             .arg(automaton->reusedTrie() ? "仅替换内容变化，复用状态机" : "重建状态机")
+             .arg(buildUs));
+}
@@ -0,0 +1,60 @@
+#ifndef GLOSSARYPROCESSOR_H
+#define GLOSSARYPROCESSOR_H
+
+#include <QObject>
+#include <QString>
+#include <QDateTime>
+#include <QThreadPool>
+#include <memory>
+#include "glossary.h"
+
+class QFileSystemWatcher;
+class QTimer;
+
+// 术语后处理：位于识别引擎的结果信号和界面之间，运行在单独的工作线程中。
+// 每条部分/最终结果只做一次线性扫描，输出替换并高亮术语后的 HTML，
+// 同时输出只做替换的纯文本给字幕浮层，浮层和两个文本区显示的术语一致。
+// 术语表文件变化时在后台线程重建状态机，建好后替换，处理中的更新不受影响。
+class GlossaryProcessor : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit GlossaryProcessor(QObject *parent = nullptr);
+    ~GlossaryProcessor();
+
+public slots:
+    // 在所属线程中调用（跨线程时用排队连接）
+    void setGlossaryFile(const QString &path, const QString &highlightColor);
+
+    void processRecognition(const QString &text);
+    void processTranslation(const QString &text);
+    void processFinalTranslation(const QString &text);
+    void processFinalSegment(qint64 offsetMs, qint64 durationMs, const QString &text, const QString &translation);
+
+signals:
+    void recognitionReady(const QString &html);
+    void translationReady(const QString &html);
+    void finalTranslationReady(const QString &html);
+    // 纯文本（只做替换）
+    void recognitionTextReady(const QString &text);
+    void translationTextReady(const QString &text);
+    void finalSegmentReady(qint64 offsetMs, qint64 durationMs, const QString &text, const QString &translation);
+
+private:
+    QString render(const QString &text, QString *plain = nullptr);
+    void scheduleReload();
+    void reload();
+    void install(std::shared_ptr<const GlossaryAutomaton> automaton, qint64 buildUs);
+
+    QString filePath;
+    QString color;
+    QFileSystemWatcher *watcher;
+    QTimer *reloadTimer;
+    QDateTime loadedModified;
+    qint64 loadedSize;
+    std::shared_ptr<const GlossaryAutomaton> automaton;
+    QThreadPool buildPool;        // 单线程，重建按顺序进行
+};
+
+#endif // GLOSSARYPROCESSOR_H
@@ -0,0 +1,363 @@
+#include "hostedspeechengine.h"
+#include "speechhost.h"
+#include "captionring.h"
+#include "flightrecorder.h"
+#include "logger.h"
+#include "metrics.h"
+#include <QCoreApplication>
+#include <QJsonDocument>
+#include <QLocalServer>
+#include <QLocalSocket>
+
+namespace {
+
+const int kDefaultHangTimeoutMs = 10000;
+const int kWatchdogIntervalMs = 1000;
+const int kMaxRestartsPerMinute = 5;
+
+} // namespace
+
+HostedSpeechEngine::HostedSpeechEngine(const QString &engineName, QObject *parent)
+    : SpeechEngine(parent)
+    , engineName(engineName)
+    , initialized(false)
+    , sessionActive(false)
+    , server(new QLocalServer(this))
+    , socket(nullptr)
+    , process(nullptr)
+    , restarting(false)
+    , shuttingDown(false)
+    , hangTimeoutMs(kDefaultHangTimeoutMs)
+    , restarts(0)
+{
+    const qint64 pid = QCoreApplication::applicationPid();
+    serverName = QString("MeetingAssistantSpeech-%1").arg(pid);
+    ringName = QString("MeetingAssistantAudio-%1").arg(pid);
+    server->setSocketOptions(QLocalServer::UserAccessOption);
+    connect(server, &QLocalServer::newConnection, this, &HostedSpeechEngine::onHostConnected);
+    watchdog.setInterval(kWatchdogIntervalMs);
+    connect(&watchdog, &QTimer::timeout, this, &HostedSpeechEngine::onWatchdog);
+    lifetime.start();
+}
+
+HostedSpeechEngine::~HostedSpeechEngine()
+{
+    shuttingDown = true;
+    watchdog.stop();
+    if (!process) {
+        return;
+    }
+    process->disconnect(this);
+    if (socket && socket->state() == QLocalSocket::ConnectedState) {
+        QJsonObject quit;
+        quit["type"] = "quit";
+        send(quit);
+        socket->flush();
+    }
+    // 正常情况下辅助进程停止识别后自行退出；卡住时直接结束
+    if (!process->waitForFinished(3000)) {
+        process->kill();
+        process->waitForFinished(1000);
+    }
+}
+
+bool HostedSpeechEngine::ensureTransport()
+{
+    if (!ring.isOpen() && !ring.create(ringName.toUtf8().constData())) {
+        LOG_ERROR(QString("无法创建音频共享内存 %1").arg(ringName));
+        emit error("无法创建音频共享内存，语音服务进程不可用");
+        return false;
+    }
+    if (!server->isListening()) {
+        QLocalServer::removeServer(serverName);
+        if (!server->listen(serverName)) {
+            LOG_ERROR(QString("无法监听本机通道 %1: %2").arg(serverName, server->errorString()));
+            emit error("无法创建本机通道，语音服务进程不可用");
+            return false;
+        }
+    }
+    if (!process) {
+        launchHost();
+    }
+    return true;
+}
+
+void HostedSpeechEngine::launchHost()
+{
+    process = new QProcess(this);
+    // 辅助进程的控制台输出直接转到本进程，不在管道中堆积
+    process->setProcessChannelMode(QProcess::ForwardedChannels);
+    connect(process, &QProcess::finished, this, &HostedSpeechEngine::onHostFinished);
+    connect(process, &QProcess::errorOccurred, this, [this](QProcess::ProcessError processError) {
+        if (processError == QProcess::FailedToStart) {
+            LOG_ERROR(QString("无法启动语音服务进程: %1").arg(process->errorString()));
+            emit error("无法启动语音服务进程");
+        }
+    });
+    launchTimer.start();
+    sinceLastMessage.start();
+    process->start(QCoreApplication::applicationFilePath(), {"--speech-host", serverName});
+    watchdog.start();
+    FlightRecorder::record(FlightEventType::State, "speech_host.launch");
+}
+
+void HostedSpeechEngine::restartHost(const QString &reason)
+{
+    static MetricCounter &restartCounter = Metrics::counter("speech_host_restarts_total", "语音服务进程的重启次数");
+
+    const qint64 now = lifetime.elapsed();
+    while (!recentRestarts.isEmpty() && now - recentRestarts.first() > 60000) {
+        recentRestarts.removeFirst();
+    }
+    recentRestarts.append(now);
+    ++restarts;
+    restartCounter.add();
+    FlightRecorder::record(FlightEventType::Error, "speech_host.restart", restarts);
+    LOG_ERROR(QString("语音服务进程%1，重新启动（第 %2 次）").arg(reason).arg(restarts));
+
+    if (socket) {
+        socket->disconnect(this);
+        socket->abort();
+        socket->deleteLater();
+        socket = nullptr;
+    }
+    outbox.clear();
+    if (process) {
+        process->disconnect(this);
+        process->kill();
+        process->waitForFinished(2000);
+        process->deleteLater();
+        process = nullptr;
+    }
+
+    if (recentRestarts.size() > kMaxRestartsPerMinute) {
+        watchdog.stop();
+        sessionActive = false;
+        LOG_ERROR("语音服务进程一分钟内反复失败，停止重启");
+        emit error("语音服务进程反复崩溃，已停止识别，请查看日志和转储文件");
+        return;
+    }
+
+    emit statusChanged(QString("语音服务进程%1，正在重启").arg(reason));
+    restarting = true;
+    launchHost();
+    if (initialized) {
+        sendInit();
+    }
+    if (sessionActive) {
+        // 继续原来的会话：辅助进程从环中上次读到的位置接着读
+        QJsonObject start;
+        start["type"] = "start";
+        start["source"] = currentSourceLanguage;
+        start["target"] = currentTargetLanguage;
+        start["resume"] = true;
+        send(start);
+    }
+}
+
+void HostedSpeechEngine::initialize(const QString &key, const QString &regionName)
+{
+    subscriptionKey = key;
+    region = regionName;
+    initialized = true;
+    if (ensureTransport()) {
+        sendInit();
+    }
+}
+
+void HostedSpeechEngine::sendInit()
+{
+    QJsonObject init;
+    init["type"] = "init";
+    init["ring"] = ringName;
+    init["engine"] = engineName;
+    init["key"] = subscriptionKey;
+    init["region"] = region;
+    init["profile"] = SpeechHost::profileToJson(latencyProfile);
+    send(init);
+}
+
+void HostedSpeechEngine::startRecognitionAndTranslation(const QString &sourceLanguage, const QString &targetLanguage)
+{
+    if (!ensureTransport()) {
+        return;
+    }
+    currentSourceLanguage = sourceLanguage;
+    currentTargetLanguage = targetLanguage;
+    sessionActive = true;
+    // 只识别从现在开始写入的音频
+    QJsonObject start;
+    start["type"] = "start";
+    start["source"] = sourceLanguage;
+    start["target"] = targetLanguage;
+    start["ringPosition"] = static_cast<double>(ring.position());
+    send(start);
+}
+
+void HostedSpeechEngine::stopRecognitionAndTranslation()
+{
+    if (!sessionActive) {
+        return;
+    }
+    sessionActive = false;
+    QJsonObject stop;
+    stop["type"] = "stop";
+    send(stop);
+}
+
+void HostedSpeechEngine::processAudioData(const QByteArray &audioData)
+{
+    static MetricCounter &droppedBytes = Metrics::counter(
+            "speech_host_dropped_audio_bytes_total", "音频共享内存满时丢弃的字节数");
+    if (!sessionActive || !ring.isOpen()) {
+        return;
+    }
+    bool wakeReader = false;
+    if (!ring.write(audioData.constData(), static_cast<size_t>(audioData.size()), wakeReader)) {
+        droppedBytes.add(audioData.size());
+        return;
+    }
+    if (wakeReader && socket && socket->state() == QLocalSocket::ConnectedState) {
+        socket->write("{\"type\":\"audio\"}\n");
+        socket->flush();
+    }
+}
+
+void HostedSpeechEngine::finishAudioInput()
+{
+    sessionActive = false;
+    QJsonObject finish;
+    finish["type"] = "finish";
+    send(finish);
+}
+
+void HostedSpeechEngine::reconfigure(const QString &sourceLanguage, const QString &targetLanguage)
+{
+    currentSourceLanguage = sourceLanguage;
+    currentTargetLanguage = targetLanguage;
+    QJsonObject message;
+    message["type"] = "reconfigure";
+    message["source"] = sourceLanguage;
+    message["target"] = targetLanguage;
+    send(message);
+}
+
+void HostedSpeechEngine::onHostConnected()
+{
+    QLocalSocket *connection = server->nextPendingConnection();
+    if (!connection) {
+        return;
+    }
+    if (socket) {
+        // 只接受当前辅助进程的连接
+        connection->abort();
+        connection->deleteLater();
+        return;
+    }
+    socket = connection;
+    connect(socket, &QLocalSocket::readyRead, this, &HostedSpeechEngine::onReadyRead);
+    sinceLastMessage.start();
+    for (const QByteArray &line : outbox) {
+        socket->write(line);
+    }
+    outbox.clear();
+    socket->flush();
+}
+
+void HostedSpeechEngine::onReadyRead()
+{
+    while (socket && socket->canReadLine()) {
+        const QByteArray line = socket->readLine().trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+        sinceLastMessage.start();
+        const QJsonDocument document = QJsonDocument::fromJson(line);
+        if (document.isObject()) {
+            handleMessage(document.object());
+        }
+    }
+}
+
+void HostedSpeechEngine::handleMessage(const QJsonObject &message)
+{
+    static MetricHistogram &resultDelay = Metrics::histogram(
+            "speech_host_result_delay_us", "识别结果从语音服务进程发出到界面进程收到的耗时（微秒）",
+            {100, 250, 500, 1000, 2500, 5000, 10000, 50000});
+    static MetricHistogram &restartMs = Metrics::histogram(
+            "speech_host_restart_ms", "语音服务进程从重启到会话恢复的耗时（毫秒）", {100, 250, 500, 1000, 2000, 5000, 10000});
+    static MetricGauge &audioDelayAvg = Metrics::gauge(
+            "speech_host_audio_delay_avg_us", "音频经共享内存交给识别器的平均延迟（微秒，最近一秒）");
+    static MetricGauge &audioDelayMax = Metrics::gauge(
+            "speech_host_audio_delay_max_us", "音频经共享内存交给识别器的最大延迟（微秒，最近一秒）");
+
+    const QString type = message.value("type").toString();
+    if (type == "result") {
+        RecognitionEvent event;
+        event.kind = message.value("final").toBool() ? RecognitionEvent::Final : RecognitionEvent::Partial;
+        event.hasTranslation = message.value("hasTranslation").toBool();
+        event.offsetMs = static_cast<qint64>(message.value("offsetMs").toDouble());
+        event.durationMs = static_cast<qint64>(message.value("durationMs").toDouble());
+        event.text = message.value("text").toString();
+        event.translation = message.value("translation").toString();
+        const quint64 sentUs = static_cast<quint64>(message.value("sentUs").toDouble());
+        const quint64 nowUs = captionRingNowUs();
+        resultDelay.observe(nowUs > sentUs ? static_cast<double>(nowUs - sentUs) : 0.0);
+        postResult(std::move(event));
+    } else if (type == "heartbeat") {
+        audioDelayAvg.set(static_cast<int64_t>(message.value("audioDelayAvgUs").toDouble()));
+        audioDelayMax.set(static_cast<int64_t>(message.value("audioDelayMaxUs").toDouble()));
+    } else if (type == "status") {
+        emit statusChanged(message.value("message").toString());
+    } else if (type == "error") {
+        emit error(message.value("message").toString());
+    } else if (type == "finished") {
+        emit sessionFinished();
+    } else if (type == "ready") {
+        const qint64 elapsedMs = launchTimer.elapsed();
+        if (restarting) {
+            restarting = false;
+            restartMs.observe(elapsedMs);
+            LOG_INFO(QString("语音服务进程已恢复会话，耗时 %1 ms，环中待补送 %2 ms 音频")
+                     .arg(elapsedMs).arg(ring.backlogBytes() / 32));
+            emit statusChanged(QString("语音服务进程已恢复（%1 ms）").arg(elapsedMs));
+        } else {
+            LOG_INFO(QString("语音服务进程会话就绪，耗时 %1 ms").arg(elapsedMs));
+        }
+    } else if (type == "hello") {
+        LOG_INFO(QString("语音服务进程已连接，进程号 %1").arg(message.value("pid").toInt()));
+    }
+}
+
+void HostedSpeechEngine::onHostFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    if (shuttingDown) {
+        return;
+    }
+    restartHost(exitStatus == QProcess::CrashExit
+                ? QString("崩溃（退出码 0x%1）").arg(static_cast<uint>(exitCode), 8, 16, QChar('0'))
+                : QString("退出（代码 %1）").arg(exitCode));
+}
+
+void HostedSpeechEngine::onWatchdog()
+{
+    if (!process || shuttingDown) {
+        return;
+    }
+    // 启动后一直没有连上，或连上后心跳中断，都按卡死处理
+    if (sinceLastMessage.elapsed() > hangTimeoutMs) {
+        restartHost(QString("%1 ms 无响应").arg(sinceLastMessage.elapsed()));
+    }
+}
+
+void HostedSpeechEngine::send(const QJsonObject &message)
+{
+    QByteArray line = QJsonDocument(message).toJson(QJsonDocument::Compact);
+    line.append('\n');
+    if (socket && socket->state() == QLocalSocket::ConnectedState) {
+        socket->write(line);
+        socket->flush();
+    } else {
+        outbox.append(line);
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef HOSTEDSPEECHENGINE_H
+#define HOSTEDSPEECHENGINE_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QList>
+#include <QProcess>
+#include <QTimer>
+#include "speechengine.h"
+#include "audioring.h"
+
+class QLocalServer;
+class QLocalSocket;
+
+// 在辅助进程（--speech-host，见 speechhost.h）中运行识别引擎的代理：
+// 界面进程不加载 SDK，SDK 崩溃或卡死时只重启辅助进程，界面和已显示的结果不受影响。
+//
+// 音频写入共享内存环，识别结果从本机套接字返回后照常进入结果队列（字幕环、会话轨迹、
+// 合并和分发都与进程内引擎相同）。辅助进程异常退出或超过 hangTimeoutMs 没有消息时
+// 结束它并重新启动，正在进行的会话自动继续，期间的音频留在环中，重启后补送。
+class HostedSpeechEngine : public SpeechEngine
+{
+    Q_OBJECT
+
+public:
+    explicit HostedSpeechEngine(const QString &engineName = "azure", QObject *parent = nullptr);
+    ~HostedSpeechEngine() override;
+
+    void initialize(const QString &subscriptionKey, const QString &region) override;
+    void startRecognitionAndTranslation(const QString &sourceLanguage, const QString &targetLanguage) override;
+    void stopRecognitionAndTranslation() override;
+    void processAudioData(const QByteArray &audioData) override;
+    void finishAudioInput() override;
+    void reconfigure(const QString &sourceLanguage, const QString &targetLanguage) override;
+
+    // 辅助进程多久没有任何消息（心跳每秒一次）视为卡死
+    void setHangTimeoutMs(int ms) { hangTimeoutMs = ms; }
+    int restartCount() const { return restarts; }
+
+private:
+    bool ensureTransport();
+    void launchHost();
+    void restartHost(const QString &reason);
+    void onHostConnected();
+    void onReadyRead();
+    void onHostFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void onWatchdog();
+    void handleMessage(const QJsonObject &message);
+    void send(const QJsonObject &message);
+    void sendInit();
+
+    QString engineName;
+    QString subscriptionKey;
+    QString region;
+    QString currentSourceLanguage;
+    QString currentTargetLanguage;
+    bool initialized;
+    bool sessionActive;         // 会话进行中：辅助进程重启后要继续
+
+    QString serverName;
+    QString ringName;
+    AudioRingWriter ring;
+    QLocalServer *server;
+    QLocalSocket *socket;
+    QProcess *process;
+    QList<QByteArray> outbox;   // 辅助进程连接之前的命令
+
+    QTimer watchdog;
+    QElapsedTimer sinceLastMessage;
+    QElapsedTimer launchTimer;      // 启动到会话就绪的耗时
+    bool restarting;
+    bool shuttingDown;
+    int hangTimeoutMs;
+    int restarts;
+    QList<qint64> recentRestarts;   // 最近一分钟内的重启时刻，用于判断反复崩溃
+    QElapsedTimer lifetime;
+};
+
+#endif // HOSTEDSPEECHENGINE_H
@@ -0,0 +1,316 @@
+#include "ingestloadtest.h"
+#include "ingestserver.h"
+#include "logger.h"
+#include <QTcpSocket>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <QtEndian>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const double kPi = 3.14159265358979323846;
+const int kSampleRate = 16000;
+const int kSendIntervalMs = 20;
+// 发送端积压超过 1 秒音频说明服务端已在施加背压
+const qint64 kStallBytes = kSampleRate * 2;
+// 发送结束帧后等待各会议室收到 finished 的最长时间
+const int kDrainTimeoutMs = 5000;
+// 测试音周期和每段长度（采样数）
+const qint64 kTonePeriodSamples = 3 * kSampleRate;
+const qint64 kToneSamples = kSampleRate * 3 / 2;
+// 比这更短的测试音片段不一定被识别为语音
+const qint64 kMinToneSamples = kSampleRate / 10;
+// 定稿的结束位置按识别帧对齐，允许的误差
+const qint64 kSpeechEndToleranceMs = 100;
+
+// 与延迟测量相同的测试音：1.5 秒 440Hz 与 1.5 秒静音交替
+qint16 toneSample(qint64 index)
+{
+    const double t = static_cast<double>(index) / kSampleRate;
+    return std::fmod(t, 3.0) < 1.5 ? static_cast<qint16>(0.3 * 32767 * std::sin(2 * kPi * 440 * t)) : 0;
+}
+
+// 已发送的音频中最后一段测试音的结束位置（毫秒），没有可识别的测试音时为 0
+qint64 lastSpeechEndMs(qint64 sentSamples)
+{
+    const qint64 period = sentSamples / kTonePeriodSamples;
+    const qint64 within = sentSamples % kTonePeriodSamples;
+    qint64 endSample = 0;
+    if (within >= kMinToneSamples) {
+        endSample = period * kTonePeriodSamples + qMin(within, kToneSamples);
+    } else if (period > 0) {
+        endSample = (period - 1) * kTonePeriodSamples + kToneSamples;
+    }
+    return endSample * 1000 / kSampleRate;
+}
+
+// 音频帧：4 字节小端长度 + 数据；空数据即结束帧
+void writeFrame(QTcpSocket *socket, const QByteArray &payload)
+{
+    const quint32 length = qToLittleEndian(static_cast<quint32>(payload.size()));
+    socket->write(reinterpret_cast<const char *>(&length), sizeof(length));
+    if (!payload.isEmpty()) {
+        socket->write(payload);
+    }
+}
+
+double percentile(QVector<double> values, double p)
+{
+    if (values.isEmpty()) {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    const int index = qBound(0, static_cast<int>(std::ceil(p * values.size())) - 1, values.size() - 1);
+    return values[index];
+}
+
+} // namespace
+
+struct IngestLoadTest::Room {
+    int index = 0;
+    QTcpSocket *socket = nullptr;
+    QElapsedTimer clock;
+    qint64 sentSamples = 0;
+    bool stalled = false;
+    bool ended = false;             // 已发送结束帧
+    bool finished = false;          // 已收到 finished
+    qint64 lastFinalEndMs = -1;
+};
+
+IngestLoadTest::IngestLoadTest(const LoadTestOptions &options, QObject *parent)
+    : QObject(parent)
+    , options(options)
+    , server(nullptr)
+    , port(options.port)
+    , baselineP95Ms(0)
+    , supportedRooms(0)
+{
+    sendTimer.setInterval(kSendIntervalMs);
+    sendTimer.setTimerType(Qt::PreciseTimer);
+    connect(&sendTimer, &QTimer::timeout, this, &IngestLoadTest::sendAudio);
+    drainTimer.setSingleShot(true);
+    connect(&drainTimer, &QTimer::timeout, this, &IngestLoadTest::completeStep);
+}
+
+IngestLoadTest::~IngestLoadTest()
+{
+    closeRooms();
+    delete server;
+}
+
+bool IngestLoadTest::start()
+{
+    if (port == 0) {
+        IngestOptions serverOptions;
+        serverOptions.port = 0;
+        serverOptions.engineName = "local";
+        server = new IngestServer(serverOptions);
+        if (!server->start()) {
+            return false;
+        }
+        port = server->serverPort();
+    }
+
+    LOG_INFO(QString("开始接入服务压力测试: %1:%2，每级 %3 秒，最多 %4 个会议室")
+             .arg(options.host)
+             .arg(port)
+             .arg(options.stepSeconds)
+             .arg(options.maxRooms));
+    startStep(1);
+    return true;
+}
+
+void IngestLoadTest::startStep(int roomCount)
+{
+    stepLatencies.clear();
+    for (int i = 0; i < roomCount; ++i) {
+        Room *room = new Room;
+        room->index = i;
+        room->socket = new QTcpSocket(this);
+        connect(room->socket, &QTcpSocket::connected, this, [room]() {
+            QJsonObject header;
+            header["room"] = QString("load-%1").arg(room->index);
+            header["sampleRate"] = kSampleRate;
+            header["channels"] = 1;
+            header["format"] = "s16";
+            room->socket->write(QJsonDocument(header).toJson(QJsonDocument::Compact) + "\n");
+            room->clock.start();
+        });
+        connect(room->socket, &QTcpSocket::readyRead, this, [this, room]() { onCaptionData(room); });
+        room->socket->connectToHost(options.host, port);
+        rooms.append(room);
+    }
+    sendTimer.start();
+    QTimer::singleShot(options.stepSeconds * 1000, this, &IngestLoadTest::finishStep);
+}
+
+void IngestLoadTest::sendAudio()
+{
+    for (Room *room : rooms) {
+        if (!room->clock.isValid()) {
+            continue;
+        }
+        if (room->socket->bytesToWrite() > kStallBytes) {
+            room->stalled = true;
+            continue;
+        }
+
+        // 按经过的时间补齐应发送的采样，定时器抖动不会让发送速度偏离实时
+        const qint64 target = room->clock.elapsed() * kSampleRate / 1000;
+        const qint64 count = target - room->sentSamples;
+        if (count <= 0) {
+            continue;
+        }
+        QByteArray chunk(static_cast<int>(count * sizeof(qint16)), Qt::Uninitialized);
+        qint16 *samples = reinterpret_cast<qint16 *>(chunk.data());
+        for (qint64 i = 0; i < count; ++i) {
+            samples[i] = toneSample(room->sentSamples + i);
+        }
+        writeFrame(room->socket, chunk);
+        room->sentSamples = target;
+    }
+}
+
+void IngestLoadTest::onCaptionData(Room *room)
+{
+    while (room->socket->canReadLine()) {
+        const QJsonObject caption = QJsonDocument::fromJson(room->socket->readLine()).object();
+        const QString type = caption.value("type").toString();
+        if (type == "finished") {
+            room->finished = true;
+            continue;
+        }
+        if (type != "final") {
+            continue;
+        }
+        const qint64 speechEndMs = caption.value("offsetMs").toInteger() + caption.value("durationMs").toInteger();
+        room->lastFinalEndMs = qMax(room->lastFinalEndMs, speechEndMs);
+        // 语音在流中的结束位置就是它被发出的时刻（实时发送），差值即定稿延迟；
+        // 结束帧之后的定稿由音频结束触发，不计入延迟
+        if (!room->ended) {
+            stepLatencies.append(room->clock.elapsed() - speechEndMs);
+        }
+    }
+
+    if (room->finished && drainTimer.isActive()
+        && std::all_of(rooms.begin(), rooms.end(), [](const Room *r) { return r->finished || !r->ended; })) {
+        drainTimer.stop();
+        completeStep();
+    }
+}
+
+void IngestLoadTest::finishStep()
+{
+    sendTimer.stop();
+
+    // 发送结束帧，等服务端送回剩余的定稿和 finished
+    bool waiting = false;
+    for (Room *room : rooms) {
+        if (room->clock.isValid() && room->socket->state() == QAbstractSocket::ConnectedState) {
+            writeFrame(room->socket, QByteArray());
+            room->ended = true;
+            waiting = true;
+        }
+    }
+    if (waiting) {
+        drainTimer.start(kDrainTimeoutMs);
+    } else {
+        completeStep();
+    }
+}
+
+void IngestLoadTest::completeStep()
+{
+    StepResult result;
+    result.rooms = rooms.size();
+    result.finals = stepLatencies.size();
+    result.p50Ms = percentile(stepLatencies, 0.50);
+    result.p95Ms = percentile(stepLatencies, 0.95);
+    result.maxMs = stepLatencies.isEmpty() ? 0 : *std::max_element(stepLatencies.begin(), stepLatencies.end());
+    for (const Room *room : rooms) {
+        if (room->stalled || !room->clock.isValid()) {
+            ++result.stalledRooms;
+        }
+        const qint64 expectedEndMs = lastSpeechEndMs(room->sentSamples);
+        if (!room->finished || (expectedEndMs > 0 && room->lastFinalEndMs < expectedEndMs - kSpeechEndToleranceMs)) {
+            ++result.incompleteRooms;
+        }
+    }
+    results.append(result);
+    closeRooms();
+
+    LOG_INFO(QString("压力测试 %1 个会议室：定稿 %2 条，p50 %3 ms，p95 %4 ms，受阻 %5 个，缺少结尾 %6 个")
+             .arg(result.rooms)
+             .arg(result.finals)
+             .arg(result.p50Ms, 0, 'f', 0)
+             .arg(result.p95Ms, 0, 'f', 0)
+             .arg(result.stalledRooms)
+             .arg(result.incompleteRooms));
+
+    bool degraded = result.finals == 0 || result.stalledRooms > 0 || result.incompleteRooms > 0;
+    if (result.rooms == 1) {
+        baselineP95Ms = result.p95Ms;
+    } else if (result.p95Ms > baselineP95Ms + options.latencyBudgetMs) {
+        degraded = true;
+    }
+
+    if (degraded) {
+        report();
+        emit finished(supportedRooms);
+        return;
+    }
+    supportedRooms = result.rooms;
+
+    if (result.rooms >= options.maxRooms) {
+        report();
+        emit finished(supportedRooms);
+        return;
+    }
+    const int nextRooms = qMin(result.rooms * 2, options.maxRooms);
+    // 留出时间让服务端回收上一级的会话
+    QTimer::singleShot(500, this, [this, nextRooms]() { startStep(nextRooms); });
+}
+
+void IngestLoadTest::closeRooms()
+{
+    for (Room *room : rooms) {
+        room->socket->disconnect(this);
+        room->socket->abort();
+        room->socket->deleteLater();
+        delete room;
+    }
+    rooms.clear();
+}
+
+void IngestLoadTest::report()
+{
+    QTextStream out(stdout);
+    out << QString("%1 %2 %3 %4 %5 %6 %7\n")
+           .arg("会议室", 8)
+           .arg("定稿数", 8)
+           .arg("p50(ms)", 10)
+           .arg("p95(ms)", 10)
+           .arg("最大(ms)", 10)
+           .arg("受阻", 6)
+           .arg("缺少结尾", 8);
+    for (const StepResult &r : results) {
+        out << QString("%1 %2 %3 %4 %5 %6 %7\n")
+               .arg(r.rooms, 8)
+               .arg(r.finals, 8)
+               .arg(r.p50Ms, 10, 'f', 0)
+               .arg(r.p95Ms, 10, 'f', 0)
+               .arg(r.maxMs, 10, 'f', 0)
+               .arg(r.stalledRooms, 6)
+               .arg(r.incompleteRooms, 8);
+    }
+    const QString summary = QString("延迟开始变差前可承载 %1 个会议室（基线 p95 %2 ms，允许增加 %3 ms）")
+            .arg(supportedRooms)
+            .arg(baselineP95Ms, 0, 'f', 0)
+            .arg(options.latencyBudgetMs, 0, 'f', 0);
+    out << summary << "\n";
+    out.flush();
+    LOG_INFO(summary);
+}
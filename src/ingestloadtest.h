@@ -0,0 +1,70 @@
+#ifndef INGESTLOADTEST_H
+#define INGESTLOADTEST_H
+
+#include <QObject>
+#include <QList>
+#include <QVector>
+#include <QElapsedTimer>
+#include <QTimer>
+
+class IngestServer;
+class QTcpSocket;
+
+struct LoadTestOptions {
+    QString host = "127.0.0.1";
+    quint16 port = 0;               // 0 表示在本进程内启动使用本地替身引擎的接入服务
+    int maxRooms = 64;
+    int stepSeconds = 10;
+    double latencyBudgetMs = 300;   // 定稿延迟 p95 比单会议室基线高出该值即视为性能下降
+};
+
+// 接入服务压力测试：按 1、2、4、8…… 个会议室逐级加压，每个会议室以实时速度发送
+// 间断的测试音，统计“语音结束 -> 收到定稿字幕”的延迟，报告延迟开始变差前能承载的会议室数。
+// 每级结束时发送结束帧，检查每个会议室都收到了最后一段语音的定稿和 finished。
+class IngestLoadTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit IngestLoadTest(const LoadTestOptions &options, QObject *parent = nullptr);
+    ~IngestLoadTest();
+
+    bool start();
+
+signals:
+    void finished(int supportedRooms);
+
+private:
+    struct Room;
+    struct StepResult {
+        int rooms = 0;
+        int finals = 0;
+        double p50Ms = 0;
+        double p95Ms = 0;
+        double maxMs = 0;
+        int stalledRooms = 0;
+        int incompleteRooms = 0;    // 没有收到最后一段语音的定稿或 finished
+    };
+
+    void startStep(int rooms);
+    void finishStep();
+    // 所有会议室都收到 finished（或超时）后统计本级结果
+    void completeStep();
+    void sendAudio();
+    void onCaptionData(Room *room);
+    void closeRooms();
+    void report();
+
+    LoadTestOptions options;
+    IngestServer *server;
+    quint16 port;
+    QList<Room *> rooms;
+    QTimer sendTimer;
+    QTimer drainTimer;
+    QVector<double> stepLatencies;
+    QList<StepResult> results;
+    double baselineP95Ms;
+    int supportedRooms;
+};
+
+#endif // INGESTLOADTEST_H
@@ -0,0 +1,441 @@
+#include "ingestserver.h"
+#include "speechengine.h"
+#include "logger.h"
+#include "metrics.h"
+#include <QThread>
+#include <QTcpSocket>
+#include <QHostAddress>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTimer>
+#include <QtEndian>
+
+namespace {
+
+MetricGauge &sessionsGauge()
+{
+    static MetricGauge &sessions = Metrics::gauge("ingest_sessions", "接入服务当前的会话数");
+    return sessions;
+}
+
+const int kSpeechSampleRate = 16000;
+const int kMaxHeaderBytes = 4096;
+// 读缓冲上限：缓冲满后 Qt 停止从内核读取，TCP 窗口关闭，发送端被阻塞
+const qint64 kReadBufferBytes = 256 * 1024;
+// 每次最多处理约 100ms 输入音频，然后让出线程给同一线程上的其他会话
+const int kMaxChunkMs = 100;
+// 回传字幕积压超过该值时丢弃部分结果，并暂停消费音频
+const qint64 kMaxOutgoingBytes = 64 * 1024;
+// 音频帧：4 字节小端长度 + 数据，长度为 0 表示音频结束
+const int kFrameHeaderBytes = 4;
+const quint32 kMaxFrameBytes = 1024 * 1024;
+// 结束后等待回传字幕写完的最长时间
+const int kCloseTimeoutMs = 10000;
+
+AudioStreamFormat describeHeaderFormat(const QJsonObject &header)
+{
+    AudioStreamFormat format;
+    format.sampleRate = header.value("sampleRate").toInt(kSpeechSampleRate);
+    format.channels = header.value("channels").toInt(1);
+    const QString sampleFormat = header.value("format").toString("s16");
+    if (sampleFormat == "s16") {
+        format.sampleType = SampleType::Int16;
+        format.containerBits = 16;
+    } else if (sampleFormat == "s32") {
+        format.sampleType = SampleType::Int32;
+        format.containerBits = 32;
+    } else if (sampleFormat == "f32") {
+        format.sampleType = SampleType::Float32;
+        format.containerBits = 32;
+    }
+    format.validBits = format.containerBits;
+    return format;
+}
+
+} // namespace
+
+IngestSession::IngestSession(int id, const IngestOptions &options, QObject *parent)
+    : QObject(parent)
+    , sessionId(id)
+    , options(options)
+    , socket(nullptr)
+    , engine(nullptr)
+    , headerReceived(false)
+    , inputFinished(false)
+    , processScheduled(false)
+    , finishRequested(false)
+    , closing(false)
+    , scratch(MemoryTag::Dsp)
+    , payloadRemaining(0)
+    , receivedBytes(0)
+    , droppedPartials(0)
+{
+}
+
+IngestSession::~IngestSession()
+{
+    if (engine) {
+        engine->stopRecognitionAndTranslation();
+    }
+}
+
+void IngestSession::start(qintptr socketDescriptor)
+{
+    socket = new QTcpSocket(this);
+    if (!socket->setSocketDescriptor(socketDescriptor)) {
+        LOG_ERROR(QString("会话 %1 无法接管连接: %2").arg(sessionId).arg(socket->errorString()));
+        close();
+        return;
+    }
+    socket->setReadBufferSize(kReadBufferBytes);
+
+    connect(socket, &QTcpSocket::readyRead, this, &IngestSession::onReadyRead);
+    // 音频结束由结束帧表示；QTcpSocket 把对端关闭写方向也当作断开，这里一律视为客户端放弃
+    connect(socket, &QTcpSocket::disconnected, this, &IngestSession::close);
+    // 字幕积压消化后继续消费音频；积压期间收到结束帧的，也在这里通知引擎
+    connect(socket, &QTcpSocket::bytesWritten, this, [this]() {
+        if (!engine || socket->bytesToWrite() >= kMaxOutgoingBytes / 2) {
+            return;
+        }
+        if (hasBufferedAudio() || (inputFinished && !finishRequested)) {
+            scheduleProcessing();
+        }
+    });
+}
+
+void IngestSession::onReadyRead()
+{
+    if (closing) {
+        return;
+    }
+
+    if (!headerReceived) {
+        if (!socket->canReadLine()) {
+            if (socket->bytesAvailable() > kMaxHeaderBytes) {
+                fail("缺少流格式头");
+            }
+            return;
+        }
+        if (!parseHeader(socket->readLine(kMaxHeaderBytes).trimmed())) {
+            return;
+        }
+    }
+
+    scheduleProcessing();
+}
+
+void IngestSession::scheduleProcessing()
+{
+    if (!processScheduled) {
+        processScheduled = true;
+        QTimer::singleShot(0, this, &IngestSession::processPending);
+    }
+}
+
+bool IngestSession::parseHeader(const QByteArray &line)
+{
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(line, &parseError);
+    if (!document.isObject()) {
+        fail(QString("流格式头不是 JSON 对象: %1").arg(parseError.errorString()));
+        return false;
+    }
+
+    const QJsonObject header = document.object();
+    converter = SampleConverter::create(describeHeaderFormat(header));
+    if (!converter.isValid() || converter.format().sampleRate <= 0) {
+        fail("不支持的音频格式");
+        return false;
+    }
+
+    room = header.value("room").toString(QString::number(sessionId));
+    const QString source = header.value("source").toString(options.sourceLanguage);
+    const QString target = header.value("target").toString(options.targetLanguage);
+
+    engine = SpeechEngine::create(options.engineName, this);
+    engine->setLatencyProfile(options.latencyProfile);
+    connect(engine, &SpeechEngine::recognitionResult, this, [this](const QString &text) {
+        QJsonObject object;
+        object["type"] = "partial";
+        object["text"] = text;
+        sendLine(object, true);
+    });
+    connect(engine, &SpeechEngine::finalSegment, this,
+            [this](qint64 offsetMs, qint64 durationMs, const QString &text, const QString &translation) {
+        QJsonObject object;
+        object["type"] = "final";
+        object["offsetMs"] = offsetMs;
+        object["durationMs"] = durationMs;
+        object["text"] = text;
+        object["translation"] = translation;
+        sendLine(object, false);
+    });
+    connect(engine, &SpeechEngine::error, this, [this](const QString &message) {
+        QJsonObject object;
+        object["type"] = "error";
+        object["message"] = message;
+        sendLine(object, false);
+    });
+    connect(engine, &SpeechEngine::sessionFinished, this, [this]() {
+        if (finishRequested) {
+            QJsonObject object;
+            object["type"] = "finished";
+            sendLine(object, false);
+            close();
+        }
+    }, Qt::QueuedConnection);
+
+    engine->initialize(options.subscriptionKey, options.region);
+    engine->startRecognitionAndTranslation(source, target);
+
+    headerReceived = true;
+    LOG_INFO(QString("会议室 %1 已接入（会话 %2，%3Hz/%4 声道，线程 %5）")
+             .arg(room)
+             .arg(sessionId)
+             .arg(converter.format().sampleRate)
+             .arg(converter.format().channels)
+             .arg(reinterpret_cast<quintptr>(QThread::currentThreadId())));
+    return true;
+}
+
+void IngestSession::processPending()
+{
+    processScheduled = false;
+    if (closing || !engine) {
+        return;
+    }
+
+    // 回传积压时不再消费音频：读缓冲随之填满，背压传回发送端
+    if (socket->bytesToWrite() > kMaxOutgoingBytes) {
+        return;
+    }
+
+    const AudioStreamFormat &format = converter.format();
+    const int bytesPerFrame = converter.bytesPerFrame();
+    const qint64 maxFrames = static_cast<qint64>(format.sampleRate) * kMaxChunkMs / 1000;
+    if (!readFrames(maxFrames * bytesPerFrame)) {
+        return;
+    }
+    const qint64 frames = pendingPcm.size() / bytesPerFrame;
+
+    if (frames > 0) {
+        const int bytes = static_cast<int>(frames * bytesPerFrame);
+        receivedBytes += bytes;
+        static MetricCounter &ingestBytes = Metrics::counter("ingest_received_bytes_total", "接入服务收到的音频字节数");
+        ingestBytes.add(bytes);
+        // 转换和重采样的中间数据只在本块内有效
+        scratch.reset();
+        int16_t *mono = scratch.allocateArray<int16_t>(static_cast<size_t>(frames));
+        converter.convert(reinterpret_cast<const uint8_t *>(pendingPcm.constData()),
+                          static_cast<uint32_t>(frames), false, mono);
+        pendingPcm.remove(0, bytes);
+
+        const int16_t *pcm = mono;
+        size_t samples = static_cast<size_t>(frames);
+        if (format.sampleRate != kSpeechSampleRate) {
+            int16_t *resampled = scratch.allocateArray<int16_t>(
+                    resampledLength(samples, format.sampleRate, kSpeechSampleRate));
+            samples = resampleLinear(mono, samples, format.sampleRate, kSpeechSampleRate, resampled);
+            pcm = resampled;
+        }
+        engine->processAudioData(QByteArray(reinterpret_cast<const char *>(pcm),
+                                            static_cast<int>(samples * sizeof(int16_t))));
+    }
+
+    if (hasBufferedAudio()) {
+        // 还有数据：下一轮事件循环继续，期间同线程的其他会话也能得到处理
+        scheduleProcessing();
+    } else if (inputFinished && !finishRequested) {
+        // 结束帧之前不足一个采样帧的零头丢弃
+        pendingPcm.clear();
+        finishRequested = true;
+        engine->finishAudioInput();
+    }
+}
+
+bool IngestSession::readFrames(qint64 budget)
+{
+    while (!inputFinished && pendingPcm.size() < budget) {
+        if (payloadRemaining == 0) {
+            if (socket->bytesAvailable() < kFrameHeaderBytes) {
+                break;
+            }
+            quint32 length = 0;
+            socket->read(reinterpret_cast<char *>(&length), kFrameHeaderBytes);
+            length = qFromLittleEndian(length);
+            if (length == 0) {
+                inputFinished = true;
+                break;
+            }
+            if (length > kMaxFrameBytes) {
+                fail(QString("音频帧过长（%1 字节）").arg(length));
+                return false;
+            }
+            payloadRemaining = length;
+        }
+        const qint64 take = qMin(payloadRemaining, qMin(socket->bytesAvailable(), budget - pendingPcm.size()));
+        if (take <= 0) {
+            break;
+        }
+        pendingPcm.append(socket->read(take));
+        payloadRemaining -= take;
+    }
+    return true;
+}
+
+bool IngestSession::hasBufferedAudio() const
+{
+    if (pendingPcm.size() >= converter.bytesPerFrame()) {
+        return true;
+    }
+    if (inputFinished) {
+        return false;
+    }
+    return socket->bytesAvailable() >= (payloadRemaining > 0 ? 1 : kFrameHeaderBytes);
+}
+
+void IngestSession::sendLine(const QJsonObject &object, bool droppable)
+{
+    if (closing || socket->state() != QAbstractSocket::ConnectedState) {
+        return;
+    }
+    if (droppable && socket->bytesToWrite() > kMaxOutgoingBytes) {
+        ++droppedPartials;
+        return;
+    }
+    socket->write(QJsonDocument(object).toJson(QJsonDocument::Compact));
+    socket->write("\n");
+}
+
+void IngestSession::fail(const QString &message)
+{
+    LOG_ERROR(QString("会话 %1: %2").arg(sessionId).arg(message));
+    QJsonObject object;
+    object["type"] = "error";
+    object["message"] = message;
+    sendLine(object, false);
+    close();
+}
+
+void IngestSession::close()
+{
+    if (closing) {
+        return;
+    }
+    closing = true;
+
+    LOG_INFO(QString("会议室 %1 断开（会话 %2），收到 %3 KB 音频，丢弃 %4 个部分结果")
+             .arg(room.isEmpty() ? QString::number(sessionId) : room)
+             .arg(sessionId)
+             .arg(receivedBytes / 1024)
+             .arg(droppedPartials));
+    if (engine) {
+        engine->stopRecognitionAndTranslation();
+    }
+    if (socket && socket->state() == QAbstractSocket::ConnectedState) {
+        socket->disconnectFromHost();
+    }
+    emit closed(sessionId);
+    if (socket && socket->state() == QAbstractSocket::ClosingState) {
+        // 回传的字幕还没写完，立即销毁会丢掉最后几条最终结果：写完断开后再销毁
+        connect(socket, &QTcpSocket::disconnected, this, &QObject::deleteLater);
+        QTimer::singleShot(kCloseTimeoutMs, this, &QObject::deleteLater);
+        return;
+    }
+    deleteLater();
+}
+
+void IngestTcpServer::incomingConnection(qintptr socketDescriptor)
+{
+    emit connectionPending(socketDescriptor);
+}
+
+IngestServer::IngestServer(const IngestOptions &options, QObject *parent)
+    : QObject(parent)
+    , options(options)
+    , nextSessionId(1)
+{
+    connect(&server, &IngestTcpServer::connectionPending, this, &IngestServer::onConnectionPending);
+}
+
+IngestServer::~IngestServer()
+{
+    server.close();
+    // 先在各线程中销毁会话，再停止线程
+    for (QObject *context : workerContexts) {
+        QMetaObject::invokeMethod(context, [context]() { delete context; }, Qt::BlockingQueuedConnection);
+    }
+    for (QThread *worker : workers) {
+        worker->quit();
+        worker->wait();
+        delete worker;
+    }
+}
+
+bool IngestServer::start()
+{
+    const int threadCount = options.workerThreads > 0 ? options.workerThreads
+                                                      : qMax(1, QThread::idealThreadCount());
+    for (int i = 0; i < threadCount; ++i) {
+        QThread *worker = new QThread();
+        worker->setObjectName(QString("ingest-%1").arg(i));
+        worker->start();
+        QObject *context = new QObject();
+        context->moveToThread(worker);
+        workers.append(worker);
+        workerContexts.append(context);
+        workerLoad.append(0);
+    }
+
+    if (!server.listen(QHostAddress(options.listenAddress), options.port)) {
+        LOG_ERROR(QString("无法监听 %1:%2: %3")
+                  .arg(options.listenAddress)
+                  .arg(options.port)
+                  .arg(server.errorString()));
+        return false;
+    }
+
+    LOG_INFO(QString("接入服务已启动: %1:%2，引擎 %3，工作线程 %4 个")
+             .arg(options.listenAddress)
+             .arg(server.serverPort())
+             .arg(options.engineName)
+             .arg(threadCount));
+    return true;
+}
+
+quint16 IngestServer::serverPort() const
+{
+    return server.serverPort();
+}
+
+void IngestServer::onConnectionPending(qintptr socketDescriptor)
+{
+    int worker = 0;
+    for (int i = 1; i < workerLoad.size(); ++i) {
+        if (workerLoad[i] < workerLoad[worker]) {
+            worker = i;
+        }
+    }
+
+    const int id = nextSessionId++;
+    sessionWorker.insert(id, worker);
+    ++workerLoad[worker];
+    sessionsGauge().add(1);
+
+    QObject *context = workerContexts[worker];
+    const IngestOptions sessionOptions = options;
+    QMetaObject::invokeMethod(context, [this, context, id, sessionOptions, socketDescriptor]() {
+        IngestSession *session = new IngestSession(id, sessionOptions, context);
+        connect(session, &IngestSession::closed, this, &IngestServer::onSessionClosed, Qt::QueuedConnection);
+        session->start(socketDescriptor);
+    }, Qt::QueuedConnection);
+}
+
+void IngestServer::onSessionClosed(int id)
+{
+    if (!sessionWorker.contains(id)) {
+        return;
+    }
+    --workerLoad[sessionWorker.take(id)];
+    sessionsGauge().add(-1);
+}
@@ -0,0 +1,132 @@
+#ifndef INGESTSERVER_H
+#define INGESTSERVER_H
+
+#include <QObject>
+#include <QList>
+#include <QHash>
+#include <QByteArray>
+#include <QTcpServer>
+#include "audioformat.h"
+#include "memoryaccounting.h"
+#include "latencyprofile.h"
+
+class QThread;
+class QTcpSocket;
+class QJsonObject;
+class SpeechEngine;
+
+// 服务模式（--serve）：在本机 TCP 端口上同时接收多个会议室的 PCM 音频流。
+//
+// 协议（每个连接一个会议室）：
+//   客户端先发送一行 JSON 头，如
+//     {"room":"A","sampleRate":48000,"channels":2,"format":"s16","source":"en-US","target":"zh-CN"}
+//   format 取 s16 / s32 / f32，省略的字段取 16000Hz、单声道、s16 和服务端默认语言；
+//   之后按帧发送交错的 PCM 数据：每帧是 4 字节小端长度加该长度的数据，长度为 0 的帧表示音频结束。
+//   服务端在同一连接上按行返回 JSON 字幕：
+//     {"type":"partial","text":...,"translation":...}
+//     {"type":"final","offsetMs":...,"durationMs":...,"text":...,"translation":...}
+//     {"type":"error","message":...}
+//   收到结束帧且识别完成后返回 {"type":"finished"}，写完所有字幕再关闭连接。
+//   客户端在此之前关闭连接（包括只关闭写方向）视为放弃，剩余的字幕不再发送。
+struct IngestOptions {
+    QString listenAddress = "127.0.0.1";
+    quint16 port = 5710;
+    QString engineName = "local";
+    QString subscriptionKey;
+    QString region;
+    QString sourceLanguage = "en-US";
+    QString targetLanguage = "zh-CN";
+    LatencyProfile latencyProfile = LatencyProfile::byName("balanced");
+    int workerThreads = 0;              // 0 表示按 CPU 核数
+};
+
+// 单个连接的会话：格式转换 -> 重采样 -> 识别引擎，运行在某个工作线程中
+class IngestSession : public QObject
+{
+    Q_OBJECT
+
+public:
+    IngestSession(int id, const IngestOptions &options, QObject *parent = nullptr);
+    ~IngestSession();
+
+    // 在所属工作线程中调用
+    void start(qintptr socketDescriptor);
+
+    int id() const { return sessionId; }
+
+signals:
+    void closed(int id);
+
+private:
+    void onReadyRead();
+    bool parseHeader(const QByteArray &line);
+    void scheduleProcessing();
+    void processPending();
+    // 从音频帧中取出最多 budget 字节 PCM 放入 pendingPcm；帧长度不合法时断开并返回 false
+    bool readFrames(qint64 budget);
+    // 还有可以立即处理的音频（不含不完整的帧头）
+    bool hasBufferedAudio() const;
+    void sendLine(const QJsonObject &object, bool droppable);
+    void fail(const QString &message);
+    void close();
+
+    int sessionId;
+    IngestOptions options;
+    QString room;
+    QTcpSocket *socket;
+    SpeechEngine *engine;
+    SampleConverter converter;
+    bool headerReceived;
+    bool inputFinished;         // 已收到结束帧
+    bool processScheduled;
+    bool finishRequested;
+    bool closing;
+    MemoryArena scratch;        // 每块音频的转换/重采样缓冲区
+    QByteArray pendingPcm;      // 已从帧中取出、还不够一个采样帧的数据
+    qint64 payloadRemaining;    // 当前帧还没读取的字节数
+    qint64 receivedBytes;
+    quint64 droppedPartials;
+};
+
+// 接收连接的 TCP 服务器，把 socket 描述符交给调度器，而不是在主线程创建 QTcpSocket
+class IngestTcpServer : public QTcpServer
+{
+    Q_OBJECT
+
+public:
+    using QTcpServer::QTcpServer;
+
+signals:
+    void connectionPending(qintptr socketDescriptor);
+
+protected:
+    void incomingConnection(qintptr socketDescriptor) override;
+};
+
+// 多路接入服务：每个工作线程承载若干会话，新连接分配给会话最少的线程
+class IngestServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit IngestServer(const IngestOptions &options, QObject *parent = nullptr);
+    ~IngestServer();
+
+    bool start();
+    quint16 serverPort() const;
+    int sessionCount() const { return sessionWorker.size(); }
+
+private:
+    void onConnectionPending(qintptr socketDescriptor);
+    void onSessionClosed(int id);
+
+    IngestOptions options;
+    IngestTcpServer server;
+    QList<QThread *> workers;
+    QList<QObject *> workerContexts;    // 各线程中会话的父对象，会话只在所属线程中创建和销毁
+    QList<int> workerLoad;              // 每个工作线程上的会话数
+    QHash<int, int> sessionWorker;
+    int nextSessionId;
+};
+
+#endif // INGESTSERVER_H
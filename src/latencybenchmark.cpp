@@ -0,0 +1,294 @@
+#include "latencybenchmark.h"
+#include "audioprocessor.h"
+#include "captionthrottle.h"
+#include "localspeechengine.h"
+#include "logger.h"
+#include <QAudioSink>
+#include <QAudioFormat>
+#include <QMediaDevices>
+#include <QAudioDevice>
+#include <QIODevice>
+#include <QTextStream>
+#include <QTimer>
+#include <cmath>
+#include <cstring>
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+const double kPi = 3.14159265358979323846;
+const int kCaptureRate = 16000;          // AudioProcessor 输出 16kHz 单声道 16-bit
+const int kToneFrameSamples = kCaptureRate / 100;
+const double kToneRmsThreshold = 1000.0; // 测试音振幅 0.3，RMS 约 7000
+
+// 测试音：1.5 秒 440Hz 音调与 1.5 秒静音交替，让本地引擎产生部分结果和定稿
+class ToneGenerator : public QIODevice
+{
+public:
+    explicit ToneGenerator(const QAudioFormat &format, QObject *parent = nullptr)
+        : QIODevice(parent), format(format), frame(0) {}
+
+    qint64 bytesAvailable() const override
+    {
+        return format.bytesForDuration(100000) + QIODevice::bytesAvailable();
+    }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override
+    {
+        const int bytesPerFrame = format.bytesPerFrame();
+        const int bytesPerSample = format.bytesPerSample();
+        const qint64 frames = maxSize / bytesPerFrame;
+        for (qint64 i = 0; i < frames; ++i, ++frame) {
+            const double t = static_cast<double>(frame) / format.sampleRate();
+            const double value = std::fmod(t, 3.0) < 1.5 ? 0.3 * std::sin(2 * kPi * 440 * t) : 0.0;
+            for (int c = 0; c < format.channelCount(); ++c) {
+                char *out = data + i * bytesPerFrame + c * bytesPerSample;
+                switch (format.sampleFormat()) {
+                case QAudioFormat::UInt8: {
+                    quint8 v = static_cast<quint8>(128 + value * 127);
+                    std::memcpy(out, &v, sizeof(v));
+                    break;
+                }
+                case QAudioFormat::Int16: {
+                    qint16 v = static_cast<qint16>(value * 32767);
+                    std::memcpy(out, &v, sizeof(v));
+                    break;
+                }
+                case QAudioFormat::Int32: {
+                    qint32 v = static_cast<qint32>(value * 2147483647.0);
+                    std::memcpy(out, &v, sizeof(v));
+                    break;
+                }
+                default: {
+                    float v = static_cast<float>(value);
+                    std::memcpy(out, &v, sizeof(v));
+                    break;
+                }
+                }
+            }
+        }
+        return frames * bytesPerFrame;
+    }
+
+    qint64 writeData(const char *, qint64) override
+    {
+        return -1;
+    }
+
+private:
+    QAudioFormat format;
+    qint64 frame;
+};
+
+} // namespace
+
+qint64 processCpuTimeMs()
+{
+#ifdef Q_OS_WIN
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime)) {
+        return 0;
+    }
+    ULARGE_INTEGER kernel, user;
+    kernel.LowPart = kernelTime.dwLowDateTime;
+    kernel.HighPart = kernelTime.dwHighDateTime;
+    user.LowPart = userTime.dwLowDateTime;
+    user.HighPart = userTime.dwHighDateTime;
+    return static_cast<qint64>((kernel.QuadPart + user.QuadPart) / 10000);
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000LL
+            + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000;
+#endif
+}
+
+LatencyBenchmark::LatencyBenchmark(int secondsPerProfile, QObject *parent)
+    : QObject(parent)
+    , secondsPerProfile(qMax(5, secondsPerProfile))
+    , profileNames(LatencyProfile::names())
+    , currentIndex(-1)
+    , toneSink(nullptr)
+    , toneSource(nullptr)
+    , audioProcessor(nullptr)
+    , engine(nullptr)
+    , throttle(nullptr)
+    , captionUpdates(0)
+    , toneActive(false)
+    , cpuStartMs(0)
+{
+}
+
+LatencyBenchmark::~LatencyBenchmark()
+{
+    cleanupRun();
+}
+
+void LatencyBenchmark::start()
+{
+    LOG_INFO(QString("开始延迟档位测量，每个档位 %1 秒").arg(secondsPerProfile));
+    startProfile(0);
+}
+
+void LatencyBenchmark::startProfile(int index)
+{
+    if (index >= profileNames.size()) {
+        report();
+        emit finished();
+        return;
+    }
+
+    currentIndex = index;
+    const LatencyProfile profile = LatencyProfile::byName(profileNames[index]);
+    LOG_INFO(QString("测量档位: %1").arg(profile.name));
+
+    // 通过默认输出设备播放测试音，回环采集会录到它
+    const QAudioDevice outputDevice = QMediaDevices::defaultAudioOutput();
+    const QAudioFormat outputFormat = outputDevice.preferredFormat();
+    toneSource = new ToneGenerator(outputFormat, this);
+    toneSource->open(QIODevice::ReadOnly);
+    toneSink = new QAudioSink(outputDevice, outputFormat, this);
+    toneSink->start(toneSource);
+
+    engine = new LocalSpeechEngine(this);
+    engine->setLatencyProfile(profile);
+    engine->initialize(QString(), QString());
+    engine->startRecognitionAndTranslation("en-US", "zh-CN");
+
+    throttle = new CaptionThrottle(this);
+    throttle->setInterval(profile.uiUpdateIntervalMs);
+    captionUpdates = 0;
+    connect(engine, &SpeechEngine::recognitionResult, throttle, &CaptionThrottle::submit);
+    connect(throttle, &CaptionThrottle::textReady, this, [this]() { ++captionUpdates; });
+    toneActive = false;
+    pendingToneEnds.clear();
+    finalLatencies.clear();
+    connect(engine, &SpeechEngine::finalSegment, this, &LatencyBenchmark::onFinalSegment);
+
+    audioProcessor = new AudioProcessor(this);
+    audioProcessor->setLatencyProfile(profile);
+    connect(audioProcessor, &AudioProcessor::audioDataReceived, this, &LatencyBenchmark::trackToneEnds);
+    connect(audioProcessor, &AudioProcessor::audioDataReceived, engine, &SpeechEngine::processAudioData);
+
+    cpuStartMs = processCpuTimeMs();
+    wallClock.start();
+    if (!audioProcessor->startRecording()) {
+        LOG_ERROR("无法启动回环采集，跳过该档位");
+    }
+
+    QTimer::singleShot(secondsPerProfile * 1000, this, &LatencyBenchmark::finishProfile);
+}
+
+void LatencyBenchmark::finishProfile()
+{
+    audioProcessor->stopRecording();
+    const qint64 wallMs = wallClock.elapsed();
+    const qint64 cpuMs = processCpuTimeMs() - cpuStartMs;
+
+    Result result;
+    result.profile = LatencyProfile::byName(profileNames[currentIndex]);
+    const CaptureLatencyStats capture = audioProcessor->latencyStats();
+    result.captureLatencyMs = capture.averageMs;
+    result.captureLatencyMaxMs = capture.maxMs;
+    result.uiDelayMs = throttle->averageDelayMs();
+    // 测试音结束时刻取自数据包到达时间，声音实际结束还要早一个采集延迟
+    for (qint64 latency : finalLatencies) {
+        result.finalLatencyMs += latency;
+        result.finalLatencyMaxMs = qMax(result.finalLatencyMaxMs, static_cast<double>(latency));
+    }
+    result.finals = finalLatencies.size();
+    if (result.finals > 0) {
+        result.finalLatencyMs = result.finalLatencyMs / result.finals + result.captureLatencyMs;
+        result.finalLatencyMaxMs += result.captureLatencyMs;
+    }
+    result.cpuPercent = wallMs > 0 ? 100.0 * cpuMs / wallMs : 0;
+    result.captionUpdates = captionUpdates;
+    results.append(result);
+
+    cleanupRun();
+    startProfile(currentIndex + 1);
+}
+
+void LatencyBenchmark::trackToneEnds(const QByteArray &data)
+{
+    const qint64 now = wallClock.elapsed();
+    const int16_t *samples = reinterpret_cast<const int16_t *>(data.constData());
+    const int count = data.size() / static_cast<int>(sizeof(int16_t));
+    for (int start = 0; start < count; start += kToneFrameSamples) {
+        const int frame = qMin(kToneFrameSamples, count - start);
+        double energy = 0.0;
+        for (int i = 0; i < frame; ++i) {
+            energy += static_cast<double>(samples[start + i]) * samples[start + i];
+        }
+        const bool voiced = std::sqrt(energy / frame) >= kToneRmsThreshold;
+        if (toneActive && !voiced) {
+            // 这个包在 now 到达，结束点之后还有 count - start 个采样
+            pendingToneEnds.append(now - static_cast<qint64>(count - start) * 1000 / kCaptureRate);
+        }
+        toneActive = voiced;
+    }
+}
+
+void LatencyBenchmark::onFinalSegment()
+{
+    // 本地引擎在句末静音超时后定稿，每段测试音对应一个最终结果；
+    // 音调过长被强制切分时没有对应的结束时刻，不计入
+    if (pendingToneEnds.isEmpty()) {
+        return;
+    }
+    finalLatencies.append(wallClock.elapsed() - pendingToneEnds.takeFirst());
+}
+
+void LatencyBenchmark::cleanupRun()
+{
+    if (toneSink) {
+        toneSink->stop();
+    }
+    delete audioProcessor;
+    audioProcessor = nullptr;
+    delete throttle;
+    throttle = nullptr;
+    delete engine;
+    engine = nullptr;
+    delete toneSink;
+    toneSink = nullptr;
+    delete toneSource;
+    toneSource = nullptr;
+}
+
+void LatencyBenchmark::report()
+{
+    QTextStream out(stdout);
+    out << QString("%1 %2 %3 %4 %5 %6 %7 %8 %9\n")
+           .arg("档位", -10)
+           .arg("采集延迟(ms)", 14)
+           .arg("采集最大(ms)", 14)
+           .arg("刷新等待(ms)", 14)
+           .arg("定稿延迟(ms)", 14)
+           .arg("定稿最大(ms)", 14)
+           .arg("定稿次数", 8)
+           .arg("CPU(%)", 8)
+           .arg("刷新次数", 8);
+    for (const Result &r : results) {
+        QString line = QString("%1 %2 %3 %4 %5 %6 %7 %8 %9")
+                .arg(r.profile.name, -10)
+                .arg(r.captureLatencyMs, 14, 'f', 1)
+                .arg(r.captureLatencyMaxMs, 14, 'f', 1)
+                .arg(r.uiDelayMs, 14, 'f', 1)
+                .arg(r.finalLatencyMs, 14, 'f', 0)
+                .arg(r.finalLatencyMaxMs, 14, 'f', 0)
+                .arg(r.finals, 8)
+                .arg(r.cpuPercent, 8, 'f', 2)
+                .arg(r.captionUpdates, 8);
+        out << line << "\n";
+        LOG_INFO(QString("延迟档位测量结果: %1").arg(line.simplified()));
+    }
+    out.flush();
+}
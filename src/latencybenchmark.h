@@ -0,0 +1,74 @@
+#ifndef LATENCYBENCHMARK_H
+#define LATENCYBENCHMARK_H
+
+#include <QObject>
+#include <QList>
+#include <QElapsedTimer>
+#include "latencyprofile.h"
+
+class AudioProcessor;
+class SpeechEngine;
+class CaptionThrottle;
+class QAudioSink;
+class QIODevice;
+
+// 进程累计 CPU 时间（用户态 + 内核态），毫秒
+qint64 processCpuTimeMs();
+
+// 延迟档位测量：在本机上依次用每个档位运行“系统回放 -> 回环采集 -> 识别 -> 字幕刷新”，
+// 报告实际的采集延迟、界面刷新延迟、定稿延迟和进程 CPU 占用。定稿延迟从采集到的每段测试音
+// 结束算到对应的最终结果到达界面线程，再加上平均采集延迟。
+// 识别使用本地替身引擎，测量期间通过默认输出设备播放间断的测试音。
+class LatencyBenchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit LatencyBenchmark(int secondsPerProfile, QObject *parent = nullptr);
+    ~LatencyBenchmark();
+
+    void start();
+
+signals:
+    void finished();
+
+private:
+    struct Result {
+        LatencyProfile profile;
+        double captureLatencyMs = 0;
+        double captureLatencyMaxMs = 0;
+        double uiDelayMs = 0;
+        double finalLatencyMs = 0;
+        double finalLatencyMaxMs = 0;
+        int finals = 0;
+        double cpuPercent = 0;
+        int captionUpdates = 0;
+    };
+
+    void startProfile(int index);
+    void finishProfile();
+    void cleanupRun();
+    // 在采集到的音频中找测试音结束的时刻
+    void trackToneEnds(const QByteArray &data);
+    void onFinalSegment();
+    void report();
+
+    int secondsPerProfile;
+    QStringList profileNames;
+    int currentIndex;
+    QList<Result> results;
+
+    QAudioSink *toneSink;
+    QIODevice *toneSource;
+    AudioProcessor *audioProcessor;
+    SpeechEngine *engine;
+    CaptionThrottle *throttle;
+    int captionUpdates;
+    bool toneActive;
+    QList<qint64> pendingToneEnds;    // 还没等到最终结果的测试音结束时刻（wallClock 毫秒）
+    QList<qint64> finalLatencies;
+    QElapsedTimer wallClock;
+    qint64 cpuStartMs;
+};
+
+#endif // LATENCYBENCHMARK_H
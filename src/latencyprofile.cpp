@@ -0,0 +1,44 @@
+#include "latencyprofile.h"
+#include <QSettings>
+
+LatencyProfile LatencyProfile::byName(const QString &name)
+{
+    LatencyProfile profile;
+    if (name == "live") {
+        profile.name = "live";
+        profile.capturePollMs = 5;
+        profile.bufferDurationMs = 20;
+        profile.initialSilenceTimeoutMs = 5000;
+        profile.endSilenceTimeoutMs = 500;
+        profile.uiUpdateIntervalMs = 0;
+    } else if (name == "minutes") {
+        profile.name = "minutes";
+        profile.capturePollMs = 50;
+        profile.bufferDurationMs = 200;
+        profile.initialSilenceTimeoutMs = 15000;
+        profile.endSilenceTimeoutMs = 2000;
+        profile.uiUpdateIntervalMs = 500;
+    } else {
+        // 与原有的固定参数一致
+        profile.name = "balanced";
+    }
+    return profile;
+}
+
+QStringList LatencyProfile::names()
+{
+    return {"live", "balanced", "minutes"};
+}
+
+LatencyProfile LatencyProfile::fromSettings(QSettings &settings)
+{
+    settings.beginGroup("Latency");
+    LatencyProfile profile = byName(settings.value("Profile", "balanced").toString());
+    profile.capturePollMs = settings.value("CapturePollMs", profile.capturePollMs).toInt();
+    profile.bufferDurationMs = settings.value("BufferDurationMs", profile.bufferDurationMs).toInt();
+    profile.initialSilenceTimeoutMs = settings.value("InitialSilenceTimeoutMs", profile.initialSilenceTimeoutMs).toInt();
+    profile.endSilenceTimeoutMs = settings.value("EndSilenceTimeoutMs", profile.endSilenceTimeoutMs).toInt();
+    profile.uiUpdateIntervalMs = settings.value("UiUpdateIntervalMs", profile.uiUpdateIntervalMs).toInt();
+    settings.endGroup();
+    return profile;
+}
@@ -0,0 +1,26 @@
+#ifndef LATENCYPROFILE_H
+#define LATENCYPROFILE_H
+
+#include <QString>
+#include <QStringList>
+
+class QSettings;
+
+// 延迟/效率档位：把分散在采集、缓冲、SDK 和界面中的相关参数放在一起调整
+struct LatencyProfile {
+    QString name;
+    int capturePollMs = 10;             // 采集线程轮询间隔
+    int bufferDurationMs = 0;           // WASAPI 缓冲区时长，0 表示系统默认
+    int initialSilenceTimeoutMs = 5000; // SDK 起始静音超时
+    int endSilenceTimeoutMs = 1000;     // SDK 句末静音超时（决定定稿延迟）
+    int uiUpdateIntervalMs = 0;         // 实时字幕最短刷新间隔，0 表示每个结果都刷新
+
+    // "live"（实时字幕，最低延迟）、"balanced"（默认）、"minutes"（会议记录，最低 CPU 和带宽）
+    static LatencyProfile byName(const QString &name);
+    static QStringList names();
+
+    // 读取 Latency/Profile，并允许用同组下的同名键覆盖单项参数
+    static LatencyProfile fromSettings(QSettings &settings);
+};
+
+#endif // LATENCYPROFILE_H
@@ -0,0 +1,193 @@
+#include "localspeechengine.h"
+#include "logger.h"
+#include <QMetaObject>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const int kSampleRate = 16000;
+const int kFrameSamples = kSampleRate / 100;          // 10ms 一帧
+const double kVoiceRmsThreshold = 500.0;              // 约 -36 dBFS
+const qint64 kPartialIntervalSamples = kSampleRate / 2;
+const qint64 kMaxSegmentSamples = kSampleRate * 15;   // 单段最长 15 秒
+
+qint64 samplesToMs(qint64 samples)
+{
+    return samples * 1000 / kSampleRate;
+}
+
+} // namespace
+
+LocalSpeechEngine::LocalSpeechEngine(QObject *parent)
+    : SpeechEngine(parent)
+    , isRunning(false)
+    , processedSamples(0)
+    , inSpeech(false)
+    , segmentStartSample(0)
+    , lastVoiceSample(0)
+    , lastPartialSample(0)
+    , segmentIndex(0)
+{
+}
+
+LocalSpeechEngine::~LocalSpeechEngine()
+{
+}
+
+void LocalSpeechEngine::initialize(const QString &, const QString &)
+{
+    emit statusChanged("本地识别引擎初始化成功");
+}
+
+void LocalSpeechEngine::startRecognitionAndTranslation(const QString &sourceLanguage, const QString &targetLanguage)
+{
+    currentSourceLanguage = sourceLanguage;
+    currentTargetLanguage = targetLanguage;
+    pendingSamples.clear();
+    processedSamples = 0;
+    inSpeech = false;
+    segmentIndex = 0;
+    isRunning = true;
+    emit statusChanged("开始语音识别和翻译");
+}
+
+void LocalSpeechEngine::stopRecognitionAndTranslation()
+{
+    if (!isRunning) {
+        return;
+    }
+    isRunning = false;
+    emit statusChanged("停止语音识别和翻译");
+    emit sessionFinished();
+}
+
+void LocalSpeechEngine::reconfigure(const QString &sourceLanguage, const QString &targetLanguage)
+{
+    if (!isRunning) {
+        startRecognitionAndTranslation(sourceLanguage, targetLanguage);
+        return;
+    }
+    // 本地引擎没有需要重建的状态，正在进行的语音段按新语言继续
+    LOG_INFO(QString("本地引擎切换语言: %1 -> %2").arg(sourceLanguage, targetLanguage));
+    currentSourceLanguage = sourceLanguage;
+    currentTargetLanguage = targetLanguage;
+}
+
+void LocalSpeechEngine::processAudioData(const QByteArray &audioData)
+{
+    if (!isRunning) {
+        return;
+    }
+
+    const int16_t *samples = reinterpret_cast<const int16_t *>(audioData.constData());
+    size_t count = static_cast<size_t>(audioData.size()) / sizeof(int16_t);
+
+    // 先补齐上次残留的半帧
+    if (!pendingSamples.empty()) {
+        size_t need = kFrameSamples - pendingSamples.size();
+        size_t take = std::min(need, count);
+        pendingSamples.insert(pendingSamples.end(), samples, samples + take);
+        samples += take;
+        count -= take;
+        if (pendingSamples.size() < static_cast<size_t>(kFrameSamples)) {
+            return;
+        }
+        processFrame(pendingSamples.data(), kFrameSamples);
+        pendingSamples.clear();
+    }
+
+    while (count >= static_cast<size_t>(kFrameSamples)) {
+        processFrame(samples, kFrameSamples);
+        samples += kFrameSamples;
+        count -= kFrameSamples;
+    }
+    pendingSamples.assign(samples, samples + count);
+}
+
+void LocalSpeechEngine::finishAudioInput()
+{
+    if (!isRunning) {
+        return;
+    }
+    if (inSpeech) {
+        emitFinal();
+    }
+    isRunning = false;
+    // 与 SDK 一样在稍后异步通知会话结束
+    QMetaObject::invokeMethod(this, &LocalSpeechEngine::sessionFinished, Qt::QueuedConnection);
+}
+
+void LocalSpeechEngine::processFrame(const int16_t *samples, int count)
+{
+    double energy = 0.0;
+    for (int i = 0; i < count; ++i) {
+        energy += static_cast<double>(samples[i]) * samples[i];
+    }
+    const bool voiced = std::sqrt(energy / count) >= kVoiceRmsThreshold;
+
+    processedSamples += count;
+    if (voiced) {
+        if (!inSpeech) {
+            inSpeech = true;
+            ++segmentIndex;
+            segmentStartSample = processedSamples - count;
+            lastPartialSample = segmentStartSample;
+        }
+        lastVoiceSample = processedSamples;
+    }
+
+    if (!inSpeech) {
+        return;
+    }
+
+    // 与 SDK 一样，句末静音超过 EndSilenceTimeoutMs 时定稿
+    const qint64 endSilenceSamples = static_cast<qint64>(latencyProfile.endSilenceTimeoutMs) * kSampleRate / 1000;
+    if (processedSamples - lastVoiceSample >= endSilenceSamples
+        || processedSamples - segmentStartSample >= kMaxSegmentSamples) {
+        emitFinal();
+    } else if (processedSamples - lastPartialSample >= kPartialIntervalSamples) {
+        lastPartialSample = processedSamples;
+        emitPartial();
+    }
+}
+
+QString LocalSpeechEngine::segmentText(bool partial) const
+{
+    double seconds = (lastVoiceSample - segmentStartSample) / static_cast<double>(kSampleRate);
+    return QString("segment %1 (%2 s)%3")
+            .arg(segmentIndex)
+            .arg(seconds, 0, 'f', 2)
+            .arg(partial ? "..." : "");
+}
+
+QString LocalSpeechEngine::segmentTranslation(bool partial) const
+{
+    return QString("[%1] segment %2%3")
+            .arg(currentTargetLanguage)
+            .arg(segmentIndex)
+            .arg(partial ? "..." : "");
+}
+
+void LocalSpeechEngine::emitPartial()
+{
+    RecognitionEvent event;
+    event.kind = RecognitionEvent::Partial;
+    event.text = segmentText(true);
+    event.translation = segmentTranslation(true);
+    event.hasTranslation = true;
+    postResult(std::move(event));
+}
+
+void LocalSpeechEngine::emitFinal()
+{
+    inSpeech = false;
+    RecognitionEvent event;
+    event.kind = RecognitionEvent::Final;
+    event.offsetMs = samplesToMs(segmentStartSample);
+    event.durationMs = samplesToMs(lastVoiceSample - segmentStartSample);
+    event.text = segmentText(false);
+    event.translation = segmentTranslation(false);
+    event.hasTranslation = true;
+    postResult(std::move(event));
+}
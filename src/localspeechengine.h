@@ -0,0 +1,44 @@
+#ifndef LOCALSPEECHENGINE_H
+#define LOCALSPEECHENGINE_H
+
+#include "speechengine.h"
+#include <vector>
+#include <cstdint>
+
+// 本地替身引擎：不访问网络，按能量检测语音段并生成确定性的识别/翻译文本。
+// 用于批处理、压力测试等需要脱离 Azure 服务运行的场景。
+class LocalSpeechEngine : public SpeechEngine
+{
+    Q_OBJECT
+
+public:
+    explicit LocalSpeechEngine(QObject *parent = nullptr);
+    ~LocalSpeechEngine() override;
+
+    void initialize(const QString &subscriptionKey, const QString &region) override;
+    void startRecognitionAndTranslation(const QString &sourceLanguage, const QString &targetLanguage) override;
+    void stopRecognitionAndTranslation() override;
+    void processAudioData(const QByteArray &audioData) override;
+    void finishAudioInput() override;
+    void reconfigure(const QString &sourceLanguage, const QString &targetLanguage) override;
+
+private:
+    void processFrame(const int16_t *samples, int count);
+    void emitPartial();
+    void emitFinal();
+    QString segmentText(bool partial) const;
+    QString segmentTranslation(bool partial) const;
+
+    bool isRunning;
+    QString currentSourceLanguage;
+    QString currentTargetLanguage;
+    std::vector<int16_t> pendingSamples;
+    qint64 processedSamples;
+    bool inSpeech;
+    qint64 segmentStartSample;
+    qint64 lastVoiceSample;
+    qint64 lastPartialSample;
+    int segmentIndex;
+};
+
+#endif // LOCALSPEECHENGINE_H
@@ -1,18 +1,40 @@
 #include "logger.h"
+#include "flightrecorder.h"
+#include "memoryaccounting.h"
 #include <QDir>
 #include <QCoreApplication>
 #include <QFileInfo>
 #include <QThread>
 #include <QDateTime>
 #include <QDebug>
+#include <QStringEncoder>
 
+QMutex Logger::logMutex;
 QFile Logger::logFile;
 QTextStream Logger::logStream;
 bool Logger::isInitialized = false;
+std::atomic<int> Logger::instanceCount(0);
+bool Logger::verbose = true;
+QString Logger::logFileName = "meeting_assistant.log";
+
+namespace {
+
+// 飞行记录器只保留前 kFlightTextSize 字节：只编码开头一段到栈上，不为整条消息分配 UTF-8 副本
+void recordFlightText(FlightEventType type, const QString &message, int line)
+{
+    char buffer[kFlightTextSize * 3];
+    QStringEncoder encoder(QStringEncoder::Utf8);
+    const char *end = encoder.appendToBuffer(buffer, QStringView(message).left(kFlightTextSize));
+    FlightRecorder::recordText(type, buffer, static_cast<size_t>(end - buffer), line);
+}
+
+} // namespace
 
 Logger::Logger(QObject *parent)
     : QObject(parent)
 {
+    ++instanceCount;
+    QMutexLocker locker(&logMutex);
     if (!isInitialized) {
         QString logPath = getLogPath();
         QDir().mkpath(QFileInfo(logPath).path());
@@ -27,15 +49,31 @@ Logger::Logger(QObject *parent)
 
 Logger::~Logger()
 {
-    if (logFile.isOpen()) {
+    // 日志文件由所有实例共享，最后一个实例析构时才关闭
+    if (--instanceCount == 0) {
+        QMutexLocker locker(&logMutex);
+        if (!logFile.isOpen()) {
+            return;
+        }
         logStream.flush();
         logFile.close();
+        isInitialized = false;
     }
 }
 
 QString Logger::getLogPath()
 {
-    return QCoreApplication::applicationDirPath() + "/logs/meeting_assistant.log";
+    return QCoreApplication::applicationDirPath() + "/logs/" + logFileName;
+}
+
+void Logger::setLogFileName(const QString &fileName)
+{
+    logFileName = fileName;
+}
+
+void Logger::setVerbose(bool enabled)
+{
+    verbose = enabled;
 }
 
 QString Logger::formatLogMessage(const QString &message, const char* file, int line)
@@ -55,28 +93,34 @@ QString Logger::formatLogMessage(const QString &message, const char* file, int l
 
 void Logger::log(const QString &message, const char* file, int line)
 {
-    if (!isInitialized) {
+    // 所有日志都进入飞行记录器（value 为行号），崩溃时随转储写出
+    recordFlightText(FlightEventType::Log, message, line);
+
+    if (!verbose) {
         return;
     }
-    
-    QString formattedMessage = formatLogMessage(message, file, line);
-    logStream << formattedMessage << Qt::endl;
-    logStream.flush();
-    
-    // 同时输出到控制台
-    qDebug().noquote() << formattedMessage;
+    writeLine(formatLogMessage(message, file, line));
 }
 
 void Logger::logError(const QString &message, const char* file, int line)
 {
-    if (!isInitialized) {
-        return;
+    recordFlightText(FlightEventType::Error, message, line);
+
+    writeLine(formatLogMessage("ERROR: " + message, file, line));
+}
+
+void Logger::writeLine(const QString &formattedMessage)
+{
+    {
+        QMutexLocker locker(&logMutex);
+        if (!isInitialized) {
+            return;
+        }
+        MemoryAccounting::transient(MemoryTag::Logging, formattedMessage.size() * sizeof(QChar));
+        logStream << formattedMessage << Qt::endl;
+        logStream.flush();
     }
-    
-    QString formattedMessage = formatLogMessage("ERROR: " + message, file, line);
-    logStream << formattedMessage << Qt::endl;
-    logStream.flush();
-    
+
     // 同时输出到控制台
     qDebug().noquote() << formattedMessage;
 } 
\ No newline at end of file
@@ -7,6 +7,8 @@
 #include <QDateTime>
 #include <QThread>
 #include <QDebug>
+#include <QMutex>
+#include <atomic>
 
 class Logger : public QObject
 {
@@ -18,12 +20,23 @@ public:
     static void log(const QString &message, const char* file = nullptr, int line = 0);
     static void logError(const QString &message, const char* file = nullptr, int line = 0);
     static QString getLogPath();
+    // 在创建第一个 Logger 之前调用；同一目录下的其他进程（如语音服务进程）使用各自的文件
+    static void setLogFileName(const QString &fileName);
+
+    // 关闭后普通日志只进入飞行记录器，日志文件只写错误
+    static void setVerbose(bool enabled);
 
 private:
     static QString formatLogMessage(const QString &message, const char* file = nullptr, int line = 0);
+    // 写入文件时加锁：日志来自界面线程、采集线程和接入服务的各个工作线程
+    static void writeLine(const QString &formattedMessage);
+    static QMutex logMutex;
     static QFile logFile;
     static QTextStream logStream;
     static bool isInitialized;
+    static std::atomic<int> instanceCount;
+    static bool verbose;
+    static QString logFileName;
 };
 
 // 定义日志宏
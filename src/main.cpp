@@ -2,10 +2,37 @@
 #include <QCommandLineParser>
 #include <QDir>
 #include <QDateTime>
+#include <QSettings>
+#include <QScopedPointer>
+#ifdef Q_OS_WIN
 #include <windows.h>
 #include <dbghelp.h>
+#else
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 #include "mainwindow.h"
+#include "batchtranscriber.h"
+#include "splittranscriber.h"
+#include "latencybenchmark.h"
+#include "overlaybenchmark.h"
+#include "ingestserver.h"
+#include "ingestloadtest.h"
+#include "soaktest.h"
+#include "capturetest.h"
+#include "sessionreplay.h"
+#include "speechhost.h"
+#include "regionprobe.h"
+#include "metricsexporter.h"
 #include "logger.h"
+#include "flightrecorder.h"
+#include "startuptimer.h"
+#include <QTimer>
 
 // 设置崩溃转储文件的保存路径
 QString getDumpFilePath() {
@@ -14,6 +41,7 @@ QString getDumpFilePath() {
     return dumpDir + "/crash_" + QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss") + ".dmp";
 }
 
+#ifdef Q_OS_WIN
 // 崩溃处理函数
 LONG WINAPI TopLevelExceptionHandler(EXCEPTION_POINTERS* pExceptionInfo) {
     static bool isHandling = false;
@@ -23,7 +51,14 @@ LONG WINAPI TopLevelExceptionHandler(EXCEPTION_POINTERS* pExceptionInfo) {
     isHandling = true;
 
     try {
+        FlightRecorder::record(FlightEventType::Error, "unhandled exception",
+                               static_cast<int64_t>(pExceptionInfo->ExceptionRecord->ExceptionCode));
         QString dumpPath = getDumpFilePath();
+
+        // 先写出飞行记录（最近的日志和流水线事件），它只占用少量栈内存
+        QString flightPath = dumpPath.left(dumpPath.lastIndexOf('.')) + ".flight";
+        bool flightWritten = FlightRecorder::dumpToFile(flightPath.toUtf8().constData());
+
         HANDLE hFile = CreateFileW(
             dumpPath.toStdWString().c_str(),
             GENERIC_WRITE,
@@ -58,6 +93,9 @@ LONG WINAPI TopLevelExceptionHandler(EXCEPTION_POINTERS* pExceptionInfo) {
             logger.logError(QString("程序崩溃，转储文件已保存到: %1").arg(dumpPath));
             logger.logError(QString("异常代码: 0x%1").arg(pExceptionInfo->ExceptionRecord->ExceptionCode, 8, 16, QChar('0')));
             logger.logError(QString("异常地址: 0x%1").arg((quintptr)pExceptionInfo->ExceptionRecord->ExceptionAddress, 8, 16, QChar('0')));
+            if (flightWritten) {
+                logger.logError(QString("飞行记录已保存到: %1").arg(flightPath));
+            }
         }
     }
     catch (...) {
@@ -69,24 +107,435 @@ LONG WINAPI TopLevelExceptionHandler(EXCEPTION_POINTERS* pExceptionInfo) {
     return EXCEPTION_CONTINUE_SEARCH;
 }
 
+void installCrashHandler() {
+    SetUnhandledExceptionFilter(TopLevelExceptionHandler);
+}
+#else
+// POSIX 崩溃处理：信号处理函数中只能用异步信号安全的调用，路径前缀在安装时准备好。
+// 写出飞行记录（crash_<时间戳>.flight）和调用栈（crash_<时间戳>.trace），再按默认方式结束进程以便生成 core
+char g_crashPathPrefix[1024];
+
+void appendUnsigned(char *out, size_t capacity, unsigned long long value) {
+    char digits[24];
+    int n = 0;
+    do {
+        digits[n++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value > 0 && n < static_cast<int>(sizeof(digits)));
+    size_t length = std::strlen(out);
+    while (n > 0 && length + 1 < capacity) {
+        out[length++] = digits[--n];
+    }
+    out[length] = '\0';
+}
+
+void writeString(int fd, const char *text) {
+    const ssize_t ignored = write(fd, text, std::strlen(text));
+    (void)ignored;
+}
+
+void posixCrashHandler(int signalNumber, siginfo_t *info, void *) {
+    static volatile sig_atomic_t isHandling = 0;
+    if (isHandling) {
+        _exit(128 + signalNumber);
+    }
+    isHandling = 1;
+
+    FlightRecorder::record(FlightEventType::Error, "fatal signal", signalNumber);
+
+    char path[1100];
+    std::strcpy(path, g_crashPathPrefix);
+    appendUnsigned(path, sizeof(path), static_cast<unsigned long long>(time(nullptr)));
+    const size_t baseLength = std::strlen(path);
+
+    std::strcat(path, ".flight");
+    FlightRecorder::dumpToFile(path);
+
+    path[baseLength] = '\0';
+    std::strcat(path, ".trace");
+    const int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    char line[128] = "signal ";
+    appendUnsigned(line, sizeof(line), static_cast<unsigned long long>(signalNumber));
+    std::strcat(line, " address 0x");
+    {
+        char hex[20];
+        unsigned long long address = reinterpret_cast<unsigned long long>(info ? info->si_addr : nullptr);
+        int n = 0;
+        do {
+            hex[n++] = "0123456789abcdef"[address & 0xF];
+            address >>= 4;
+        } while (address > 0 && n < 16);
+        size_t length = std::strlen(line);
+        while (n > 0) {
+            line[length++] = hex[--n];
+        }
+        line[length++] = '\n';
+        line[length] = '\0';
+    }
+
+    void *frames[64];
+    const int frameCount = backtrace(frames, 64);
+    if (fd >= 0) {
+        writeString(fd, line);
+        backtrace_symbols_fd(frames, frameCount, fd);
+        close(fd);
+    }
+    writeString(STDERR_FILENO, "程序崩溃，调用栈和飞行记录已保存到 ");
+    writeString(STDERR_FILENO, path);
+    writeString(STDERR_FILENO, "\n");
+
+    signal(signalNumber, SIG_DFL);
+    raise(signalNumber);
+}
+
+void installCrashHandler() {
+    QString dumpDir = QCoreApplication::applicationDirPath() + "/dumps";
+    QDir().mkpath(dumpDir);
+    const QByteArray prefix = (dumpDir + "/crash_").toUtf8();
+    std::snprintf(g_crashPathPrefix, sizeof(g_crashPathPrefix), "%s", prefix.constData());
+
+    // backtrace 第一次调用会加载 libgcc，提前调用一次，避免在信号处理中分配内存
+    void *warmup[1];
+    backtrace(warmup, 1);
+
+    // 栈溢出时在备用栈上运行处理函数
+    static char alternateStack[64 * 1024];
+    stack_t stack;
+    stack.ss_sp = alternateStack;
+    stack.ss_size = sizeof(alternateStack);
+    stack.ss_flags = 0;
+    sigaltstack(&stack, nullptr);
+
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_sigaction = posixCrashHandler;
+    action.sa_flags = SA_SIGINFO | SA_ONSTACK;
+    sigemptyset(&action.sa_mask);
+    for (int signalNumber : {SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT}) {
+        sigaction(signalNumber, &action, nullptr);
+    }
+}
+#endif
+
+// 命令行选项
+struct CommandLineOptions {
+    QCommandLineOption batch{"batch", "批量转写录音文件（无界面），参数为文件或目录"};
+    QCommandLineOption jobs{"jobs", "批量转写的并发数（分段转写时为同时进行的识别会话数）", "n", "2"};
+    QCommandLineOption split{"split", "与 --batch 一起使用：把每个长录音按静音切成几分钟的段，多个识别会话并行转写后拼接"};
+    QCommandLineOption output{"output", "转写结果输出目录（默认与音频文件相同）；采集自检时为要写出的 WAV 文件", "path"};
+    QCommandLineOption engine{"engine", "识别引擎：azure 或 local（本地替身）", "name", "azure"};
+    QCommandLineOption source{"source", "源语言", "lang", "en-US"};
+    QCommandLineOption target{"target", "目标语言", "lang", "zh-CN"};
+    QCommandLineOption measureLatency{"measure-latency", "依次运行各延迟档位，报告本机实际的延迟和 CPU 占用"};
+    QCommandLineOption duration{"duration", "每个延迟档位或字幕浮层基准每个阶段的测量时长，或采集自检的时长（秒）", "seconds", "20"};
+    QCommandLineOption serve{"serve", "接入服务模式（无界面），通过本机 TCP 接收多个会议室的音频流"};
+    QCommandLineOption port{"port", "接入服务端口（压力测试时为 0 则在本进程内启动服务）", "port", "5710"};
+    QCommandLineOption loadTest{"load-test", "对接入服务逐级加压，报告可承载的会议室数"};
+    QCommandLineOption maxRooms{"max-rooms", "压力测试的最大会议室数", "n", "64"};
+    QCommandLineOption step{"step", "压力测试每级的时长（秒）", "seconds", "10"};
+    QCommandLineOption soak{"soak", "浸泡测试：加速回放音频（可指定一个文件），检查内存、句柄、线程和延迟是否持续上升"};
+    QCommandLineOption hours{"hours", "浸泡测试回放的音频时长（小时）", "hours", "6"};
+    QCommandLineOption speed{"speed", "浸泡测试（默认 120）、会话回放（默认 1）或分段转写每个会话（默认不限）相对实时的速度", "factor", "120"};
+    QCommandLineOption captureTest{"capture-test", "采集自检：只运行系统声音采集，检查数据速率和电平（可用 --output 写出 WAV）"};
+    QCommandLineOption replay{"replay", "回放会话轨迹（[Trace] Record 记录的 .matrace 文件），不访问网络", "file"};
+    QCommandLineOption speechHost{"speech-host", "作为语音服务进程运行（由界面进程启动，参数为本机通道名）", "name"};
+    QCommandLineOption probeRegions{"probe-regions", "检查密钥并测量 [Probe] 中各候选区域的延迟，报告推荐的区域"};
+    QCommandLineOption overlayBenchmark{"overlay-benchmark", "用合成字幕比较字幕浮层和实时区文本框的绘制耗时和 CPU 占用"};
+
+    void addTo(QCommandLineParser &parser) const {
+        parser.addOptions({batch, jobs, split, output, engine, source, target, measureLatency, duration,
+                           serve, port, loadTest, maxRooms, step, soak, hours, speed, captureTest, replay, speechHost,
+                           probeRegions, overlayBenchmark});
+        parser.addPositionalArgument("files", "要转写的音频文件或目录（批处理模式）", "[files...]");
+    }
+};
+
+// 无界面模式只需要 QCoreApplication
+bool isHeadlessMode(int argc, char *argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        if (qstrcmp(argv[i], "--batch") == 0 || qstrcmp(argv[i], "--serve") == 0
+            || qstrcmp(argv[i], "--load-test") == 0
+            || qstrcmp(argv[i], "--speech-host") == 0 || qstrcmp(argv[i], "--probe-regions") == 0) {
+            return true;
+        }
+#ifndef Q_OS_WIN
+        // Windows 的回环采集依赖 QApplication 初始化的 COM，其他平台不需要
+        if (qstrcmp(argv[i], "--capture-test") == 0) {
+            return true;
+        }
+#endif
+    }
+    return false;
+}
+
+// 批量转写模式
+int runBatchMode(QCoreApplication &app, const QCommandLineParser &parser, const CommandLineOptions &cli) {
+    QSettings settings(QCoreApplication::applicationDirPath() + "/config.ini", QSettings::IniFormat);
+
+    BatchOptions options;
+    options.inputs = parser.positionalArguments();
+    options.outputDir = parser.value(cli.output);
+    options.engineName = parser.value(cli.engine);
+    options.subscriptionKey = settings.value("Azure/Key").toString();
+    options.region = settings.value("Azure/Region").toString();
+    options.sourceLanguage = parser.value(cli.source);
+    options.targetLanguage = parser.value(cli.target);
+    options.maxParallel = parser.value(cli.jobs).toInt();
+
+    if (options.engineName != "local" && (options.subscriptionKey.isEmpty() || options.region.isEmpty())) {
+        LOG_ERROR("config.ini 中缺少 Azure 区域或密钥");
+        return 2;
+    }
+
+    if (parser.isSet(cli.split)) {
+        const double feedSpeed = parser.isSet(cli.speed) ? parser.value(cli.speed).toDouble() : 0.0;
+        SplitTranscriber transcriber(options, SplitTranscriber::splitOptionsFromSettings(settings), feedSpeed);
+        QObject::connect(&transcriber, &SplitTranscriber::finished, &app, [&app](int failedCount) {
+            app.exit(failedCount > 0 ? 1 : 0);
+        });
+        if (!transcriber.start()) {
+            return 2;
+        }
+        return app.exec();
+    }
+
+    BatchTranscriber transcriber(options);
+    QObject::connect(&transcriber, &BatchTranscriber::finished, &app, [&app](int failedCount) {
+        app.exit(failedCount > 0 ? 1 : 0);
+    });
+    if (!transcriber.start()) {
+        return 2;
+    }
+    return app.exec();
+}
+
+// 延迟档位测量（需要 QApplication 初始化的 COM 环境进行回环采集）
+int runLatencyMeasurement(QCoreApplication &app, const QCommandLineParser &parser, const CommandLineOptions &cli) {
+    LatencyBenchmark benchmark(parser.value(cli.duration).toInt());
+    QObject::connect(&benchmark, &LatencyBenchmark::finished, &app, &QCoreApplication::quit);
+    benchmark.start();
+    return app.exec();
+}
+
+// 字幕浮层基准（需要界面）
+int runOverlayBenchmark(QCoreApplication &app, const QCommandLineParser &parser, const CommandLineOptions &cli) {
+    OverlayBenchmark benchmark(parser.value(cli.duration).toInt());
+    QObject::connect(&benchmark, &OverlayBenchmark::finished, &app, &QCoreApplication::quit);
+    benchmark.start();
+    return app.exec();
+}
+
+// 接入服务模式，一直运行到进程被结束
+int runIngestService(QCoreApplication &app, const QCommandLineParser &parser, const CommandLineOptions &cli) {
+    QSettings settings(QCoreApplication::applicationDirPath() + "/config.ini", QSettings::IniFormat);
+
+    IngestOptions options;
+    options.port = static_cast<quint16>(parser.value(cli.port).toUInt());
+    // 未显式指定引擎时使用本地替身
+    options.engineName = parser.isSet(cli.engine) ? parser.value(cli.engine) : QString("local");
+    options.subscriptionKey = settings.value("Azure/Key").toString();
+    options.region = settings.value("Azure/Region").toString();
+    options.sourceLanguage = parser.value(cli.source);
+    options.targetLanguage = parser.value(cli.target);
+    options.latencyProfile = LatencyProfile::fromSettings(settings);
+    options.workerThreads = settings.value("Ingest/WorkerThreads", 0).toInt();
+
+    if (options.engineName != "local" && (options.subscriptionKey.isEmpty() || options.region.isEmpty())) {
+        LOG_ERROR("config.ini 中缺少 Azure 区域或密钥");
+        return 2;
+    }
+
+    IngestServer server(options);
+    if (!server.start()) {
+        return 2;
+    }
+    MetricsExporter metricsExporter;
+    metricsExporter.configure(settings);
+    metricsExporter.start();
+    return app.exec();
+}
+
+// 接入服务压力测试
+int runIngestLoadTest(QCoreApplication &app, const QCommandLineParser &parser, const CommandLineOptions &cli) {
+    LoadTestOptions options;
+    options.port = parser.isSet(cli.port) ? static_cast<quint16>(parser.value(cli.port).toUInt()) : 0;
+    options.maxRooms = qMax(1, parser.value(cli.maxRooms).toInt());
+    options.stepSeconds = qMax(5, parser.value(cli.step).toInt());
+
+    IngestLoadTest loadTest(options);
+    QObject::connect(&loadTest, &IngestLoadTest::finished, &app, [&app](int) { app.quit(); });
+    if (!loadTest.start()) {
+        return 2;
+    }
+    return app.exec();
+}
+
+// 浸泡测试（字幕控件需要 QApplication，窗口不显示）
+int runSoakTest(QCoreApplication &app, const QCommandLineParser &parser, const CommandLineOptions &cli) {
+    SoakOptions options;
+    options.inputFile = parser.positionalArguments().value(0);
+    options.audioHours = parser.value(cli.hours).toDouble();
+    options.speed = parser.value(cli.speed).toDouble();
+
+    SoakTest soakTest(options);
+    QObject::connect(&soakTest, &SoakTest::finished, &app, [&app](bool passed) {
+        app.exit(passed ? 0 : 1);
+    });
+    if (!soakTest.start()) {
+        return 2;
+    }
+    return app.exec();
+}
+
+// 采集自检
+int runCaptureTest(QCoreApplication &app, const QCommandLineParser &parser, const CommandLineOptions &cli) {
+    QSettings settings(QCoreApplication::applicationDirPath() + "/config.ini", QSettings::IniFormat);
+
+    CaptureTestOptions options;
+    options.durationSeconds = qMax(1, parser.value(cli.duration).toInt());
+    options.outputWav = parser.value(cli.output);
+    options.deviceName = settings.value("Capture/Device").toString();
+
+    CaptureTest captureTest(options);
+    QObject::connect(&captureTest, &CaptureTest::finished, &app, [&app](bool passed) {
+        app.exit(passed ? 0 : 1);
+    });
+    if (!captureTest.start()) {
+        return 2;
+    }
+    return app.exec();
+}
+
+// 语音服务进程：界面进程退出或断开时随之退出
+int runSpeechHost(QCoreApplication &app, const QCommandLineParser &parser, const CommandLineOptions &cli) {
+    SpeechHost host(parser.value(cli.speechHost));
+    if (!host.start()) {
+        return 2;
+    }
+    return app.exec();
+}
+
+// 区域探测：推荐区域写入探测缓存，下次开始时直接使用
+int runRegionProbe(QCoreApplication &app) {
+    QSettings settings(QCoreApplication::applicationDirPath() + "/config.ini", QSettings::IniFormat);
+    const QString key = settings.value("Azure/Key").toString();
+    if (key.isEmpty()) {
+        LOG_ERROR("config.ini 中缺少 Azure 密钥");
+        return 2;
+    }
+
+    RegionProbe probe;
+    probe.configure(settings);
+    QObject::connect(&probe, &RegionProbe::finished, &app, [&](const QString &region) {
+        if (region.isEmpty()) {
+            LOG_ERROR("密钥在探测的区域中均无效");
+            app.exit(1);
+            return;
+        }
+        RegionProbe::saveCached(settings, key, region, probe.latencyMs(region));
+        LOG_INFO(QString("推荐区域: %1（%2 ms）").arg(region).arg(probe.latencyMs(region)));
+        app.exit(0);
+    });
+    probe.start(key);
+    return app.exec();
+}
+
 int main(int argc, char *argv[])
 {
+#ifdef Q_OS_WIN
     // 设置异常处理
-    SetUnhandledExceptionFilter(TopLevelExceptionHandler);
+    installCrashHandler();
+#endif
+    StartupTimer::mark(StartupPhase::ProcessStart);
 
-    QApplication app(argc, argv);
-    app.setQuitOnLastWindowClosed(true);
+    const bool headless = isHeadlessMode(argc, argv);
+    QScopedPointer<QCoreApplication> app(headless ? new QCoreApplication(argc, argv)
+                                                  : new QApplication(argc, argv));
     
     // 设置应用程序信息
     QCoreApplication::setOrganizationName("MeetingAssistant");
     QCoreApplication::setApplicationName("MeetingAssistant");
+#ifndef Q_OS_WIN
+    // 转储目录取决于程序路径，需要在创建 QCoreApplication 之后安装
+    installCrashHandler();
+#endif
     
     // 创建日志目录
     QString logDir = QCoreApplication::applicationDirPath() + "/logs";
     QDir().mkpath(logDir);
-    
+    for (int i = 1; i < argc; ++i) {
+        if (qstrcmp(argv[i], "--speech-host") == 0) {
+            Logger::setLogFileName("speech_host.log");
+        }
+    }
+    Logger logger;
+    QSettings logSettings(QCoreApplication::applicationDirPath() + "/config.ini", QSettings::IniFormat);
+    Logger::setVerbose(logSettings.value("Log/Verbose", true).toBool());
+
+    // 命令行参数
+    QCommandLineParser parser;
+    parser.setApplicationDescription("MeetingAssistant 实时语音识别与翻译");
+    parser.addHelpOption();
+    CommandLineOptions cli;
+    cli.addTo(parser);
+    parser.process(*app);
+
+    if (parser.isSet(cli.speechHost)) {
+        return runSpeechHost(*app, parser, cli);
+    }
+    if (parser.isSet(cli.batch)) {
+        return runBatchMode(*app, parser, cli);
+    }
+    if (parser.isSet(cli.serve)) {
+        return runIngestService(*app, parser, cli);
+    }
+    if (parser.isSet(cli.loadTest)) {
+        return runIngestLoadTest(*app, parser, cli);
+    }
+    if (parser.isSet(cli.soak)) {
+        return runSoakTest(*app, parser, cli);
+    }
+    if (parser.isSet(cli.captureTest)) {
+        return runCaptureTest(*app, parser, cli);
+    }
+    if (parser.isSet(cli.measureLatency)) {
+        return runLatencyMeasurement(*app, parser, cli);
+    }
+    if (parser.isSet(cli.overlayBenchmark)) {
+        return runOverlayBenchmark(*app, parser, cli);
+    }
+    if (parser.isSet(cli.probeRegions)) {
+        return runRegionProbe(*app);
+    }
+
+    StartupTimer::mark(StartupPhase::ApplicationInit);
+    StartupTimer::setBudgetMs(logSettings.value("Startup/BudgetMs", 1500).toInt());
+
+    MetricsExporter metricsExporter;
+    metricsExporter.configure(logSettings);
+    metricsExporter.start();
+
+    // 回放对象要比窗口活得久：窗口析构时先停止回放用的采集
+    SessionReplay sessionReplay;
+    if (parser.isSet(cli.replay)) {
+        if (!sessionReplay.open(parser.value(cli.replay))) {
+            LOG_ERROR(QString("无法回放 %1: %2").arg(parser.value(cli.replay), sessionReplay.errorString()));
+            return 2;
+        }
+        sessionReplay.setSpeed(parser.isSet(cli.speed) ? parser.value(cli.speed).toDouble() : 1.0);
+    }
+
+    QApplication::setQuitOnLastWindowClosed(true);
     MainWindow window;
+    if (parser.isSet(cli.replay)) {
+        window.setSessionReplay(&sessionReplay);
+    }
     window.show();
+    // show() 只是排队，等事件循环处理完首批事件（含首次绘制）后再计时
+    QTimer::singleShot(0, &window, []() {
+        StartupTimer::mark(StartupPhase::WindowShown);
+        StartupTimer::report();
+    });
     
-    return app.exec();
+    return app->exec();
 } 
\ No newline at end of file
@@ -1,5 +1,15 @@
 #include "mainwindow.h"
 #include "./ui_mainwindow.h"
+#include "audioprocessor.h"
+#include "azurespeechapi.h"
+#include "hostedspeechengine.h"
+#include "startuptimer.h"
+#include "glossaryprocessor.h"
+#include "sessionreplay.h"
+#include "memoryaccounting.h"
+#include "memorypanel.h"
+#include "regionprobe.h"
+#include "subtitleoverlay.h"
 #include <QMessageBox>
 #include <QStandardPaths>
 #include <QDir>
@@ -7,13 +17,36 @@
 #include <QCoreApplication>
 #include <QScrollBar>
 #include <QTimer>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QThread>
+#include <QDateTime>
+#include <QShortcut>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
-    , audioProcessor(new AudioProcessor(this))
-    , azureSpeechAPI(new AzureSpeechAPI(this))
+    , audioProcessor(nullptr)
+    , speechEngine(nullptr)
+    , textTranslator(new TextTranslator(this))
+    , recognitionThrottle(new CaptionThrottle(this))
+    , translationThrottle(new CaptionThrottle(this))
+    , glossaryProcessor(nullptr)
+    , glossaryThread(nullptr)
     , logger(new Logger(this))
+    , sourceLanguage("en-US")
+    , targetLanguage("zh-CN")
+    , hostSpeechEngine(true)
+    , speechHostHangTimeoutMs(10000)
+    , regionProbe(nullptr)
+    , autoSelectRegion(true)
+    , probeCacheTtlHours(24)
+    , startAfterProbe(false)
+    , sessionReplay(nullptr)
+    , memoryPanel(nullptr)
+    , subtitleOverlay(new SubtitleOverlay)
+    , overlayShowsRecognition(false)
+    , historyBytes(0)
 {
     ui->setupUi(this);
     
@@ -27,18 +60,30 @@ MainWindow::MainWindow(QWidget *parent)
     historyChineseText = ui->historyChineseText;
     
     // 连接信号和槽
-    connect(audioProcessor, &AudioProcessor::audioDataReceived,
-            this, &MainWindow::onAudioDataReceived);
-    connect(azureSpeechAPI, &AzureSpeechAPI::recognitionResult,
-            this, &MainWindow::onRecognitionResult);
-    connect(azureSpeechAPI, &AzureSpeechAPI::translationResult,
-            this, &MainWindow::onTranslationResult);
-    connect(azureSpeechAPI, &AzureSpeechAPI::finalTranslationResult,
-            this, &MainWindow::onFinalTranslationResult);
-    connect(azureSpeechAPI, &AzureSpeechAPI::error,
-            this, &MainWindow::onError);
-    connect(azureSpeechAPI, &AzureSpeechAPI::statusChanged,
-            this, &MainWindow::onStatusChanged);
+    connect(textTranslator, &TextTranslator::translated,
+            this, &MainWindow::onExtraTranslation);
+    // 实时字幕经过节流后再刷新到界面；启用术语表时节流的是已高亮的 HTML
+    QSettings settings(configFilePath, QSettings::IniFormat);
+    if (settings.value("CaptionFeed/Enabled", true).toBool()) {
+        const QByteArray name = settings.value("CaptionFeed/Name", kCaptionRingDefaultName).toString().toUtf8();
+        const uint32_t slotCount = settings.value("CaptionFeed/Slots", kCaptionRingDefaultSlots).toUInt();
+        if (captionRing.create(name.constData(), slotCount)) {
+            LOG_INFO(QString("字幕共享内存已创建: %1").arg(QString::fromUtf8(name)));
+        } else {
+            LOG_ERROR(QString("无法创建字幕共享内存 %1（可能已有其他实例在发布）").arg(QString::fromUtf8(name)));
+        }
+    }
+    if (setupGlossary(settings)) {
+        connect(recognitionThrottle, &CaptionThrottle::textReady,
+                ui->recognitionText, &QTextEdit::setHtml);
+        connect(translationThrottle, &CaptionThrottle::textReady,
+                ui->translationText, &QTextEdit::setHtml);
+    } else {
+        connect(recognitionThrottle, &CaptionThrottle::textReady,
+                ui->recognitionText, &QTextEdit::setPlainText);
+        connect(translationThrottle, &CaptionThrottle::textReady,
+                ui->translationText, &QTextEdit::setPlainText);
+    }
     connect(ui->startButton, &QPushButton::clicked,
             this, &MainWindow::onStartButtonClicked);
     connect(ui->stopButton, &QPushButton::clicked,
@@ -46,6 +91,19 @@ MainWindow::MainWindow(QWidget *parent)
     connect(ui->testButton, &QPushButton::clicked, this, &MainWindow::onTestButtonClicked);
     connect(ui->saveConfigButton, &QPushButton::clicked, this, &MainWindow::onSaveConfigClicked);
     connect(ui->clearButton, &QPushButton::clicked, this, &MainWindow::onClearButtonClicked);
+    connect(new QShortcut(QKeySequence("Ctrl+Shift+M"), this), &QShortcut::activated,
+            this, &MainWindow::showMemoryPanel);
+    // 字幕浮层：共享屏幕时浮在其他窗口上方，不接收鼠标和焦点
+    subtitleOverlay->configure(settings);
+    overlayShowsRecognition = settings.value("Overlay/Text", "translation").toString() == "recognition";
+    connect(new QShortcut(QKeySequence("Ctrl+Shift+O"), this), &QShortcut::activated,
+            this, &MainWindow::toggleSubtitleOverlay);
+    if (settings.value("Overlay/Enabled", false).toBool()) {
+        subtitleOverlay->show();
+    }
+    // 识别进行中切换语言不停止采集
+    connect(ui->sourceLanguageCombo, &QComboBox::activated, this, &MainWindow::onLanguageChanged);
+    connect(ui->targetLanguageCombo, &QComboBox::activated, this, &MainWindow::onLanguageChanged);
     ui->stopButton->setEnabled(false);
     recognitionHistory = "";
     translationHistory = "";
@@ -56,27 +114,228 @@ MainWindow::MainWindow(QWidget *parent)
 
 MainWindow::~MainWindow()
 {
+    if (glossaryThread) {
+        glossaryThread->quit();
+        glossaryThread->wait();
+        delete glossaryProcessor;
+    }
+    MemoryAccounting::adjust(MemoryTag::UiHistory, -historyBytes);
+    delete subtitleOverlay;
     delete ui;
     delete audioProcessor;
-    delete azureSpeechAPI;
+    delete speechEngine;
     delete logger;
 }
 
+void MainWindow::ensureSpeechStack()
+{
+    if (speechEngine) {
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    if (sessionReplay) {
+        audioProcessor = new AudioProcessor(sessionReplay->createCapture(), this);
+        speechEngine = sessionReplay->createEngine(this);
+    } else {
+        audioProcessor = new AudioProcessor(this);
+        audioProcessor->setDeviceName(captureDevice);
+        if (hostSpeechEngine) {
+            HostedSpeechEngine *hosted = new HostedSpeechEngine("azure", this);
+            hosted->setHangTimeoutMs(speechHostHangTimeoutMs);
+            speechEngine = hosted;
+        } else {
+            speechEngine = new AzureSpeechAPI(this);
+        }
+    }
+
+    if (captionRing.isOpen()) {
+        speechEngine->setCaptionRing(&captionRing);
+    }
+    if (!traceDirectory.isEmpty() && !sessionReplay) {
+        audioProcessor->setSessionTrace(&sessionTrace);
+        speechEngine->setSessionTrace(&sessionTrace);
+    }
+
+    connect(audioProcessor, &AudioProcessor::audioDataReceived,
+            this, &MainWindow::onAudioDataReceived);
+    if (glossaryProcessor) {
+        // 结果先经过术语处理线程
+        connect(speechEngine, &SpeechEngine::recognitionResult,
+                glossaryProcessor, &GlossaryProcessor::processRecognition);
+        connect(speechEngine, &SpeechEngine::translationResult,
+                glossaryProcessor, &GlossaryProcessor::processTranslation);
+        connect(speechEngine, &SpeechEngine::finalTranslationResult,
+                glossaryProcessor, &GlossaryProcessor::processFinalTranslation);
+    } else {
+        connect(speechEngine, &SpeechEngine::recognitionResult,
+                this, &MainWindow::onRecognitionResult);
+        connect(speechEngine, &SpeechEngine::translationResult,
+                this, &MainWindow::onTranslationResult);
+        connect(speechEngine, &SpeechEngine::finalTranslationResult,
+                this, &MainWindow::onFinalTranslationResult);
+    }
+    connect(speechEngine, &SpeechEngine::finalSegment,
+            this, &MainWindow::onFinalSegment);
+    // 浮层显示纯文本，不经过节流：它自己把重绘合并到显示器刷新间隔。
+    // 启用术语表时取术语处理后的纯文本，和两个文本区的替换结果一致；
+    // 部分结果和定稿走同一个线程，到达浮层的顺序不变
+    const auto commitOverlayLine = [this](qint64, qint64, const QString &text, const QString &translation) {
+        subtitleOverlay->commitLine(overlayShowsRecognition || translation.isEmpty() ? text : translation);
+    };
+    if (glossaryProcessor) {
+        connect(glossaryProcessor,
+                overlayShowsRecognition ? &GlossaryProcessor::recognitionTextReady : &GlossaryProcessor::translationTextReady,
+                subtitleOverlay, &SubtitleOverlay::setLiveText);
+        connect(speechEngine, &SpeechEngine::finalSegment,
+                glossaryProcessor, &GlossaryProcessor::processFinalSegment);
+        connect(glossaryProcessor, &GlossaryProcessor::finalSegmentReady, subtitleOverlay, commitOverlayLine);
+    } else {
+        connect(speechEngine,
+                overlayShowsRecognition ? &SpeechEngine::recognitionResult : &SpeechEngine::translationResult,
+                subtitleOverlay, &SubtitleOverlay::setLiveText);
+        connect(speechEngine, &SpeechEngine::finalSegment, subtitleOverlay, commitOverlayLine);
+    }
+    connect(speechEngine, &SpeechEngine::error,
+            this, &MainWindow::onError);
+    connect(speechEngine, &SpeechEngine::statusChanged,
+            this, &MainWindow::onStatusChanged);
+
+    LOG_INFO(QString("采集和语音引擎已创建，耗时 %1 ms").arg(timer.elapsed()));
+}
+
+void MainWindow::setSessionReplay(SessionReplay *replay)
+{
+    sessionReplay = replay;
+    // 回放不访问网络：不做额外翻译，不测试连接
+    extraLanguages.clear();
+    ui->startButton->setEnabled(true);
+    ui->testButton->setEnabled(false);
+    ui->saveConfigButton->setEnabled(false);
+    if (!replay->sourceLanguage().isEmpty()) {
+        ui->sourceLanguageCombo->setCurrentText(replay->sourceLanguage());
+        ui->targetLanguageCombo->setCurrentText(replay->targetLanguage());
+    }
+    setWindowTitle(windowTitle() + QString(" - 回放 %1").arg(QFileInfo(replay->path()).fileName()));
+
+    connect(replay, &SessionReplay::finished, this, [this](const QString &report) {
+        if (ui->stopButton->isEnabled()) {
+            onStopButtonClicked();
+        }
+        ui->statusBar->showMessage(report);
+    });
+    QTimer::singleShot(0, this, &MainWindow::onStartButtonClicked);
+}
+
+void MainWindow::beginSessionTrace()
+{
+    if (traceDirectory.isEmpty() || sessionReplay) {
+        return;
+    }
+    QDir().mkpath(traceDirectory);
+    const QString path = QDir(traceDirectory).filePath(
+            QString("session_%1.matrace").arg(QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss")));
+    if (!sessionTrace.open(path.toUtf8().constData())) {
+        LOG_ERROR(QString("无法创建会话轨迹 %1").arg(path));
+        return;
+    }
+    const QByteArray from = sourceLanguage.toUtf8();
+    const QByteArray to = targetLanguage.toUtf8();
+    sessionTrace.writeStrings(SessionTraceType::Start, from.constData(), static_cast<size_t>(from.size()),
+                              to.constData(), static_cast<size_t>(to.size()));
+    LOG_INFO(QString("记录会话轨迹: %1").arg(path));
+}
+
+void MainWindow::endSessionTrace()
+{
+    if (!sessionTrace.isOpen()) {
+        return;
+    }
+    sessionTrace.writeStop();
+    LOG_INFO(QString("会话轨迹已关闭：%1 条记录，%2 MB")
+             .arg(sessionTrace.records())
+             .arg(sessionTrace.bytes() / 1048576.0, 0, 'f', 1));
+    sessionTrace.close();
+}
+
+bool MainWindow::setupGlossary(QSettings &settings)
+{
+    const QString path = settings.value("Glossary/File",
+                                        QCoreApplication::applicationDirPath() + "/glossary.txt").toString();
+    if (path.isEmpty() || !QFileInfo::exists(path)) {
+        return false;
+    }
+
+    glossaryThread = new QThread(this);
+    glossaryThread->setObjectName("GlossaryThread");
+    glossaryProcessor = new GlossaryProcessor();
+    glossaryProcessor->moveToThread(glossaryThread);
+    glossaryThread->start();
+
+    const QString color = settings.value("Glossary/HighlightColor").toString();
+    QMetaObject::invokeMethod(glossaryProcessor, [this, path, color]() {
+        glossaryProcessor->setGlossaryFile(path, color);
+    }, Qt::QueuedConnection);
+
+    // 处理后的结果回到界面线程
+    connect(glossaryProcessor, &GlossaryProcessor::recognitionReady,
+            recognitionThrottle, &CaptionThrottle::submit);
+    connect(glossaryProcessor, &GlossaryProcessor::translationReady,
+            translationThrottle, &CaptionThrottle::submit);
+    connect(glossaryProcessor, &GlossaryProcessor::finalTranslationReady,
+            this, [this](const QString &html) {
+        if (historyChineseText) historyChineseText->append(html);
+        updateHistoryAccounting();
+    });
+    LOG_INFO(QString("已启用术语表: %1").arg(path));
+    return true;
+}
+
 void MainWindow::onStartButtonClicked()
 {
     QString key = ui->keyEdit->text();
     QString region = ui->regionEdit->text();
 
-    if (key.isEmpty() || region.isEmpty()) {
+    if (!sessionReplay && key.isEmpty()) {
         QMessageBox::warning(this, "错误", "请填写完整的Azure Speech服务配置信息");
         return;
     }
+    // 未填区域时先用缓存的探测结果，没有缓存则探测完成后再开始
+    if (!sessionReplay && region.isEmpty()) {
+        QSettings settings(configFilePath, QSettings::IniFormat);
+        qint64 latencyMs = -1;
+        if (!RegionProbe::loadCached(settings, key, probeCacheTtlHours, region, latencyMs)) {
+            runRegionProbe(true);
+            return;
+        }
+        LOG_INFO(QString("使用缓存的区域 %1（%2 ms）").arg(region).arg(latencyMs));
+        applyRegion(region);
+    }
+
+    ensureSpeechStack();
+
+    // 按延迟档位设置采集、SDK 和界面参数
+    audioProcessor->setLatencyProfile(latencyProfile);
+    speechEngine->setLatencyProfile(latencyProfile);
+    recognitionThrottle->setInterval(latencyProfile.uiUpdateIntervalMs);
+    translationThrottle->setInterval(latencyProfile.uiUpdateIntervalMs);
 
     // 初始化Azure Speech服务
-    azureSpeechAPI->initialize(key, region);
+    speechEngine->initialize(key, region);
     
     // 开始语音识别和翻译
-    azureSpeechAPI->startRecognitionAndTranslation("en-US", "zh-CN");
+    sourceLanguage = ui->sourceLanguageCombo->currentText().trimmed();
+    targetLanguage = ui->targetLanguageCombo->currentText().trimmed();
+    beginSessionTrace();
+    speechEngine->startRecognitionAndTranslation(sourceLanguage, targetLanguage);
+
+    // 第一次开始时补充记录引擎就绪阶段（SDK 在这里才被加载）
+    if (!StartupTimer::hasPhase(StartupPhase::EngineReady)) {
+        StartupTimer::mark(StartupPhase::EngineReady);
+        StartupTimer::report();
+    }
     
     // 开始音频处理
     audioProcessor->startRecording();
@@ -90,11 +349,28 @@ void MainWindow::onStartButtonClicked()
 
 void MainWindow::onStopButtonClicked()
 {
+    if (!audioProcessor) {
+        return;
+    }
+
     // 停止音频处理
     audioProcessor->stopRecording();
     
     // 停止语音识别和翻译
-    azureSpeechAPI->stopRecognitionAndTranslation();
+    speechEngine->stopRecognitionAndTranslation();
+    endSessionTrace();
+
+    // 本次采集的不连续、静音段和迟到唤醒统计
+    const QString captureSummary = describeGlitchStats(audioProcessor->glitchStats());
+    LOG_INFO(captureSummary);
+    ui->statusBar->showMessage(captureSummary);
+
+    if (!extraLanguages.isEmpty()) {
+        LOG_INFO(QString("额外翻译统计：HTTP 请求 %1 次，缓存命中 %2 次，未命中 %3 次")
+                 .arg(textTranslator->requestsSent())
+                 .arg(textTranslator->cacheHits())
+                 .arg(textTranslator->cacheMisses()));
+    }
     
     // 更新UI状态
     ui->startButton->setEnabled(true);
@@ -105,27 +381,31 @@ void MainWindow::onStopButtonClicked()
 
 void MainWindow::onAudioDataReceived(const QByteArray &data)
 {
-    azureSpeechAPI->processAudioData(data);
+    speechEngine->processAudioData(data);
 }
 
 void MainWindow::onRecognitionResult(const QString &text)
 {
-    ui->recognitionText->setPlainText(text);
+    recognitionThrottle->submit(text);
 }
 
 void MainWindow::onTranslationResult(const QString &text)
 {
-    ui->translationText->setPlainText(text);
+    translationThrottle->submit(text);
 }
 
 void MainWindow::onError(const QString &message)
 {
+    const QByteArray utf8 = message.toUtf8();
+    sessionTrace.writeStrings(SessionTraceType::Error, utf8.constData(), static_cast<size_t>(utf8.size()));
     QMessageBox::warning(this, "错误", message);
     ui->statusBar->showMessage(message);
 }
 
 void MainWindow::onStatusChanged(const QString &status)
 {
+    const QByteArray utf8 = status.toUtf8();
+    sessionTrace.writeStrings(SessionTraceType::Status, utf8.constData(), static_cast<size_t>(utf8.size()));
     ui->statusBar->showMessage(status);
 }
 
@@ -142,6 +422,8 @@ void MainWindow::onSaveConfigClicked()
     QSettings settings(configFilePath, QSettings::IniFormat);
     settings.setValue("Azure/Region", region);
     settings.setValue("Azure/Key", key);
+    settings.setValue("Speech/SourceLanguage", ui->sourceLanguageCombo->currentText().trimmed());
+    settings.setValue("Speech/TargetLanguage", ui->targetLanguageCombo->currentText().trimmed());
     
     QMessageBox::information(this, "保存成功", "配置已保存");
 }
@@ -154,25 +436,117 @@ void MainWindow::loadConfig()
     
     ui->regionEdit->setText(region);
     ui->keyEdit->setText(key);
+    ui->sourceLanguageCombo->setCurrentText(settings.value("Speech/SourceLanguage", sourceLanguage).toString());
+    ui->targetLanguageCombo->setCurrentText(settings.value("Speech/TargetLanguage", targetLanguage).toString());
+
+    latencyProfile = LatencyProfile::fromSettings(settings);
+    captureDevice = settings.value("Capture/Device").toString();
+    // SDK 崩溃或卡死时只重启语音服务进程；设为 false 则在界面进程内运行识别
+    hostSpeechEngine = settings.value("SpeechHost/Enabled", true).toBool();
+    speechHostHangTimeoutMs = qMax(3000, settings.value("SpeechHost/HangTimeoutMs", 10000).toInt());
+    autoSelectRegion = settings.value("Probe/AutoSelect", true).toBool();
+    probeCacheTtlHours = qMax(1, settings.value("Probe/CacheTtlHours", 24).toInt());
+    if (settings.value("Trace/Record", false).toBool()) {
+        traceDirectory = settings.value("Trace/Directory",
+                                        QCoreApplication::applicationDirPath() + "/traces").toString();
+    }
+    LOG_INFO(QString("延迟档位: %1").arg(latencyProfile.name));
+
+    // 额外翻译语言（逗号分隔），未配置时不启用
+    extraLanguages = settings.value("Translator/ExtraLanguages").toString().split(',', Qt::SkipEmptyParts);
+    for (QString &language : extraLanguages) {
+        language = language.trimmed();
+    }
+    textTranslator->setEndpoint(QUrl(settings.value("Translator/Endpoint",
+                                                    "https://api.cognitive.microsofttranslator.com").toString()));
+    textTranslator->setCredentials(settings.value("Translator/Key", key).toString(),
+                                   settings.value("Translator/Region", region).toString());
+    textTranslator->setMaxBatchSize(settings.value("Translator/BatchSize", 25).toInt());
+    textTranslator->setMaxRequestsInFlight(settings.value("Translator/MaxInFlight", 4).toInt());
+    textTranslator->setCacheCapacity(settings.value("Translator/CacheSize", 2000).toInt());
     
-    // 如果配置已存在，启用开始按钮
-    if (!region.isEmpty() && !key.isEmpty()) {
+    // 如果配置已存在，启用开始按钮；区域可以在开始时自动选择
+    if (!key.isEmpty()) {
         ui->startButton->setEnabled(true);
     }
 }
 
 void MainWindow::onTestButtonClicked()
 {
-    QString region = ui->regionEdit->text();
-    QString key = ui->keyEdit->text();
-    
-    if (region.isEmpty() || key.isEmpty()) {
-        QMessageBox::warning(this, "错误", "请填写区域和密钥");
+    if (ui->keyEdit->text().isEmpty()) {
+        QMessageBox::warning(this, "错误", "请填写密钥");
         return;
     }
-    
-    // 测试连接
-    azureSpeechAPI->testConnection(key, region);
+
+    // 只请求令牌接口检查密钥，不加载 SDK、不建立识别会话
+    runRegionProbe(false);
+}
+
+void MainWindow::runRegionProbe(bool thenStart)
+{
+    if (!regionProbe) {
+        regionProbe = new RegionProbe(this);
+        connect(regionProbe, &RegionProbe::finished, this, &MainWindow::onRegionProbeFinished);
+    }
+    startAfterProbe = startAfterProbe || thenStart;
+    if (regionProbe->isRunning()) {
+        return;
+    }
+    QSettings settings(configFilePath, QSettings::IniFormat);
+    regionProbe->configure(settings);
+    // 已填写的区域即使不在候选列表中也一并探测
+    const QString region = ui->regionEdit->text().trimmed().toLower();
+    if (!region.isEmpty()) {
+        regionProbe->setRegions(QStringList{region} + regionProbe->candidateRegions());
+    }
+
+    ui->testButton->setEnabled(false);
+    ui->startButton->setEnabled(false);
+    ui->statusBar->showMessage("正在检查密钥并测量各区域延迟...");
+    regionProbe->start(ui->keyEdit->text());
+}
+
+void MainWindow::onRegionProbeFinished(const QString &recommended)
+{
+    const bool thenStart = startAfterProbe;
+    startAfterProbe = false;
+    ui->testButton->setEnabled(true);
+    ui->startButton->setEnabled(true);
+
+    const QString key = ui->keyEdit->text();
+    const QString current = ui->regionEdit->text().trimmed().toLower();
+    if (recommended.isEmpty()) {
+        const QString message = QString("密钥在探测的区域中均无效：%1").arg(regionProbe->summary());
+        LOG_ERROR(message);
+        ui->statusBar->showMessage("连接测试失败");
+        QMessageBox::warning(this, "连接测试", message);
+        return;
+    }
+
+    QSettings settings(configFilePath, QSettings::IniFormat);
+    RegionProbe::saveCached(settings, key, recommended, regionProbe->latencyMs(recommended));
+    if (current.isEmpty() || (autoSelectRegion && current != recommended)) {
+        applyRegion(recommended);
+    }
+
+    const QString status = QString("连接测试成功，推荐区域 %1（%2 ms）")
+                               .arg(recommended).arg(regionProbe->latencyMs(recommended));
+    ui->statusBar->showMessage(status);
+    if (thenStart) {
+        onStartButtonClicked();
+        return;
+    }
+    QMessageBox::information(this, "连接测试", status + "\n\n" + regionProbe->summary());
+}
+
+void MainWindow::applyRegion(const QString &region)
+{
+    ui->regionEdit->setText(region);
+    QSettings settings(configFilePath, QSettings::IniFormat);
+    if (!settings.contains("Translator/Region")) {
+        textTranslator->setCredentials(settings.value("Translator/Key", ui->keyEdit->text()).toString(), region);
+    }
+    LOG_INFO(QString("已选择区域 %1").arg(region));
 }
 
 // 新增槽函数，供最终结果调用
@@ -180,16 +554,103 @@ void MainWindow::onFinalRecognitionResult(const QString &text)
 {
     recognitionHistory += text + "\n";
     ui->recognitionText->setPlainText(recognitionHistory);
+    updateHistoryAccounting();
 }
 
 void MainWindow::onFinalTranslationResult(const QString &text)
 {
     if (historyChineseText) historyChineseText->append(text);
+    updateHistoryAccounting();
+}
+
+void MainWindow::onFinalSegment(qint64, qint64, const QString &text, const QString &)
+{
+    if (text.isEmpty()) {
+        return;
+    }
+    // 翻译服务使用不带地区的语言代码，如 en-US -> en
+    const QString from = sourceLanguage.section('-', 0, 0);
+    for (const QString &language : extraLanguages) {
+        textTranslator->translate(text, from, language);
+    }
+}
+
+void MainWindow::onExtraTranslation(quint64, const QString &language, const QString &, const QString &translation)
+{
+    if (historyChineseText) historyChineseText->append(QString("[%1] %2").arg(language, translation));
+    updateHistoryAccounting();
+}
+
+void MainWindow::onLanguageChanged()
+{
+    const QString source = ui->sourceLanguageCombo->currentText().trimmed();
+    const QString target = ui->targetLanguageCombo->currentText().trimmed();
+    if (source.isEmpty() || target.isEmpty()) {
+        return;
+    }
+    // 未开始识别时只记录选择，开始时生效
+    if (!speechEngine || !ui->stopButton->isEnabled()) {
+        return;
+    }
+    if (source == sourceLanguage && target == targetLanguage) {
+        return;
+    }
+    sourceLanguage = source;
+    targetLanguage = target;
+    const QByteArray from = sourceLanguage.toUtf8();
+    const QByteArray to = targetLanguage.toUtf8();
+    sessionTrace.writeStrings(SessionTraceType::Reconfigure, from.constData(), static_cast<size_t>(from.size()),
+                              to.constData(), static_cast<size_t>(to.size()));
+    speechEngine->reconfigure(sourceLanguage, targetLanguage);
 }
 
 void MainWindow::onClearButtonClicked()
 {
     ui->recognitionText->clear();
     ui->translationText->clear();
+    subtitleOverlay->clear();
     if (historyChineseText) historyChineseText->clear();
-} 
\ No newline at end of file
+    // 识别历史也一起清空，否则下一条最终结果会把旧内容重新显示出来
+    recognitionHistory.clear();
+    recognitionHistory.squeeze();
+    updateHistoryAccounting();
+}
+
+void MainWindow::updateHistoryAccounting()
+{
+    // 文档的实际占用还包括排版结构，这里按文本量估计，足以看出增长趋势
+    qint64 bytes = recognitionHistory.capacity() * qint64(sizeof(QChar))
+            + ui->recognitionText->document()->characterCount() * qint64(sizeof(QChar));
+    if (historyChineseText) {
+        bytes += historyChineseText->document()->characterCount() * qint64(sizeof(QChar));
+    }
+    MemoryAccounting::adjust(MemoryTag::UiHistory, bytes - historyBytes);
+    historyBytes = bytes;
+}
+
+void MainWindow::showMemoryPanel()
+{
+    if (!memoryPanel) {
+        memoryPanel = new MemoryPanel(this);
+    }
+    memoryPanel->show();
+    memoryPanel->raise();
+    memoryPanel->activateWindow();
+} 
+
+void MainWindow::toggleSubtitleOverlay()
+{
+    subtitleOverlay->setVisible(!subtitleOverlay->isVisible());
+    ui->statusBar->showMessage(subtitleOverlay->isVisible() ? "字幕浮层已打开" : "字幕浮层已关闭", 3000);
+}
+
+void MainWindow::changeEvent(QEvent *event)
+{
+    QMainWindow::changeEvent(event);
+    if (event->type() == QEvent::WindowStateChange) {
+        // 最小化时实时区看不见，只保留最新文本，恢复时显示一次
+        const bool minimized = isMinimized();
+        recognitionThrottle->setSuspended(minimized);
+        translationThrottle->setSuspended(minimized);
+    }
+}
@@ -8,10 +8,23 @@
 #include <QTimer>
 #include <QLabel>
 #include <QTextEdit>
-#include "audioprocessor.h"
-#include "azurespeechapi.h"
+#include <QSettings>
+#include "texttranslator.h"
+#include "captionthrottle.h"
+#include "latencyprofile.h"
+#include "captionring.h"
+#include "sessiontrace.h"
 #include "logger.h"
 
+class AudioProcessor;
+class SpeechEngine;
+class SessionReplay;
+class GlossaryProcessor;
+class MemoryPanel;
+class RegionProbe;
+class SubtitleOverlay;
+class QThread;
+
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
 QT_END_NAMESPACE
@@ -24,6 +37,13 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+    // 回放模式（--replay）：采集和识别由会话轨迹驱动，不访问网络，显示后自动开始
+    void setSessionReplay(SessionReplay *replay);
+
+protected:
+    // 最小化时暂停实时区刷新
+    void changeEvent(QEvent *event) override;
+
 private slots:
     void onStartButtonClicked();
     void onStopButtonClicked();
@@ -38,16 +58,60 @@ private slots:
     void onFinalRecognitionResult(const QString &text);
     void onFinalTranslationResult(const QString &text);
     void onClearButtonClicked();
+    void onLanguageChanged();
+    void onFinalSegment(qint64 offsetMs, qint64 durationMs, const QString &text, const QString &translation);
+    void onExtraTranslation(quint64 requestId, const QString &language, const QString &source, const QString &translation);
 
 private:
+    // 采集和语音引擎（以及 Speech SDK）在第一次开始或测试时才创建
+    void ensureSpeechStack();
+    // 配置了术语表时启动术语处理线程，返回是否启用
+    bool setupGlossary(QSettings &settings);
+    // 配置了 [Trace] Record 时，每次开始都新建一个会话轨迹文件
+    void beginSessionTrace();
+    void endSessionTrace();
+    // 历史文本变化后把占用的变化计入 UiHistory
+    void updateHistoryAccounting();
+    void showMemoryPanel();
+    void toggleSubtitleOverlay();
+    // 并行探测候选区域；thenStart 为真时探测完成后继续开始识别
+    void runRegionProbe(bool thenStart);
+    void onRegionProbeFinished(const QString &region);
+    // 填入区域，翻译未单独配置区域时一并更新
+    void applyRegion(const QString &region);
+
     Ui::MainWindow *ui;
     AudioProcessor *audioProcessor;
-    AzureSpeechAPI *azureSpeechAPI;
+    SpeechEngine *speechEngine;
+    TextTranslator *textTranslator;
+    CaptionThrottle *recognitionThrottle;
+    CaptionThrottle *translationThrottle;
+    GlossaryProcessor *glossaryProcessor;   // 未启用术语表时为空，结果直接进界面
+    QThread *glossaryThread;
     Logger *logger;
     QString configFilePath;
     QString recognitionHistory;
     QString translationHistory;
     QTextEdit *historyChineseText;
+    QString sourceLanguage;
+    QString targetLanguage;
+    QString captureDevice;        // 采集设备，空为默认输出设备
+    bool hostSpeechEngine;        // 识别引擎运行在独立的语音服务进程中
+    int speechHostHangTimeoutMs;
+    RegionProbe *regionProbe;     // 第一次测试或自动选择区域时创建
+    bool autoSelectRegion;        // 测试后自动填入延迟最低的有效区域
+    int probeCacheTtlHours;
+    bool startAfterProbe;
+    QStringList extraLanguages;   // 定稿字幕额外翻译的语言
+    LatencyProfile latencyProfile;
+    CaptionRingWriter captionRing;   // 供本机其他程序读取的实时字幕
+    SessionTraceWriter sessionTrace;
+    QString traceDirectory;          // 非空表示记录会话轨迹
+    SessionReplay *sessionReplay;    // 回放模式下不为空
+    MemoryPanel *memoryPanel;        // 第一次打开时创建
+    SubtitleOverlay *subtitleOverlay;   // 独立的顶层窗口，主窗口最小化时仍显示
+    bool overlayShowsRecognition;       // 浮层显示原文而不是翻译
+    qint64 historyBytes;             // 已计入 UiHistory 的历史文本字节数
 };
 
 #endif // MAINWINDOW_H 
\ No newline at end of file
@@ -0,0 +1,181 @@
+#include "memoryaccounting.h"
+#include "metrics.h"
+#include <atomic>
+#include <string>
+
+namespace {
+
+const char *const kTagNames[] = {"capture", "dsp", "push", "results", "ui_history", "logging"};
+static_assert(sizeof(kTagNames) / sizeof(kTagNames[0]) == static_cast<size_t>(MemoryTag::Count),
+              "MemoryTag 与名称表不一致");
+
+struct TagState {
+    std::atomic<int64_t> live{0};
+    std::atomic<int64_t> peak{0};
+    MetricGauge *liveGauge = nullptr;
+    MetricGauge *peakGauge = nullptr;
+    MetricCounter *allocations = nullptr;
+    MetricCounter *allocatedBytes = nullptr;
+};
+
+// 各标签的指标在第一次记账时一起注册；之后每次记账只有几次原子操作
+TagState *tagStates()
+{
+    static TagState *states = []() {
+        static TagState table[static_cast<int>(MemoryTag::Count)];
+        for (int i = 0; i < static_cast<int>(MemoryTag::Count); ++i) {
+            const std::string prefix = std::string("memory_") + kTagNames[i];
+            table[i].liveGauge = &Metrics::gauge((prefix + "_live_bytes").c_str(), "该子系统当前占用的字节数");
+            table[i].peakGauge = &Metrics::gauge((prefix + "_peak_bytes").c_str(), "该子系统占用的峰值字节数");
+            table[i].allocations = &Metrics::counter((prefix + "_allocations_total").c_str(), "该子系统的分配次数");
+            table[i].allocatedBytes = &Metrics::counter((prefix + "_allocated_bytes_total").c_str(),
+                                                        "该子系统累计分配的字节数");
+        }
+        return table;
+    }();
+    return states;
+}
+
+TagState &state(MemoryTag tag)
+{
+    return tagStates()[static_cast<int>(tag)];
+}
+
+void addLive(TagState &s, int64_t delta)
+{
+    const int64_t live = s.live.fetch_add(delta, std::memory_order_relaxed) + delta;
+    s.liveGauge->set(live);
+    int64_t peak = s.peak.load(std::memory_order_relaxed);
+    while (live > peak && !s.peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+    if (live > peak) {
+        s.peakGauge->set(live);
+    }
+}
+
+} // namespace
+
+const char *memoryTagName(MemoryTag tag)
+{
+    const int i = static_cast<int>(tag);
+    return i >= 0 && i < static_cast<int>(MemoryTag::Count) ? kTagNames[i] : "unknown";
+}
+
+void MemoryAccounting::allocated(MemoryTag tag, size_t bytes)
+{
+    TagState &s = state(tag);
+    s.allocations->add();
+    s.allocatedBytes->add(bytes);
+    addLive(s, static_cast<int64_t>(bytes));
+}
+
+void MemoryAccounting::freed(MemoryTag tag, size_t bytes)
+{
+    addLive(state(tag), -static_cast<int64_t>(bytes));
+}
+
+void MemoryAccounting::adjust(MemoryTag tag, int64_t deltaBytes)
+{
+    if (deltaBytes == 0) {
+        return;
+    }
+    TagState &s = state(tag);
+    if (deltaBytes > 0) {
+        s.allocations->add();
+        s.allocatedBytes->add(static_cast<uint64_t>(deltaBytes));
+    }
+    addLive(s, deltaBytes);
+}
+
+void MemoryAccounting::transient(MemoryTag tag, size_t bytes)
+{
+    TagState &s = state(tag);
+    s.allocations->add();
+    s.allocatedBytes->add(bytes);
+}
+
+MemoryTagStats MemoryAccounting::stats(MemoryTag tag)
+{
+    const TagState &s = state(tag);
+    MemoryTagStats result;
+    result.liveBytes = s.live.load(std::memory_order_relaxed);
+    result.peakBytes = s.peak.load(std::memory_order_relaxed);
+    result.allocations = s.allocations->value();
+    result.allocatedBytes = s.allocatedBytes->value();
+    return result;
+}
+
+MemoryArena::MemoryArena(MemoryTag tag, size_t blockSize)
+    : tag(tag)
+    , blockSize(blockSize)
+    , current(0)
+    , offset(0)
+    , used(0)
+    , reserved(0)
+{
+}
+
+MemoryArena::~MemoryArena()
+{
+    for (const Block &block : blocks) {
+        MemoryAccounting::freed(tag, block.size);
+        ::operator delete(block.data);
+    }
+}
+
+void *MemoryArena::allocate(size_t bytes, size_t alignment)
+{
+    for (;;) {
+        if (current < blocks.size()) {
+            Block &block = blocks[current];
+            const uintptr_t base = reinterpret_cast<uintptr_t>(block.data);
+            const size_t aligned = ((base + offset + alignment - 1) & ~(alignment - 1)) - base;
+            if (aligned + bytes <= block.size) {
+                offset = aligned + bytes;
+                used += bytes;
+                return block.data + aligned;
+            }
+            if (current + 1 < blocks.size()) {
+                ++current;
+                offset = 0;
+                continue;
+            }
+        }
+        // 没有可用的块：申请新块（大请求单独成块）
+        const size_t size = bytes + alignment > blockSize ? bytes + alignment : blockSize;
+        Block block;
+        block.data = static_cast<char *>(::operator new(size));
+        block.size = size;
+        MemoryAccounting::allocated(tag, size);
+        reserved += size;
+        blocks.push_back(block);
+        current = blocks.size() - 1;
+        offset = 0;
+    }
+}
+
+void MemoryArena::reset()
+{
+    // 只保留第一块；本轮用到多块说明块太小，把第一块换成能容纳整轮的大小
+    if (blocks.size() > 1) {
+        size_t needed = 0;
+        for (const Block &block : blocks) {
+            needed += block.size;
+            MemoryAccounting::freed(tag, block.size);
+            ::operator delete(block.data);
+        }
+        blocks.clear();
+        if (needed > blockSize) {
+            blockSize = needed;
+        }
+        Block block;
+        block.data = static_cast<char *>(::operator new(blockSize));
+        block.size = blockSize;
+        MemoryAccounting::allocated(tag, blockSize);
+        blocks.push_back(block);
+        reserved = blockSize;
+    }
+    current = 0;
+    offset = 0;
+    used = 0;
+}
@@ -0,0 +1,131 @@
+#ifndef MEMORYACCOUNTING_H
+#define MEMORYACCOUNTING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <vector>
+
+// 按子系统统计内存：每个标签记录当前占用、峰值、分配次数和分配字节数，
+// 同时导出为指标 memory_<标签>_live_bytes / _peak_bytes / _allocations_total / _allocated_bytes_total，
+// 界面上的内存面板（MemoryPanel）显示同样的数据。
+//
+// 自己代码路径上的缓冲区用 TaggedAllocator（容器）或 MemoryArena（按轮次整体回收的临时内存）分配；
+// 由 Qt 持有、无法替换分配器的内存（QString、QTextDocument 等）用 adjust() 按大小变化记账，
+// 交给 Qt 后不再跟踪的一次性分配用 transient() 只计分配次数和字节数。本头文件不依赖 Qt。
+
+enum class MemoryTag : int {
+    Capture = 0,    // 采集线程的读取缓冲区和发出的数据包
+    Dsp,            // 格式转换、重采样的临时缓冲区
+    Push,           // 送入语音服务前缓冲的音频（切换语言期间）
+    Results,        // 识别结果队列中的文本
+    UiHistory,      // 界面上的历史文本
+    Logging,        // 日志格式化
+    Count
+};
+
+const char *memoryTagName(MemoryTag tag);
+
+struct MemoryTagStats {
+    int64_t liveBytes = 0;
+    int64_t peakBytes = 0;
+    uint64_t allocations = 0;
+    uint64_t allocatedBytes = 0;
+};
+
+class MemoryAccounting
+{
+public:
+    static void allocated(MemoryTag tag, size_t bytes);
+    static void freed(MemoryTag tag, size_t bytes);
+    // 占用变化 deltaBytes（可为负），增加时计一次分配
+    static void adjust(MemoryTag tag, int64_t deltaBytes);
+    // 交给其他模块释放的分配：只计次数和字节数，不计入当前占用
+    static void transient(MemoryTag tag, size_t bytes);
+
+    static MemoryTagStats stats(MemoryTag tag);
+};
+
+// 计入指定标签的标准分配器，用于 std::vector 等容器
+template <typename T, MemoryTag Tag>
+class TaggedAllocator
+{
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = TaggedAllocator<U, Tag>;
+    };
+
+    TaggedAllocator() noexcept = default;
+    template <typename U>
+    TaggedAllocator(const TaggedAllocator<U, Tag> &) noexcept {}
+
+    T *allocate(size_t n)
+    {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+        T *p = static_cast<T *>(::operator new(n * sizeof(T)));
+        MemoryAccounting::allocated(Tag, n * sizeof(T));
+        return p;
+    }
+
+    void deallocate(T *p, size_t n) noexcept
+    {
+        MemoryAccounting::freed(Tag, n * sizeof(T));
+        ::operator delete(p);
+    }
+
+    template <typename U>
+    bool operator==(const TaggedAllocator<U, Tag> &) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const TaggedAllocator<U, Tag> &) const noexcept { return false; }
+};
+
+template <MemoryTag Tag>
+using TaggedPcmBuffer = std::vector<int16_t, TaggedAllocator<int16_t, Tag>>;
+
+// 单线程的顺序分配器：从按块申请的内存中依次切分，reset() 一次性回收本轮的全部分配，
+// 保留第一块供下一轮复用。适合每个数据包、每条日志这样生命周期整齐的临时内存，
+// 稳定运行后不再向堆申请。超过块大小的请求单独成块。
+class MemoryArena
+{
+public:
+    explicit MemoryArena(MemoryTag tag, size_t blockSize = 64 * 1024);
+    ~MemoryArena();
+
+    void *allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+    template <typename T>
+    T *allocateArray(size_t count)
+    {
+        return static_cast<T *>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void reset();
+
+    size_t bytesInUse() const { return used; }
+    size_t bytesReserved() const { return reserved; }
+
+private:
+    MemoryArena(const MemoryArena &) = delete;
+    MemoryArena &operator=(const MemoryArena &) = delete;
+
+    struct Block {
+        char *data;
+        size_t size;
+    };
+
+    MemoryTag tag;
+    size_t blockSize;
+    std::vector<Block> blocks;
+    size_t current;     // 正在切分的块
+    size_t offset;      // 当前块中已用字节
+    size_t used;
+    size_t reserved;
+};
+
+#endif // MEMORYACCOUNTING_H
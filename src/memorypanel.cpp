@@ -0,0 +1,89 @@
+#include "memorypanel.h"
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QVBoxLayout>
+
+namespace {
+
+const int kRefreshIntervalMs = 1000;
+
+const char *const kTagLabels[] = {"采集", "格式转换", "推流", "识别结果", "界面历史", "日志"};
+static_assert(sizeof(kTagLabels) / sizeof(kTagLabels[0]) == static_cast<size_t>(MemoryTag::Count),
+              "MemoryTag 与显示名称不一致");
+
+QString formatBytes(double bytes)
+{
+    if (bytes >= 1024.0 * 1024.0) {
+        return QString("%1 MB").arg(bytes / (1024.0 * 1024.0), 0, 'f', 1);
+    }
+    if (bytes >= 1024.0) {
+        return QString("%1 KB").arg(bytes / 1024.0, 0, 'f', 1);
+    }
+    return QString("%1 B").arg(bytes, 0, 'f', 0);
+}
+
+} // namespace
+
+MemoryPanel::MemoryPanel(QWidget *parent)
+    : QWidget(parent, Qt::Tool)
+    , table(new QTableWidget(static_cast<int>(MemoryTag::Count), 5, this))
+{
+    setWindowTitle("内存统计");
+    table->setHorizontalHeaderLabels({"子系统", "当前占用", "峰值", "分配次数/秒", "分配量/秒"});
+    table->verticalHeader()->setVisible(false);
+    table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->setSelectionMode(QAbstractItemView::NoSelection);
+    for (int row = 0; row < static_cast<int>(MemoryTag::Count); ++row) {
+        table->setItem(row, 0, new QTableWidgetItem(QString("%1 (%2)")
+                                                    .arg(kTagLabels[row], memoryTagName(static_cast<MemoryTag>(row)))));
+        for (int column = 1; column < table->columnCount(); ++column) {
+            QTableWidgetItem *item = new QTableWidgetItem;
+            item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            table->setItem(row, column, item);
+        }
+    }
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addWidget(table);
+    resize(560, 240);
+
+    timer.setInterval(kRefreshIntervalMs);
+    connect(&timer, &QTimer::timeout, this, &MemoryPanel::refresh);
+}
+
+void MemoryPanel::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    // 打开时以当前计数为基准，第一次刷新的速率不包含面板关闭期间的分配
+    for (int i = 0; i < static_cast<int>(MemoryTag::Count); ++i) {
+        previous[i] = MemoryAccounting::stats(static_cast<MemoryTag>(i));
+    }
+    sinceLastRefresh.start();
+    refresh();
+    timer.start();
+}
+
+void MemoryPanel::hideEvent(QHideEvent *event)
+{
+    timer.stop();
+    QWidget::hideEvent(event);
+}
+
+void MemoryPanel::refresh()
+{
+    const double seconds = sinceLastRefresh.restart() / 1000.0;
+    for (int row = 0; row < static_cast<int>(MemoryTag::Count); ++row) {
+        const MemoryTagStats stats = MemoryAccounting::stats(static_cast<MemoryTag>(row));
+        const MemoryTagStats &last = previous[row];
+        const double allocationRate = seconds > 0 ? (stats.allocations - last.allocations) / seconds : 0;
+        const double byteRate = seconds > 0 ? (stats.allocatedBytes - last.allocatedBytes) / seconds : 0;
+
+        table->item(row, 1)->setText(formatBytes(static_cast<double>(stats.liveBytes)));
+        table->item(row, 2)->setText(formatBytes(static_cast<double>(stats.peakBytes)));
+        table->item(row, 3)->setText(QString::number(allocationRate, 'f', 1));
+        table->item(row, 4)->setText(formatBytes(byteRate) + "/s");
+        previous[row] = stats;
+    }
+}
@@ -0,0 +1,32 @@
+#ifndef MEMORYPANEL_H
+#define MEMORYPANEL_H
+
+#include <QWidget>
+#include <QTimer>
+#include <QElapsedTimer>
+#include "memoryaccounting.h"
+
+class QTableWidget;
+
+// 调试用的内存面板：每秒刷新各子系统的当前占用、峰值和分配速率（Ctrl+Shift+M 打开）
+class MemoryPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit MemoryPanel(QWidget *parent = nullptr);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private:
+    void refresh();
+
+    QTableWidget *table;
+    QTimer timer;
+    QElapsedTimer sinceLastRefresh;
+    MemoryTagStats previous[static_cast<int>(MemoryTag::Count)];
+};
+
+#endif // MEMORYPANEL_H
@@ -0,0 +1,204 @@
+#include "metrics.h"
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+
+namespace {
+
+const char kPrefix[] = "meetingassistant_";
+
+enum class MetricKind { Counter, Gauge, Histogram };
+
+struct MetricEntry {
+    std::string name;
+    std::string help;
+    MetricKind kind;
+    double scale = 1.0;
+    std::unique_ptr<MetricCounter> counter;
+    std::unique_ptr<MetricGauge> gauge;
+    std::unique_ptr<MetricHistogram> histogram;
+};
+
+// 注册表只在取用和导出时加锁，热路径只访问已缓存的指标对象
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<MetricEntry>> entries;
+
+    MetricEntry *find(const char *name, MetricKind kind)
+    {
+        for (const auto &entry : entries) {
+            if (entry->kind == kind && entry->name == name) {
+                return entry.get();
+            }
+        }
+        return nullptr;
+    }
+
+    MetricEntry *add(const char *name, const char *help, MetricKind kind)
+    {
+        entries.emplace_back(new MetricEntry);
+        MetricEntry *entry = entries.back().get();
+        entry->name = name;
+        entry->help = help;
+        entry->kind = kind;
+        return entry;
+    }
+};
+
+Registry &registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+void appendNumber(std::string &out, double v)
+{
+    char buffer[32];
+    if (v == std::floor(v) && std::fabs(v) < 1e15) {
+        std::snprintf(buffer, sizeof(buffer), "%.0f", v);
+    } else {
+        std::snprintf(buffer, sizeof(buffer), "%.6g", v);
+    }
+    out += buffer;
+}
+
+void appendHeader(std::string &out, const MetricEntry &entry, const char *type)
+{
+    out += "# HELP ";
+    out += kPrefix;
+    out += entry.name;
+    out += ' ';
+    out += entry.help;
+    out += "\n# TYPE ";
+    out += kPrefix;
+    out += entry.name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+} // namespace
+
+MetricHistogram::MetricHistogram(std::initializer_list<double> upperBounds)
+    : numBounds(0)
+{
+    for (double bound : upperBounds) {
+        if (numBounds == kMaxBuckets) {
+            break;
+        }
+        bounds[numBounds++] = bound;
+    }
+    for (auto &bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+void MetricHistogram::observe(double v)
+{
+    int i = 0;
+    while (i < numBounds && v > bounds[i]) {
+        ++i;
+    }
+    buckets[i].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    sumMicros.fetch_add(static_cast<int64_t>(v * 1e6), std::memory_order_relaxed);
+}
+
+MetricCounter &Metrics::counter(const char *name, const char *help, double scale)
+{
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    MetricEntry *entry = r.find(name, MetricKind::Counter);
+    if (!entry) {
+        entry = r.add(name, help, MetricKind::Counter);
+        entry->scale = scale;
+        entry->counter.reset(new MetricCounter);
+    }
+    return *entry->counter;
+}
+
+MetricGauge &Metrics::gauge(const char *name, const char *help)
+{
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    MetricEntry *entry = r.find(name, MetricKind::Gauge);
+    if (!entry) {
+        entry = r.add(name, help, MetricKind::Gauge);
+        entry->gauge.reset(new MetricGauge);
+    }
+    return *entry->gauge;
+}
+
+MetricHistogram &Metrics::histogram(const char *name, const char *help, std::initializer_list<double> upperBounds)
+{
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    MetricEntry *entry = r.find(name, MetricKind::Histogram);
+    if (!entry) {
+        entry = r.add(name, help, MetricKind::Histogram);
+        entry->histogram.reset(new MetricHistogram(upperBounds));
+    }
+    return *entry->histogram;
+}
+
+std::string Metrics::prometheusText()
+{
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    std::string out;
+    out.reserve(r.entries.size() * 160);
+    for (const auto &entry : r.entries) {
+        switch (entry->kind) {
+        case MetricKind::Counter:
+            appendHeader(out, *entry, "counter");
+            out += kPrefix;
+            out += entry->name;
+            out += ' ';
+            appendNumber(out, entry->counter->value() * entry->scale);
+            out += '\n';
+            break;
+        case MetricKind::Gauge:
+            appendHeader(out, *entry, "gauge");
+            out += kPrefix;
+            out += entry->name;
+            out += ' ';
+            appendNumber(out, static_cast<double>(entry->gauge->value()));
+            out += '\n';
+            break;
+        case MetricKind::Histogram: {
+            const MetricHistogram &h = *entry->histogram;
+            appendHeader(out, *entry, "histogram");
+            // 各桶的计数分别读取，快照不是严格一致的，对监控足够
+            uint64_t cumulative = 0;
+            for (int i = 0; i <= h.bucketCount(); ++i) {
+                cumulative += h.bucketValue(i);
+                out += kPrefix;
+                out += entry->name;
+                out += "_bucket{le=\"";
+                if (i < h.bucketCount()) {
+                    appendNumber(out, h.upperBound(i));
+                } else {
+                    out += "+Inf";
+                }
+                out += "\"} ";
+                appendNumber(out, static_cast<double>(cumulative));
+                out += '\n';
+            }
+            out += kPrefix;
+            out += entry->name;
+            out += "_sum ";
+            appendNumber(out, h.sum());
+            out += '\n';
+            out += kPrefix;
+            out += entry->name;
+            out += "_count ";
+            appendNumber(out, static_cast<double>(cumulative));
+            out += '\n';
+            break;
+        }
+        }
+    }
+    return out;
+}
@@ -0,0 +1,75 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+// 运行指标：热路径上只做一次原子加法，不加锁、不分配内存。
+// 指标对象在第一次取用时注册并一直存在，调用方用函数内的 static 引用缓存：
+//     static MetricCounter &packets = Metrics::counter("capture_packets_total", "采集到的数据包数");
+//     packets.add();
+// 快照以 Prometheus 文本格式导出（见 MetricsExporter）。本头文件不依赖 Qt。
+
+class MetricCounter
+{
+public:
+    void add(uint64_t n = 1) { count.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return count.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> count{0};
+};
+
+class MetricGauge
+{
+public:
+    void set(int64_t v) { current.store(v, std::memory_order_relaxed); }
+    void add(int64_t delta) { current.fetch_add(delta, std::memory_order_relaxed); }
+    int64_t value() const { return current.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> current{0};
+};
+
+// 固定桶的直方图，桶上限在注册时给定（最多 kMaxBuckets 个，另有 +Inf 桶）
+class MetricHistogram
+{
+public:
+    static const int kMaxBuckets = 16;
+
+    explicit MetricHistogram(std::initializer_list<double> upperBounds);
+
+    void observe(double v);
+
+    int bucketCount() const { return numBounds; }
+    double upperBound(int i) const { return bounds[i]; }
+    // 非累计计数；i == bucketCount() 为 +Inf 桶
+    uint64_t bucketValue(int i) const { return buckets[i].load(std::memory_order_relaxed); }
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    double sum() const { return sumMicros.load(std::memory_order_relaxed) / 1e6; }
+
+private:
+    double bounds[kMaxBuckets];
+    int numBounds;
+    std::atomic<uint64_t> buckets[kMaxBuckets + 1];
+    std::atomic<uint64_t> total{0};
+    std::atomic<int64_t> sumMicros{0};
+};
+
+class Metrics
+{
+public:
+    // 名称不含前缀，导出时统一加 "meetingassistant_"。同名再次取用返回同一对象。
+    // scale 用于导出时换算单位，例如按字节计数、按秒导出
+    static MetricCounter &counter(const char *name, const char *help, double scale = 1.0);
+    static MetricGauge &gauge(const char *name, const char *help);
+    static MetricHistogram &histogram(const char *name, const char *help, std::initializer_list<double> upperBounds);
+
+    // Prometheus 文本格式（0.0.4）的完整快照
+    static std::string prometheusText();
+};
+
+#endif // METRICS_H
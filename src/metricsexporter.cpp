@@ -0,0 +1,135 @@
+#include "metricsexporter.h"
+#include "metrics.h"
+#include "logger.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFile>
+#include <QHostAddress>
+#include <QSettings>
+#include <QTcpSocket>
+
+namespace {
+
+const int kMaxRequestBytes = 8192;
+const int kRequestTimeoutMs = 5000;
+
+} // namespace
+
+MetricsExporter::MetricsExporter(QObject *parent)
+    : QObject(parent)
+    , port(9464)
+    , fileIntervalSec(60)
+    , maxFileBytes(5 * 1024 * 1024)
+    , fileCount(3)
+    , filePath(QCoreApplication::applicationDirPath() + "/logs/metrics.log")
+{
+    uptime.start();
+    connect(&server, &QTcpServer::newConnection, this, &MetricsExporter::onNewConnection);
+    connect(&fileTimer, &QTimer::timeout, this, &MetricsExporter::writeSnapshotFile);
+}
+
+MetricsExporter::~MetricsExporter()
+{
+    if (fileTimer.isActive()) {
+        writeSnapshotFile();
+    }
+}
+
+void MetricsExporter::configure(const QSettings &settings)
+{
+    port = static_cast<quint16>(settings.value("Metrics/Port", port).toUInt());
+    fileIntervalSec = settings.value("Metrics/FileIntervalSec", fileIntervalSec).toInt();
+    maxFileBytes = settings.value("Metrics/MaxFileMB", 5).toLongLong() * 1024 * 1024;
+    fileCount = qMax(1, settings.value("Metrics/FileCount", fileCount).toInt());
+}
+
+bool MetricsExporter::start()
+{
+    bool ok = true;
+    if (port != 0) {
+        // 只监听本机，由机器上的采集代理转发
+        if (server.listen(QHostAddress::LocalHost, port)) {
+            LOG_INFO(QString("指标端点: http://127.0.0.1:%1/metrics").arg(server.serverPort()));
+        } else {
+            LOG_ERROR(QString("无法监听指标端口 %1: %2").arg(port).arg(server.errorString()));
+            ok = false;
+        }
+    }
+    if (fileIntervalSec > 0) {
+        fileTimer.start(fileIntervalSec * 1000);
+    }
+    return ok;
+}
+
+void MetricsExporter::onNewConnection()
+{
+    while (QTcpSocket *socket = server.nextPendingConnection()) {
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { handleRequest(socket); });
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        QTimer::singleShot(kRequestTimeoutMs, socket, [socket]() { socket->abort(); });
+    }
+}
+
+void MetricsExporter::handleRequest(QTcpSocket *socket)
+{
+    const QByteArray pending = socket->peek(kMaxRequestBytes);
+    if (!pending.contains("\r\n\r\n")) {
+        if (pending.size() >= kMaxRequestBytes) {
+            socket->abort();
+        }
+        return;
+    }
+    socket->disconnect(this);
+    const QByteArray request = socket->readAll();
+    const QList<QByteArray> requestLine = request.left(request.indexOf("\r\n")).split(' ');
+
+    QByteArray status = "200 OK";
+    QByteArray body;
+    if (requestLine.size() < 2 || requestLine[0] != "GET") {
+        status = "405 Method Not Allowed";
+    } else if (requestLine[1] != "/metrics" && requestLine[1] != "/") {
+        status = "404 Not Found";
+    } else {
+        body = snapshot();
+    }
+
+    QByteArray response = "HTTP/1.1 " + status + "\r\n"
+            "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+            "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+            "Connection: close\r\n\r\n" + body;
+    socket->write(response);
+    socket->disconnectFromHost();
+}
+
+QByteArray MetricsExporter::snapshot() const
+{
+    static MetricGauge &uptimeGauge = Metrics::gauge("process_uptime_seconds", "进程运行时长（秒）");
+    uptimeGauge.set(uptime.elapsed() / 1000);
+    const std::string text = Metrics::prometheusText();
+    return QByteArray(text.data(), static_cast<int>(text.size()));
+}
+
+void MetricsExporter::writeSnapshotFile()
+{
+    QFile file(filePath);
+    if (file.exists() && file.size() >= maxFileBytes) {
+        rotateFiles();
+    }
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        LOG_ERROR(QString("无法写入指标文件 %1: %2").arg(filePath).arg(file.errorString()));
+        return;
+    }
+    file.write("# snapshot " + QDateTime::currentDateTime().toString(Qt::ISODateWithMs).toUtf8() + "\n");
+    file.write(snapshot());
+    file.write("\n");
+}
+
+void MetricsExporter::rotateFiles()
+{
+    // metrics.log -> metrics.log.1 -> ... -> metrics.log.N（最旧的删除）
+    QFile::remove(QString("%1.%2").arg(filePath).arg(fileCount));
+    for (int i = fileCount - 1; i >= 1; --i) {
+        QFile::rename(QString("%1.%2").arg(filePath).arg(i), QString("%1.%2").arg(filePath).arg(i + 1));
+    }
+    QFile::rename(filePath, filePath + ".1");
+}
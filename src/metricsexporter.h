@@ -0,0 +1,44 @@
+#ifndef METRICSEXPORTER_H
+#define METRICSEXPORTER_H
+
+#include <QObject>
+#include <QTcpServer>
+#include <QTimer>
+#include <QElapsedTimer>
+
+class QSettings;
+class QTcpSocket;
+
+// 指标导出：在 127.0.0.1 上提供 Prometheus 抓取端点（GET /metrics），
+// 并定期把带时间戳的快照追加到 logs/metrics.log，超过大小后轮转。
+// 参数取自 config.ini 的 [Metrics] 段：Port（默认 9464，0 关闭端点）、
+// FileIntervalSec（默认 60，0 关闭文件）、MaxFileMB（默认 5）、FileCount（保留的轮转文件数，默认 3）。
+class MetricsExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MetricsExporter(QObject *parent = nullptr);
+    ~MetricsExporter();
+
+    void configure(const QSettings &settings);
+    bool start();
+
+private:
+    void onNewConnection();
+    void handleRequest(QTcpSocket *socket);
+    QByteArray snapshot() const;
+    void writeSnapshotFile();
+    void rotateFiles();
+
+    QTcpServer server;
+    QTimer fileTimer;
+    QElapsedTimer uptime;
+    quint16 port;
+    int fileIntervalSec;
+    qint64 maxFileBytes;
+    int fileCount;
+    QString filePath;
+};
+
+#endif // METRICSEXPORTER_H
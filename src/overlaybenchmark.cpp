@@ -0,0 +1,188 @@
+#include "overlaybenchmark.h"
+#include "subtitleoverlay.h"
+#include "latencybenchmark.h"
+#include "logger.h"
+#include <QCoreApplication>
+#include <QSettings>
+#include <QTextEdit>
+#include <QTextStream>
+
+namespace {
+
+const int kTickIntervalMs = 50;     // 每秒 20 次部分结果，高于 SDK 的实际频率
+
+} // namespace
+
+OverlayBenchmark::OverlayBenchmark(int seconds, QObject *parent)
+    : QObject(parent)
+    , phaseSeconds(qMax(3, seconds))
+    , currentPhase(0)
+    , overlay(nullptr)
+    , pane(nullptr)
+    , cpuStartMs(0)
+    , words({"我们", "今天", "主要", "讨论", "下个", "季度", "的", "产品", "路线图", "以及", "预算",
+             "安排", "首先", "请", "市场部", "介绍", "一下", "用户", "反馈", "然后", "确认", "发布", "时间"})
+    , wordsInSentence(0)
+    , sentenceLength(0)
+    , seed(12345)
+    , paneUpdates(0)
+    , paneTotalNs(0)
+    , paneMaxNs(0)
+{
+    ticker.setInterval(kTickIntervalMs);
+    connect(&ticker, &QTimer::timeout, this, &OverlayBenchmark::tick);
+}
+
+OverlayBenchmark::~OverlayBenchmark()
+{
+    delete overlay;
+    delete pane;
+}
+
+void OverlayBenchmark::start()
+{
+    QSettings settings(QCoreApplication::applicationDirPath() + "/config.ini", QSettings::IniFormat);
+    overlay = new SubtitleOverlay;
+    overlay->configure(settings);
+    pane = new QTextEdit;
+    pane->setReadOnly(true);
+    pane->resize(700, 160);
+    pane->setWindowTitle("实时区（对照）");
+
+    LOG_INFO(QString("开始字幕浮层基准，每个阶段 %1 秒，刷新间隔 %2 ms")
+             .arg(phaseSeconds).arg(overlay->frameIntervalMs()));
+    startPhase(OverlayPhase);
+}
+
+void OverlayBenchmark::startPhase(int phase)
+{
+    if (phase >= PhaseCount) {
+        report();
+        emit finished();
+        return;
+    }
+    currentPhase = phase;
+    sentence.clear();
+    wordsInSentence = 0;
+    paneUpdates = 0;
+    paneTotalNs = 0;
+    paneMaxNs = 0;
+
+    if (phase == PanePhase) {
+        overlay->hide();
+        pane->show();
+    } else {
+        pane->hide();
+        overlay->show();
+    }
+    // 等窗口显示完成后再开始计数
+    QTimer::singleShot(500, this, [this, phase]() {
+        overlay->resetPaintStats();
+        cpuStartMs = processCpuTimeMs();
+        wallClock.start();
+        if (phase != IdlePhase) {
+            ticker.start();
+        }
+        QTimer::singleShot(phaseSeconds * 1000, this, &OverlayBenchmark::finishPhase);
+    });
+}
+
+QString OverlayBenchmark::nextPartial(bool &final)
+{
+    if (wordsInSentence == 0) {
+        sentence.clear();
+        // 8 到 23 个词定稿一次
+        seed = seed * 1103515245u + 12345u;
+        sentenceLength = 8 + static_cast<int>((seed >> 16) % 16);
+    }
+    seed = seed * 1103515245u + 12345u;
+    sentence += words[static_cast<int>((seed >> 16) % static_cast<quint32>(words.size()))];
+    ++wordsInSentence;
+    final = wordsInSentence >= sentenceLength;
+    if (final) {
+        wordsInSentence = 0;
+    }
+    return sentence;
+}
+
+void OverlayBenchmark::tick()
+{
+    bool final = false;
+    const QString text = nextPartial(final);
+    if (currentPhase == OverlayPhase) {
+        overlay->setLiveText(text);
+        if (final) {
+            overlay->commitLine(text);
+        }
+    } else if (currentPhase == PanePhase) {
+        // 与主窗口实时区相同：每次更新整体替换文本，立即绘制以计入排版和绘制
+        QElapsedTimer timer;
+        timer.start();
+        pane->setPlainText(text);
+        pane->repaint();
+        const qint64 elapsedNs = timer.nsecsElapsed();
+        ++paneUpdates;
+        paneTotalNs += elapsedNs;
+        paneMaxNs = qMax(paneMaxNs, elapsedNs);
+    }
+}
+
+void OverlayBenchmark::finishPhase()
+{
+    ticker.stop();
+    const qint64 wallMs = wallClock.elapsed();
+    const qint64 cpuMs = processCpuTimeMs() - cpuStartMs;
+
+    Result result;
+    result.cpuPercent = wallMs > 0 ? 100.0 * cpuMs / wallMs : 0;
+    if (currentPhase == PanePhase) {
+        result.name = "文本框";
+        result.updates = paneUpdates;
+        result.paints = paneUpdates;
+        // 文本框每次更新立即排版并绘制，计时已包含两者
+        result.updateAvgMs = paneUpdates > 0 ? paneTotalNs / 1e6 / paneUpdates : 0;
+        result.paintAvgMs = result.updateAvgMs;
+        result.paintMaxMs = paneMaxNs / 1e6;
+        result.pixelsPerPaint = static_cast<double>(pane->viewport()->width()) * pane->viewport()->height();
+    } else {
+        const SubtitleOverlay::PaintStats stats = overlay->paintStats();
+        result.name = currentPhase == OverlayPhase ? "浮层" : "浮层空闲";
+        result.updates = stats.updates;
+        result.paints = stats.paints;
+        // 浮层的排版在 setLiveText/commitLine 中，绘制合并到刷新间隔，两部分相加后按更新次数平均
+        result.updateAvgMs = stats.updates > 0 ? (stats.totalLayoutNs + stats.totalPaintNs) / 1e6 / stats.updates : 0;
+        result.paintAvgMs = stats.paints > 0 ? stats.totalPaintNs / 1e6 / stats.paints : 0;
+        result.paintMaxMs = stats.maxPaintNs / 1e6;
+        result.pixelsPerPaint = stats.paints > 0 ? static_cast<double>(stats.paintedPixels) / stats.paints : 0;
+    }
+    results.append(result);
+    startPhase(currentPhase + 1);
+}
+
+void OverlayBenchmark::report()
+{
+    QTextStream out(stdout);
+    out << QString("%1 %2 %3 %4 %5 %6 %7 %8\n")
+           .arg("阶段", -10)
+           .arg("更新次数", 10)
+           .arg("绘制次数", 10)
+           .arg("每次更新(ms)", 14)
+           .arg("平均绘制(ms)", 14)
+           .arg("最长绘制(ms)", 14)
+           .arg("每次像素", 10)
+           .arg("CPU(%)", 8);
+    for (const Result &r : results) {
+        QString line = QString("%1 %2 %3 %4 %5 %6 %7 %8")
+                .arg(r.name, -10)
+                .arg(r.updates, 10)
+                .arg(r.paints, 10)
+                .arg(r.updateAvgMs, 14, 'f', 3)
+                .arg(r.paintAvgMs, 14, 'f', 3)
+                .arg(r.paintMaxMs, 14, 'f', 3)
+                .arg(r.pixelsPerPaint, 10, 'f', 0)
+                .arg(r.cpuPercent, 8, 'f', 2);
+        out << line << "\n";
+        LOG_INFO(QString("字幕浮层基准结果: %1").arg(line.simplified()));
+    }
+    out.flush();
+}
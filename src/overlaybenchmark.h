@@ -0,0 +1,71 @@
+#ifndef OVERLAYBENCHMARK_H
+#define OVERLAYBENCHMARK_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QList>
+#include <QStringList>
+#include <QTimer>
+
+class SubtitleOverlay;
+class QTextEdit;
+
+// 字幕浮层基准（--overlay-benchmark）：按固定节奏生成合成的部分结果（逐词增长，若干词后定稿），
+// 依次送给字幕浮层和一个与主窗口实时区相同的 QTextEdit（每次更新都刷新），最后空闲一段时间，
+// 报告每个阶段每次更新的绘制耗时、实际绘制次数和进程 CPU 占用。
+class OverlayBenchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit OverlayBenchmark(int seconds, QObject *parent = nullptr);
+    ~OverlayBenchmark();
+
+    void start();
+
+signals:
+    void finished();
+
+private:
+    enum Phase { OverlayPhase, PanePhase, IdlePhase, PhaseCount };
+
+    struct Result {
+        QString name;
+        int updates = 0;
+        int paints = 0;
+        double updateAvgMs = 0;     // 每次更新的排版和绘制耗时，两种界面按同一口径比较
+        double paintAvgMs = 0;
+        double paintMaxMs = 0;
+        double pixelsPerPaint = 0;
+        double cpuPercent = 0;
+    };
+
+    void startPhase(int phase);
+    void finishPhase();
+    void tick();
+    QString nextPartial(bool &final);
+    void report();
+
+    int phaseSeconds;
+    int currentPhase;
+    SubtitleOverlay *overlay;
+    QTextEdit *pane;
+    QTimer ticker;
+    QElapsedTimer wallClock;
+    qint64 cpuStartMs;
+    QList<Result> results;
+
+    // 合成字幕
+    QStringList words;
+    QString sentence;
+    int wordsInSentence;
+    int sentenceLength;
+    quint32 seed;
+
+    // 文本框阶段的计时
+    int paneUpdates;
+    qint64 paneTotalNs;
+    qint64 paneMaxNs;
+};
+
+#endif // OVERLAYBENCHMARK_H
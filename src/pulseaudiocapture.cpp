@@ -0,0 +1,148 @@
+#include "pulseaudiocapture.h"
+#include "logger.h"
+#include "flightrecorder.h"
+#include "memoryaccounting.h"
+#include <pulse/simple.h>
+#include <pulse/error.h>
+#include <chrono>
+
+namespace {
+
+const int kSampleRate = 16000;
+const int kBytesPerFrame = 2;
+// 默认输出设备的 monitor 源，PulseAudio 和 pipewire-pulse 都支持
+const char kDefaultMonitor[] = "@DEFAULT_MONITOR@";
+
+uint64_t steadyNowUs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+} // namespace
+
+PulseAudioCapture::PulseAudioCapture(QObject *parent)
+    : AudioCapture(parent)
+    , stream(nullptr)
+    , capturing(false)
+    , fragmentMs(10)
+{
+    LOG_INFO("PulseAudioCapture 初始化");
+}
+
+PulseAudioCapture::~PulseAudioCapture()
+{
+    stopCapture();
+}
+
+void PulseAudioCapture::setLatencyProfile(const LatencyProfile &profile)
+{
+    fragmentMs = qBound(5, profile.capturePollMs, 200);
+}
+
+bool PulseAudioCapture::startCapture()
+{
+    if (capturing.load()) {
+        LOG_INFO("音频捕获已经在进行中");
+        return true;
+    }
+
+    const QByteArray device = (deviceName.isEmpty() ? QString(kDefaultMonitor) : deviceName).toUtf8();
+    const uint32_t fragmentBytes = static_cast<uint32_t>(kSampleRate * kBytesPerFrame * fragmentMs / 1000);
+
+    pa_sample_spec spec;
+    spec.format = PA_SAMPLE_S16LE;
+    spec.rate = kSampleRate;
+    spec.channels = 1;
+
+    // fragsize 决定服务端多久交付一次数据，也就是采集延迟的主要部分
+    pa_buffer_attr attr;
+    attr.maxlength = static_cast<uint32_t>(-1);
+    attr.tlength = static_cast<uint32_t>(-1);
+    attr.prebuf = static_cast<uint32_t>(-1);
+    attr.minreq = static_cast<uint32_t>(-1);
+    attr.fragsize = fragmentBytes;
+
+    LOG_INFO(QString("开始音频捕获，源: %1，片段 %2 ms").arg(QString::fromUtf8(device)).arg(fragmentMs));
+    int errorCode = 0;
+    stream = pa_simple_new(nullptr, "MeetingAssistant", PA_STREAM_RECORD, device.constData(),
+                           "系统声音采集", &spec, nullptr, &attr, &errorCode);
+    if (!stream) {
+        LOG_ERROR(QString("无法连接声音服务的采集源 %1: %2")
+                  .arg(QString::fromUtf8(device), QString::fromUtf8(pa_strerror(errorCode))));
+        emit error("无法连接 PulseAudio/PipeWire 采集源");
+        return false;
+    }
+
+    FlightRecorder::record(FlightEventType::State, "capture.start");
+    capturing = true;
+    captureThread = std::thread(&PulseAudioCapture::captureLoop, this);
+    LOG_INFO("音频捕获已启动（16kHz/16bit/单声道，由声音服务转换）");
+    return true;
+}
+
+void PulseAudioCapture::stopCapture()
+{
+    if (!capturing.exchange(false) && !captureThread.joinable()) {
+        return;
+    }
+
+    LOG_INFO("停止音频捕获");
+    FlightRecorder::record(FlightEventType::State, "capture.stop");
+    // monitor 源一直有数据（静音时为 0），读取最多再阻塞一个片段
+    if (captureThread.joinable()) {
+        captureThread.join();
+    }
+    if (stream) {
+        pa_simple_free(stream);
+        stream = nullptr;
+    }
+    LOG_INFO("音频捕获已停止");
+}
+
+void PulseAudioCapture::captureLoop()
+{
+    const size_t fragmentFrames = static_cast<size_t>(kSampleRate * fragmentMs / 1000);
+    TaggedPcmBuffer<MemoryTag::Capture> buffer(fragmentFrames);
+    const quint64 fragmentUs = static_cast<quint64>(fragmentMs) * 1000;
+    // 读取本身是阻塞的，调度器只用来统计静音段和迟到的数据包
+    scheduler.reset(steadyNowUs());
+
+    while (capturing.load()) {
+        int errorCode = 0;
+        if (pa_simple_read(stream, buffer.data(), buffer.size() * sizeof(int16_t), &errorCode) < 0) {
+            LOG_ERROR(QString("读取音频失败: %1").arg(QString::fromUtf8(pa_strerror(errorCode))));
+            emit error("音频采集中断");
+            capturing = false;
+            break;
+        }
+
+        // 片段中第一帧的延迟 = 服务端尚未交付的数据 + 片段本身的时长
+        CapturePacket packet;
+        packet.frames = static_cast<uint32_t>(buffer.size());
+        const pa_usec_t serverLatency = pa_simple_get_latency(stream, &errorCode);
+        if (serverLatency != static_cast<pa_usec_t>(-1)) {
+            packet.latencyUs = static_cast<int64_t>(serverLatency + fragmentUs);
+            recordLatencyUs(static_cast<quint64>(packet.latencyUs));
+        }
+
+        bool silent = true;
+        for (int16_t sample : buffer) {
+            if (sample != 0) {
+                silent = false;
+                break;
+            }
+        }
+        packet.silent = silent;
+        scheduler.onPacket(packet, steadyNowUs());
+        countPacket(buffer.size(), silent);
+        FlightRecorder::record(FlightEventType::Counter, silent ? "capture.silent" : "capture.frames",
+                               static_cast<int64_t>(buffer.size()));
+
+        // 发出的数据包由接收方释放，只计入采集的分配量
+        MemoryAccounting::transient(MemoryTag::Capture, buffer.size() * sizeof(int16_t));
+        emit audioDataReceived(QByteArray(reinterpret_cast<const char *>(buffer.data()),
+                                          static_cast<int>(buffer.size() * sizeof(int16_t))));
+    }
+    scheduler.finish(steadyNowUs());
+}
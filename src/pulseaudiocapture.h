@@ -0,0 +1,36 @@
+#ifndef PULSEAUDIOCAPTURE_H
+#define PULSEAUDIOCAPTURE_H
+
+#include "audiocapture.h"
+#include <atomic>
+#include <thread>
+
+struct pa_simple;
+
+// Linux 系统声音采集：录制默认输出设备的 monitor 源（PulseAudio 或 PipeWire 的 pulse 兼容层）。
+// 直接向声音服务请求 16kHz/16bit/单声道，格式转换和重采样由服务完成，进程内不再处理。
+// 采集线程阻塞在 pa_simple_read 上，每读满一个片段（时长取延迟档位的轮询间隔）发出一次数据。
+class PulseAudioCapture : public AudioCapture
+{
+    Q_OBJECT
+
+public:
+    explicit PulseAudioCapture(QObject *parent = nullptr);
+    ~PulseAudioCapture() override;
+
+    bool startCapture() override;
+    void stopCapture() override;
+    bool isCapturing() const override { return capturing.load(); }
+
+    void setLatencyProfile(const LatencyProfile &profile) override;
+
+private:
+    void captureLoop();
+
+    pa_simple *stream;
+    std::thread captureThread;
+    std::atomic<bool> capturing;
+    int fragmentMs;
+};
+
+#endif // PULSEAUDIOCAPTURE_H
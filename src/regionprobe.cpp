@@ -0,0 +1,241 @@
+#include "regionprobe.h"
+#include "logger.h"
+#include "metrics.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QSettings>
+#include <QUrl>
+#include <algorithm>
+
+namespace {
+
+const int kDefaultTimeoutMs = 3000;
+const int kDefaultAttempts = 2;
+
+} // namespace
+
+RegionProbe::RegionProbe(QObject *parent)
+    : QObject(parent)
+    , networkManager(nullptr)
+    , endpointTemplate(defaultEndpointTemplate())
+    , regions(defaultRegions())
+    , timeoutMs(kDefaultTimeoutMs)
+    , attempts(kDefaultAttempts)
+    , pendingReplies(0)
+{
+}
+
+QString RegionProbe::defaultEndpointTemplate()
+{
+    return "https://{region}.api.cognitive.microsoft.com/sts/v1.0/issueToken";
+}
+
+QStringList RegionProbe::defaultRegions()
+{
+    return {"eastus", "westus2", "westeurope", "northeurope", "eastasia", "southeastasia",
+            "japaneast", "koreacentral", "centralindia", "australiaeast"};
+}
+
+void RegionProbe::configure(QSettings &settings)
+{
+    setEndpointTemplate(settings.value("Probe/Endpoint", defaultEndpointTemplate()).toString());
+    const QString regionList = settings.value("Probe/Regions").toString();
+    if (!regionList.trimmed().isEmpty()) {
+        setRegions(regionList.split(',', Qt::SkipEmptyParts));
+    }
+    setTimeoutMs(settings.value("Probe/TimeoutMs", kDefaultTimeoutMs).toInt());
+    setAttempts(settings.value("Probe/Attempts", kDefaultAttempts).toInt());
+}
+
+void RegionProbe::setEndpointTemplate(const QString &value)
+{
+    endpointTemplate = value.trimmed();
+}
+
+void RegionProbe::setRegions(const QStringList &list)
+{
+    regions.clear();
+    for (const QString &region : list) {
+        const QString trimmed = region.trimmed().toLower();
+        if (!trimmed.isEmpty() && !regions.contains(trimmed)) {
+            regions.append(trimmed);
+        }
+    }
+}
+
+void RegionProbe::setTimeoutMs(int ms)
+{
+    timeoutMs = qMax(500, ms);
+}
+
+void RegionProbe::setAttempts(int count)
+{
+    attempts = qBound(1, count, 5);
+}
+
+void RegionProbe::start(const QString &key)
+{
+    if (isRunning()) {
+        return;
+    }
+    subscriptionKey = key;
+    probeResults.clear();
+    attemptsLeft.clear();
+    for (const QString &region : regions) {
+        RegionProbeResult result;
+        result.region = region;
+        probeResults.append(result);
+        attemptsLeft.append(attempts);
+    }
+    if (probeResults.isEmpty()) {
+        // 和有请求时一样异步通知，调用方可以在 start() 之后再进入事件循环
+        QMetaObject::invokeMethod(this, [this]() { emit finished(QString()); }, Qt::QueuedConnection);
+        return;
+    }
+    if (!networkManager) {
+        networkManager = new QNetworkAccessManager(this);
+    }
+
+    LOG_INFO(QString("开始探测 %1 个区域").arg(probeResults.size()));
+    elapsed.start();
+    for (int i = 0; i < probeResults.size(); ++i) {
+        sendRequest(i);
+    }
+}
+
+void RegionProbe::sendRequest(int index)
+{
+    const QUrl url(QString(endpointTemplate).replace("{region}", probeResults[index].region));
+    QNetworkRequest request(url);
+    request.setRawHeader("Ocp-Apim-Subscription-Key", subscriptionKey.toUtf8());
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
+    request.setTransferTimeout(timeoutMs);
+
+    --attemptsLeft[index];
+    ++pendingReplies;
+    QElapsedTimer timer;
+    timer.start();
+    QNetworkReply *reply = networkManager->post(request, QByteArray());
+    connect(reply, &QNetworkReply::finished, this, [this, index, reply, timer]() {
+        handleReply(index, reply, timer.elapsed());
+    });
+}
+
+void RegionProbe::handleReply(int index, QNetworkReply *reply, qint64 elapsedMs)
+{
+    static MetricCounter &probeRequests = Metrics::counter("region_probe_requests_total", "区域探测发出的请求数");
+    probeRequests.add();
+    --pendingReplies;
+    reply->deleteLater();
+
+    RegionProbeResult &result = probeResults[index];
+    const QVariant status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute);
+    if (status.isValid()) {
+        // 401/403 也说明区域可达，只是密钥不属于该区域
+        // 任何一次返回 200 就说明密钥有效，之后的 429/5xx 不覆盖成功的结果
+        result.reachable = true;
+        const int httpStatus = status.toInt();
+        if (httpStatus == 200) {
+            result.authorized = true;
+            result.httpStatus = httpStatus;
+            result.errorString.clear();
+        } else if (!result.authorized) {
+            result.httpStatus = httpStatus;
+            result.errorString = reply->errorString();
+        }
+        result.latencyMs = result.latencyMs < 0 ? elapsedMs : qMin(result.latencyMs, elapsedMs);
+        // 复用已建立的连接再测一次
+        if (attemptsLeft[index] > 0) {
+            sendRequest(index);
+        }
+    } else if (!result.reachable) {
+        result.errorString = reply->errorString();
+    }
+
+    if (pendingReplies > 0) {
+        return;
+    }
+
+    const QString recommended = recommendedRegion();
+    LOG_INFO(QString("区域探测完成，耗时 %1 ms：%2").arg(elapsed.elapsed()).arg(summary()));
+    emit finished(recommended);
+}
+
+QString RegionProbe::recommendedRegion() const
+{
+    const RegionProbeResult *best = nullptr;
+    for (const RegionProbeResult &result : probeResults) {
+        if (result.authorized && (!best || result.latencyMs < best->latencyMs)) {
+            best = &result;
+        }
+    }
+    return best ? best->region : QString();
+}
+
+qint64 RegionProbe::latencyMs(const QString &region) const
+{
+    for (const RegionProbeResult &result : probeResults) {
+        if (result.region == region) {
+            return result.latencyMs;
+        }
+    }
+    return -1;
+}
+
+QString RegionProbe::summary() const
+{
+    QList<RegionProbeResult> sorted = probeResults;
+    std::stable_sort(sorted.begin(), sorted.end(), [](const RegionProbeResult &a, const RegionProbeResult &b) {
+        if (a.reachable != b.reachable) {
+            return a.reachable;
+        }
+        return a.latencyMs < b.latencyMs;
+    });
+    QStringList parts;
+    for (const RegionProbeResult &result : sorted) {
+        if (!result.reachable) {
+            parts.append(QString("%1 不可达").arg(result.region));
+        } else if (result.authorized) {
+            parts.append(QString("%1 %2 ms（密钥有效）").arg(result.region).arg(result.latencyMs));
+        } else {
+            parts.append(QString("%1 %2 ms").arg(result.region).arg(result.latencyMs));
+        }
+    }
+    return parts.join("，");
+}
+
+QString RegionProbe::keyDigest(const QString &key)
+{
+    return QString::fromLatin1(QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha256).toHex().left(16));
+}
+
+bool RegionProbe::loadCached(QSettings &settings, const QString &key, int ttlHours, QString &region, qint64 &latencyMs)
+{
+    settings.beginGroup("ProbeCache");
+    const QString digest = settings.value("KeyDigest").toString();
+    const QDateTime probedAt = QDateTime::fromString(settings.value("ProbedAt").toString(), Qt::ISODate);
+    const QString cachedRegion = settings.value("Region").toString();
+    const qint64 cachedLatency = settings.value("LatencyMs", -1).toLongLong();
+    settings.endGroup();
+
+    if (cachedRegion.isEmpty() || digest != keyDigest(key) || !probedAt.isValid()
+        || probedAt.secsTo(QDateTime::currentDateTimeUtc()) > static_cast<qint64>(ttlHours) * 3600) {
+        return false;
+    }
+    region = cachedRegion;
+    latencyMs = cachedLatency;
+    return true;
+}
+
+void RegionProbe::saveCached(QSettings &settings, const QString &key, const QString &region, qint64 latencyMs)
+{
+    settings.beginGroup("ProbeCache");
+    settings.setValue("KeyDigest", keyDigest(key));
+    settings.setValue("Region", region);
+    settings.setValue("LatencyMs", latencyMs);
+    settings.setValue("ProbedAt", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    settings.endGroup();
+}
@@ -0,0 +1,84 @@
+#ifndef REGIONPROBE_H
+#define REGIONPROBE_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+class QSettings;
+
+struct RegionProbeResult {
+    QString region;
+    bool reachable = false;     // 收到了 HTTP 响应
+    bool authorized = false;    // 密钥在该区域有效（令牌接口返回 200）
+    int httpStatus = 0;
+    qint64 latencyMs = -1;      // 各次请求中最短的往返时间
+    QString errorString;
+};
+
+// 区域探测：向候选区域的令牌接口（只签发访问令牌，不建立识别会话）并行发送请求，
+// 同时检查密钥和测量往返延迟。密钥只在所属资源的区域有效，因此推荐的是
+// 密钥有效的区域中延迟最低的一个；其他区域的延迟仅供参考。
+// 每个区域第一次请求包含建立连接的时间，之后的请求复用连接，取最短的一次作为延迟。
+//
+// 地址模板中的 {region} 替换为区域名，默认为 Azure 的令牌接口，
+// 可在 [Probe] Endpoint 中改为本地替身服务（如 http://127.0.0.1:8000/{region}/issueToken）。
+class RegionProbe : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RegionProbe(QObject *parent = nullptr);
+
+    static QString defaultEndpointTemplate();
+    static QStringList defaultRegions();
+
+    // 读取 [Probe] Endpoint / Regions / TimeoutMs / Attempts
+    void configure(QSettings &settings);
+    void setEndpointTemplate(const QString &endpointTemplate);
+    void setRegions(const QStringList &regions);
+    void setTimeoutMs(int ms);
+    void setAttempts(int count);
+    QStringList candidateRegions() const { return regions; }
+
+    void start(const QString &subscriptionKey);
+    bool isRunning() const { return pendingReplies > 0; }
+
+    QList<RegionProbeResult> results() const { return probeResults; }
+    // 密钥有效的区域中延迟最低的一个，没有时为空
+    QString recommendedRegion() const;
+    qint64 latencyMs(const QString &region) const;
+    QString summary() const;
+
+    // 探测结果缓存在配置文件的 [ProbeCache] 中，只保存密钥的摘要
+    static bool loadCached(QSettings &settings, const QString &subscriptionKey, int ttlHours,
+                           QString &region, qint64 &latencyMs);
+    static void saveCached(QSettings &settings, const QString &subscriptionKey,
+                           const QString &region, qint64 latencyMs);
+
+signals:
+    void finished(const QString &recommendedRegion);
+
+private:
+    void sendRequest(int index);
+    void handleReply(int index, QNetworkReply *reply, qint64 elapsedMs);
+    static QString keyDigest(const QString &subscriptionKey);
+
+    QNetworkAccessManager *networkManager;
+    QString endpointTemplate;
+    QStringList regions;
+    int timeoutMs;
+    int attempts;
+    QString subscriptionKey;
+
+    QList<RegionProbeResult> probeResults;
+    QList<int> attemptsLeft;
+    int pendingReplies;
+    QElapsedTimer elapsed;
+};
+
+#endif // REGIONPROBE_H
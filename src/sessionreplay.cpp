@@ -0,0 +1,248 @@
+#include "sessionreplay.h"
+#include "logger.h"
+#include "flightrecorder.h"
+#include <algorithm>
+#include <chrono>
+
+ReplayAudioCapture::ReplayAudioCapture(SessionReplay *replay, QObject *parent)
+    : AudioCapture(parent)
+    , replay(replay)
+{
+}
+
+ReplayAudioCapture::~ReplayAudioCapture()
+{
+    stopCapture();
+}
+
+bool ReplayAudioCapture::startCapture()
+{
+    FlightRecorder::record(FlightEventType::State, "capture.start");
+    replay->start();
+    return true;
+}
+
+void ReplayAudioCapture::stopCapture()
+{
+    if (replay->isRunning()) {
+        FlightRecorder::record(FlightEventType::State, "capture.stop");
+    }
+    replay->stop();
+}
+
+bool ReplayAudioCapture::isCapturing() const
+{
+    return replay->isRunning();
+}
+
+void ReplayAudioCapture::deliver(const char *pcm, size_t bytes)
+{
+    countPacket(bytes / sizeof(int16_t), false);
+    emit audioDataReceived(QByteArray(pcm, static_cast<int>(bytes)));
+}
+
+ReplaySpeechEngine::ReplaySpeechEngine(QObject *parent)
+    : SpeechEngine(parent)
+    , isRunning(false)
+{
+}
+
+void ReplaySpeechEngine::initialize(const QString &, const QString &)
+{
+    emit statusChanged("回放引擎就绪（不访问网络）");
+}
+
+void ReplaySpeechEngine::startRecognitionAndTranslation(const QString &, const QString &)
+{
+    isRunning = true;
+}
+
+void ReplaySpeechEngine::stopRecognitionAndTranslation()
+{
+    if (!isRunning) {
+        return;
+    }
+    isRunning = false;
+    emit sessionFinished();
+}
+
+void ReplaySpeechEngine::processAudioData(const QByteArray &)
+{
+    // 识别结果来自轨迹，音频只需要流经程序的其余部分
+}
+
+void ReplaySpeechEngine::finishAudioInput()
+{
+    isRunning = false;
+    QMetaObject::invokeMethod(this, &ReplaySpeechEngine::sessionFinished, Qt::QueuedConnection);
+}
+
+void ReplaySpeechEngine::reconfigure(const QString &sourceLanguage, const QString &targetLanguage)
+{
+    // 回放期间的语言切换以轨迹为准
+    LOG_INFO(QString("回放中忽略语言切换: %1 -> %2").arg(sourceLanguage, targetLanguage));
+}
+
+SessionReplay::SessionReplay(QObject *parent)
+    : QObject(parent)
+    , speedFactor(1.0)
+    , capture(nullptr)
+    , engine(nullptr)
+    , running(false)
+{
+}
+
+SessionReplay::~SessionReplay()
+{
+    stop();
+}
+
+bool SessionReplay::open(const QString &path)
+{
+    if (!reader.open(path.toUtf8().constData())) {
+        lastError = QString::fromStdString(reader.errorString());
+        return false;
+    }
+    tracePath = path;
+
+    // 开始时的语言来自第一条 Start 记录
+    SessionTraceEvent event;
+    while (reader.next(event)) {
+        if (event.type == SessionTraceType::Start) {
+            traceSourceLanguage = QString::fromUtf8(event.text, static_cast<int>(event.textLength));
+            traceTargetLanguage = QString::fromUtf8(event.translation, static_cast<int>(event.translationLength));
+            break;
+        }
+    }
+    reader.rewind();
+
+    LOG_INFO(QString("已加载会话轨迹 %1：%2 条记录，时长 %3 秒，语言 %4 -> %5")
+             .arg(path)
+             .arg(reader.recordCount())
+             .arg(durationSeconds(), 0, 'f', 1)
+             .arg(traceSourceLanguage, traceTargetLanguage));
+    return true;
+}
+
+void SessionReplay::setSpeed(double factor)
+{
+    speedFactor = qBound(0.1, factor, 1000.0);
+}
+
+AudioCapture *SessionReplay::createCapture(QObject *parent)
+{
+    capture = new ReplayAudioCapture(this, parent);
+    return capture;
+}
+
+SpeechEngine *SessionReplay::createEngine(QObject *parent)
+{
+    engine = new ReplaySpeechEngine(parent);
+    return engine;
+}
+
+void SessionReplay::start()
+{
+    stop();
+    if (!capture || !engine) {
+        LOG_ERROR("回放缺少采集或引擎");
+        return;
+    }
+    LOG_INFO(QString("开始回放 %1（%2 倍速）").arg(tracePath).arg(speedFactor));
+    running = true;
+    replayThread = std::thread(&SessionReplay::run, this);
+}
+
+void SessionReplay::stop()
+{
+    running = false;
+    if (replayThread.joinable()) {
+        replayThread.join();
+    }
+}
+
+void SessionReplay::run()
+{
+    using Clock = std::chrono::steady_clock;
+
+    reader.rewind();
+    const Clock::time_point begin = Clock::now();
+    quint64 audioPackets = 0;
+    quint64 results = 0;
+    quint64 dispatched = 0;
+    qint64 totalLagUs = 0;
+    qint64 maxLagUs = 0;
+    bool completed = true;
+
+    SessionTraceEvent event;
+    while (reader.next(event)) {
+        const Clock::time_point due = begin + std::chrono::microseconds(
+                static_cast<qint64>(event.timeUs / speedFactor));
+        // 分段等待，停止时不必等到下一条记录
+        Clock::time_point now = Clock::now();
+        while (running.load() && now < due) {
+            std::this_thread::sleep_until(std::min(due, now + std::chrono::milliseconds(50)));
+            now = Clock::now();
+        }
+        if (!running.load()) {
+            completed = false;
+            break;
+        }
+
+        // 实际投递时刻比轨迹晚多少：回放线程被挤占或接收方处理不过来时变大
+        const qint64 lagUs = std::chrono::duration_cast<std::chrono::microseconds>(now - due).count();
+        totalLagUs += lagUs;
+        maxLagUs = std::max(maxLagUs, lagUs);
+        ++dispatched;
+
+        switch (event.type) {
+        case SessionTraceType::Audio:
+            capture->deliver(event.data, event.dataLength);
+            ++audioPackets;
+            break;
+        case SessionTraceType::Partial:
+        case SessionTraceType::Final: {
+            RecognitionEvent result;
+            result.kind = event.type == SessionTraceType::Final ? RecognitionEvent::Final : RecognitionEvent::Partial;
+            result.hasTranslation = (event.flags & kSessionTraceHasTranslation) != 0;
+            result.offsetMs = event.offsetMs;
+            result.durationMs = event.durationMs;
+            result.text = QString::fromUtf8(event.text, static_cast<int>(event.textLength));
+            result.translation = QString::fromUtf8(event.translation, static_cast<int>(event.translationLength));
+            engine->deliverResult(std::move(result));
+            ++results;
+            break;
+        }
+        case SessionTraceType::Reconfigure:
+            engine->deliverStatus(QString("切换语言: %1 -> %2")
+                                  .arg(QString::fromUtf8(event.text, static_cast<int>(event.textLength)),
+                                       QString::fromUtf8(event.translation, static_cast<int>(event.translationLength))));
+            break;
+        case SessionTraceType::Status:
+            engine->deliverStatus(QString::fromUtf8(event.text, static_cast<int>(event.textLength)));
+            break;
+        case SessionTraceType::Error:
+            engine->deliverError(QString::fromUtf8(event.text, static_cast<int>(event.textLength)));
+            break;
+        case SessionTraceType::Start:
+        case SessionTraceType::Stop:
+            break;
+        }
+    }
+
+    const double wallSeconds = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - begin).count() / 1000.0;
+    const double traceSeconds = event.timeUs / 1e6;
+    const QString report = QString("回放%1：轨迹 %2 秒，用时 %3 秒（%4 倍速），音频包 %5 个，识别结果 %6 条，"
+                                   "投递滞后平均 %7 ms，最大 %8 ms")
+            .arg(completed ? "完成" : "中止")
+            .arg(traceSeconds, 0, 'f', 1)
+            .arg(wallSeconds, 0, 'f', 1)
+            .arg(wallSeconds > 0 ? traceSeconds / wallSeconds : 0, 0, 'f', 2)
+            .arg(audioPackets)
+            .arg(results)
+            .arg(dispatched > 0 ? totalLagUs / 1000.0 / dispatched : 0, 0, 'f', 2)
+            .arg(maxLagUs / 1000.0, 0, 'f', 2);
+    LOG_INFO(report);
+    running = false;
+    emit finished(report);
+}
@@ -0,0 +1,110 @@
+#ifndef SESSIONREPLAY_H
+#define SESSIONREPLAY_H
+
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include <thread>
+#include "audiocapture.h"
+#include "speechengine.h"
+#include "sessiontrace.h"
+
+class SessionReplay;
+
+// 回放时代替系统声音采集：在回放线程中按记录的时间发出原始数据包，和真实采集线程一样
+class ReplayAudioCapture : public AudioCapture
+{
+    Q_OBJECT
+
+public:
+    explicit ReplayAudioCapture(SessionReplay *replay, QObject *parent = nullptr);
+    ~ReplayAudioCapture() override;
+
+    bool startCapture() override;
+    void stopCapture() override;
+    bool isCapturing() const override;
+    void setLatencyProfile(const LatencyProfile &) override {}
+
+    // 回放线程调用
+    void deliver(const char *pcm, size_t bytes);
+
+private:
+    SessionReplay *replay;
+};
+
+// 回放时代替语音服务：忽略送入的音频，按记录的时间投递识别结果、状态和错误
+class ReplaySpeechEngine : public SpeechEngine
+{
+    Q_OBJECT
+
+public:
+    explicit ReplaySpeechEngine(QObject *parent = nullptr);
+
+    void initialize(const QString &subscriptionKey, const QString &region) override;
+    void startRecognitionAndTranslation(const QString &sourceLanguage, const QString &targetLanguage) override;
+    void stopRecognitionAndTranslation() override;
+    void processAudioData(const QByteArray &audioData) override;
+    void finishAudioInput() override;
+    void reconfigure(const QString &sourceLanguage, const QString &targetLanguage) override;
+
+    // 回放线程调用
+    void deliverResult(RecognitionEvent &&event) { postResult(std::move(event)); }
+    void deliverStatus(const QString &status) { emit statusChanged(status); }
+    void deliverError(const QString &message) { emit error(message); }
+
+private:
+    bool isRunning;
+};
+
+// 会话回放：读取 SessionTraceWriter 记录的轨迹，按原来的时间间隔（可加速）
+// 把音频包交给 ReplayAudioCapture、把识别事件交给 ReplaySpeechEngine，
+// 程序其余部分（结果分发、术语表、节流、界面）照常运行，不访问网络。
+// 回放在采集开始时启动，轨迹结束或采集停止时结束，结束时发出 finished 报告时序偏差。
+class SessionReplay : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SessionReplay(QObject *parent = nullptr);
+    ~SessionReplay() override;
+
+    bool open(const QString &path);
+    QString errorString() const { return lastError; }
+    QString path() const { return tracePath; }
+
+    // 相对原始速度的倍数，1 为实时
+    void setSpeed(double factor);
+    double speed() const { return speedFactor; }
+
+    // 轨迹中记录的开始时的语言
+    QString sourceLanguage() const { return traceSourceLanguage; }
+    QString targetLanguage() const { return traceTargetLanguage; }
+    double durationSeconds() const { return reader.durationUs() / 1e6; }
+
+    // 创建回放用的采集和引擎，它们只能在回放对象之前销毁
+    AudioCapture *createCapture(QObject *parent = nullptr);
+    SpeechEngine *createEngine(QObject *parent = nullptr);
+
+    void start();
+    void stop();
+    bool isRunning() const { return running.load(); }
+
+signals:
+    void finished(const QString &report);
+
+private:
+    void run();
+
+    SessionTraceReader reader;
+    QString tracePath;
+    QString lastError;
+    QString traceSourceLanguage;
+    QString traceTargetLanguage;
+    double speedFactor;
+    ReplayAudioCapture *capture;
+    ReplaySpeechEngine *engine;
+    std::thread replayThread;
+    std::atomic<bool> running;
+};
+
+#endif // SESSIONREPLAY_H
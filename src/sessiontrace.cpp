@@ -0,0 +1,484 @@
+#include "sessiontrace.h"
+#include <chrono>
+#include <cstring>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const uint64_t kInitialFileSize = 16ull << 20;
+const uint64_t kMaxGrowStep = 256ull << 20;
+
+uint64_t steadyNowUs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+size_t align8(size_t n)
+{
+    return (n + 7) & ~static_cast<size_t>(7);
+}
+
+} // namespace
+
+// 平台相关的文件映射：写入方可扩展文件并重新映射，读取方只读映射整个文件
+class SessionTraceFile
+{
+public:
+    ~SessionTraceFile() { close(0); }
+
+    bool create(const char *utf8Path, uint64_t size)
+    {
+#ifdef _WIN32
+        fileHandle = CreateFileW(widen(utf8Path).c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ,
+                                 nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (fileHandle == INVALID_HANDLE_VALUE) {
+            fileHandle = nullptr;
+            return false;
+        }
+#else
+        fd = ::open(utf8Path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            return false;
+        }
+#endif
+        writable = true;
+        return map(size);
+    }
+
+    bool openReadOnly(const char *utf8Path)
+    {
+#ifdef _WIN32
+        fileHandle = CreateFileW(widen(utf8Path).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                 nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (fileHandle == INVALID_HANDLE_VALUE) {
+            fileHandle = nullptr;
+            return false;
+        }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(fileHandle, &size) || size.QuadPart == 0) {
+            return false;
+        }
+        return map(static_cast<uint64_t>(size.QuadPart));
+#else
+        fd = ::open(utf8Path, O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            return false;
+        }
+        return map(static_cast<uint64_t>(st.st_size));
+#endif
+    }
+
+    // 扩展到 size 字节并重新映射，原有内容保留
+    bool grow(uint64_t size)
+    {
+        unmap();
+        return map(size);
+    }
+
+    // 写入方关闭时把文件截到 finalSize（为 0 则不截断）
+    void close(uint64_t finalSize)
+    {
+        unmap();
+#ifdef _WIN32
+        if (fileHandle) {
+            if (writable && finalSize > 0) {
+                LARGE_INTEGER end;
+                end.QuadPart = static_cast<LONGLONG>(finalSize);
+                SetFilePointerEx(fileHandle, end, nullptr, FILE_BEGIN);
+                SetEndOfFile(fileHandle);
+            }
+            CloseHandle(fileHandle);
+            fileHandle = nullptr;
+        }
+#else
+        if (fd >= 0) {
+            if (writable && finalSize > 0 && ftruncate(fd, static_cast<off_t>(finalSize)) != 0) {
+                // 截断失败时保留预分配的尾部，读取方按 usedBytes 读取
+            }
+            ::close(fd);
+            fd = -1;
+        }
+#endif
+        writable = false;
+    }
+
+    char *data() const { return static_cast<char *>(view); }
+    uint64_t size() const { return mappedSize; }
+
+private:
+    bool map(uint64_t size)
+    {
+#ifdef _WIN32
+        const DWORD protect = writable ? PAGE_READWRITE : PAGE_READONLY;
+        // 写入方的映射大小超过文件长度时，系统会自动扩展文件
+        mappingHandle = CreateFileMappingW(fileHandle, nullptr, protect,
+                                           static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), nullptr);
+        if (!mappingHandle) {
+            return false;
+        }
+        view = MapViewOfFile(mappingHandle, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, static_cast<SIZE_T>(size));
+#else
+        if (writable && ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            return false;
+        }
+        view = mmap(nullptr, static_cast<size_t>(size), writable ? PROT_READ | PROT_WRITE : PROT_READ,
+                    MAP_SHARED, fd, 0);
+        if (view == MAP_FAILED) {
+            view = nullptr;
+        }
+#endif
+        mappedSize = view ? size : 0;
+        return view != nullptr;
+    }
+
+    void unmap()
+    {
+#ifdef _WIN32
+        if (view) {
+            UnmapViewOfFile(view);
+        }
+        if (mappingHandle) {
+            CloseHandle(mappingHandle);
+            mappingHandle = nullptr;
+        }
+#else
+        if (view) {
+            munmap(view, static_cast<size_t>(mappedSize));
+        }
+#endif
+        view = nullptr;
+        mappedSize = 0;
+    }
+
+#ifdef _WIN32
+    static std::wstring widen(const char *utf8)
+    {
+        const int n = MultiByteToWideChar(CP_UTF8, 0, utf8, -1, nullptr, 0);
+        if (n <= 0) {
+            return std::wstring();
+        }
+        std::wstring result(static_cast<size_t>(n), L'\0');
+        MultiByteToWideChar(CP_UTF8, 0, utf8, -1, &result[0], n);
+        result.resize(static_cast<size_t>(n - 1));
+        return result;
+    }
+
+    HANDLE fileHandle = nullptr;
+    HANDLE mappingHandle = nullptr;
+#else
+    int fd = -1;
+#endif
+    bool writable = false;
+    void *view = nullptr;
+    uint64_t mappedSize = 0;
+};
+
+SessionTraceWriter::SessionTraceWriter()
+    : file(nullptr)
+    , startUs(0)
+    , writeOffset(0)
+    , recordCount(0)
+{
+}
+
+SessionTraceWriter::~SessionTraceWriter()
+{
+    close();
+}
+
+bool SessionTraceWriter::open(const char *utf8Path)
+{
+    close();
+    std::lock_guard<std::mutex> lock(mutex);
+
+    SessionTraceFile *created = new SessionTraceFile;
+    if (!created->create(utf8Path, kInitialFileSize)) {
+        delete created;
+        return false;
+    }
+    file = created;
+
+    SessionTraceHeader *header = reinterpret_cast<SessionTraceHeader *>(file->data());
+    std::memset(header, 0, sizeof(SessionTraceHeader));
+    std::memcpy(header->magic, "MATR", 4);
+    header->version = kSessionTraceVersion;
+    header->headerSize = sizeof(SessionTraceHeader);
+    header->sampleRate = 16000;
+    header->startTimeUnixMs = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count());
+    startUs = steadyNowUs();
+    writeOffset = sizeof(SessionTraceHeader);
+    recordCount = 0;
+    return true;
+}
+
+void SessionTraceWriter::close()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!file) {
+        return;
+    }
+    reinterpret_cast<SessionTraceHeader *>(file->data())->usedBytes = writeOffset;
+    file->close(writeOffset);
+    delete file;
+    file = nullptr;
+}
+
+bool SessionTraceWriter::isOpen() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return file != nullptr;
+}
+
+uint64_t SessionTraceWriter::elapsedUs() const
+{
+    return steadyNowUs() - startUs;
+}
+
+char *SessionTraceWriter::beginRecord(SessionTraceType type, uint16_t flags, size_t payloadBytes)
+{
+    if (!file) {
+        return nullptr;
+    }
+    const size_t recordBytes = align8(sizeof(SessionTraceRecord) + payloadBytes);
+    // 末尾始终留出一条空记录头作为结束标记
+    const uint64_t needed = writeOffset + recordBytes + sizeof(SessionTraceRecord);
+    if (needed > file->size()) {
+        uint64_t newSize = file->size();
+        while (newSize < needed) {
+            newSize += newSize < kMaxGrowStep ? newSize : kMaxGrowStep;
+        }
+        if (!file->grow(newSize)) {
+            // 磁盘满或地址空间不足：停止记录，已写入的部分仍可回放
+            file->close(writeOffset);
+            delete file;
+            file = nullptr;
+            return nullptr;
+        }
+    }
+
+    char *p = file->data() + writeOffset;
+    SessionTraceRecord *record = reinterpret_cast<SessionTraceRecord *>(p);
+    record->size = static_cast<uint32_t>(recordBytes);
+    record->type = static_cast<uint16_t>(type);
+    record->flags = flags;
+    record->timeUs = elapsedUs();
+    writeOffset += recordBytes;
+    ++recordCount;
+    return p + sizeof(SessionTraceRecord);
+}
+
+void SessionTraceWriter::writeAudio(const void *pcm, size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    const uint16_t padding = static_cast<uint16_t>(align8(sizeof(SessionTraceRecord) + bytes)
+                                                   - sizeof(SessionTraceRecord) - bytes);
+    char *payload = beginRecord(SessionTraceType::Audio, padding, bytes);
+    if (payload && bytes > 0) {
+        std::memcpy(payload, pcm, bytes);
+    }
+}
+
+void SessionTraceWriter::writeResult(bool isFinal, bool hasTranslation, int64_t offsetMs, int64_t durationMs,
+                                     const char *text, size_t textLength,
+                                     const char *translation, size_t translationLength)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    char *payload = beginRecord(isFinal ? SessionTraceType::Final : SessionTraceType::Partial,
+                                hasTranslation ? kSessionTraceHasTranslation : 0,
+                                sizeof(SessionTraceResult) + textLength + translationLength);
+    if (!payload) {
+        return;
+    }
+    SessionTraceResult result;
+    result.offsetMs = offsetMs;
+    result.durationMs = durationMs;
+    result.textLength = static_cast<uint32_t>(textLength);
+    result.translationLength = static_cast<uint32_t>(translationLength);
+    std::memcpy(payload, &result, sizeof(result));
+    payload += sizeof(result);
+    if (textLength > 0) {
+        std::memcpy(payload, text, textLength);
+    }
+    if (translationLength > 0) {
+        std::memcpy(payload + textLength, translation, translationLength);
+    }
+}
+
+void SessionTraceWriter::writeStrings(SessionTraceType type, const char *first, size_t firstLength,
+                                      const char *second, size_t secondLength)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    char *payload = beginRecord(type, 0, sizeof(SessionTraceStrings) + firstLength + secondLength);
+    if (!payload) {
+        return;
+    }
+    SessionTraceStrings strings;
+    strings.firstLength = static_cast<uint32_t>(firstLength);
+    strings.secondLength = static_cast<uint32_t>(secondLength);
+    std::memcpy(payload, &strings, sizeof(strings));
+    payload += sizeof(strings);
+    if (firstLength > 0) {
+        std::memcpy(payload, first, firstLength);
+    }
+    if (secondLength > 0) {
+        std::memcpy(payload + firstLength, second, secondLength);
+    }
+}
+
+void SessionTraceWriter::writeStop()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    beginRecord(SessionTraceType::Stop, 0, 0);
+}
+
+SessionTraceReader::SessionTraceReader()
+    : file(nullptr)
+    , fileHeader(nullptr)
+    , base(nullptr)
+    , endOffset(0)
+    , readOffset(0)
+    , lastTimeUs(0)
+    , totalRecords(0)
+{
+}
+
+SessionTraceReader::~SessionTraceReader()
+{
+    close();
+}
+
+bool SessionTraceReader::open(const char *utf8Path)
+{
+    close();
+
+    SessionTraceFile *opened = new SessionTraceFile;
+    if (!opened->openReadOnly(utf8Path)) {
+        delete opened;
+        lastError = "无法打开轨迹文件";
+        return false;
+    }
+    const SessionTraceHeader *h = reinterpret_cast<const SessionTraceHeader *>(opened->data());
+    if (opened->size() < sizeof(SessionTraceHeader) || std::memcmp(h->magic, "MATR", 4) != 0) {
+        delete opened;
+        lastError = "不是会话轨迹文件";
+        return false;
+    }
+    if (h->version != kSessionTraceVersion || h->headerSize != sizeof(SessionTraceHeader)) {
+        delete opened;
+        lastError = "轨迹文件版本不受支持";
+        return false;
+    }
+
+    file = opened;
+    fileHeader = h;
+    base = file->data();
+    endOffset = h->usedBytes > 0 && h->usedBytes <= file->size() ? h->usedBytes : file->size();
+
+    // 先扫描一遍得到记录数和总时长，也顺便确定未正常关闭的文件的实际结尾
+    rewind();
+    SessionTraceEvent event;
+    while (next(event)) {
+        ++totalRecords;
+        lastTimeUs = event.timeUs;
+    }
+    endOffset = readOffset;
+    rewind();
+    lastError.clear();
+    return true;
+}
+
+void SessionTraceReader::close()
+{
+    delete file;
+    file = nullptr;
+    fileHeader = nullptr;
+    base = nullptr;
+    endOffset = 0;
+    readOffset = 0;
+    lastTimeUs = 0;
+    totalRecords = 0;
+}
+
+bool SessionTraceReader::next(SessionTraceEvent &event)
+{
+    if (!base || readOffset + sizeof(SessionTraceRecord) > endOffset) {
+        return false;
+    }
+    SessionTraceRecord record;
+    std::memcpy(&record, base + readOffset, sizeof(record));
+    if (record.size < sizeof(SessionTraceRecord) || readOffset + record.size > endOffset) {
+        return false;
+    }
+
+    const char *payload = base + readOffset + sizeof(SessionTraceRecord);
+    const size_t payloadBytes = record.size - sizeof(SessionTraceRecord);
+    event = SessionTraceEvent();
+    event.type = static_cast<SessionTraceType>(record.type);
+    event.flags = record.flags;
+    event.timeUs = record.timeUs;
+
+    switch (event.type) {
+    case SessionTraceType::Audio:
+        event.data = payload;
+        event.dataLength = payloadBytes >= record.flags ? payloadBytes - record.flags : 0;
+        break;
+    case SessionTraceType::Partial:
+    case SessionTraceType::Final: {
+        SessionTraceResult result;
+        if (payloadBytes < sizeof(result)) {
+            return false;
+        }
+        std::memcpy(&result, payload, sizeof(result));
+        if (sizeof(result) + result.textLength + result.translationLength > payloadBytes) {
+            return false;
+        }
+        event.offsetMs = result.offsetMs;
+        event.durationMs = result.durationMs;
+        event.text = payload + sizeof(result);
+        event.textLength = result.textLength;
+        event.translation = event.text + result.textLength;
+        event.translationLength = result.translationLength;
+        break;
+    }
+    case SessionTraceType::Start:
+    case SessionTraceType::Reconfigure:
+    case SessionTraceType::Status:
+    case SessionTraceType::Error: {
+        SessionTraceStrings strings;
+        if (payloadBytes < sizeof(strings)) {
+            return false;
+        }
+        std::memcpy(&strings, payload, sizeof(strings));
+        if (sizeof(strings) + strings.firstLength + strings.secondLength > payloadBytes) {
+            return false;
+        }
+        event.text = payload + sizeof(strings);
+        event.textLength = strings.firstLength;
+        event.translation = event.text + strings.firstLength;
+        event.translationLength = strings.secondLength;
+        break;
+    }
+    case SessionTraceType::Stop:
+        break;
+    default:
+        // 未知类型（新版本写入）：跳过
+        break;
+    }
+
+    readOffset += record.size;
+    return true;
+}
@@ -0,0 +1,165 @@
+#ifndef SESSIONTRACE_H
+#define SESSIONTRACE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+// 会话轨迹：一次真实会话中采集到的每个音频包和识别器的每个事件，按单调时间顺序写入一个
+// 内存映射文件，回放时（见 SessionReplay）按原来的时间间隔重新驱动整个程序，不需要网络。
+// 本头文件和 sessiontrace.cpp 不依赖 Qt。
+//
+// 文件布局（版本 1，小端）：
+//   [0, 64)    SessionTraceHeader
+//   [64, ...)  变长记录，每条以 SessionTraceRecord 开头，总长度按 8 字节对齐
+// 写入时文件按块预先扩展，正常关闭时截到实际长度并写入 usedBytes；
+// 异常退出时 usedBytes 为 0，读取方扫描到长度为 0 的记录为止。
+//
+// 各类记录的内容：
+//   Audio       16kHz/16bit/单声道 PCM，即采集线程发出的原始数据包
+//   Partial     SessionTraceResult + text + translation（UTF-8，不以 0 结尾）
+//   Final       同上
+//   Start       SessionTraceStrings：源语言 + 目标语言
+//   Reconfigure 同上（识别中切换语言）
+//   Status      SessionTraceStrings：状态文本
+//   Error       同上
+//   Stop        无内容
+
+const uint32_t kSessionTraceVersion = 1;
+
+enum class SessionTraceType : uint16_t {
+    Audio = 1,
+    Partial = 2,
+    Final = 3,
+    Start = 4,
+    Reconfigure = 5,
+    Status = 6,
+    Error = 7,
+    Stop = 8
+};
+
+struct SessionTraceHeader {
+    char magic[4];              // "MATR"
+    uint32_t version;
+    uint32_t headerSize;        // 64
+    uint32_t sampleRate;        // 16000
+    uint64_t startTimeUnixMs;   // 开始记录时的系统时间
+    uint64_t usedBytes;         // 正常关闭时写入的文件长度，0 表示未正常关闭
+    char reserved[32];
+};
+static_assert(sizeof(SessionTraceHeader) == 64, "SessionTraceHeader 布局变化需要同步修改版本号");
+
+struct SessionTraceRecord {
+    uint32_t size;              // 含本结构的记录总长度（8 字节对齐），0 表示结束
+    uint16_t type;              // SessionTraceType
+    uint16_t flags;             // 识别结果：bit0 表示带翻译；音频：末尾的对齐填充字节数
+    uint64_t timeUs;            // 相对开始记录的单调时间
+};
+static_assert(sizeof(SessionTraceRecord) == 16, "SessionTraceRecord 布局变化需要同步修改版本号");
+
+const uint16_t kSessionTraceHasTranslation = 1;
+
+struct SessionTraceResult {
+    int64_t offsetMs;
+    int64_t durationMs;
+    uint32_t textLength;
+    uint32_t translationLength;
+};
+
+struct SessionTraceStrings {
+    uint32_t firstLength;
+    uint32_t secondLength;
+};
+
+class SessionTraceFile;
+
+// 写入方：各方法可在任意线程调用（内部加锁，每条记录只做一次内存复制）
+class SessionTraceWriter
+{
+public:
+    SessionTraceWriter();
+    ~SessionTraceWriter();
+
+    bool open(const char *utf8Path);
+    void close();
+    bool isOpen() const;
+
+    // 相对开始记录的单调时间（微秒）
+    uint64_t elapsedUs() const;
+
+    void writeAudio(const void *pcm, size_t bytes);
+    void writeResult(bool isFinal, bool hasTranslation, int64_t offsetMs, int64_t durationMs,
+                     const char *text, size_t textLength, const char *translation, size_t translationLength);
+    void writeStrings(SessionTraceType type, const char *first, size_t firstLength,
+                      const char *second = nullptr, size_t secondLength = 0);
+    void writeStop();
+
+    uint64_t records() const { return recordCount; }
+    uint64_t bytes() const { return writeOffset; }
+
+private:
+    SessionTraceWriter(const SessionTraceWriter &) = delete;
+    SessionTraceWriter &operator=(const SessionTraceWriter &) = delete;
+
+    // 预留一条记录的空间并写好记录头，返回内容区的指针；空间不足时扩展文件
+    char *beginRecord(SessionTraceType type, uint16_t flags, size_t payloadBytes);
+
+    mutable std::mutex mutex;
+    SessionTraceFile *file;
+    uint64_t startUs;
+    uint64_t writeOffset;
+    uint64_t recordCount;
+};
+
+// 一条已解析的记录，指针指向映射内存，读取方关闭前有效
+struct SessionTraceEvent {
+    SessionTraceType type = SessionTraceType::Stop;
+    uint16_t flags = 0;
+    uint64_t timeUs = 0;
+    const char *data = nullptr;         // Audio 的 PCM
+    size_t dataLength = 0;
+    int64_t offsetMs = 0;
+    int64_t durationMs = 0;
+    const char *text = nullptr;         // 识别文本或第一个字符串
+    size_t textLength = 0;
+    const char *translation = nullptr;  // 翻译或第二个字符串
+    size_t translationLength = 0;
+};
+
+// 读取方：只读映射整个文件，顺序遍历
+class SessionTraceReader
+{
+public:
+    SessionTraceReader();
+    ~SessionTraceReader();
+
+    // 文件不存在、不是轨迹文件或版本不符时返回 false，原因见 errorString()
+    bool open(const char *utf8Path);
+    void close();
+
+    const SessionTraceHeader &header() const { return *fileHeader; }
+    const std::string &errorString() const { return lastError; }
+    // 记录总时长（最后一条记录的时间）
+    uint64_t durationUs() const { return lastTimeUs; }
+    uint64_t recordCount() const { return totalRecords; }
+
+    void rewind() { readOffset = sizeof(SessionTraceHeader); }
+    // 取下一条记录，到达末尾返回 false
+    bool next(SessionTraceEvent &event);
+
+private:
+    SessionTraceReader(const SessionTraceReader &) = delete;
+    SessionTraceReader &operator=(const SessionTraceReader &) = delete;
+
+    SessionTraceFile *file;
+    const SessionTraceHeader *fileHeader;
+    const char *base;
+    uint64_t endOffset;
+    uint64_t readOffset;
+    uint64_t lastTimeUs;
+    uint64_t totalRecords;
+    std::string lastError;
+};
+
+#endif // SESSIONTRACE_H
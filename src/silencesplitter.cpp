@@ -0,0 +1,157 @@
+#include "silencesplitter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+namespace {
+
+// 硬切时按 100ms 的平均能量找最安静的位置，避免切在音节之间的短暂停顿上
+const size_t kQuietWindowFrames = 10;
+
+struct SilenceRun {
+    int64_t startMs;
+    int64_t endMs;
+    // 对齐到帧，切点两侧的帧划分与整段处理时相同
+    int64_t midMs() const { return (startMs + endMs) / 2 / kSplitFrameMs * kSplitFrameMs; }
+    int64_t lengthMs() const { return endMs - startMs; }
+};
+
+std::vector<SilenceRun> findSilenceRuns(const std::vector<float> &frameRms, double threshold, int64_t minSilenceMs)
+{
+    std::vector<SilenceRun> runs;
+    size_t runStart = 0;
+    bool inRun = false;
+    for (size_t i = 0; i <= frameRms.size(); ++i) {
+        const bool silent = i < frameRms.size() && frameRms[i] < threshold;
+        if (silent && !inRun) {
+            inRun = true;
+            runStart = i;
+        } else if (!silent && inRun) {
+            inRun = false;
+            const SilenceRun run{static_cast<int64_t>(runStart) * kSplitFrameMs, static_cast<int64_t>(i) * kSplitFrameMs};
+            if (run.lengthMs() >= minSilenceMs) {
+                runs.push_back(run);
+            }
+        }
+    }
+    return runs;
+}
+
+int64_t quietestPointMs(const std::vector<float> &frameRms, int64_t loMs, int64_t hiMs)
+{
+    const size_t first = static_cast<size_t>(loMs / kSplitFrameMs);
+    const size_t last = std::min(static_cast<size_t>(hiMs / kSplitFrameMs), frameRms.size());
+    if (first + kQuietWindowFrames > last) {
+        return hiMs;
+    }
+    double sum = 0;
+    for (size_t i = first; i < first + kQuietWindowFrames; ++i) {
+        sum += frameRms[i];
+    }
+    double bestSum = sum;
+    size_t bestStart = first;
+    for (size_t i = first + kQuietWindowFrames; i < last; ++i) {
+        sum += frameRms[i] - frameRms[i - kQuietWindowFrames];
+        const size_t start = i - kQuietWindowFrames + 1;
+        if (sum < bestSum) {
+            bestSum = sum;
+            bestStart = start;
+        }
+    }
+    return static_cast<int64_t>(bestStart + kQuietWindowFrames / 2) * kSplitFrameMs;
+}
+
+} // namespace
+
+void FrameEnergyMeter::add(const int16_t *data, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        const double sample = data[i];
+        energy += sample * sample;
+        if (++frameFill == kSplitFrameSamples) {
+            frameRms.push_back(static_cast<float>(std::sqrt(energy / kSplitFrameSamples)));
+            energy = 0;
+            frameFill = 0;
+        }
+    }
+    samples += count;
+}
+
+void FrameEnergyMeter::finish()
+{
+    if (frameFill > 0) {
+        frameRms.push_back(static_cast<float>(std::sqrt(energy / frameFill)));
+        energy = 0;
+        frameFill = 0;
+    }
+}
+
+double estimateSilenceRms(const std::vector<float> &frameRms)
+{
+    if (frameRms.empty()) {
+        return 0;
+    }
+    std::vector<float> sorted(frameRms);
+    const size_t tenth = sorted.size() / 10;
+    std::nth_element(sorted.begin(), sorted.begin() + tenth, sorted.end());
+    // 数字静音的噪声底为 0，至少取约 -47 dBFS；背景声很大时最多取约 -30 dBFS
+    return std::min(std::max(sorted[tenth] * 2.0, 150.0), 1000.0);
+}
+
+std::vector<AudioChunk> splitOnSilence(const std::vector<float> &frameRms, int64_t durationMs,
+                                       const SilenceSplitOptions &options, double *thresholdUsed)
+{
+    const double threshold = options.silenceRms > 0 ? options.silenceRms : estimateSilenceRms(frameRms);
+    if (thresholdUsed) {
+        *thresholdUsed = threshold;
+    }
+    const int64_t targetMs = std::max<int64_t>(options.targetChunkMs, 1000);
+    const int64_t maxMs = std::max(options.maxChunkMs, targetMs);
+    const int64_t overlapMs = std::max<int64_t>(options.overlapMs, 0);
+    const std::vector<SilenceRun> runs = findSilenceRuns(frameRms, threshold, std::max<int64_t>(options.minSilenceMs, kSplitFrameMs));
+
+    std::vector<AudioChunk> chunks;
+    int64_t start = 0;
+    bool previousForced = false;
+    size_t runIndex = 0;
+    while (durationMs - start > maxMs) {
+        const int64_t lo = start + targetMs / 2;
+        const int64_t hi = start + maxMs;
+        const int64_t ideal = start + targetMs;
+
+        // 范围内最长的静音，一样长时取离目标长度最近的
+        while (runIndex < runs.size() && runs[runIndex].midMs() < lo) {
+            ++runIndex;
+        }
+        const SilenceRun *best = nullptr;
+        for (size_t i = runIndex; i < runs.size() && runs[i].midMs() <= hi; ++i) {
+            if (!best || runs[i].lengthMs() > best->lengthMs()
+                || (runs[i].lengthMs() == best->lengthMs()
+                    && std::llabs(runs[i].midMs() - ideal) < std::llabs(best->midMs() - ideal))) {
+                best = &runs[i];
+            }
+        }
+
+        AudioChunk chunk;
+        chunk.forcedCut = best == nullptr;
+        const int64_t cut = best ? best->midMs() : quietestPointMs(frameRms, lo, hi);
+        chunk.ownStartMs = start;
+        chunk.ownEndMs = cut;
+        chunk.audioStartMs = previousForced ? std::max<int64_t>(start - overlapMs, 0) : start;
+        chunk.audioEndMs = chunk.forcedCut ? std::min(cut + overlapMs, durationMs) : cut;
+        chunks.push_back(chunk);
+
+        start = cut;
+        previousForced = chunk.forcedCut;
+    }
+
+    // 最后一段拥有之后的所有结果（识别器报告的结束时间可能略超出录音长度）
+    AudioChunk last;
+    last.ownStartMs = start;
+    last.ownEndMs = std::numeric_limits<int64_t>::max();
+    last.audioStartMs = previousForced ? std::max<int64_t>(start - overlapMs, 0) : start;
+    last.audioEndMs = durationMs;
+    chunks.push_back(last);
+    return chunks;
+}
@@ -0,0 +1,95 @@
+#ifndef SILENCESPLITTER_H
+#define SILENCESPLITTER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 长录音按静音切分，供多个识别会话并行处理（见 splittranscriber.h）。本头文件不依赖 Qt。
+//
+// 先用 FrameEnergyMeter 在解码时逐帧（10ms）计算 RMS，再由 splitOnSilence 在每段
+// [目标长度的一半, 最大长度] 范围内找最长的静音，以静音中点为切点。范围内没有足够长的
+// 静音时在最安静的位置硬切，硬切处两侧各多送 overlapMs 的音频，跨切点的语音段在
+// 两个会话中都能完整识别，再由 stitchChunkSegments 拼接（规则见该函数）。
+
+const int kSplitSampleRate = 16000;
+const int kSplitFrameMs = 10;
+const int kSplitFrameSamples = kSplitSampleRate * kSplitFrameMs / 1000;
+
+struct SilenceSplitOptions {
+    int64_t targetChunkMs = 300000;     // 每段的目标长度
+    int64_t maxChunkMs = 420000;        // 每段的最大长度（不含重叠）
+    int64_t minSilenceMs = 300;         // 可作为切点的最短静音
+    int64_t overlapMs = 3000;           // 硬切处两侧多送的音频
+    double silenceRms = 0;              // 静音阈值，0 为按录音的噪声底自动估计
+};
+
+// 一段音频：识别会话处理 [audioStartMs, audioEndMs)，[ownStartMs, ownEndMs) 为切点之间的部分
+struct AudioChunk {
+    int64_t audioStartMs = 0;
+    int64_t audioEndMs = 0;
+    int64_t ownStartMs = 0;
+    int64_t ownEndMs = 0;
+    bool forcedCut = false;             // 结尾是硬切（没有找到静音）
+};
+
+// 逐帧计算 16kHz/16bit/单声道 PCM 的 RMS，可分多次送入
+class FrameEnergyMeter
+{
+public:
+    void add(const int16_t *samples, size_t count);
+    // 把不足一帧的尾部也计为一帧
+    void finish();
+
+    const std::vector<float> &frames() const { return frameRms; }
+    uint64_t totalSamples() const { return samples; }
+    int64_t durationMs() const { return static_cast<int64_t>(samples * 1000 / kSplitSampleRate); }
+
+private:
+    std::vector<float> frameRms;
+    double energy = 0;
+    int frameFill = 0;
+    uint64_t samples = 0;
+};
+
+// 按录音的噪声底估计静音阈值：较安静的 10% 帧的 RMS 加上余量
+double estimateSilenceRms(const std::vector<float> &frameRms);
+
+// 切分整段录音，返回按时间排列、首尾相接的段；thresholdUsed 返回实际使用的静音阈值
+std::vector<AudioChunk> splitOnSilence(const std::vector<float> &frameRms, int64_t durationMs,
+                                       const SilenceSplitOptions &options, double *thresholdUsed = nullptr);
+
+// 按时间拼接各段的识别结果。segments[k] 为第 k 段的结果，时间已换算为相对整个录音，
+// 按开始时间排列；Segment 需要有 offsetMs 和 durationMs 成员。
+//
+// 第 k 段保留中点在切点之前、或开始于下一段音频之前（下一段看不到开头）的结果，
+// 且只保留结束于前面已保留结果之后的部分。静音切点处两段互不相交，结果原样保留；
+// 硬切处的语音至少被一段完整保留，不会丢失，最多在接缝处重复一两句。
+template <typename Segment>
+std::vector<Segment> stitchChunkSegments(const std::vector<AudioChunk> &chunks,
+                                         const std::vector<std::vector<Segment>> &segments)
+{
+    std::vector<Segment> stitched;
+    int64_t coveredUntilMs = 0;
+    for (size_t k = 0; k < chunks.size() && k < segments.size(); ++k) {
+        const int64_t nextAudioStartMs = k + 1 < chunks.size() ? chunks[k + 1].audioStartMs : chunks[k].ownEndMs;
+        int64_t keptUntilMs = coveredUntilMs;
+        for (const Segment &segment : segments[k]) {
+            const int64_t startMs = segment.offsetMs;
+            const int64_t endMs = segment.offsetMs + segment.durationMs;
+            if (startMs + segment.durationMs / 2 >= chunks[k].ownEndMs && startMs >= nextAudioStartMs) {
+                break;
+            }
+            // 零长度的结果按开始时间判断
+            if (endMs > coveredUntilMs || (segment.durationMs == 0 && startMs >= coveredUntilMs)) {
+                stitched.push_back(segment);
+                keptUntilMs = std::max(keptUntilMs, endMs);
+            }
+        }
+        coveredUntilMs = keptUntilMs;
+    }
+    return stitched;
+}
+
+#endif // SILENCESPLITTER_H
@@ -0,0 +1,384 @@
+#include "soaktest.h"
+#include "batchtranscriber.h"
+#include "captionthrottle.h"
+#include "localspeechengine.h"
+#include "logger.h"
+#include <QAudioDecoder>
+#include <QAudioBuffer>
+#include <QAudioFormat>
+#include <QTextEdit>
+#include <QTextDocument>
+#include <QTextStream>
+#include <QUrl>
+#include <cmath>
+#include <memory>
+#ifdef Q_OS_WIN
+#include <windows.h>
+#include <psapi.h>
+#include <tlhelp32.h>
+#else
+#include <QDir>
+#include <QFile>
+#include <malloc.h>
+#endif
+
+namespace {
+
+const double kPi = 3.14159265358979323846;
+const int kSampleRate = 16000;
+const int kChunkSamples = kSampleRate / 100;    // 与采集线程一样按 10ms 送入
+const int kPumpIntervalMs = 10;
+
+struct ProcessStats {
+    double rssMb = 0;
+    double heapMb = 0;
+    int handles = 0;
+    int threads = 0;
+};
+
+ProcessStats sampleProcessStats()
+{
+    ProcessStats stats;
+#ifdef Q_OS_WIN
+    PROCESS_MEMORY_COUNTERS_EX memory;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS *>(&memory), sizeof(memory))) {
+        stats.rssMb = memory.WorkingSetSize / (1024.0 * 1024.0);
+        stats.heapMb = memory.PrivateUsage / (1024.0 * 1024.0);
+    }
+    DWORD handleCount = 0;
+    if (GetProcessHandleCount(GetCurrentProcess(), &handleCount)) {
+        stats.handles = static_cast<int>(handleCount);
+    }
+    HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+    if (snapshot != INVALID_HANDLE_VALUE) {
+        THREADENTRY32 entry;
+        entry.dwSize = sizeof(entry);
+        const DWORD pid = GetCurrentProcessId();
+        for (BOOL ok = Thread32First(snapshot, &entry); ok; ok = Thread32Next(snapshot, &entry)) {
+            if (entry.th32OwnerProcessID == pid) {
+                ++stats.threads;
+            }
+        }
+        CloseHandle(snapshot);
+    }
+#else
+    QFile status("/proc/self/status");
+    if (status.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        const QStringList lines = QString::fromUtf8(status.readAll()).split('\n');
+        for (const QString &line : lines) {
+            if (line.startsWith("VmRSS:")) {
+                stats.rssMb = line.section(':', 1).trimmed().section(' ', 0, 0).toDouble() / 1024.0;
+            } else if (line.startsWith("Threads:")) {
+                stats.threads = line.section(':', 1).trimmed().toInt();
+            }
+        }
+    }
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    stats.heapMb = mallinfo2().uordblks / (1024.0 * 1024.0);
+#endif
+    stats.handles = QDir("/proc/self/fd").entryList(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::System).size();
+#endif
+    return stats;
+}
+
+// 最小二乘斜率（每音频小时的变化量）
+double slopePerHour(const QList<double> &x, const QList<double> &y)
+{
+    const int n = x.size();
+    if (n < 2) {
+        return 0;
+    }
+    double meanX = 0, meanY = 0;
+    for (int i = 0; i < n; ++i) {
+        meanX += x[i];
+        meanY += y[i];
+    }
+    meanX /= n;
+    meanY /= n;
+    double numerator = 0, denominator = 0;
+    for (int i = 0; i < n; ++i) {
+        numerator += (x[i] - meanX) * (y[i] - meanY);
+        denominator += (x[i] - meanX) * (x[i] - meanX);
+    }
+    return denominator > 0 ? numerator / denominator : 0;
+}
+
+} // namespace
+
+SoakTest::SoakTest(const SoakOptions &options, QObject *parent)
+    : QObject(parent)
+    , options(options)
+    , decoder(nullptr)
+    , clipPosition(0)
+    , engine(nullptr)
+    , throttle(nullptr)
+    , liveText(nullptr)
+    , historyText(nullptr)
+    , lastPumpMs(0)
+    , pushedSamples(0)
+    , targetSamples(0)
+    , nextSampleAt(0)
+    , windowMaxLagMs(0)
+    , windowLatencySum(0)
+    , windowLatencyCount(0)
+    , finals(0)
+{
+    pumpTimer.setInterval(kPumpIntervalMs);
+    pumpTimer.setTimerType(Qt::PreciseTimer);
+    connect(&pumpTimer, &QTimer::timeout, this, &SoakTest::pumpAudio);
+}
+
+SoakTest::~SoakTest()
+{
+    delete decoder;
+    delete engine;
+    delete liveText;
+    delete historyText;
+}
+
+bool SoakTest::start()
+{
+    if (options.audioHours <= 0 || options.speed <= 0) {
+        LOG_ERROR("浸泡测试的时长和加速倍数必须大于 0");
+        return false;
+    }
+    if (options.inputFile.isEmpty()) {
+        generateTone();
+        startRun();
+    } else {
+        decodeInput();
+    }
+    return true;
+}
+
+void SoakTest::generateTone()
+{
+    // 1.5 秒 440Hz 与 1.5 秒静音交替
+    clip.resize(kSampleRate * 3);
+    for (size_t i = 0; i < clip.size(); ++i) {
+        const double t = static_cast<double>(i) / kSampleRate;
+        clip[i] = t < 1.5 ? static_cast<int16_t>(0.3 * 32767 * std::sin(2 * kPi * 440 * t)) : 0;
+    }
+}
+
+void SoakTest::decodeInput()
+{
+    QAudioFormat format;
+    format.setSampleRate(kSampleRate);
+    format.setChannelCount(1);
+    format.setSampleFormat(QAudioFormat::Int16);
+
+    decoder = new QAudioDecoder;
+    decoder->setAudioFormat(format);
+    decoder->setSource(QUrl::fromLocalFile(options.inputFile));
+
+    auto converter = std::make_shared<SampleConverter>();
+    connect(decoder, &QAudioDecoder::bufferReady, this, [this, converter]() {
+        const QByteArray pcm = convertToSpeechPcm(decoder->read(), *converter);
+        const int16_t *data = reinterpret_cast<const int16_t *>(pcm.constData());
+        clip.insert(clip.end(), data, data + pcm.size() / sizeof(int16_t));
+    });
+    connect(decoder, &QAudioDecoder::finished, this, [this]() {
+        LOG_INFO(QString("浸泡测试音频已解码: %1 秒").arg(clip.size() / static_cast<double>(kSampleRate), 0, 'f', 1));
+        if (clip.empty()) {
+            generateTone();
+        }
+        startRun();
+    });
+    connect(decoder, QOverload<QAudioDecoder::Error>::of(&QAudioDecoder::error), this, [this]() {
+        LOG_ERROR(QString("无法解码 %1: %2，改用测试音").arg(options.inputFile, decoder->errorString()));
+        clip.clear();
+        generateTone();
+        startRun();
+    });
+    decoder->start();
+}
+
+void SoakTest::startRun()
+{
+    if (decoder) {
+        decoder->disconnect(this);
+        decoder->stop();
+    }
+
+    // 与主窗口相同的下游：节流后的实时字幕和不断追加的历史
+    const LatencyProfile profile = LatencyProfile::byName("balanced");
+    engine = new LocalSpeechEngine();
+    engine->setLatencyProfile(profile);
+    engine->initialize(QString(), QString());
+    engine->startRecognitionAndTranslation("en-US", "zh-CN");
+
+    throttle = new CaptionThrottle(this);
+    throttle->setInterval(profile.uiUpdateIntervalMs);
+    liveText = new QTextEdit();
+    historyText = new QTextEdit();
+    connect(engine, &SpeechEngine::recognitionResult, throttle, &CaptionThrottle::submit);
+    connect(throttle, &CaptionThrottle::textReady, liveText, &QTextEdit::setPlainText);
+    connect(engine, &SpeechEngine::finalTranslationResult, historyText, &QTextEdit::append);
+    connect(engine, &SpeechEngine::finalSegment, this, &SoakTest::onFinalSegment);
+
+    targetSamples = static_cast<qint64>(options.audioHours * 3600 * kSampleRate);
+    nextSampleAt = 0;
+    LOG_INFO(QString("开始浸泡测试: %1 小时音频，%2 倍速，每 %3 分钟音频采样一次")
+             .arg(options.audioHours)
+             .arg(options.speed)
+             .arg(options.sampleEveryAudioMinutes));
+
+    pumpClock.start();
+    lastPumpMs = 0;
+    pumpTimer.start();
+}
+
+void SoakTest::pumpAudio()
+{
+    const qint64 nowMs = pumpClock.elapsed();
+    windowMaxLagMs = qMax(windowMaxLagMs, static_cast<double>(nowMs - lastPumpMs - kPumpIntervalMs));
+    lastPumpMs = nowMs;
+
+    // 上一轮排队的结果已经分发
+    lastPush.invalidate();
+
+    const qint64 due = qMin(targetSamples, static_cast<qint64>(nowMs * options.speed * kSampleRate / 1000));
+    while (pushedSamples + kChunkSamples <= due) {
+        QByteArray chunk(kChunkSamples * static_cast<int>(sizeof(int16_t)), Qt::Uninitialized);
+        int16_t *out = reinterpret_cast<int16_t *>(chunk.data());
+        for (int i = 0; i < kChunkSamples; ++i) {
+            out[i] = clip[clipPosition];
+            clipPosition = (clipPosition + 1) % clip.size();
+        }
+        engine->processAudioData(chunk);
+        pushedSamples += kChunkSamples;
+        if (!lastPush.isValid() && engine->pendingResults() > 0) {
+            lastPush.start();
+        }
+
+        if (pushedSamples >= nextSampleAt) {
+            takeSample();
+            nextSampleAt += static_cast<qint64>(options.sampleEveryAudioMinutes) * 60 * kSampleRate;
+        }
+    }
+
+    if (pushedSamples + kChunkSamples > targetSamples) {
+        pumpTimer.stop();
+        takeSample();
+        finish();
+    }
+}
+
+void SoakTest::onFinalSegment()
+{
+    ++finals;
+    // 从结果入队到写入历史控件的耗时
+    if (lastPush.isValid()) {
+        windowLatencySum += lastPush.nsecsElapsed() / 1e6;
+        ++windowLatencyCount;
+    }
+}
+
+void SoakTest::takeSample()
+{
+    const ProcessStats stats = sampleProcessStats();
+    Sample sample;
+    sample.audioHours = pushedSamples / (3600.0 * kSampleRate);
+    sample.rssMb = stats.rssMb;
+    sample.heapMb = stats.heapMb;
+    sample.handles = stats.handles;
+    sample.threads = stats.threads;
+    sample.queueDepth = static_cast<double>(engine->pendingResults());
+    sample.eventLoopLagMs = windowMaxLagMs;
+    sample.captionLatencyMs = windowLatencyCount > 0 ? windowLatencySum / windowLatencyCount : 0;
+    samples.append(sample);
+
+    windowMaxLagMs = 0;
+    windowLatencySum = 0;
+    windowLatencyCount = 0;
+
+    LOG_INFO(QString("浸泡采样 %1 h: RSS %2 MB, 堆 %3 MB, 句柄 %4, 线程 %5, 队列 %6, 事件循环延迟 %7 ms, 字幕延迟 %8 ms, 历史 %9 字符")
+             .arg(sample.audioHours, 0, 'f', 2)
+             .arg(sample.rssMb, 0, 'f', 1)
+             .arg(sample.heapMb, 0, 'f', 1)
+             .arg(sample.handles)
+             .arg(sample.threads)
+             .arg(sample.queueDepth)
+             .arg(sample.eventLoopLagMs, 0, 'f', 1)
+             .arg(sample.captionLatencyMs, 0, 'f', 2)
+             .arg(historyText->document()->characterCount()));
+}
+
+void SoakTest::finish()
+{
+    engine->stopRecognitionAndTranslation();
+    const bool passed = evaluate();
+    emit finished(passed);
+}
+
+bool SoakTest::evaluate()
+{
+    struct Metric {
+        const char *name;
+        double Sample::*field;
+        double minimumIncrease;     // 低于该绝对增量的变化视为噪声
+    };
+    const Metric metrics[] = {
+        {"RSS(MB)", &Sample::rssMb, 16},
+        {"堆(MB)", &Sample::heapMb, 8},
+        {"句柄", &Sample::handles, 20},
+        {"线程", &Sample::threads, 2},
+        {"队列深度", &Sample::queueDepth, 16},
+        {"事件循环延迟(ms)", &Sample::eventLoopLagMs, 20},
+        {"字幕延迟(ms)", &Sample::captionLatencyMs, 5},
+    };
+
+    // 前 10% 的采样作为预热，不参与拟合
+    const int warmup = qMax(1, samples.size() / 10);
+    QList<double> hours;
+    for (int i = warmup; i < samples.size(); ++i) {
+        hours.append(samples[i].audioHours);
+    }
+
+    QTextStream out(stdout);
+    out << QString("%1 %2 %3 %4 %5\n")
+           .arg("指标", -18)
+           .arg("起始", 10)
+           .arg("结束", 10)
+           .arg("拟合增量", 10)
+           .arg("结果", 6);
+
+    bool passed = true;
+    for (const Metric &metric : metrics) {
+        QList<double> values;
+        for (int i = warmup; i < samples.size(); ++i) {
+            values.append(samples[i].*(metric.field));
+        }
+        if (values.size() < 3) {
+            continue;
+        }
+        const double span = hours.last() - hours.first();
+        const double increase = slopePerHour(hours, values) * span;
+        const double baseline = values.first();
+        const bool rising = increase > metric.minimumIncrease
+                && increase > options.growthThreshold * qMax(baseline, 1.0);
+        passed = passed && !rising;
+
+        const QString line = QString("%1 %2 %3 %4 %5")
+                .arg(QString::fromUtf8(metric.name), -18)
+                .arg(baseline, 10, 'f', 1)
+                .arg(values.last(), 10, 'f', 1)
+                .arg(increase, 10, 'f', 1)
+                .arg(rising ? "上升" : "正常", 6);
+        out << line << "\n";
+        if (rising) {
+            LOG_ERROR(QString("浸泡测试发现持续上升: %1").arg(line.simplified()));
+        }
+    }
+
+    const QString summary = QString("浸泡测试%1：%2 小时音频，%3 条定稿，耗时 %4 秒")
+            .arg(passed ? "通过" : "失败")
+            .arg(options.audioHours)
+            .arg(finals)
+            .arg(pumpClock.elapsed() / 1000.0, 0, 'f', 0);
+    out << summary << "\n";
+    out.flush();
+    LOG_INFO(summary);
+    return passed;
+}
@@ -0,0 +1,88 @@
+#ifndef SOAKTEST_H
+#define SOAKTEST_H
+
+#include <QObject>
+#include <QList>
+#include <QStringList>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <vector>
+#include <cstdint>
+
+class QAudioDecoder;
+class QTextEdit;
+class SpeechEngine;
+class CaptionThrottle;
+
+struct SoakOptions {
+    QString inputFile;              // 为空时使用内置测试音
+    double audioHours = 6;
+    double speed = 120;             // 相对实时的加速倍数
+    int sampleEveryAudioMinutes = 5;
+    double growthThreshold = 0.2;   // 指标从前段到末段增长超过 20% 视为上升趋势
+};
+
+// 长时间浸泡测试：以加速速度循环回放音频，经本地替身引擎、字幕节流一直到字幕控件，
+// 按音频时间定期采样进程内存、堆、句柄、线程数、队列深度和字幕延迟，
+// 结束时对每项指标做线性拟合，增长超过阈值则判定失败。
+class SoakTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SoakTest(const SoakOptions &options, QObject *parent = nullptr);
+    ~SoakTest();
+
+    bool start();
+
+signals:
+    // passed 为 false 表示至少一项指标持续上升
+    void finished(bool passed);
+
+private:
+    struct Sample {
+        double audioHours = 0;
+        double rssMb = 0;
+        double heapMb = 0;
+        double handles = 0;
+        double threads = 0;
+        double queueDepth = 0;
+        double eventLoopLagMs = 0;
+        double captionLatencyMs = 0;
+    };
+
+    void decodeInput();
+    void generateTone();
+    void startRun();
+    void pumpAudio();
+    void onFinalSegment();
+    void takeSample();
+    void finish();
+    bool evaluate();
+
+    SoakOptions options;
+    QAudioDecoder *decoder;
+    std::vector<int16_t> clip;      // 循环回放的 16kHz 单声道 PCM
+    size_t clipPosition;
+
+    SpeechEngine *engine;
+    CaptionThrottle *throttle;
+    QTextEdit *liveText;
+    QTextEdit *historyText;
+
+    QTimer pumpTimer;
+    QElapsedTimer pumpClock;
+    qint64 lastPumpMs;
+    qint64 pushedSamples;
+    qint64 targetSamples;
+    qint64 nextSampleAt;
+
+    QElapsedTimer lastPush;         // 最近一次送入音频的时刻，用于计算字幕延迟
+    double windowMaxLagMs;
+    double windowLatencySum;
+    int windowLatencyCount;
+    int finals;
+    QList<Sample> samples;
+};
+
+#endif // SOAKTEST_H
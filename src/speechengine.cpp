@@ -0,0 +1,208 @@
+#include "speechengine.h"
+#include "azurespeechapi.h"
+#include "localspeechengine.h"
+#include "logger.h"
+#include "metrics.h"
+#include "captionring.h"
+#include "sessiontrace.h"
+#include "memoryaccounting.h"
+#include <QMetaObject>
+#include <QStringEncoder>
+
+namespace {
+
+const size_t kResultQueueCapacity = 1024;
+
+// 结果在队列中占用的内存：事件本身加两段文本
+int64_t queuedBytes(const RecognitionEvent &event)
+{
+    return static_cast<int64_t>(sizeof(RecognitionEvent))
+            + (event.text.size() + event.translation.size()) * static_cast<int64_t>(sizeof(QChar));
+}
+
+// 每条结果写轨迹、发布字幕时需要的 UTF-8 文本：从线程各自的 arena 分配，用完整体回收
+MemoryArena &resultScratch()
+{
+    thread_local MemoryArena arena(MemoryTag::Results, 16 * 1024);
+    return arena;
+}
+
+const char *encodeUtf8(MemoryArena &arena, const QString &text, size_t &length)
+{
+    QStringEncoder encoder(QStringEncoder::Utf8);
+    char *out = static_cast<char *>(arena.allocate(static_cast<size_t>(encoder.requiredSpace(text.size())), 1));
+    length = static_cast<size_t>(encoder.appendToBuffer(out, text) - out);
+    return out;
+}
+
+} // namespace
+
+SpeechEngine::SpeechEngine(QObject *parent)
+    : QObject(parent)
+    , resultQueue(kResultQueueCapacity)
+    , drainScheduled(false)
+    , overflowCount(0)
+    , droppedPartials(0)
+    , captionRing(nullptr)
+    , sessionTrace(nullptr)
+    , resultSink(nullptr)
+{
+}
+
+SpeechEngine *SpeechEngine::create(const QString &name, QObject *parent)
+{
+    if (name.compare("local", Qt::CaseInsensitive) == 0) {
+        return new LocalSpeechEngine(parent);
+    }
+    return new AzureSpeechAPI(parent);
+}
+
+void SpeechEngine::reconfigure(const QString &sourceLanguage, const QString &targetLanguage)
+{
+    stopRecognitionAndTranslation();
+    startRecognitionAndTranslation(sourceLanguage, targetLanguage);
+}
+
+void SpeechEngine::postResult(RecognitionEvent &&event)
+{
+    static MetricCounter &partials = Metrics::counter("results_partial_total", "部分识别结果数");
+    static MetricCounter &finals = Metrics::counter("results_final_total", "最终识别结果数");
+    static MetricCounter &dropped = Metrics::counter("results_dropped_partials_total", "结果队列满时丢弃的部分结果数");
+
+    const bool isFinal = event.kind == RecognitionEvent::Final;
+    (isFinal ? finals : partials).add();
+    if (sessionTrace) {
+        MemoryArena &scratch = resultScratch();
+        scratch.reset();
+        size_t textLength = 0;
+        size_t translationLength = 0;
+        const char *text = encodeUtf8(scratch, event.text, textLength);
+        const char *translation = encodeUtf8(scratch, event.translation, translationLength);
+        sessionTrace->writeResult(isFinal, event.hasTranslation, event.offsetMs, event.durationMs,
+                                  text, textLength, translation, translationLength);
+    }
+    const int64_t bytes = queuedBytes(event);
+    // 溢出表不为空时不能越过它进入队列，否则顺序会乱
+    const bool queued = overflowCount.load(std::memory_order_acquire) == 0
+            && resultQueue.tryPush(std::move(event));
+    if (!queued) {
+        // 队列满说明分发跟不上。投递方可能就是引擎所在线程（本地引擎、浸泡测试、分段转写），
+        // 这里等待空位会永远等不到分发，所以部分结果直接丢弃，最终结果放入溢出表
+        if (!isFinal) {
+            droppedPartials.fetch_add(1, std::memory_order_relaxed);
+            dropped.add();
+            return;
+        }
+        static MetricCounter &overflowed = Metrics::counter("results_overflow_finals_total",
+                                                            "结果队列满时放入溢出表的最终结果数");
+        overflowed.add();
+        QMutexLocker locker(&overflowMutex);
+        overflow.append(std::move(event));
+        overflowCount.store(static_cast<size_t>(overflow.size()), std::memory_order_release);
+    }
+    MemoryAccounting::adjust(MemoryTag::Results, bytes);
+
+    // 每批只投递一次分发调用
+    if (!drainScheduled.exchange(true, std::memory_order_acq_rel)) {
+        QMetaObject::invokeMethod(this, &SpeechEngine::drainResults, Qt::QueuedConnection);
+    }
+}
+
+void SpeechEngine::drainResults()
+{
+    // 先清除标志，之后到达的事件会安排下一次分发
+    drainScheduled.store(false, std::memory_order_release);
+
+    QVector<RecognitionEvent> batch;
+    RecognitionEvent event;
+    int64_t drainedBytes = 0;
+    while (resultQueue.tryPop(event)) {
+        drainedBytes += queuedBytes(event);
+        batch.append(std::move(event));
+    }
+    // 溢出表中的结果都比队列中的晚，放在最后；取走后投递方重新使用队列。
+    // 上面的循环结束后、溢出之前可能又有结果进入队列，持锁后先把它们取出
+    if (overflowCount.load(std::memory_order_acquire) > 0) {
+        QMutexLocker locker(&overflowMutex);
+        while (resultQueue.tryPop(event)) {
+            drainedBytes += queuedBytes(event);
+            batch.append(std::move(event));
+        }
+        for (RecognitionEvent &e : overflow) {
+            drainedBytes += queuedBytes(e);
+            batch.append(std::move(e));
+        }
+        overflow.clear();
+        overflowCount.store(0, std::memory_order_release);
+    }
+    MemoryAccounting::adjust(MemoryTag::Results, -drainedBytes);
+    static MetricHistogram &batchSize = Metrics::histogram(
+            "results_drain_batch_size", "每次分发时队列中积累的结果数", {1, 2, 4, 8, 16, 64, 256});
+    batchSize.observe(batch.size());
+
+    // 最后一个最终结果之后，只保留最新的部分结果
+    int lastPartial = -1;
+    for (int i = 0; i < batch.size(); ++i) {
+        if (batch[i].kind == RecognitionEvent::Partial) {
+            lastPartial = i;
+        }
+    }
+
+    for (int i = 0; i < batch.size(); ++i) {
+        const RecognitionEvent &e = batch[i];
+        if (e.kind == RecognitionEvent::Partial) {
+            if (i != lastPartial) {
+                continue;
+            }
+            publishCaption(e);
+            if (resultSink) {
+                resultSink->forwardResult(e);
+            }
+            emit recognitionResult(e.text);
+            if (e.hasTranslation) {
+                emit translationResult(e.translation);
+            }
+        } else {
+            publishCaption(e);
+            if (resultSink) {
+                resultSink->forwardResult(e);
+            }
+            if (i < lastPartial) {
+                // 之后还有新的部分结果，实时区直接显示那一条
+                if (e.hasTranslation) {
+                    emit finalTranslationResult(e.translation);
+                }
+            } else {
+                emit recognitionResult(e.text);
+                if (e.hasTranslation) {
+                    emit translationResult(e.translation);
+                    emit finalTranslationResult(e.translation);
+                }
+            }
+            emit finalSegment(e.offsetMs, e.durationMs, e.text, e.translation);
+        }
+    }
+
+    const quint64 dropped = droppedPartials.exchange(0, std::memory_order_relaxed);
+    if (dropped > 0) {
+        LOG_ERROR(QString("结果队列已满，丢弃 %1 个部分结果").arg(dropped));
+    }
+}
+
+void SpeechEngine::publishCaption(const RecognitionEvent &event)
+{
+    if (!captionRing) {
+        return;
+    }
+    static MetricCounter &published = Metrics::counter("caption_feed_records_total", "发布到共享内存字幕环的记录数");
+    MemoryArena &scratch = resultScratch();
+    scratch.reset();
+    size_t textLength = 0;
+    size_t translationLength = 0;
+    const char *text = encodeUtf8(scratch, event.text, textLength);
+    const char *translation = encodeUtf8(scratch, event.translation, translationLength);
+    captionRing->publish(event.kind == RecognitionEvent::Final ? CaptionKind::Final : CaptionKind::Partial,
+                         text, textLength, translation, translationLength,
+                         event.offsetMs, event.durationMs);
+    published.add();
+}
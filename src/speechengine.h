@@ -0,0 +1,113 @@
+#ifndef SPEECHENGINE_H
+#define SPEECHENGINE_H
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QMutex>
+#include <QVector>
+#include <atomic>
+#include "latencyprofile.h"
+#include "lockfreequeue.h"
+
+class CaptionRingWriter;
+class SessionTraceWriter;
+
+// 识别结果事件：在 SDK 回调线程中构造一次（UTF-8 -> UTF-16 只转换一次），
+// 经无锁队列交给引擎所在线程批量分发
+struct RecognitionEvent {
+    enum Kind : quint8 { Partial, Final };
+
+    Kind kind = Partial;
+    bool hasTranslation = false;
+    qint64 offsetMs = 0;
+    qint64 durationMs = 0;
+    QString text;
+    QString translation;
+};
+
+// 接收引擎分发的识别结果（部分结果已合并），在引擎所在线程调用
+class RecognitionEventSink
+{
+public:
+    virtual ~RecognitionEventSink() = default;
+    virtual void forwardResult(const RecognitionEvent &event) = 0;
+};
+
+// 语音识别/翻译引擎的公共接口。
+// AzureSpeechAPI 是正式实现，LocalSpeechEngine 是不依赖网络的本地替身，用于批处理和测试。
+// 输入音频固定为 16kHz/16bit/单声道 PCM。
+class SpeechEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SpeechEngine(QObject *parent = nullptr);
+    ~SpeechEngine() override = default;
+
+    // 根据名称创建引擎："azure"（默认）或 "local"
+    static SpeechEngine *create(const QString &name, QObject *parent = nullptr);
+
+    virtual void initialize(const QString &subscriptionKey, const QString &region) = 0;
+    virtual void startRecognitionAndTranslation(const QString &sourceLanguage, const QString &targetLanguage) = 0;
+    virtual void stopRecognitionAndTranslation() = 0;
+    // audioData 只在调用期间有效（可能直接指向共享内存），需要保留时应复制
+    virtual void processAudioData(const QByteArray &audioData) = 0;
+
+    // 音频输入结束：引擎处理完剩余音频后发出 sessionFinished
+    virtual void finishAudioInput() = 0;
+
+    // 识别进行中切换语言，音频输入不中断。默认实现为先停止再开始
+    virtual void reconfigure(const QString &sourceLanguage, const QString &targetLanguage);
+
+    // 静音超时等参数，在 initialize 之前设置
+    virtual void setLatencyProfile(const LatencyProfile &profile) { latencyProfile = profile; }
+
+    // 分发的每条部分/最终结果同时发布到共享内存字幕环（见 captionring.h），为空则不发布
+    void setCaptionRing(CaptionRingWriter *ring) { captionRing = ring; }
+
+    // 识别结果在进入结果队列前（SDK 回调线程中）写入会话轨迹，为空则不记录
+    void setSessionTrace(SessionTraceWriter *trace) { sessionTrace = trace; }
+
+    // 分发的每条结果同时转交给 sink（语音服务辅助进程用它把结果发回界面进程），为空则不转交
+    void setResultSink(RecognitionEventSink *sink) { resultSink = sink; }
+
+    // 尚未分发的识别结果数（近似值，仅用于统计）
+    size_t pendingResults() const
+    {
+        return resultQueue.sizeApprox() + overflowCount.load(std::memory_order_relaxed);
+    }
+
+signals:
+    void recognitionResult(const QString &text);
+    void translationResult(const QString &text);
+    void finalTranslationResult(const QString &text);
+    // 最终结果及其在音频流中的位置（毫秒）
+    void finalSegment(qint64 offsetMs, qint64 durationMs, const QString &text, const QString &translation);
+    void sessionFinished();
+    void error(const QString &message);
+    void statusChanged(const QString &status);
+
+protected:
+    // 可在任意线程（包括引擎自己的线程）调用，从不阻塞；同一批中的多个部分结果只分发最新的一个
+    void postResult(RecognitionEvent &&event);
+
+    LatencyProfile latencyProfile;
+
+private:
+    void drainResults();
+    void publishCaption(const RecognitionEvent &event);
+
+    LockFreeQueue<RecognitionEvent> resultQueue;
+    std::atomic<bool> drainScheduled;
+    // 队列满时最终结果放在这里；不为空期间之后的最终结果也排在这里，保持顺序
+    QMutex overflowMutex;
+    QVector<RecognitionEvent> overflow;
+    std::atomic<size_t> overflowCount;
+    std::atomic<quint64> droppedPartials;
+    CaptionRingWriter *captionRing;
+    SessionTraceWriter *sessionTrace;
+    RecognitionEventSink *resultSink;
+};
+
+#endif // SPEECHENGINE_H
@@ -0,0 +1,264 @@
+#include "speechhost.h"
+#include "captionring.h"
+#include "logger.h"
+#include <QCoreApplication>
+#include <QJsonDocument>
+
+namespace {
+
+const int kHeartbeatIntervalMs = 1000;
+const qint64 kBytesPerMs = 32;      // 16kHz/16bit/单声道
+
+} // namespace
+
+SpeechHost::SpeechHost(const QString &serverName, QObject *parent)
+    : QObject(parent)
+    , serverName(serverName)
+    , engine(nullptr)
+    , sessionRunning(false)
+    , baseOffsetMs(0)
+    , chunks(0)
+    , delaySumUs(0)
+    , delayMaxUs(0)
+    , intervalChunks(0)
+{
+    connect(&socket, &QLocalSocket::readyRead, this, &SpeechHost::onReadyRead);
+    // 界面进程退出（或被结束）时辅助进程随之退出
+    connect(&socket, &QLocalSocket::disconnected, this, []() {
+        LOG_INFO("界面进程已断开，语音服务进程退出");
+        QCoreApplication::quit();
+    });
+    heartbeat.setInterval(kHeartbeatIntervalMs);
+    connect(&heartbeat, &QTimer::timeout, this, &SpeechHost::sendHeartbeat);
+}
+
+SpeechHost::~SpeechHost()
+{
+    if (engine && sessionRunning) {
+        engine->stopRecognitionAndTranslation();
+    }
+}
+
+bool SpeechHost::start()
+{
+    socket.connectToServer(serverName);
+    if (!socket.waitForConnected(5000)) {
+        LOG_ERROR(QString("无法连接界面进程 %1: %2").arg(serverName, socket.errorString()));
+        return false;
+    }
+    QJsonObject hello;
+    hello["type"] = "hello";
+    hello["pid"] = QCoreApplication::applicationPid();
+    send(hello);
+    heartbeat.start();
+    LOG_INFO(QString("语音服务进程已连接 %1").arg(serverName));
+    return true;
+}
+
+QJsonObject SpeechHost::profileToJson(const LatencyProfile &profile)
+{
+    QJsonObject json;
+    json["name"] = profile.name;
+    json["capturePollMs"] = profile.capturePollMs;
+    json["bufferDurationMs"] = profile.bufferDurationMs;
+    json["initialSilenceTimeoutMs"] = profile.initialSilenceTimeoutMs;
+    json["endSilenceTimeoutMs"] = profile.endSilenceTimeoutMs;
+    json["uiUpdateIntervalMs"] = profile.uiUpdateIntervalMs;
+    return json;
+}
+
+LatencyProfile SpeechHost::profileFromJson(const QJsonObject &json)
+{
+    LatencyProfile profile = LatencyProfile::byName(json.value("name").toString());
+    profile.capturePollMs = json.value("capturePollMs").toInt(profile.capturePollMs);
+    profile.bufferDurationMs = json.value("bufferDurationMs").toInt(profile.bufferDurationMs);
+    profile.initialSilenceTimeoutMs = json.value("initialSilenceTimeoutMs").toInt(profile.initialSilenceTimeoutMs);
+    profile.endSilenceTimeoutMs = json.value("endSilenceTimeoutMs").toInt(profile.endSilenceTimeoutMs);
+    profile.uiUpdateIntervalMs = json.value("uiUpdateIntervalMs").toInt(profile.uiUpdateIntervalMs);
+    return profile;
+}
+
+void SpeechHost::onReadyRead()
+{
+    while (socket.canReadLine()) {
+        const QByteArray line = socket.readLine().trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+        const QJsonDocument document = QJsonDocument::fromJson(line);
+        if (!document.isObject()) {
+            LOG_ERROR(QString("无法解析界面进程的命令: %1").arg(QString::fromUtf8(line.left(200))));
+            continue;
+        }
+        handleMessage(document.object());
+    }
+}
+
+void SpeechHost::handleMessage(const QJsonObject &message)
+{
+    const QString type = message.value("type").toString();
+    if (type == "audio") {
+        drainAudio();
+    } else if (type == "init") {
+        const QByteArray ringName = message.value("ring").toString().toUtf8();
+        if (!ring.isOpen() && !ring.open(ringName.constData())) {
+            QJsonObject failure;
+            failure["type"] = "error";
+            failure["message"] = QString("语音服务进程无法打开音频共享内存 %1").arg(QString::fromUtf8(ringName));
+            send(failure);
+            return;
+        }
+        ensureEngine(message.value("engine").toString());
+        latencyProfile = profileFromJson(message.value("profile").toObject());
+        engine->setLatencyProfile(latencyProfile);
+        engine->initialize(message.value("key").toString(), message.value("region").toString());
+    } else if (type == "start") {
+        if (!engine) {
+            return;
+        }
+        if (message.value("resume").toBool()) {
+            // 从上一个进程最后一个最终结果处重新识别，结果位置接在那之后
+            ring.rewind();
+            baseOffsetMs = static_cast<qint64>(ring.consumedPcmBytes()) / kBytesPerMs;
+        } else {
+            ring.restartAt(static_cast<quint64>(message.value("ringPosition").toDouble()));
+            baseOffsetMs = 0;
+        }
+        delivered.clear();
+        engine->startRecognitionAndTranslation(message.value("source").toString(), message.value("target").toString());
+        sessionRunning = true;
+        QJsonObject ready;
+        ready["type"] = "ready";
+        send(ready);
+        drainAudio();
+    } else if (type == "stop") {
+        if (engine && sessionRunning) {
+            sessionRunning = false;
+            engine->stopRecognitionAndTranslation();
+        }
+    } else if (type == "finish") {
+        if (engine && sessionRunning) {
+            drainAudio();
+            sessionRunning = false;
+            engine->finishAudioInput();
+        }
+    } else if (type == "reconfigure") {
+        if (engine && sessionRunning) {
+            engine->reconfigure(message.value("source").toString(), message.value("target").toString());
+        }
+    } else if (type == "quit") {
+        QCoreApplication::quit();
+    }
+}
+
+void SpeechHost::ensureEngine(const QString &name)
+{
+    if (engine) {
+        return;
+    }
+    engine = SpeechEngine::create(name.isEmpty() ? QString("azure") : name, this);
+    engine->setResultSink(this);
+    connect(engine, &SpeechEngine::statusChanged, this, [this](const QString &status) {
+        QJsonObject message;
+        message["type"] = "status";
+        message["message"] = status;
+        send(message);
+    });
+    connect(engine, &SpeechEngine::error, this, [this](const QString &text) {
+        QJsonObject message;
+        message["type"] = "error";
+        message["message"] = text;
+        send(message);
+    });
+    connect(engine, &SpeechEngine::sessionFinished, this, [this]() {
+        commitAudio(ring.pcmBytes());
+        QJsonObject message;
+        message["type"] = "finished";
+        send(message);
+    });
+}
+
+void SpeechHost::drainAudio()
+{
+    if (!engine || !sessionRunning) {
+        return;
+    }
+    do {
+        AudioRingChunk chunk;
+        while (ring.peek(chunk)) {
+            const quint64 delayUs = captionRingNowUs() - chunk.writeTimeUs;
+            delaySumUs += delayUs;
+            delayMaxUs = qMax(delayMaxUs, delayUs);
+            ++intervalChunks;
+            ++chunks;
+            // 直接引用共享内存中的数据，识别器推流时才复制
+            engine->processAudioData(QByteArray::fromRawData(chunk.pcm, static_cast<int>(chunk.bytes)));
+            ring.release(chunk);
+            delivered.append({ring.position(), ring.pcmBytes()});
+            // 长时间没有最终结果（例如一直静音）时不能占满环，最多保留半个环
+            while (!delivered.isEmpty() && ring.position() - delivered.first().position > ring.capacity() / 2) {
+                commitAudio(delivered.first().pcmBytes);
+            }
+        }
+    } while (!ring.prepareWait());
+}
+
+void SpeechHost::sendHeartbeat()
+{
+    // 唤醒消息丢失时（例如重启期间）也能继续读取
+    drainAudio();
+
+    QJsonObject message;
+    message["type"] = "heartbeat";
+    message["chunks"] = static_cast<double>(chunks);
+    message["audioDelayAvgUs"] = intervalChunks > 0 ? static_cast<double>(delaySumUs / intervalChunks) : 0.0;
+    message["audioDelayMaxUs"] = static_cast<double>(delayMaxUs);
+    send(message);
+    delaySumUs = 0;
+    delayMaxUs = 0;
+    intervalChunks = 0;
+}
+
+void SpeechHost::send(const QJsonObject &message)
+{
+    if (socket.state() != QLocalSocket::ConnectedState) {
+        return;
+    }
+    socket.write(QJsonDocument(message).toJson(QJsonDocument::Compact));
+    socket.write("\n", 1);
+    socket.flush();
+}
+
+void SpeechHost::forwardResult(const RecognitionEvent &event)
+{
+    const bool isFinal = event.kind == RecognitionEvent::Final;
+    QJsonObject message;
+    message["type"] = "result";
+    message["final"] = isFinal;
+    message["hasTranslation"] = event.hasTranslation;
+    message["offsetMs"] = static_cast<double>(event.offsetMs + baseOffsetMs);
+    message["durationMs"] = static_cast<double>(event.durationMs);
+    message["text"] = event.text;
+    message["translation"] = event.translation;
+    message["sentUs"] = static_cast<double>(captionRingNowUs());
+    send(message);
+
+    if (isFinal) {
+        commitAudio(static_cast<quint64>(event.offsetMs + event.durationMs + baseOffsetMs) * kBytesPerMs);
+    }
+}
+
+void SpeechHost::commitAudio(quint64 pcmBytes)
+{
+    // 只提交整块都在 pcmBytes 之前的数据块，重启后最多重复识别一个数据块
+    int count = 0;
+    while (count < delivered.size() && delivered.at(count).pcmBytes <= pcmBytes) {
+        ++count;
+    }
+    if (count == 0) {
+        return;
+    }
+    const DeliveredChunk last = delivered.at(count - 1);
+    delivered.remove(0, count);
+    ring.commit(last.position, last.pcmBytes);
+}
@@ -0,0 +1,79 @@
+#ifndef SPEECHHOST_H
+#define SPEECHHOST_H
+
+#include <QObject>
+#include <QJsonObject>
+#include <QList>
+#include <QLocalSocket>
+#include <QTimer>
+#include "speechengine.h"
+#include "audioring.h"
+
+// 语音服务辅助进程（--speech-host <通道名>）：SDK 崩溃或卡死只影响这个进程，
+// 界面进程中的 HostedSpeechEngine 负责启动、监视和重启它。
+//
+// 音频经共享内存环（audioring.h）传递，控制命令和识别结果经本机套接字（QLocalSocket）
+// 按行传递 JSON，和接入服务的协议风格一致：
+//   界面 -> 辅助进程
+//     {"type":"init","ring":...,"engine":...,"key":...,"region":...,"profile":{...}}
+//     {"type":"start","source":...,"target":...,"ringPosition":n}    新会话，从环的 n 处读起
+//     {"type":"start","source":...,"target":...,"resume":true}       重启后继续上次的会话
+//     {"type":"stop"} {"type":"finish"} {"type":"reconfigure","source":...,"target":...}
+//     {"type":"audio"}      环中有新数据（只在辅助进程等待时发送）
+//     {"type":"quit"}
+//   辅助进程 -> 界面
+//     {"type":"hello","pid":...} {"type":"ready"}                  ready 表示会话已开始
+//     {"type":"result","final":...,"hasTranslation":...,"offsetMs":...,"durationMs":...,
+//      "text":...,"translation":...,"sentUs":...}                    sentUs 为 captionRingNowUs()
+//     {"type":"status","message":...} {"type":"error","message":...} {"type":"finished"}
+//     {"type":"heartbeat","chunks":...,"audioDelayAvgUs":...,"audioDelayMaxUs":...}   每秒一次
+class SpeechHost : public QObject, private RecognitionEventSink
+{
+    Q_OBJECT
+
+public:
+    explicit SpeechHost(const QString &serverName, QObject *parent = nullptr);
+    ~SpeechHost() override;
+
+    bool start();
+
+    // LatencyProfile 在两个进程间传递
+    static QJsonObject profileToJson(const LatencyProfile &profile);
+    static LatencyProfile profileFromJson(const QJsonObject &json);
+
+private:
+    void onReadyRead();
+    void handleMessage(const QJsonObject &message);
+    void ensureEngine(const QString &name);
+    void drainAudio();
+    void sendHeartbeat();
+    void send(const QJsonObject &message);
+    void forwardResult(const RecognitionEvent &event) override;
+    // 提交 pcmBytes（整个流中的位置）之前已交给识别器的音频，写入方可以覆盖
+    void commitAudio(quint64 pcmBytes);
+
+    QString serverName;
+    QLocalSocket socket;
+    AudioRingReader ring;
+    SpeechEngine *engine;
+    LatencyProfile latencyProfile;
+    bool sessionRunning;
+    qint64 baseOffsetMs;        // 本进程会话开始处在整个流中的位置，加到结果的位置上
+
+    // 已交给识别器、还没有最终结果的数据块（结束处的环位置和流中位置），
+    // 辅助进程重启后从第一个未提交的数据块重新识别
+    struct DeliveredChunk {
+        quint64 position;
+        quint64 pcmBytes;
+    };
+    QList<DeliveredChunk> delivered;
+    QTimer heartbeat;
+
+    // 经共享内存的音频延迟（写入到交给识别器），每次心跳后清零
+    quint64 chunks;
+    quint64 delaySumUs;
+    quint64 delayMaxUs;
+    quint64 intervalChunks;
+};
+
+#endif // SPEECHHOST_H
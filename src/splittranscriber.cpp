@@ -0,0 +1,418 @@
+#include "splittranscriber.h"
+#include "speechengine.h"
+#include "metrics.h"
+#include "logger.h"
+#include <QAudioDecoder>
+#include <QAudioBuffer>
+#include <QAudioFormat>
+#include <QDir>
+#include <QSettings>
+#include <QTemporaryFile>
+#include <QTextStream>
+#include <QTimer>
+#include <QUrl>
+#include <algorithm>
+
+namespace {
+
+const qint64 kBytesPerMs = kSplitSampleRate * 2 / 1000;
+const qint64 kFeedPieceBytes = kBytesPerMs * 1000;     // 不限速时每轮事件循环送入 1 秒
+const int kPacerIntervalMs = 100;
+const int kMaxChunkAttempts = 2;                       // 一段失败时重试一次
+
+} // namespace
+
+struct SplitTranscriber::Session {
+    int id = 0;
+    int chunkIndex = 0;
+    SpeechEngine *engine = nullptr;
+    QTimer *pacer = nullptr;
+    qint64 position = 0;            // 在映射中的字节位置
+    qint64 end = 0;
+    std::vector<TranscriptSegment> segments;
+    bool finished = false;
+};
+
+SplitTranscriber::SplitTranscriber(const BatchOptions &options, const SilenceSplitOptions &splitOptions,
+                                   double feedSpeed, QObject *parent)
+    : QObject(parent)
+    , options(options)
+    , splitOptions(splitOptions)
+    , feedSpeed(feedSpeed)
+    , decoder(nullptr)
+    , pcmFile(nullptr)
+    , pcm(nullptr)
+    , pcmBytes(0)
+    , fileFailed(false)
+    , decodeMs(0)
+    , totalAudioSeconds(0)
+    , completedCount(0)
+    , failedCount(0)
+    , nextSessionId(0)
+{
+    if (this->options.maxParallel < 1) {
+        this->options.maxParallel = 1;
+    }
+}
+
+SplitTranscriber::~SplitTranscriber()
+{
+    releaseFile();
+}
+
+SilenceSplitOptions SplitTranscriber::splitOptionsFromSettings(QSettings &settings)
+{
+    SilenceSplitOptions split;
+    split.targetChunkMs = settings.value("Split/TargetChunkSeconds", 300).toLongLong() * 1000;
+    split.maxChunkMs = settings.value("Split/MaxChunkSeconds", 420).toLongLong() * 1000;
+    split.minSilenceMs = settings.value("Split/MinSilenceMs", split.minSilenceMs).toLongLong();
+    split.overlapMs = settings.value("Split/OverlapMs", split.overlapMs).toLongLong();
+    split.silenceRms = settings.value("Split/SilenceRms", 0).toDouble();
+    return split;
+}
+
+bool SplitTranscriber::start()
+{
+    pendingFiles = collectAudioFiles(options.inputs);
+    if (pendingFiles.isEmpty()) {
+        LOG_ERROR("没有找到可转写的音频文件");
+        return false;
+    }
+
+    if (!options.outputDir.isEmpty()) {
+        QDir().mkpath(options.outputDir);
+    }
+
+    LOG_INFO(QString("分段转写开始：%1 个文件，并发会话数 %2，引擎 %3，送入速度 %4")
+             .arg(pendingFiles.size())
+             .arg(options.maxParallel)
+             .arg(options.engineName)
+             .arg(feedSpeed > 0 ? QString("%1 倍实时").arg(feedSpeed) : QString("不限")));
+    wallClock.start();
+    startNextFile();
+    return true;
+}
+
+void SplitTranscriber::startNextFile()
+{
+    if (pendingFiles.isEmpty()) {
+        const double wallSeconds = wallClock.elapsed() / 1000.0;
+        QString summary = QString("分段转写结束：成功 %1，失败 %2，音频 %3 小时，耗时 %4 小时，吞吐 %5 音频小时/小时")
+                .arg(completedCount)
+                .arg(failedCount)
+                .arg(totalAudioSeconds / 3600.0, 0, 'f', 3)
+                .arg(wallSeconds / 3600.0, 0, 'f', 3)
+                .arg(wallSeconds > 0 ? totalAudioSeconds / wallSeconds : 0.0, 0, 'f', 1);
+        LOG_INFO(summary);
+        QTextStream(stdout) << summary << Qt::endl;
+        emit finished(failedCount);
+        return;
+    }
+
+    inputPath = pendingFiles.takeFirst();
+    fileFailed = false;
+    fileTimer.start();
+    energyMeter = FrameEnergyMeter();
+    converter = SampleConverter();
+    LOG_INFO(QString("开始解码: %1").arg(inputPath));
+
+    // 解码结果暂存在临时文件中，三小时的录音约 350 MB，不占用进程内存
+    pcmFile = new QTemporaryFile(QDir::temp().filePath("meetingassistant_split_XXXXXX.pcm"));
+    if (!pcmFile->open()) {
+        finishFile(QString("无法创建临时文件: %1").arg(pcmFile->errorString()));
+        return;
+    }
+
+    QAudioFormat format;
+    format.setSampleRate(kSplitSampleRate);
+    format.setChannelCount(1);
+    format.setSampleFormat(QAudioFormat::Int16);
+
+    decoder = new QAudioDecoder;
+    decoder->setAudioFormat(format);
+    decoder->setSource(QUrl::fromLocalFile(inputPath));
+    connect(decoder, &QAudioDecoder::bufferReady, this, &SplitTranscriber::onBufferReady);
+    connect(decoder, &QAudioDecoder::finished, this, &SplitTranscriber::onDecodeFinished);
+    connect(decoder, QOverload<QAudioDecoder::Error>::of(&QAudioDecoder::error), this,
+            [this](QAudioDecoder::Error) {
+        finishFile(QString("解码失败: %1").arg(decoder->errorString()));
+    });
+    decoder->start();
+}
+
+void SplitTranscriber::onBufferReady()
+{
+    while (decoder->bufferAvailable()) {
+        QAudioBuffer buffer = decoder->read();
+        if (!buffer.isValid()) {
+            continue;
+        }
+        const QByteArray data = convertToSpeechPcm(buffer, converter);
+        if (data.isEmpty()) {
+            continue;
+        }
+        energyMeter.add(reinterpret_cast<const int16_t *>(data.constData()),
+                        static_cast<size_t>(data.size()) / sizeof(int16_t));
+        if (pcmFile->write(data) != data.size()) {
+            finishFile(QString("写入临时文件失败: %1").arg(pcmFile->errorString()));
+            return;
+        }
+    }
+}
+
+void SplitTranscriber::onDecodeFinished()
+{
+    static MetricCounter &chunkCount = Metrics::counter("split_chunks_total", "分段转写切出的段数");
+    static MetricCounter &forcedCuts = Metrics::counter("split_forced_cuts_total", "分段转写中没有找到静音的硬切次数");
+
+    energyMeter.finish();
+    decodeMs = fileTimer.elapsed();
+    pcmFile->flush();
+    pcmBytes = pcmFile->size();
+    if (pcmBytes == 0) {
+        finishFile("没有解码出音频");
+        return;
+    }
+    pcm = reinterpret_cast<const char *>(pcmFile->map(0, pcmBytes));
+    if (!pcm) {
+        finishFile(QString("无法映射临时文件: %1").arg(pcmFile->errorString()));
+        return;
+    }
+
+    double threshold = 0;
+    chunks = splitOnSilence(energyMeter.frames(), energyMeter.durationMs(), splitOptions, &threshold);
+    chunkSegments.assign(chunks.size(), std::vector<TranscriptSegment>());
+    pendingChunks.clear();
+    chunkAttempts.clear();
+    int forced = 0;
+    for (int i = 0; i < static_cast<int>(chunks.size()); ++i) {
+        pendingChunks.append(i);
+        chunkAttempts.append(0);
+        forced += chunks[i].forcedCut ? 1 : 0;
+    }
+    chunkCount.add(chunks.size());
+    forcedCuts.add(forced);
+
+    LOG_INFO(QString("解码完成: %1，音频 %2 秒，解码耗时 %3 秒，静音阈值 RMS %4，切为 %5 段（硬切 %6 处）")
+             .arg(inputPath)
+             .arg(energyMeter.durationMs() / 1000.0, 0, 'f', 1)
+             .arg(decodeMs / 1000.0, 0, 'f', 1)
+             .arg(threshold, 0, 'f', 0)
+             .arg(chunks.size())
+             .arg(forced));
+    startPendingSessions();
+}
+
+void SplitTranscriber::startPendingSessions()
+{
+    while (sessions.size() < options.maxParallel && !pendingChunks.isEmpty() && !fileFailed) {
+        startSession(pendingChunks.takeFirst());
+    }
+    if (sessions.isEmpty() && (pendingChunks.isEmpty() || fileFailed)) {
+        finishFile();
+    }
+}
+
+void SplitTranscriber::startSession(int chunkIndex)
+{
+    const AudioChunk &chunk = chunks[static_cast<size_t>(chunkIndex)];
+    Session *session = new Session;
+    session->id = ++nextSessionId;
+    session->chunkIndex = chunkIndex;
+    session->position = qMin(chunk.audioStartMs * kBytesPerMs, pcmBytes);
+    session->end = qMin(chunk.audioEndMs * kBytesPerMs, pcmBytes);
+    sessions.append(session);
+    ++chunkAttempts[chunkIndex];
+
+    // 引擎信号可能来自 SDK 线程并排队送达，此时会话可能已经结束，因此按 id 查找
+    const int id = session->id;
+    const qint64 chunkStartMs = chunk.audioStartMs;
+    session->engine = SpeechEngine::create(options.engineName);
+    connect(session->engine, &SpeechEngine::finalSegment, this,
+            [this, id, chunkStartMs](qint64 offsetMs, qint64 durationMs, const QString &text, const QString &translation) {
+        if (Session *session = findSession(id)) {
+            session->segments.push_back({chunkStartMs + offsetMs, durationMs, text, translation});
+        }
+    });
+    // 结束和错误总是排队处理，避免在送入音频的调用内部销毁会话
+    connect(session->engine, &SpeechEngine::sessionFinished, this, [this, id]() {
+        if (Session *session = findSession(id)) {
+            finishSession(session);
+        }
+    }, Qt::QueuedConnection);
+    connect(session->engine, &SpeechEngine::error, this, [this, id](const QString &message) {
+        if (Session *session = findSession(id)) {
+            finishSession(session, message);
+        }
+    }, Qt::QueuedConnection);
+
+    session->engine->initialize(options.subscriptionKey, options.region);
+    session->engine->startRecognitionAndTranslation(options.sourceLanguage, options.targetLanguage);
+
+    if (feedSpeed > 0) {
+        session->pacer = new QTimer(this);
+        session->pacer->setInterval(kPacerIntervalMs);
+        connect(session->pacer, &QTimer::timeout, this, [this, id]() {
+            if (Session *session = findSession(id)) {
+                feedSession(session);
+            }
+        });
+        session->pacer->start();
+    } else {
+        scheduleFeed(id);
+    }
+}
+
+void SplitTranscriber::scheduleFeed(int id)
+{
+    // 不限速时每轮事件循环只送入一片，各会话轮流送入，结果也能及时取走
+    QTimer::singleShot(0, this, [this, id]() {
+        if (Session *session = findSession(id)) {
+            feedSession(session);
+        }
+    });
+}
+
+SplitTranscriber::Session *SplitTranscriber::findSession(int id) const
+{
+    for (Session *session : sessions) {
+        if (session->id == id) {
+            return session;
+        }
+    }
+    return nullptr;
+}
+
+void SplitTranscriber::feedSession(Session *session)
+{
+    // 限速时每次送入一个定时周期对应的音频，按 2 字节对齐；不限速时每次送入一片
+    const qint64 budget = feedSpeed > 0
+            ? qMax<qint64>(static_cast<qint64>(feedSpeed * kPacerIntervalMs) * kBytesPerMs, 2) & ~qint64(1)
+            : kFeedPieceBytes;
+    qint64 fed = 0;
+    while (session->position < session->end && fed < budget) {
+        const qint64 piece = qMin(qMin(kFeedPieceBytes, session->end - session->position), budget - fed);
+        // 直接引用映射中的数据，引擎需要保留时自行复制
+        session->engine->processAudioData(QByteArray::fromRawData(pcm + session->position, static_cast<int>(piece)));
+        session->position += piece;
+        fed += piece;
+    }
+    if (session->position >= session->end) {
+        if (session->pacer) {
+            session->pacer->stop();
+        }
+        // 所有音频已送入，等待引擎处理完剩余部分
+        session->engine->finishAudioInput();
+    } else if (!session->pacer) {
+        scheduleFeed(session->id);
+    }
+}
+
+void SplitTranscriber::finishSession(Session *session, const QString &errorMessage)
+{
+    if (session->finished) {
+        return;
+    }
+    session->finished = true;
+
+    const int index = session->chunkIndex;
+    const AudioChunk &chunk = chunks[static_cast<size_t>(index)];
+    if (errorMessage.isEmpty()) {
+        std::vector<TranscriptSegment> &segments = chunkSegments[static_cast<size_t>(index)];
+        segments = std::move(session->segments);
+        std::stable_sort(segments.begin(), segments.end(), [](const TranscriptSegment &a, const TranscriptSegment &b) {
+            return a.offsetMs < b.offsetMs;
+        });
+        LOG_INFO(QString("第 %1/%2 段完成（%3 - %4 秒），%5 句")
+                 .arg(index + 1).arg(chunks.size())
+                 .arg(chunk.audioStartMs / 1000.0, 0, 'f', 1)
+                 .arg(chunk.audioEndMs / 1000.0, 0, 'f', 1)
+                 .arg(segments.size()));
+    } else if (chunkAttempts[index] < kMaxChunkAttempts) {
+        LOG_ERROR(QString("第 %1 段识别失败，重试: %2").arg(index + 1).arg(errorMessage));
+        pendingChunks.prepend(index);
+    } else {
+        LOG_ERROR(QString("第 %1 段识别失败: %2").arg(index + 1).arg(errorMessage));
+        fileFailed = true;
+    }
+
+    sessions.removeOne(session);
+    if (session->pacer) {
+        session->pacer->deleteLater();
+    }
+    session->engine->disconnect(this);
+    session->engine->stopRecognitionAndTranslation();
+    session->engine->deleteLater();
+    delete session;
+
+    startPendingSessions();
+}
+
+void SplitTranscriber::finishFile(const QString &errorMessage)
+{
+    const QString outputPath = transcriptPathFor(inputPath, options.outputDir);
+    const double audioSeconds = energyMeter.durationMs() / 1000.0;
+    const double elapsedSeconds = fileTimer.elapsed() / 1000.0;
+
+    QString writeError;
+    if (!errorMessage.isEmpty()) {
+        LOG_ERROR(QString("转写失败: %1, %2").arg(inputPath, errorMessage));
+        ++failedCount;
+    } else if (fileFailed) {
+        LOG_ERROR(QString("转写失败: %1，有段落多次识别失败").arg(inputPath));
+        ++failedCount;
+    } else {
+        const std::vector<TranscriptSegment> stitched = stitchChunkSegments(chunks, chunkSegments);
+        if (!writeTranscriptFile(outputPath, QList<TranscriptSegment>(stitched.begin(), stitched.end()), &writeError)) {
+            LOG_ERROR(QString("写入转写结果失败: %1, %2").arg(outputPath, writeError));
+            ++failedCount;
+        } else {
+            ++completedCount;
+            totalAudioSeconds += audioSeconds;
+            LOG_INFO(QString("转写完成: %1，音频 %2 秒，耗时 %3 秒（解码 %4 秒），%5 段并行 %6 路，%7 句，%8 倍实时 -> %9")
+                     .arg(inputPath)
+                     .arg(audioSeconds, 0, 'f', 1)
+                     .arg(elapsedSeconds, 0, 'f', 1)
+                     .arg(decodeMs / 1000.0, 0, 'f', 1)
+                     .arg(chunks.size())
+                     .arg(options.maxParallel)
+                     .arg(stitched.size())
+                     .arg(elapsedSeconds > 0 ? audioSeconds / elapsedSeconds : 0.0, 0, 'f', 1)
+                     .arg(outputPath));
+        }
+    }
+
+    // 解码器和引擎只延迟删除，可以在它们的信号中释放；下一个文件从事件循环中开始
+    releaseFile();
+    QTimer::singleShot(0, this, &SplitTranscriber::startNextFile);
+}
+
+void SplitTranscriber::releaseFile()
+{
+    for (Session *session : sessions) {
+        if (session->pacer) {
+            session->pacer->deleteLater();
+        }
+        session->engine->disconnect(this);
+        session->engine->stopRecognitionAndTranslation();
+        session->engine->deleteLater();
+        delete session;
+    }
+    sessions.clear();
+    if (decoder) {
+        decoder->disconnect(this);
+        decoder->stop();
+        decoder->deleteLater();
+        decoder = nullptr;
+    }
+    if (pcm) {
+        pcmFile->unmap(reinterpret_cast<uchar *>(const_cast<char *>(pcm)));
+        pcm = nullptr;
+    }
+    delete pcmFile;
+    pcmFile = nullptr;
+    pcmBytes = 0;
+    chunks.clear();
+    chunkSegments.clear();
+    pendingChunks.clear();
+}
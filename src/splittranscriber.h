@@ -0,0 +1,86 @@
+#ifndef SPLITTRANSCRIBER_H
+#define SPLITTRANSCRIBER_H
+
+#include <QObject>
+#include <QStringList>
+#include <QList>
+#include <QElapsedTimer>
+#include <vector>
+#include "batchtranscriber.h"
+#include "silencesplitter.h"
+
+class QAudioDecoder;
+class QSettings;
+class QTemporaryFile;
+
+// 长录音分段并行转写（--batch --split）：一个识别会话只能按顺序处理一路音频，
+// 三小时的录音就要识别约三小时。这里先解码整个文件（同时逐帧计算能量，PCM 暂存在
+// 临时文件中并映射），按静音切成不超过几分钟的段（见 silencesplitter.h），再用
+// maxParallel 个识别会话同时处理各段，结果按各段在录音中的位置拼接成一份转写文件。
+// 多个输入文件依次处理。
+//
+// feedSpeed 大于 0 时每个会话按该倍速送入音频（用本地替身引擎验证并发收益），
+// 为 0 时不限速，每轮事件循环给每个会话送入 1 秒，各会话交替推进。
+class SplitTranscriber : public QObject
+{
+    Q_OBJECT
+
+public:
+    SplitTranscriber(const BatchOptions &options, const SilenceSplitOptions &splitOptions,
+                     double feedSpeed = 0, QObject *parent = nullptr);
+    ~SplitTranscriber();
+
+    // 读取 [Split] TargetChunkSeconds / MaxChunkSeconds / MinSilenceMs / OverlapMs / SilenceRms
+    static SilenceSplitOptions splitOptionsFromSettings(QSettings &settings);
+
+    // 展开输入并开始处理，没有可处理的文件时返回 false
+    bool start();
+
+signals:
+    void finished(int failedCount);
+
+private:
+    struct Session;
+
+    void startNextFile();
+    void onBufferReady();
+    void onDecodeFinished();
+    void startPendingSessions();
+    void startSession(int chunkIndex);
+    Session *findSession(int id) const;
+    void scheduleFeed(int id);
+    void feedSession(Session *session);
+    void finishSession(Session *session, const QString &errorMessage = QString());
+    void finishFile(const QString &errorMessage = QString());
+    void releaseFile();
+
+    BatchOptions options;
+    SilenceSplitOptions splitOptions;
+    double feedSpeed;
+    QStringList pendingFiles;
+
+    // 当前文件
+    QString inputPath;
+    QAudioDecoder *decoder;
+    SampleConverter converter;
+    FrameEnergyMeter energyMeter;
+    QTemporaryFile *pcmFile;        // 每个文件新建，释放时删除
+    const char *pcm;                // pcmFile 的映射
+    qint64 pcmBytes;
+    std::vector<AudioChunk> chunks;
+    std::vector<std::vector<TranscriptSegment>> chunkSegments;
+    QList<int> pendingChunks;
+    QList<int> chunkAttempts;
+    QList<Session *> sessions;
+    bool fileFailed;
+    QElapsedTimer fileTimer;
+    qint64 decodeMs;
+
+    QElapsedTimer wallClock;
+    double totalAudioSeconds;
+    int completedCount;
+    int failedCount;
+    int nextSessionId;
+};
+
+#endif // SPLITTRANSCRIBER_H
@@ -0,0 +1,99 @@
+#include "startuptimer.h"
+#include "logger.h"
+#include "flightrecorder.h"
+#include <QElapsedTimer>
+#ifdef Q_OS_WIN
+#include <windows.h>
+#endif
+
+namespace {
+
+QList<StartupTimer::Phase> recordedPhases;
+int budgetMs = 1500;
+
+#ifndef Q_OS_WIN
+// 非 Windows 平台以静态初始化时刻近似进程启动
+QElapsedTimer &processClock()
+{
+    static QElapsedTimer clock;
+    if (!clock.isValid()) {
+        clock.start();
+    }
+    return clock;
+}
+const bool clockStarted = (processClock(), true);
+#endif
+
+} // namespace
+
+double StartupTimer::sinceProcessStartMs()
+{
+#ifdef Q_OS_WIN
+    // 以进程创建时间为起点，包含加载器解析 DLL 的时间
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime)) {
+        return 0;
+    }
+    FILETIME now;
+    GetSystemTimePreciseAsFileTime(&now);
+    ULARGE_INTEGER start, current;
+    start.LowPart = creationTime.dwLowDateTime;
+    start.HighPart = creationTime.dwHighDateTime;
+    current.LowPart = now.dwLowDateTime;
+    current.HighPart = now.dwHighDateTime;
+    return current.QuadPart > start.QuadPart ? (current.QuadPart - start.QuadPart) / 10000.0 : 0;
+#else
+    return processClock().nsecsElapsed() / 1000000.0;
+#endif
+}
+
+void StartupTimer::mark(const QString &phase)
+{
+    if (hasPhase(phase)) {
+        return;
+    }
+    const double ms = sinceProcessStartMs();
+    recordedPhases.append({phase, ms});
+    FlightRecorder::record(FlightEventType::State, "startup.phase", static_cast<int64_t>(ms));
+}
+
+bool StartupTimer::hasPhase(const QString &phase)
+{
+    for (const Phase &p : recordedPhases) {
+        if (p.name == phase) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void StartupTimer::setBudgetMs(int ms)
+{
+    budgetMs = ms;
+}
+
+QList<StartupTimer::Phase> StartupTimer::phases()
+{
+    return recordedPhases;
+}
+
+void StartupTimer::report()
+{
+    double previous = 0;
+    for (const Phase &p : recordedPhases) {
+        LOG_INFO(QString("启动阶段 %1: %2 ms（本阶段 %3 ms）")
+                 .arg(p.name)
+                 .arg(p.sinceProcessStartMs, 0, 'f', 1)
+                 .arg(p.sinceProcessStartMs - previous, 0, 'f', 1));
+        previous = p.sinceProcessStartMs;
+    }
+
+    // 预算只约束到主窗口可用为止，引擎就绪发生在用户点击开始之后
+    for (const Phase &p : recordedPhases) {
+        if (p.name == StartupPhase::WindowShown && budgetMs > 0 && p.sinceProcessStartMs > budgetMs) {
+            LOG_ERROR(QString("冷启动耗时 %1 ms，超过预算 %2 ms")
+                      .arg(p.sinceProcessStartMs, 0, 'f', 1)
+                      .arg(budgetMs));
+        }
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef STARTUPTIMER_H
+#define STARTUPTIMER_H
+
+#include <QString>
+#include <QList>
+
+// 启动阶段名称
+namespace StartupPhase {
+const char ProcessStart[] = "进程启动";
+const char ApplicationInit[] = "QApplication 初始化";
+const char WindowShown[] = "主窗口显示";
+const char EngineReady[] = "引擎就绪";
+}
+
+// 启动阶段计时：记录进程启动、QApplication 初始化、主窗口显示、引擎就绪等阶段
+// 距进程创建的毫秒数，并与启动预算（config.ini 的 Startup/BudgetMs）比较。
+// 只在主线程使用。
+class StartupTimer
+{
+public:
+    struct Phase {
+        QString name;
+        double sinceProcessStartMs;
+    };
+
+    // 记录一个阶段，同名阶段只记录第一次
+    static void mark(const QString &phase);
+
+    static bool hasPhase(const QString &phase);
+    static void setBudgetMs(int ms);
+    static QList<Phase> phases();
+
+    // 把已记录的阶段写入日志；超过预算时写错误日志
+    static void report();
+
+private:
+    static double sinceProcessStartMs();
+};
+
+#endif // STARTUPTIMER_H
@@ -0,0 +1,246 @@
+#include "subtitleoverlay.h"
+#include "metrics.h"
+#include <QElapsedTimer>
+#include <QFontMetrics>
+#include <QGuiApplication>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QScreen>
+#include <QSettings>
+#include <QTextOption>
+#include <cmath>
+
+SubtitleOverlay::SubtitleOverlay(QWidget *parent)
+    : QWidget(parent, Qt::Tool | Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint
+                          | Qt::WindowTransparentForInput | Qt::WindowDoesNotAcceptFocus)
+    , maxLines(3)
+    , maxRowsPerLine(2)
+    , padding(12)
+    , screenIndex(-1)
+    , widthPercent(80)
+    , bottomMargin(60)
+    , backgroundColor(0, 0, 0, 160)
+    , frameInterval(16)
+{
+    setWindowTitle("字幕浮层");
+    setAttribute(Qt::WA_TranslucentBackground);
+    setAttribute(Qt::WA_ShowWithoutActivating);
+    font.setPointSize(26);
+    font.setBold(true);
+
+    frameTimer.setSingleShot(true);
+    connect(&frameTimer, &QTimer::timeout, this, &SubtitleOverlay::flushRepaint);
+}
+
+void SubtitleOverlay::configure(QSettings &settings)
+{
+    maxLines = qBound(1, settings.value("Overlay/Lines", 3).toInt(), 8);
+    font.setPointSize(qBound(8, settings.value("Overlay/FontSize", 26).toInt(), 96));
+    backgroundColor.setAlphaF(qBound(0.0, settings.value("Overlay/Opacity", 0.63).toDouble(), 1.0));
+    screenIndex = settings.value("Overlay/Screen", -1).toInt();
+    widthPercent = qBound(20, settings.value("Overlay/WidthPercent", 80).toInt(), 100);
+    bottomMargin = qMax(0, settings.value("Overlay/BottomMargin", 60).toInt());
+    padding = qMax(4, QFontMetrics(font).height() / 3);
+    placeOnScreen();
+}
+
+void SubtitleOverlay::placeOnScreen()
+{
+    const QList<QScreen *> screens = QGuiApplication::screens();
+    QScreen *target = screenIndex >= 0 && screenIndex < screens.size()
+            ? screens[screenIndex] : QGuiApplication::primaryScreen();
+    if (!target) {
+        return;
+    }
+
+    // 每行最多 maxRowsPerLine 行文字，窗口高度按最多的行数预留，位置固定在屏幕底部
+    const QRect area = target->availableGeometry();
+    const int lineSpacing = QFontMetrics(font).lineSpacing();
+    const int width = area.width() * widthPercent / 100;
+    const int height = maxLines * (lineSpacing * maxRowsPerLine + padding * 3 / 2) + padding;
+    setGeometry(area.x() + (area.width() - width) / 2, area.y() + area.height() - bottomMargin - height,
+                width, height);
+    frameInterval = qMax(1, qRound(1000.0 / qMax(1.0, target->refreshRate())));
+
+    // 宽度或字体变化后所有行重新排版
+    for (Line &line : lines) {
+        prepareLine(line, line.text);
+    }
+    prepareLine(live, live.text);
+    arrangeLines();
+    scheduleRepaint(QRegion(rect()));
+}
+
+void SubtitleOverlay::setLiveText(const QString &text)
+{
+    if (text == live.text) {
+        return;
+    }
+    QElapsedTimer timer;
+    timer.start();
+    const QRect oldRect = live.rect;
+    prepareLine(live, text);
+    // 行高不变时其他行不动，只重绘实时行新旧两个位置
+    const bool moved = arrangeLines();
+    stats.totalLayoutNs += timer.nsecsElapsed();
+    if (moved) {
+        scheduleRepaint(QRegion(rect()));
+    } else {
+        scheduleRepaint(QRegion(oldRect).united(live.rect));
+    }
+}
+
+void SubtitleOverlay::commitLine(const QString &text)
+{
+    if (text.trimmed().isEmpty()) {
+        return;
+    }
+    QElapsedTimer timer;
+    timer.start();
+    // 定稿文本通常和最后一次部分结果相同，直接沿用已排好的实时行
+    if (text != live.text) {
+        prepareLine(live, text);
+    }
+    lines.append(live);
+    while (lines.size() > maxLines) {
+        lines.removeFirst();
+    }
+    live = Line();
+    arrangeLines();
+    stats.totalLayoutNs += timer.nsecsElapsed();
+    scheduleRepaint(QRegion(rect()));
+}
+
+void SubtitleOverlay::clear()
+{
+    lines.clear();
+    live = Line();
+    scheduleRepaint(QRegion(rect()));
+}
+
+void SubtitleOverlay::prepareLine(Line &line, const QString &text)
+{
+    line.text = text;
+    if (text.isEmpty()) {
+        line.layout = QStaticText();
+        return;
+    }
+
+    // 实时行可能很长（部分结果是整句），只保留能放进 maxRowsPerLine 行的结尾部分；
+    // 换行会在行尾留下空白，按九成宽度估算
+    const QFontMetrics metrics(font);
+    const int textWidth = qMax(1, width() - 4 * padding);
+    const int budget = textWidth * maxRowsPerLine * 9 / 10;
+    QString shown = text;
+    int advance = metrics.horizontalAdvance(shown);
+    if (advance > budget) {
+        shown = metrics.elidedText(text, Qt::ElideLeft, budget);
+        advance = metrics.horizontalAdvance(shown);
+    }
+
+    QTextOption option;
+    option.setAlignment(Qt::AlignHCenter);
+    option.setWrapMode(QTextOption::WrapAtWordBoundaryOrAnywhere);
+    line.layout.setTextFormat(Qt::PlainText);
+    line.layout.setTextOption(option);
+    line.layout.setPerformanceHint(QStaticText::AggressiveCaching);
+    // 一行放得下时按实际宽度排版，背景框随文字收窄
+    line.layout.setTextWidth(advance > textWidth ? textWidth : -1);
+    line.layout.setText(shown);
+    line.layout.prepare(QTransform(), font);
+    ++stats.layouts;
+}
+
+bool SubtitleOverlay::arrangeLines()
+{
+    // 实时行在最下方，已定稿的行从新到旧依次向上，放不下的不显示
+    int bottom = height() - padding;
+    auto place = [this, &bottom](Line &line) {
+        if (line.text.isEmpty()) {
+            line.rect = QRect();
+            return;
+        }
+        const QSizeF size = line.layout.size();
+        const int boxWidth = static_cast<int>(std::ceil(size.width())) + 2 * padding;
+        const int boxHeight = static_cast<int>(std::ceil(size.height())) + padding;
+        const int top = bottom - boxHeight;
+        line.rect = top >= 0 ? QRect((width() - boxWidth) / 2, top, boxWidth, boxHeight) : QRect();
+        bottom = top - padding / 2;
+    };
+
+    place(live);
+    bool moved = false;
+    for (int i = lines.size() - 1; i >= 0; --i) {
+        const QRect before = lines[i].rect;
+        place(lines[i]);
+        moved = moved || lines[i].rect != before;
+    }
+    return moved;
+}
+
+void SubtitleOverlay::scheduleRepaint(const QRegion &region)
+{
+    ++stats.updates;
+    dirty += region;
+    if (!isVisible() || frameTimer.isActive()) {
+        return;
+    }
+    // 距上次绘制不足一个刷新间隔时等到下一帧，期间的变化合并为一次绘制
+    const qint64 sinceLast = sinceLastFrame.isValid() ? sinceLastFrame.elapsed() : frameInterval;
+    frameTimer.start(static_cast<int>(qMax<qint64>(0, frameInterval - sinceLast)));
+}
+
+void SubtitleOverlay::flushRepaint()
+{
+    if (!dirty.isEmpty()) {
+        update(dirty);
+        dirty = QRegion();
+    }
+    sinceLastFrame.start();
+}
+
+void SubtitleOverlay::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    dirty = QRegion();
+    update();
+}
+
+void SubtitleOverlay::paintEvent(QPaintEvent *event)
+{
+    static MetricHistogram &paintUs = Metrics::histogram("overlay_paint_us", "字幕浮层每次绘制的耗时（微秒）",
+                                                         {50, 100, 200, 500, 1000, 2000, 5000, 10000});
+    QElapsedTimer timer;
+    timer.start();
+
+    // 透明窗口的重绘区域已被清空，只需画与之相交的行
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setFont(font);
+    const QRect area = event->rect();
+    const qreal radius = padding / 2.0;
+    auto drawLine = [&](const Line &line) {
+        if (line.rect.isNull() || !line.rect.intersects(area)) {
+            return;
+        }
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(backgroundColor);
+        painter.drawRoundedRect(line.rect, radius, radius);
+        painter.setPen(Qt::white);
+        painter.drawStaticText(line.rect.x() + padding, line.rect.y() + padding / 2, line.layout);
+    };
+    for (const Line &line : lines) {
+        drawLine(line);
+    }
+    drawLine(live);
+    painter.end();
+
+    const qint64 elapsedNs = timer.nsecsElapsed();
+    ++stats.paints;
+    stats.totalPaintNs += elapsedNs;
+    stats.maxPaintNs = qMax(stats.maxPaintNs, elapsedNs);
+    for (const QRect &painted : event->region()) {
+        stats.paintedPixels += static_cast<qint64>(painted.width()) * painted.height();
+    }
+    paintUs.observe(elapsedNs / 1000.0);
+}
@@ -0,0 +1,85 @@
+#ifndef SUBTITLEOVERLAY_H
+#define SUBTITLEOVERLAY_H
+
+#include <QWidget>
+#include <QElapsedTimer>
+#include <QFont>
+#include <QList>
+#include <QRegion>
+#include <QStaticText>
+#include <QTimer>
+
+class QSettings;
+
+// 字幕浮层：无边框、置顶、鼠标穿透的透明窗口，在屏幕底部显示最近几行字幕，
+// 共享屏幕演示时字幕浮在幻灯片上（Ctrl+Shift+O 切换）。
+//
+// 每行的排版结果缓存在 QStaticText 中，只有文本变化的行重新排版；实时行变化时只重绘
+// 这一行的区域，行高变化或定稿滚动时才重绘整个窗口。重绘合并到显示器刷新间隔，
+// 没有新结果时不运行任何定时器。
+class SubtitleOverlay : public QWidget
+{
+    Q_OBJECT
+
+public:
+    struct PaintStats {
+        int updates = 0;            // 提交的变化次数（相同文本不计）
+        int paints = 0;             // 实际绘制次数
+        int layouts = 0;            // 重新排版的行数
+        qint64 totalLayoutNs = 0;   // setLiveText/commitLine 中排版和摆放的耗时
+        qint64 totalPaintNs = 0;
+        qint64 maxPaintNs = 0;
+        qint64 paintedPixels = 0;   // 各次绘制区域的面积之和
+    };
+
+    explicit SubtitleOverlay(QWidget *parent = nullptr);
+
+    // 读取 [Overlay] Lines / FontSize / Opacity / Screen / WidthPercent / BottomMargin
+    void configure(QSettings &settings);
+
+    // 实时行（部分结果），定稿时由 commitLine 移入上方
+    void setLiveText(const QString &text);
+    void commitLine(const QString &text);
+    void clear();
+
+    int frameIntervalMs() const { return frameInterval; }
+    PaintStats paintStats() const { return stats; }
+    void resetPaintStats() { stats = PaintStats(); }
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+
+private:
+    struct Line {
+        QString text;
+        QStaticText layout;
+        QRect rect;                 // 在窗口中的位置，含背景边距
+    };
+
+    void placeOnScreen();
+    void prepareLine(Line &line, const QString &text);
+    // 按行高从底部向上排列，返回是否有行的位置变化
+    bool arrangeLines();
+    void scheduleRepaint(const QRegion &region);
+    void flushRepaint();
+
+    QList<Line> lines;              // 已定稿的行，旧的在前
+    Line live;
+    int maxLines;
+    int maxRowsPerLine;
+    QFont font;
+    int padding;
+    int screenIndex;
+    int widthPercent;
+    int bottomMargin;
+    QColor backgroundColor;
+
+    QRegion dirty;
+    QTimer frameTimer;
+    QElapsedTimer sinceLastFrame;
+    int frameInterval;
+    PaintStats stats;
+};
+
+#endif // SUBTITLEOVERLAY_H
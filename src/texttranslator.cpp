@@ -0,0 +1,224 @@
+#include "texttranslator.h"
+#include "logger.h"
+#include "metrics.h"
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+#include <QNetworkReply>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QUrlQuery>
+
+namespace {
+
+const int kDefaultBatchSize = 25;
+const int kDefaultRequestsInFlight = 4;
+const int kDefaultCacheCapacity = 2000;
+const int kBatchWindowMs = 30;   // 等待同批文本的时间窗口
+
+} // namespace
+
+TextTranslator::TextTranslator(QObject *parent)
+    : QObject(parent)
+    , networkManager(nullptr)
+    , endpoint(QUrl("https://api.cognitive.microsofttranslator.com"))
+    , maxBatchSize(kDefaultBatchSize)
+    , maxRequestsInFlight(kDefaultRequestsInFlight)
+    , requestsInFlight(0)
+    , cache(kDefaultCacheCapacity)
+    , nextRequestId(0)
+    , hitCount(0)
+    , missCount(0)
+    , requestCount(0)
+{
+    batchTimer.setSingleShot(true);
+    batchTimer.setInterval(kBatchWindowMs);
+    connect(&batchTimer, &QTimer::timeout, this, &TextTranslator::flushPending);
+}
+
+TextTranslator::~TextTranslator()
+{
+}
+
+void TextTranslator::setEndpoint(const QUrl &url)
+{
+    endpoint = url;
+}
+
+void TextTranslator::setCredentials(const QString &key, const QString &keyRegion)
+{
+    subscriptionKey = key;
+    region = keyRegion;
+}
+
+void TextTranslator::setMaxBatchSize(int size)
+{
+    maxBatchSize = qMax(1, size);
+}
+
+void TextTranslator::setMaxRequestsInFlight(int count)
+{
+    maxRequestsInFlight = qMax(1, count);
+}
+
+void TextTranslator::setCacheCapacity(int entries)
+{
+    cache.setMaxCost(qMax(1, entries));
+}
+
+QString TextTranslator::cacheKey(const QString &text, const QString &from, const QString &to)
+{
+    return from + QChar(0x1f) + to + QChar(0x1f) + text;
+}
+
+quint64 TextTranslator::translate(const QString &text, const QString &from, const QString &to)
+{
+    const quint64 requestId = ++nextRequestId;
+    const QString key = cacheKey(text, from, to);
+
+    // QCache::object 会把条目移到最近使用的位置
+    if (QString *cached = cache.object(key)) {
+        ++hitCount;
+        static MetricCounter &hits = Metrics::counter("translator_cache_hits_total", "额外翻译的缓存命中数");
+        hits.add();
+        emit translated(requestId, to, text, *cached);
+        return requestId;
+    }
+
+    ++missCount;
+    static MetricCounter &misses = Metrics::counter("translator_cache_misses_total", "额外翻译的缓存未命中数");
+    misses.add();
+    auto it = waiters.find(key);
+    if (it != waiters.end()) {
+        // 同样的文本已经在队列或请求中，等待同一个结果
+        it->append(requestId);
+        return requestId;
+    }
+    waiters.insert(key, {requestId});
+
+    PendingBatch *batch = nullptr;
+    for (PendingBatch &candidate : pending) {
+        if (candidate.from == from && candidate.to == to) {
+            batch = &candidate;
+            break;
+        }
+    }
+    if (!batch) {
+        pending.append({from, to, {}});
+        batch = &pending.last();
+    }
+    batch->texts.append(text);
+
+    if (batch->texts.size() >= maxBatchSize) {
+        flushPending();
+    } else if (!batchTimer.isActive()) {
+        batchTimer.start();
+    }
+    return requestId;
+}
+
+void TextTranslator::flushPending()
+{
+    while (requestsInFlight < maxRequestsInFlight && !pending.isEmpty()) {
+        PendingBatch &batch = pending.first();
+        QStringList texts = batch.texts.mid(0, maxBatchSize);
+        batch.texts = batch.texts.mid(texts.size());
+        const QString from = batch.from;
+        const QString to = batch.to;
+        if (batch.texts.isEmpty()) {
+            pending.removeFirst();
+        }
+        sendBatch(from, to, texts);
+    }
+}
+
+void TextTranslator::sendBatch(const QString &from, const QString &to, const QStringList &texts)
+{
+    QJsonArray body;
+    for (const QString &text : texts) {
+        body.append(QJsonObject{{"Text", text}});
+    }
+
+    QUrl url(endpoint);
+    QString path = url.path();
+    if (path.endsWith('/')) {
+        path.chop(1);
+    }
+    url.setPath(path + "/translate");
+    QUrlQuery query;
+    query.addQueryItem("api-version", "3.0");
+    query.addQueryItem("from", from);
+    query.addQueryItem("to", to);
+    url.setQuery(query);
+
+    QNetworkRequest request(url);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json; charset=UTF-8");
+    if (!subscriptionKey.isEmpty()) {
+        request.setRawHeader("Ocp-Apim-Subscription-Key", subscriptionKey.toUtf8());
+    }
+    if (!region.isEmpty()) {
+        request.setRawHeader("Ocp-Apim-Subscription-Region", region.toUtf8());
+    }
+
+    // 第一次真正发请求时再创建，未启用额外翻译的启动不加载网络栈
+    if (!networkManager) {
+        networkManager = new QNetworkAccessManager(this);
+    }
+    ++requestsInFlight;
+    ++requestCount;
+    static MetricCounter &requests = Metrics::counter("translator_requests_total", "额外翻译发出的 HTTP 请求数");
+    requests.add();
+    QNetworkReply *reply = networkManager->post(request, QJsonDocument(body).toJson(QJsonDocument::Compact));
+    connect(reply, &QNetworkReply::finished, this, [this, reply, from, to, texts]() {
+        handleReply(reply, from, to, texts);
+    });
+}
+
+void TextTranslator::handleReply(QNetworkReply *reply, const QString &from, const QString &to, const QStringList &texts)
+{
+    --requestsInFlight;
+    reply->deleteLater();
+
+    const QByteArray response = reply->readAll();
+    const QJsonDocument doc = QJsonDocument::fromJson(response);
+
+    if (reply->error() != QNetworkReply::NoError || !doc.isArray()) {
+        QString message = reply->errorString();
+        QJsonObject errorObj = doc.object().value("error").toObject();
+        if (!errorObj.isEmpty()) {
+            message = errorObj.value("message").toString();
+        }
+        LOG_ERROR(QString("文本翻译请求失败（%1 条）: %2").arg(texts.size()).arg(message));
+        dropWaiters(from, to, texts);
+        emit error(message);
+        flushPending();
+        return;
+    }
+
+    const QJsonArray results = doc.array();
+    for (int i = 0; i < texts.size(); ++i) {
+        const QString key = cacheKey(texts[i], from, to);
+        const QList<quint64> ids = waiters.take(key);
+        if (i >= results.size()) {
+            continue;
+        }
+        const QJsonArray translations = results[i].toObject().value("translations").toArray();
+        if (translations.isEmpty()) {
+            continue;
+        }
+        const QString translation = translations.first().toObject().value("text").toString();
+        cache.insert(key, new QString(translation));
+        for (quint64 id : ids) {
+            emit translated(id, to, texts[i], translation);
+        }
+    }
+
+    flushPending();
+}
+
+void TextTranslator::dropWaiters(const QString &from, const QString &to, const QStringList &texts)
+{
+    for (const QString &text : texts) {
+        waiters.remove(cacheKey(text, from, to));
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef TEXTTRANSLATOR_H
+#define TEXTTRANSLATOR_H
+
+#include <QObject>
+#include <QCache>
+#include <QHash>
+#include <QList>
+#include <QStringList>
+#include <QTimer>
+#include <QUrl>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+// 文本翻译客户端（Azure Translator v3 REST 接口）。
+// 用于把已经定稿的字幕再翻译成其他语言：同一语言对的文本合并成批量请求，
+// 并发请求数有上限，连接由 QNetworkAccessManager 保持复用；
+// 结果按“原文 + 语言对”放入 LRU 缓存，重复的句子不再访问网络。
+class TextTranslator : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TextTranslator(QObject *parent = nullptr);
+    ~TextTranslator();
+
+    // 服务地址，默认为 https://api.cognitive.microsofttranslator.com，可指向本地替身服务
+    void setEndpoint(const QUrl &endpoint);
+    void setCredentials(const QString &key, const QString &region);
+    void setMaxBatchSize(int size);
+    void setMaxRequestsInFlight(int count);
+    void setCacheCapacity(int entries);
+
+    // 请求翻译，返回请求编号；命中缓存时在返回前就发出 translated
+    quint64 translate(const QString &text, const QString &from, const QString &to);
+
+    int cacheHits() const { return hitCount; }
+    int cacheMisses() const { return missCount; }
+    int requestsSent() const { return requestCount; }
+
+signals:
+    void translated(quint64 requestId, const QString &to, const QString &source, const QString &translation);
+    void error(const QString &message);
+
+private:
+    // 同一语言对待发送的文本
+    struct PendingBatch {
+        QString from;
+        QString to;
+        QStringList texts;
+    };
+
+    static QString cacheKey(const QString &text, const QString &from, const QString &to);
+    void flushPending();
+    void sendBatch(const QString &from, const QString &to, const QStringList &texts);
+    void handleReply(QNetworkReply *reply, const QString &from, const QString &to, const QStringList &texts);
+    void dropWaiters(const QString &from, const QString &to, const QStringList &texts);
+
+    QNetworkAccessManager *networkManager;
+    QUrl endpoint;
+    QString subscriptionKey;
+    QString region;
+    int maxBatchSize;
+    int maxRequestsInFlight;
+    int requestsInFlight;
+
+    QCache<QString, QString> cache;
+    QHash<QString, QList<quint64>> waiters;   // 缓存键 -> 等待该结果的请求
+    QList<PendingBatch> pending;
+    QTimer batchTimer;
+    quint64 nextRequestId;
+
+    int hitCount;
+    int missCount;
+    int requestCount;
+};
+
+#endif // TEXTTRANSLATOR_H
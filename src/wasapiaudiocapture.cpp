@@ -1,19 +1,85 @@
 #include "wasapiaudiocapture.h"
 #include "logger.h"
+#include "flightrecorder.h"
 #include <comdef.h>
-#include <vector>
+#include <ksmedia.h>
+#include <avrt.h>
 #include <cmath>
 
+namespace {
+
+// 根据 WAVEFORMATEX / WAVEFORMATEXTENSIBLE 描述得到采样格式
+AudioStreamFormat describeWaveFormat(const WAVEFORMATEX* format)
+{
+    AudioStreamFormat result;
+    result.channels = format->nChannels;
+    result.sampleRate = static_cast<int>(format->nSamplesPerSec);
+    result.containerBits = format->wBitsPerSample;
+    result.validBits = format->wBitsPerSample;
+
+    bool isFloat = false;
+    bool isPcm = false;
+    if (format->wFormatTag == WAVE_FORMAT_EXTENSIBLE && format->cbSize >= sizeof(WAVEFORMATEXTENSIBLE) - sizeof(WAVEFORMATEX)) {
+        auto ext = reinterpret_cast<const WAVEFORMATEXTENSIBLE*>(format);
+        isFloat = IsEqualGUID(ext->SubFormat, KSDATAFORMAT_SUBTYPE_IEEE_FLOAT) != FALSE;
+        isPcm = IsEqualGUID(ext->SubFormat, KSDATAFORMAT_SUBTYPE_PCM) != FALSE;
+        if (ext->Samples.wValidBitsPerSample != 0) {
+            result.validBits = ext->Samples.wValidBitsPerSample;
+        }
+    } else {
+        isFloat = format->wFormatTag == WAVE_FORMAT_IEEE_FLOAT;
+        isPcm = format->wFormatTag == WAVE_FORMAT_PCM;
+    }
+
+    if (isFloat && format->wBitsPerSample == 32) {
+        result.sampleType = SampleType::Float32;
+    } else if (isPcm) {
+        switch (format->wBitsPerSample) {
+        case 16: result.sampleType = SampleType::Int16; break;
+        case 24: result.sampleType = SampleType::Int24Packed; break;
+        case 32: result.sampleType = SampleType::Int32; break;
+        default: break;
+        }
+    }
+    return result;
+}
+
+// 采集调度用的单调时钟
+class QpcClock : public CaptureClock
+{
+public:
+    QpcClock() { QueryPerformanceFrequency(&frequency); }
+
+    uint64_t nowUs() override
+    {
+        LARGE_INTEGER now;
+        QueryPerformanceCounter(&now);
+        return static_cast<uint64_t>(now.QuadPart / frequency.QuadPart) * 1000000ULL
+                + static_cast<uint64_t>(now.QuadPart % frequency.QuadPart) * 1000000ULL / frequency.QuadPart;
+    }
+
+private:
+    LARGE_INTEGER frequency;
+};
+
+} // namespace
+
 WasapiAudioCapture::WasapiAudioCapture(QObject *parent)
-    : QObject(parent)
+    : AudioCapture(parent)
     , m_deviceEnumerator(nullptr)
     , m_audioDevice(nullptr)
     , m_audioClient(nullptr)
     , m_captureClient(nullptr)
     , m_captureThread(nullptr)
+    , m_bufferEvent(nullptr)
     , m_isCapturing(false)
     , m_waveFormat(nullptr)
     , m_bufferFrameCount(0)
+    , m_scratch(MemoryTag::Dsp)
+    , m_pollIntervalMs(10)
+    , m_devicePeriodMs(10)
+    , m_bufferDurationMs(0)
+    , m_pollLimitMs(0)
     , logger(std::make_unique<Logger>())
 {
     LOG_INFO("WasapiAudioCapture 初始化");
@@ -26,6 +92,30 @@ WasapiAudioCapture::~WasapiAudioCapture()
     cleanupWASAPI();
 }
 
+void WasapiAudioCapture::setLatencyProfile(const LatencyProfile &profile)
+{
+    m_pollIntervalMs = qMax(1, profile.capturePollMs);
+    m_bufferDurationMs = qMax(0, profile.bufferDurationMs);
+}
+
+int64_t WasapiAudioCapture::recordPacketLatency(UINT64 qpcPosition)
+{
+    // GetBuffer 返回的设备位置以 100ns 为单位
+    LARGE_INTEGER now;
+    LARGE_INTEGER frequency;
+    QueryPerformanceCounter(&now);
+    QueryPerformanceFrequency(&frequency);
+    const UINT64 now100ns = static_cast<UINT64>(now.QuadPart / frequency.QuadPart) * 10000000ULL
+            + static_cast<UINT64>(now.QuadPart % frequency.QuadPart) * 10000000ULL / frequency.QuadPart;
+    if (qpcPosition == 0 || now100ns < qpcPosition) {
+        return -1;
+    }
+
+    const UINT64 latencyUs = (now100ns - qpcPosition) / 10;
+    recordLatencyUs(latencyUs);
+    return static_cast<int64_t>(latencyUs);
+}
+
 bool WasapiAudioCapture::initializeWASAPI()
 {
     LOG_INFO("开始初始化 WASAPI");
@@ -118,13 +208,48 @@ bool WasapiAudioCapture::initializeWASAPI()
         pMixFormat = nullptr;  // 防止在后面的 CoTaskMemFree 中重复释放
     }
 
-    // 使用选定的格式初始化
+    // 使用选定的格式初始化，缓冲区时长由延迟档位决定（单位 100ns）。
+    // 回环流的缓冲区事件需要 Windows 10；初始化或设置事件失败时退回按兜底超时轮询。
+    // Initialize 失败后同一个 IAudioClient 不能再次初始化，轮询要换一个新激活的客户端
+    bool eventDriven = false;
     hr = m_audioClient->Initialize(AUDCLNT_SHAREMODE_SHARED,
-                                 AUDCLNT_STREAMFLAGS_LOOPBACK,
-                                 0,    // 默认缓冲区时长
-                                 0,    // event-driven 模式
+                                 AUDCLNT_STREAMFLAGS_LOOPBACK | AUDCLNT_STREAMFLAGS_EVENTCALLBACK,
+                                 static_cast<REFERENCE_TIME>(m_bufferDurationMs) * 10000,
+                                 0,
                                  (WAVEFORMATEX*)m_waveFormat,
                                  nullptr);
+    if (SUCCEEDED(hr)) {
+        if (!m_bufferEvent) {
+            m_bufferEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+        }
+        eventDriven = m_bufferEvent && SUCCEEDED(m_audioClient->SetEventHandle(m_bufferEvent));
+        if (!eventDriven) {
+            LOG_ERROR("无法设置缓冲区事件，改为轮询");
+        }
+    } else {
+        LOG_ERROR(QString("事件驱动初始化失败（0x%1），改为轮询").arg(hr, 8, 16, QChar('0')));
+    }
+
+    if (!eventDriven) {
+        if (m_bufferEvent) {
+            CloseHandle(m_bufferEvent);
+            m_bufferEvent = nullptr;
+        }
+        m_audioClient->Release();
+        m_audioClient = nullptr;
+        hr = m_audioDevice->Activate(__uuidof(IAudioClient),
+                                    CLSCTX_ALL,
+                                    nullptr,
+                                    (void**)&m_audioClient);
+        if (SUCCEEDED(hr)) {
+            hr = m_audioClient->Initialize(AUDCLNT_SHAREMODE_SHARED,
+                                         AUDCLNT_STREAMFLAGS_LOOPBACK,
+                                         static_cast<REFERENCE_TIME>(m_bufferDurationMs) * 10000,
+                                         0,
+                                         (WAVEFORMATEX*)m_waveFormat,
+                                         nullptr);
+        }
+    }
 
     if (pMixFormat) {
         CoTaskMemFree(pMixFormat);  // 如果之前没有使用系统混音格式，释放它
@@ -139,6 +264,12 @@ bool WasapiAudioCapture::initializeWASAPI()
         return false;
     }
 
+    // 设备周期决定缓冲区事件的间隔，兜底超时按它放宽
+    REFERENCE_TIME defaultPeriod = 0;
+    if (SUCCEEDED(m_audioClient->GetDevicePeriod(&defaultPeriod, nullptr)) && defaultPeriod > 0) {
+        m_devicePeriodMs = qMax(1, static_cast<int>(defaultPeriod / 10000));
+    }
+
     // 获取缓冲区大小
     hr = m_audioClient->GetBufferSize(&m_bufferFrameCount);
     if (FAILED(hr)) {
@@ -150,7 +281,32 @@ bool WasapiAudioCapture::initializeWASAPI()
         return false;
     }
 
-    LOG_INFO(QString("音频缓冲区大小：%1 帧").arg(m_bufferFrameCount));
+    // 轮询时没有事件提醒，两次取数据的间隔不能超过缓冲区时长的一半，否则缓冲区写满后丢音频
+    const int bufferMs = static_cast<int>(static_cast<qint64>(m_bufferFrameCount) * 1000
+                                          / qMax<DWORD>(1, m_waveFormat->Format.nSamplesPerSec));
+    m_pollLimitMs = m_bufferEvent ? 0 : qMax(1, bufferMs / 2);
+
+    LOG_INFO(QString("音频缓冲区大小：%1 帧（%2 ms），设备周期 %3 ms，%4")
+             .arg(m_bufferFrameCount)
+             .arg(bufferMs)
+             .arg(m_devicePeriodMs)
+             .arg(m_bufferEvent ? "事件驱动" : QString("轮询，间隔不超过 %1 ms").arg(m_pollLimitMs)));
+
+    // 根据协商出的格式选定采样转换函数，之后每个数据包不再判断格式
+    AudioStreamFormat streamFormat = describeWaveFormat(&m_waveFormat->Format);
+    m_converter = SampleConverter::create(streamFormat);
+    if (!m_converter.isValid()) {
+        LOG_ERROR(QString("不支持的采样格式：格式标记 0x%1, %2 bit（有效 %3 bit）")
+                 .arg(m_waveFormat->Format.wFormatTag, 4, 16, QChar('0'))
+                 .arg(streamFormat.containerBits)
+                 .arg(streamFormat.validBits));
+        emit error("不支持的音频采样格式");
+        return false;
+    }
+    LOG_INFO(QString("采样格式：%1 bit 容器，%2 bit 有效，%3 通道")
+             .arg(streamFormat.containerBits)
+             .arg(streamFormat.validBits)
+             .arg(streamFormat.channels));
 
     // 获取捕获客户端
     hr = m_audioClient->GetService(__uuidof(IAudioCaptureClient),
@@ -191,6 +347,10 @@ void WasapiAudioCapture::cleanupWASAPI()
         CoTaskMemFree(m_waveFormat);  // 使用 CoTaskMemFree 释放内存
         m_waveFormat = nullptr;
     }
+    if (m_bufferEvent) {
+        CloseHandle(m_bufferEvent);
+        m_bufferEvent = nullptr;
+    }
     LOG_INFO("WASAPI 资源清理完成");
 }
 
@@ -207,6 +367,15 @@ bool WasapiAudioCapture::startCapture()
         return false;
     }
 
+    // 有声音时的兜底超时取两个设备周期（且不短于档位的轮询间隔），静音时逐步放宽
+    CaptureSchedulerConfig schedule;
+    schedule.activeTimeoutMs = qMax(2 * m_devicePeriodMs, m_pollIntervalMs);
+    if (m_pollLimitMs > 0) {
+        schedule.activeTimeoutMs = qMin(schedule.activeTimeoutMs, m_pollLimitMs);
+        schedule.maxIdleTimeoutMs = m_pollLimitMs;
+    }
+    scheduler.setConfig(schedule);
+
     HRESULT hr = m_audioClient->Start();
     if (FAILED(hr)) {
         LOG_ERROR("无法启动音频捕获");
@@ -215,6 +384,7 @@ bool WasapiAudioCapture::startCapture()
     }
 
     m_isCapturing = true;
+    FlightRecorder::record(FlightEventType::State, "capture.start", m_waveFormat->Format.nSamplesPerSec);
     m_captureThread = CreateThread(nullptr, 0, captureThread, this, 0, nullptr);
     if (!m_captureThread) {
         LOG_ERROR("无法创建捕获线程");
@@ -234,7 +404,11 @@ void WasapiAudioCapture::stopCapture()
     }
 
     LOG_INFO("停止音频捕获");
+    FlightRecorder::record(FlightEventType::State, "capture.stop");
     m_isCapturing = false;
+    if (m_bufferEvent) {
+        SetEvent(m_bufferEvent);  // 不必等到超时
+    }
     if (m_captureThread) {
         WaitForSingleObject(m_captureThread, INFINITE);
         CloseHandle(m_captureThread);
@@ -250,127 +424,94 @@ void WasapiAudioCapture::stopCapture()
 DWORD WINAPI WasapiAudioCapture::captureThread(LPVOID context)
 {
     WasapiAudioCapture* capture = static_cast<WasapiAudioCapture*>(context);
+
+    // 注册到 MMCSS，系统繁忙时采集线程仍按音频任务的优先级调度
+    DWORD taskIndex = 0;
+    HANDLE mmcssTask = AvSetMmThreadCharacteristicsW(L"Pro Audio", &taskIndex);
+    if (!mmcssTask) {
+        mmcssTask = AvSetMmThreadCharacteristicsW(L"Audio", &taskIndex);
+    }
+    if (!mmcssTask) {
+        LOG_ERROR(QString("采集线程注册 MMCSS 失败，错误代码 %1，按普通优先级运行").arg(GetLastError()));
+    }
+
+    QpcClock clock;
+    runCaptureLoop(clock, *capture, capture->scheduler, capture->m_isCapturing);
+
+    if (mmcssTask) {
+        AvRevertMmThreadCharacteristics(mmcssTask);
+    }
+    return 0;
+}
+
+bool WasapiAudioCapture::waitForData(int timeoutMs)
+{
+    if (!m_bufferEvent) {
+        Sleep(static_cast<DWORD>(m_pollLimitMs > 0 ? qMin(timeoutMs, m_pollLimitMs) : timeoutMs));
+        return false;
+    }
+    return WaitForSingleObject(m_bufferEvent, static_cast<DWORD>(timeoutMs)) == WAIT_OBJECT_0;
+}
+
+bool WasapiAudioCapture::readPacket(CapturePacket &packet)
+{
     UINT32 packetLength = 0;
+    if (FAILED(m_captureClient->GetNextPacketSize(&packetLength)) || packetLength == 0) {
+        return false;
+    }
+
     BYTE* data = nullptr;
     UINT32 numFramesAvailable = 0;
     DWORD flags = 0;
+    UINT64 qpcPosition = 0;
+    HRESULT hr = m_captureClient->GetBuffer(&data, &numFramesAvailable, &flags, nullptr, &qpcPosition);
+    if (FAILED(hr) || hr == AUDCLNT_S_BUFFER_EMPTY) {
+        return false;
+    }
 
-    while (capture->m_isCapturing) {
-        Sleep(10); // 避免过度占用CPU
-
-        HRESULT hr = capture->m_captureClient->GetNextPacketSize(&packetLength);
-        if (FAILED(hr)) {
-            continue;
-        }
+    packet.frames = numFramesAvailable;
+    packet.silent = (flags & AUDCLNT_BUFFERFLAGS_SILENT) != 0;
+    packet.discontinuity = (flags & AUDCLNT_BUFFERFLAGS_DATA_DISCONTINUITY) != 0;
+    packet.timestampError = (flags & AUDCLNT_BUFFERFLAGS_TIMESTAMP_ERROR) != 0;
+    packet.latencyUs = recordPacketLatency(qpcPosition);
 
-        while (packetLength > 0) {
-            hr = capture->m_captureClient->GetBuffer(&data,
-                                                   &numFramesAvailable,
-                                                   &flags,
-                                                   nullptr,
-                                                   nullptr);
-            if (FAILED(hr)) {
-                break;
-            }
-
-            if (data && numFramesAvailable > 0) {
-                capture->processAudioData(data, numFramesAvailable);
-            }
-
-            capture->m_captureClient->ReleaseBuffer(numFramesAvailable);
-            hr = capture->m_captureClient->GetNextPacketSize(&packetLength);
-            if (FAILED(hr)) {
-                break;
-            }
-        }
+    if (numFramesAvailable > 0) {
+        processAudioData(data, numFramesAvailable, flags);
     }
 
-    return 0;
+    m_captureClient->ReleaseBuffer(numFramesAvailable);
+    return true;
 }
 
-void WasapiAudioCapture::processAudioData(const BYTE* data, UINT32 numFrames)
+void WasapiAudioCapture::processAudioData(const BYTE* data, UINT32 numFrames, DWORD flags)
 {
-    if (!data || numFrames == 0) {
+    const bool silent = (flags & AUDCLNT_BUFFERFLAGS_SILENT) != 0;
+    if ((!data && !silent) || numFrames == 0) {
         return;
     }
 
-    // 将 BYTE* 转换为 float* 数组
-    auto floatBuf = reinterpret_cast<const float*>(data);
-    
-    // 创建 16-bit PCM 缓冲区
-    std::vector<int16_t> pcm16;
-    pcm16.reserve(numFrames * m_waveFormat->Format.nChannels);
-
-    // 转换每个采样点
-    for (UINT32 i = 0; i < numFrames * m_waveFormat->Format.nChannels; ++i) {
-        float f = floatBuf[i];
-        // 裁剪到 [-1.0, 1.0] 范围
-        if (f > 1.f)  f = 1.f;
-        if (f < -1.f) f = -1.f;
-        // 转换为 16-bit PCM
-        pcm16.push_back(static_cast<int16_t>(f * 32767));
-    }
-
-    // 如果当前不是 16kHz/16bit/单声道，需要进行转换
-    std::vector<int16_t> finalBuffer;
-    if (m_waveFormat->Format.nSamplesPerSec != 16000 || m_waveFormat->Format.nChannels != 1) {
-        // 先进行声道混音（如果需要）
-        std::vector<int16_t> monoBuffer;
-        if (m_waveFormat->Format.nChannels > 1) {
-            monoBuffer.reserve(numFrames);
-            for (UINT32 i = 0; i < numFrames; ++i) {
-                int32_t sum = 0;
-                for (UINT32 ch = 0; ch < m_waveFormat->Format.nChannels; ++ch) {
-                    sum += pcm16[i * m_waveFormat->Format.nChannels + ch];
-                }
-                monoBuffer.push_back(static_cast<int16_t>(sum / m_waveFormat->Format.nChannels));
-            }
-        } else {
-            monoBuffer = std::move(pcm16);
-        }
+    FlightRecorder::record(FlightEventType::Counter, silent ? "capture.silent" : "capture.frames", numFrames);
 
-        // 然后进行重采样（如果需要）
-        if (m_waveFormat->Format.nSamplesPerSec != 16000) {
-            const double ratio = 16000.0 / m_waveFormat->Format.nSamplesPerSec;
-            const size_t newSize = static_cast<size_t>(std::ceil(monoBuffer.size() * ratio));
-            finalBuffer.reserve(newSize);
-
-            // 线性插值重采样
-            for (size_t i = 0; i < newSize; ++i) {
-                double pos = i / ratio;
-                size_t pos1 = static_cast<size_t>(std::floor(pos));
-                size_t pos2 = pos1 + 1;
-                double frac = pos - pos1;
-
-                // 边界检查
-                if (pos2 >= monoBuffer.size()) {
-                    pos2 = monoBuffer.size() - 1;
-                }
-
-                // 线性插值
-                double sample = monoBuffer[pos1] * (1.0 - frac) + monoBuffer[pos2] * frac;
-                finalBuffer.push_back(static_cast<int16_t>(std::round(sample)));
-            }
-        } else {
-            finalBuffer = std::move(monoBuffer);
-        }
-    } else {
-        finalBuffer = std::move(pcm16);
-    }
-
-    // 创建输出数据
-    QByteArray out(reinterpret_cast<const char*>(finalBuffer.data()), finalBuffer.size() * sizeof(int16_t));
-    
-    // 使用静态计数器来减少日志输出频率
-    static int logCounter = 0;
-    if (++logCounter % 100 == 0) {  // 每100个数据块记录一次
-        LOG_INFO(QString("处理音频数据：输入 %1 帧，%2 通道，%3 Hz，输出 %4 帧，16kHz/16bit/单声道，输出大小：%5 字节")
-                .arg(numFrames)
-                .arg(m_waveFormat->Format.nChannels)
-                .arg(m_waveFormat->Format.nSamplesPerSec)
-                .arg(finalBuffer.size())
-                .arg(out.size()));
+    countPacket(numFrames, silent);
+
+    // 转换和重采样的中间数据只在本包内有效，从每包回收一次的 m_scratch 中分配
+    m_scratch.reset();
+    int16_t *mono = m_scratch.allocateArray<int16_t>(numFrames);
+    m_converter.convert(data, numFrames, silent, mono);
+
+    // 如果当前不是 16kHz，需要进行重采样
+    const int inRate = static_cast<int>(m_waveFormat->Format.nSamplesPerSec);
+    const int16_t *pcm = mono;
+    size_t samples = numFrames;
+    if (inRate != 16000) {
+        int16_t *resampled = m_scratch.allocateArray<int16_t>(resampledLength(numFrames, inRate, 16000));
+        samples = resampleLinear(mono, numFrames, inRate, 16000, resampled);
+        pcm = resampled;
     }
 
+    // 创建输出数据：交给接收方释放，只计入采集的分配量
+    QByteArray out(reinterpret_cast<const char*>(pcm), static_cast<int>(samples * sizeof(int16_t)));
+    MemoryAccounting::transient(MemoryTag::Capture, out.size());
+
     emit audioDataReceived(out);
 } 
\ No newline at end of file
@@ -8,37 +8,54 @@
 #include <audioclient.h>
 #include <functiondiscoverykeys_devpkey.h>
 #include "logger.h"
+#include "audioformat.h"
+#include "audiocapture.h"
+#include "memoryaccounting.h"
+#include <atomic>
 #include <memory>
 
-class WasapiAudioCapture : public QObject
+// WASAPI 回环采集默认输出设备。
+// 采集线程注册到 MMCSS，由音频引擎的缓冲区事件驱动（带超时兜底），调度见 CaptureScheduler。
+class WasapiAudioCapture : public AudioCapture, private CaptureSource
 {
     Q_OBJECT
 public:
     explicit WasapiAudioCapture(QObject *parent = nullptr);
     ~WasapiAudioCapture();
 
-    bool startCapture();
-    void stopCapture();
-    bool isCapturing() const { return m_isCapturing; }
+    bool startCapture() override;
+    void stopCapture() override;
+    bool isCapturing() const override { return m_isCapturing; }
 
-signals:
-    void audioDataReceived(const QByteArray &data);
-    void error(const QString &message);
+    // 设置兜底超时和缓冲区时长，下次 startCapture 时生效
+    void setLatencyProfile(const LatencyProfile &profile) override;
 
 private:
     bool initializeWASAPI();
     void cleanupWASAPI();
     static DWORD WINAPI captureThread(LPVOID context);
-    void processAudioData(const BYTE* data, UINT32 numFrames);
+    void processAudioData(const BYTE* data, UINT32 numFrames, DWORD flags);
+    int64_t recordPacketLatency(UINT64 qpcPosition);
+
+    // CaptureSource：等待缓冲区事件，取出并处理一个数据包
+    bool waitForData(int timeoutMs) override;
+    bool readPacket(CapturePacket &packet) override;
 
     IMMDeviceEnumerator* m_deviceEnumerator;
     IMMDevice* m_audioDevice;
     IAudioClient* m_audioClient;
     IAudioCaptureClient* m_captureClient;
     HANDLE m_captureThread;
-    bool m_isCapturing;
+    HANDLE m_bufferEvent;
+    std::atomic<bool> m_isCapturing;
     WAVEFORMATEXTENSIBLE* m_waveFormat;
     UINT32 m_bufferFrameCount;
+    SampleConverter m_converter;
+    MemoryArena m_scratch;      // 每个数据包的转换/重采样缓冲区，只在采集线程使用
+    int m_pollIntervalMs;
+    int m_devicePeriodMs;
+    int m_bufferDurationMs;
+    int m_pollLimitMs;          // 轮询模式下的最长等待（缓冲区时长的一半），事件驱动时为 0
     std::unique_ptr<Logger> logger;
     static const int SAMPLE_RATE = 16000;
     static const int CHANNELS = 1;
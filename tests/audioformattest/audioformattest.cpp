@@ -0,0 +1,246 @@
+// 采样格式转换测试：用合成的设备缓冲区覆盖 float32、int16、packed int24、32 位容器中的 24 位、
+// int32，以及多声道混合、有效位掩码和静音标志。全部通过时返回 0。
+//   g++ -std=c++17 -I../../src audioformattest.cpp ../../src/audioformat.cpp -o audioformattest
+
+#include "audioformat.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+#define CHECK_EQ(actual, expected) \
+    checkEqual(static_cast<long long>(actual), static_cast<long long>(expected), #actual, __LINE__)
+
+void checkEqual(long long actual, long long expected, const char *what, int line)
+{
+    if (actual != expected) {
+        std::fprintf(stderr, "第 %d 行: %s = %lld，期望 %lld\n", line, what, actual, expected);
+        ++failures;
+    }
+}
+
+AudioStreamFormat makeFormat(SampleType type, int channels, int containerBits, int validBits = 0)
+{
+    AudioStreamFormat format;
+    format.sampleType = type;
+    format.channels = channels;
+    format.sampleRate = 48000;
+    format.containerBits = containerBits;
+    format.validBits = validBits > 0 ? validBits : containerBits;
+    return format;
+}
+
+template <typename T>
+void append(std::vector<uint8_t> &buffer, T value)
+{
+    const size_t at = buffer.size();
+    buffer.resize(at + sizeof(T));
+    std::memcpy(buffer.data() + at, &value, sizeof(T));
+}
+
+void appendInt24(std::vector<uint8_t> &buffer, int32_t value)
+{
+    const uint32_t u = static_cast<uint32_t>(value);
+    buffer.push_back(static_cast<uint8_t>(u));
+    buffer.push_back(static_cast<uint8_t>(u >> 8));
+    buffer.push_back(static_cast<uint8_t>(u >> 16));
+}
+
+std::vector<int16_t> convert(const AudioStreamFormat &format, const std::vector<uint8_t> &buffer, bool silent = false)
+{
+    SampleConverter converter = SampleConverter::create(format);
+    std::vector<int16_t> out;
+    converter.convert(buffer.data(), static_cast<uint32_t>(buffer.size() / converter.bytesPerFrame()), silent, out);
+    return out;
+}
+
+void testFloat32()
+{
+    std::vector<uint8_t> mono;
+    for (float f : {0.0f, 0.5f, -0.5f, 1.0f, 1.5f, -2.0f}) {
+        append(mono, f);
+    }
+    const std::vector<int16_t> out = convert(makeFormat(SampleType::Float32, 1, 32), mono);
+    CHECK_EQ(out.size(), 6);
+    CHECK_EQ(out[0], 0);
+    CHECK_EQ(out[1], 16383);
+    CHECK_EQ(out[2], -16383);
+    CHECK_EQ(out[3], 32767);
+    CHECK_EQ(out[4], 32767);     // 超出量程的值被裁剪
+    CHECK_EQ(out[5], -32767);
+
+    std::vector<uint8_t> stereo;
+    append(stereo, 0.5f);
+    append(stereo, -0.5f);
+    append(stereo, 1.0f);
+    append(stereo, 0.0f);
+    const std::vector<int16_t> mixed = convert(makeFormat(SampleType::Float32, 2, 32), stereo);
+    CHECK_EQ(mixed.size(), 2);
+    CHECK_EQ(mixed[0], 0);
+    CHECK_EQ(mixed[1], 16383);
+}
+
+void testInt16()
+{
+    std::vector<uint8_t> mono;
+    for (int16_t v : {int16_t(0), int16_t(1234), int16_t(-32768), int16_t(32767)}) {
+        append(mono, v);
+    }
+    const std::vector<int16_t> out = convert(makeFormat(SampleType::Int16, 1, 16), mono);
+    CHECK_EQ(out.size(), 4);
+    CHECK_EQ(out[1], 1234);
+    CHECK_EQ(out[2], -32768);
+    CHECK_EQ(out[3], 32767);
+
+    // 12 位有效：容器低 4 位是无效数据
+    std::vector<uint8_t> masked;
+    append(masked, int16_t(0x1237));
+    append(masked, int16_t(-0x0FF1));
+    const std::vector<int16_t> maskedOut = convert(makeFormat(SampleType::Int16, 1, 16, 12), masked);
+    CHECK_EQ(maskedOut[0], 0x1230);
+    CHECK_EQ(maskedOut[1], -0x1000);
+
+    std::vector<uint8_t> stereo;
+    append(stereo, int16_t(1000));
+    append(stereo, int16_t(3000));
+    append(stereo, int16_t(-32768));
+    append(stereo, int16_t(-32768));
+    const std::vector<int16_t> mixed = convert(makeFormat(SampleType::Int16, 2, 16), stereo);
+    CHECK_EQ(mixed[0], 2000);
+    CHECK_EQ(mixed[1], -32768);
+}
+
+void testInt24Packed()
+{
+    std::vector<uint8_t> buffer;
+    appendInt24(buffer, 0x123456);
+    appendInt24(buffer, -1);
+    appendInt24(buffer, 0x7FFFFF);
+    appendInt24(buffer, -0x800000);
+    const std::vector<int16_t> out = convert(makeFormat(SampleType::Int24Packed, 1, 24), buffer);
+    CHECK_EQ(out.size(), 4);
+    CHECK_EQ(out[0], 0x1234);
+    CHECK_EQ(out[1], -1);
+    CHECK_EQ(out[2], 32767);
+    CHECK_EQ(out[3], -32768);
+}
+
+void testInt24In32()
+{
+    // WAVEFORMATEXTENSIBLE：32 位容器，24 位有效，采样左对齐，低字节为填充
+    std::vector<uint8_t> buffer;
+    append(buffer, static_cast<int32_t>(0x7FFFFF00 | 0xAB));
+    append(buffer, static_cast<int32_t>(0x80000000u | 0xCD));
+    append(buffer, static_cast<int32_t>(0x00123400 | 0xFF));
+    const std::vector<int16_t> out = convert(makeFormat(SampleType::Int32, 1, 32, 24), buffer);
+    CHECK_EQ(out.size(), 3);
+    CHECK_EQ(out[0], 32767);
+    CHECK_EQ(out[1], -32768);
+    CHECK_EQ(out[2], 0x0012);
+}
+
+void testInt32()
+{
+    std::vector<uint8_t> buffer;
+    append(buffer, int32_t(0x40000000));
+    append(buffer, int32_t(-0x40000000));
+    append(buffer, int32_t(0x7FFFFFFF));
+    append(buffer, int32_t(-0x7FFFFFFF - 1));
+    const std::vector<int16_t> out = convert(makeFormat(SampleType::Int32, 2, 32), buffer);
+    CHECK_EQ(out.size(), 2);
+    CHECK_EQ(out[0], 0);
+    CHECK_EQ(out[1], (32767 - 32768) / 2);
+}
+
+void testMultichannelDownmix()
+{
+    // 5.1 声道走运行期声道数的路径，各声道取平均
+    std::vector<uint8_t> buffer;
+    for (int frame = 0; frame < 3; ++frame) {
+        for (int c = 0; c < 6; ++c) {
+            append(buffer, static_cast<int16_t>((c + 1) * 1000 * (frame == 1 ? -1 : 1)));
+        }
+    }
+    const std::vector<int16_t> out = convert(makeFormat(SampleType::Int16, 6, 16), buffer);
+    CHECK_EQ(out.size(), 3);
+    CHECK_EQ(out[0], 3500);
+    CHECK_EQ(out[1], -3500);
+
+    std::vector<uint8_t> floats;
+    for (float f : {1.0f, 1.0f, 1.0f, -1.0f}) {
+        append(floats, f);
+    }
+    const std::vector<int16_t> quad = convert(makeFormat(SampleType::Float32, 4, 32), floats);
+    CHECK_EQ(quad.size(), 1);
+    CHECK_EQ(quad[0], 32767 / 2);
+}
+
+void testSilentAndUnsupported()
+{
+    std::vector<uint8_t> buffer;
+    for (int i = 0; i < 8; ++i) {
+        append(buffer, 0.75f);
+    }
+    const std::vector<int16_t> silent = convert(makeFormat(SampleType::Float32, 2, 32), buffer, true);
+    CHECK_EQ(silent.size(), 4);
+    for (int16_t v : silent) {
+        CHECK_EQ(v, 0);
+    }
+
+    // 静音包的数据指针可能为空
+    SampleConverter converter = SampleConverter::create(makeFormat(SampleType::Int16, 2, 16));
+    std::vector<int16_t> out(5, 99);
+    converter.convert(nullptr, 5, true, out);
+    CHECK_EQ(out.size(), 5);
+    CHECK_EQ(out[4], 0);
+
+    SampleConverter unsupported = SampleConverter::create(makeFormat(SampleType::Unsupported, 2, 8));
+    CHECK_EQ(unsupported.isValid(), false);
+    out.assign(3, 99);
+    unsupported.convert(buffer.data(), 3, false, out);
+    CHECK_EQ(out[0], 0);
+
+    CHECK_EQ(SampleConverter::create(makeFormat(SampleType::Int16, 0, 16)).isValid(), false);
+    CHECK_EQ(SampleConverter::create(makeFormat(SampleType::Int24Packed, 2, 24)).bytesPerFrame(), 6);
+}
+
+void testResample()
+{
+    std::vector<int16_t> in(480);
+    for (size_t i = 0; i < in.size(); ++i) {
+        in[i] = static_cast<int16_t>(i);
+    }
+    std::vector<int16_t> out;
+    resampleLinear(in, 48000, 16000, out);
+    CHECK_EQ(out.size(), 160);
+    CHECK_EQ(out[0], 0);
+    CHECK_EQ(out[10], 30);
+    resampleLinear(in, 16000, 16000, out);
+    CHECK_EQ(out.size(), 480);
+    CHECK_EQ(out[479], 479);
+    resampleLinear(std::vector<int16_t>(), 48000, 16000, out);
+    CHECK_EQ(out.size(), 0);
+}
+
+} // namespace
+
+int main()
+{
+    testFloat32();
+    testInt16();
+    testInt24Packed();
+    testInt24In32();
+    testInt32();
+    testMultichannelDownmix();
+    testSilentAndUnsupported();
+    testResample();
+    if (failures > 0) {
+        std::fprintf(stderr, "%d 项检查失败\n", failures);
+        return 1;
+    }
+    std::printf("audioformattest: 全部通过\n");
+    return 0;
+}
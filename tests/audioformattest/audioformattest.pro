@@ -0,0 +1,13 @@
+# 采样格式转换测试（不依赖 Qt）：构造各种设备格式的合成缓冲区，检查转换结果
+TEMPLATE = app
+CONFIG += console c++17
+CONFIG -= qt app_bundle
+
+INCLUDEPATH += ../../src
+
+SOURCES += \
+    audioformattest.cpp \
+    ../../src/audioformat.cpp
+
+HEADERS += \
+    ../../src/audioformat.h
@@ -0,0 +1,267 @@
+// 音频共享内存环测试：写入方和读取方在两个线程中并发运行，检查数据块按顺序、内容完整，
+// 空间不足时只丢弃不覆盖，回退游标后从最后一次提交处重新读取；再在子进程中读取并提交，
+// 随机时刻结束子进程（模拟辅助进程崩溃），检查新的读取方得到的提交位置和字节数总是成对。
+// 全部通过时返回 0。
+//   g++ -std=c++17 -pthread -I../../src audioringtest.cpp ../../src/audioring.cpp ../../src/captionring.cpp -o audioringtest
+
+#include "audioring.h"
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#ifndef _WIN32
+#include <csignal>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(condition) check((condition), #condition, __LINE__)
+
+void check(bool passed, const char *what, int line)
+{
+    if (!passed) {
+        std::fprintf(stderr, "第 %d 行: %s 不成立\n", line, what);
+        ++failures;
+    }
+}
+
+std::string ringName(const char *suffix)
+{
+#ifdef _WIN32
+    return std::string("audioringtest_") + suffix;
+#else
+    return std::string("audioringtest_") + std::to_string(getpid()) + "_" + suffix;
+#endif
+}
+
+// 数据块内容：开头是序号，其余字节由序号决定，长度为偶数
+size_t chunkBytes(uint32_t seq)
+{
+    return 64 + (seq * 37u % 480u) * 2;
+}
+
+void fillChunk(uint32_t seq, std::vector<char> &out)
+{
+    out.resize(chunkBytes(seq));
+    std::memcpy(out.data(), &seq, sizeof(seq));
+    for (size_t i = sizeof(seq); i < out.size(); ++i) {
+        out[i] = static_cast<char>(seq + i);
+    }
+}
+
+bool chunkMatches(const AudioRingChunk &chunk, uint32_t seq)
+{
+    std::vector<char> expected;
+    fillChunk(seq, expected);
+    return chunk.bytes == expected.size() && std::memcmp(chunk.pcm, expected.data(), expected.size()) == 0;
+}
+
+uint32_t chunkSeq(const AudioRingChunk &chunk)
+{
+    uint32_t seq = 0;
+    std::memcpy(&seq, chunk.pcm, sizeof(seq));
+    return seq;
+}
+
+void testSingleThread()
+{
+    const std::string name = ringName("single");
+    AudioRingWriter writer;
+    CHECK(writer.create(name.c_str(), 4096));
+    AudioRingReader reader;
+    CHECK(reader.open(name.c_str()));
+
+    bool wake = false;
+    std::vector<char> pcm;
+    for (uint32_t seq = 0; seq < 4; ++seq) {
+        fillChunk(seq, pcm);
+        CHECK(writer.write(pcm.data(), pcm.size(), wake));
+    }
+    AudioRingChunk chunk;
+    uint64_t afterFirst = 0;
+    uint64_t bytesAfterFirst = 0;
+    for (uint32_t seq = 0; seq < 4; ++seq) {
+        CHECK(reader.peek(chunk) && chunkMatches(chunk, seq));
+        reader.release(chunk);
+        if (seq == 0) {
+            afterFirst = reader.position();
+            bytesAfterFirst = reader.pcmBytes();
+        }
+    }
+    CHECK(!reader.peek(chunk));
+
+    // 只提交第一块：其余三块仍占用空间，回退后重新读到
+    reader.commit(afterFirst, bytesAfterFirst);
+    CHECK(reader.consumedPcmBytes() == chunkBytes(0));
+    CHECK(writer.backlogBytes() == reader.position() - afterFirst);
+    // 超出游标或早于已提交位置的提交被忽略
+    reader.commit(reader.position() + 8, 1);
+    reader.commit(0, 0);
+    CHECK(reader.consumedPcmBytes() == chunkBytes(0));
+
+    reader.rewind();
+    CHECK(reader.position() == afterFirst && reader.pcmBytes() == bytesAfterFirst);
+    CHECK(reader.peek(chunk) && chunkSeq(chunk) == 1);
+
+    // 新会话从写入位置开始，计数清零
+    reader.restartAt(writer.position());
+    CHECK(reader.consumedPcmBytes() == 0 && writer.backlogBytes() == 0);
+    CHECK(!reader.peek(chunk));
+    CHECK(reader.prepareWait());
+    fillChunk(9, pcm);
+    CHECK(writer.write(pcm.data(), pcm.size(), wake) && wake);
+}
+
+// 写入方满了就重试；读取方每隔几块提交一次，偶尔回退到最后一次提交处重新读
+void testTwoThreads()
+{
+    const std::string name = ringName("threads");
+    AudioRingWriter writer;
+    CHECK(writer.create(name.c_str(), 1u << 16));
+    AudioRingReader reader;
+    CHECK(reader.open(name.c_str()));
+
+    const uint32_t kChunks = 50000;
+    std::atomic<bool> writerDone(false);
+    std::thread producer([&]() {
+        std::vector<char> pcm;
+        bool wake = false;
+        for (uint32_t seq = 0; seq < kChunks; ++seq) {
+            fillChunk(seq, pcm);
+            while (!writer.write(pcm.data(), pcm.size(), wake)) {
+                std::this_thread::yield();
+            }
+        }
+        writerDone = true;
+    });
+
+    std::mt19937 random(7);
+    uint32_t expected = 0;
+    uint32_t committedNext = 0;     // 最后一次提交之后的第一块
+    uint64_t consumed = 0;
+    int mismatches = 0;
+    int rewinds = 0;
+    AudioRingChunk chunk;
+    while (committedNext < kChunks) {
+        if (!reader.peek(chunk)) {
+            if (writerDone && expected == kChunks) {
+                reader.commit(reader.position(), reader.pcmBytes());
+                committedNext = expected;
+            }
+            std::this_thread::yield();
+            continue;
+        }
+        if (!chunkMatches(chunk, expected)) {
+            ++mismatches;
+        }
+        reader.release(chunk);
+        consumed += chunk.bytes;
+        ++expected;
+        if (reader.pcmBytes() != consumed) {
+            ++mismatches;
+        }
+        const unsigned roll = random() % 100;
+        if (roll < 20) {
+            reader.commit(reader.position(), reader.pcmBytes());
+            committedNext = expected;
+        } else if (roll == 99) {
+            reader.rewind();
+            expected = committedNext;
+            consumed = reader.pcmBytes();
+            ++rewinds;
+        }
+    }
+    producer.join();
+    CHECK(mismatches == 0);
+    CHECK(rewinds > 0);
+    CHECK(writer.backlogBytes() == 0);
+    // 写入方空间不足时丢弃（随后重试），丢弃计数只增不减
+    std::printf("两个线程：%u 块，回退 %d 次，写入方重试丢弃 %llu 字节\n", kChunks, rewinds,
+                static_cast<unsigned long long>(writer.droppedBytes()));
+}
+
+#ifndef _WIN32
+// 子进程逐块读取并提交，父进程在随机时刻结束它；新的读取方回退后，
+// 已提交位置处的数据块序号必须和提交的字节数对应
+void testCrashedReader()
+{
+    const std::string name = ringName("fork");
+    AudioRingWriter writer;
+    CHECK(writer.create(name.c_str(), 1u << 23));
+    const uint32_t kChunks = 8000;
+    std::vector<uint64_t> bytesBefore(kChunks + 1, 0);
+    std::vector<char> pcm;
+    bool wake = false;
+    for (uint32_t seq = 0; seq < kChunks; ++seq) {
+        fillChunk(seq, pcm);
+        CHECK(writer.write(pcm.data(), pcm.size(), wake));
+        bytesBefore[seq + 1] = bytesBefore[seq] + pcm.size();
+    }
+
+    std::mt19937 random(11);
+    int inconsistent = 0;
+    int midway = 0;
+    for (int trial = 0; trial < 40; ++trial) {
+        const pid_t child = fork();
+        if (child == 0) {
+            AudioRingReader reader;
+            if (!reader.open(name.c_str())) {
+                _exit(2);
+            }
+            reader.restartAt(0);
+            AudioRingChunk chunk;
+            for (;;) {
+                while (reader.peek(chunk)) {
+                    reader.release(chunk);
+                    reader.commit(reader.position(), reader.pcmBytes());
+                }
+                reader.restartAt(0);    // 读完后从头再来，直到被结束
+            }
+        }
+        timespec pause = {0, static_cast<long>(random() % 3000000)};
+        nanosleep(&pause, nullptr);
+        kill(child, SIGKILL);
+        int status = 0;
+        waitpid(child, &status, 0);
+
+        AudioRingReader reader;
+        CHECK(reader.open(name.c_str()));
+        const uint64_t consumed = reader.consumedPcmBytes();
+        AudioRingChunk chunk;
+        if (reader.peek(chunk)) {
+            const uint32_t seq = chunkSeq(chunk);
+            inconsistent += seq >= kChunks || bytesBefore[seq] != consumed || !chunkMatches(chunk, seq);
+            midway += seq > 0;
+        } else {
+            inconsistent += consumed != bytesBefore[kChunks];
+        }
+    }
+    CHECK(inconsistent == 0);
+    CHECK(midway > 0);
+}
+#endif
+
+} // namespace
+
+int main()
+{
+    testSingleThread();
+    testTwoThreads();
+#ifndef _WIN32
+    testCrashedReader();
+#endif
+    if (failures > 0) {
+        std::fprintf(stderr, "%d 项检查失败\n", failures);
+        return 1;
+    }
+    std::printf("audioringtest: 全部通过\n");
+    return 0;
+}
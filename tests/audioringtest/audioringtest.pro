@@ -0,0 +1,17 @@
+# 音频共享内存环测试（不依赖 Qt）：两个线程并发读写、回退重读，子进程读取方崩溃后提交位置和字节数成对
+TEMPLATE = app
+CONFIG += console c++17 thread
+CONFIG -= qt app_bundle
+
+INCLUDEPATH += ../../src
+
+SOURCES += \
+    audioringtest.cpp \
+    ../../src/audioring.cpp \
+    ../../src/captionring.cpp
+
+HEADERS += \
+    ../../src/audioring.h \
+    ../../src/captionring.h
+
+unix:!macx: LIBS += -lrt
@@ -0,0 +1,148 @@
+// 采集调度测试（不依赖 Qt）：用模拟时钟和脚本化的数据来源驱动 runCaptureLoop，
+// 检查静音退避、声音恢复时立即唤醒、迟到唤醒/数据包、不连续和静音段计数。全部通过时返回 0。
+//   g++ -std=c++17 -I../../src capturescheduletest.cpp ../../src/capturescheduler.cpp ../../src/metrics.cpp -o capturescheduletest
+
+#include "capturescheduler.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+
+namespace {
+
+const int kSampleRate = 16000;
+
+// 模拟场景（微秒）：0–2 秒和 7–8 秒在播放，每 10 ms 一个数据包，其余时间回环流没有数据。
+// 7.2 秒的数据包带不连续标记，7.5 秒采集线程被挂起 150 ms，4 秒后有一次超时唤醒晚了 50 ms
+const uint64_t kPeriodUs = 10000;
+const uint64_t kAudible[][2] = {{0, 2000000}, {7000000, 8000000}};
+const uint64_t kResumeUs = 7000000;
+const uint64_t kEndUs = 8500000;
+const uint64_t kDiscontinuityUs = 7200000;
+const uint64_t kStallAtUs = 7500000;
+const uint64_t kStallUs = 150000;
+const uint64_t kOverrunAfterUs = 4000000;
+const uint64_t kOverrunUs = 50000;
+const uint64_t kNever = UINT64_MAX;
+
+class SimulatedClock : public CaptureClock
+{
+public:
+    uint64_t nowUs() override { return now; }
+    uint64_t now = 0;
+};
+
+class ScriptedSource : public CaptureSource
+{
+public:
+    ScriptedSource(SimulatedClock &clock, std::atomic<bool> &running)
+        : clock(clock), running(running), cursorUs(0), stalled(false), overran(false), resumeLatencyUs(-1)
+    {
+    }
+
+    bool waitForData(int timeoutMs) override
+    {
+        const uint64_t deadline = clock.now + static_cast<uint64_t>(timeoutMs) * 1000;
+        if (cursorUs != kNever && cursorUs <= deadline) {
+            clock.now = std::max(clock.now, cursorUs);
+            if (!stalled && clock.now >= kStallAtUs) {
+                clock.now += kStallUs;
+                stalled = true;
+            }
+            return true;
+        }
+        clock.now = deadline;
+        if (!overran && clock.now >= kOverrunAfterUs) {
+            clock.now += kOverrunUs;
+            overran = true;
+        }
+        if (clock.now >= kEndUs) {
+            running = false;
+        }
+        return false;
+    }
+
+    bool readPacket(CapturePacket &packet) override
+    {
+        if (cursorUs == kNever || cursorUs > clock.now) {
+            return false;
+        }
+        packet.frames = static_cast<uint32_t>(kPeriodUs * kSampleRate / 1000000);
+        packet.latencyUs = static_cast<int64_t>(clock.now - cursorUs);
+        packet.discontinuity = cursorUs == kDiscontinuityUs;
+        if (cursorUs == kResumeUs) {
+            resumeLatencyUs = packet.latencyUs;
+        }
+        cursorUs = nextPacketAfter(cursorUs);
+        return true;
+    }
+
+    int64_t resumeLatency() const { return resumeLatencyUs; }
+
+private:
+    static uint64_t nextPacketAfter(uint64_t t)
+    {
+        const uint64_t next = (t / kPeriodUs + 1) * kPeriodUs;
+        for (const auto &span : kAudible) {
+            if (next < span[1]) {
+                return std::max(next, span[0]);
+            }
+        }
+        return kNever;
+    }
+
+    SimulatedClock &clock;
+    std::atomic<bool> &running;
+    uint64_t cursorUs;
+    bool stalled;
+    bool overran;
+    int64_t resumeLatencyUs;
+};
+
+} // namespace
+
+int main()
+{
+    CaptureSchedulerConfig config;
+    CaptureScheduler scheduler(config);
+    SimulatedClock clock;
+    std::atomic<bool> running(true);
+    ScriptedSource source(clock, running);
+    runCaptureLoop(clock, source, scheduler, running);
+    const CaptureGlitchStats stats = scheduler.stats();
+
+    // 不退避时 5.5 秒无数据期间每个活跃超时醒来一次
+    const uint64_t silentWithoutBackoff = (kEndUs - 8000000 + kResumeUs - 2000000) / 1000 / config.activeTimeoutMs;
+    struct Check {
+        const char *name;
+        bool passed;
+    };
+    const Check checks[] = {
+        {"静音时放宽超时（超时唤醒少于不退避时的三分之一）", stats.timeoutWakeups * 3 < silentWithoutBackoff},
+        {"声音恢复时立即唤醒（首包延迟小于一个活跃超时）",
+         source.resumeLatency() >= 0 && source.resumeLatency() < static_cast<int64_t>(config.activeTimeoutMs) * 1000},
+        {"数据包一个不少", stats.packets == 300},
+        {"静音段计为 2 段", stats.silentSpans == 2},
+        {"不连续计为 1 次", stats.discontinuities == 1},
+        {"超时唤醒过晚计为 1 次迟到", stats.lateWakeups == 1},
+        {"线程挂起后取到的积压数据包计为迟到", stats.latePackets > 0},
+    };
+
+    std::printf("唤醒 %llu 次（事件 %llu，超时 %llu），不退避时静音期间约 %llu 次超时唤醒\n",
+                static_cast<unsigned long long>(stats.wakeups),
+                static_cast<unsigned long long>(stats.eventWakeups),
+                static_cast<unsigned long long>(stats.timeoutWakeups),
+                static_cast<unsigned long long>(silentWithoutBackoff));
+    int failures = 0;
+    for (const Check &check : checks) {
+        if (!check.passed) {
+            std::fprintf(stderr, "失败: %s\n", check.name);
+            ++failures;
+        }
+    }
+    if (failures > 0) {
+        std::fprintf(stderr, "%d 项检查失败\n", failures);
+        return 1;
+    }
+    std::printf("capturescheduletest: 全部通过\n");
+    return 0;
+}
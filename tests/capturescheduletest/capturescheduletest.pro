@@ -0,0 +1,15 @@
+# 采集调度测试（不依赖 Qt）：模拟时钟下的静音退避、恢复唤醒和各项计数
+TEMPLATE = app
+CONFIG += console c++17
+CONFIG -= qt app_bundle
+
+INCLUDEPATH += ../../src
+
+SOURCES += \
+    capturescheduletest.cpp \
+    ../../src/capturescheduler.cpp \
+    ../../src/metrics.cpp
+
+HEADERS += \
+    ../../src/capturescheduler.h \
+    ../../src/metrics.h
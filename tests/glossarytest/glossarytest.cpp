@@ -0,0 +1,116 @@
+// 术语匹配测试：检查 GlossaryAutomaton 取最左最长、互不重叠的匹配，
+// 以及单词边界、大小写折叠、中文术语和 HTML 输出。全部通过时返回 0。
+
+#include "glossary.h"
+#include <cstdio>
+
+namespace {
+
+int failures = 0;
+
+QVector<GlossaryEntry> makeEntries(const QStringList &terms)
+{
+    QVector<GlossaryEntry> entries;
+    for (const QString &term : terms) {
+        entries.append(GlossaryEntry{term, QString()});
+    }
+    return entries;
+}
+
+// 匹配结果写成 "起点:术语" 的列表，便于比较和输出
+QString describeMatches(const QStringList &terms, const QString &text)
+{
+    const QVector<GlossaryEntry> entries = makeEntries(terms);
+    const auto automaton = GlossaryAutomaton::build(entries);
+    std::vector<GlossaryMatch> matches;
+    automaton->findMatches(text, matches);
+    QStringList parts;
+    for (const GlossaryMatch &m : matches) {
+        parts.append(QString("%1:%2").arg(m.start).arg(text.mid(m.start, m.length)));
+    }
+    return parts.join(' ');
+}
+
+void expectMatches(const QStringList &terms, const QString &text, const QString &expected, int line)
+{
+    const QString actual = describeMatches(terms, text);
+    if (actual != expected) {
+        std::fprintf(stderr, "第 %d 行: \"%s\" 匹配为 [%s]，期望 [%s]\n", line,
+                     qPrintable(text), qPrintable(actual), qPrintable(expected));
+        ++failures;
+    }
+}
+
+#define EXPECT_MATCHES(terms, text, expected) expectMatches(terms, text, expected, __LINE__)
+
+void testLeftmostLongest()
+{
+    // 较长的术语与较短的术语起点相同，且较短术语之后紧跟另一个术语
+    EXPECT_MATCHES(QStringList({"microsoft", "microsoft teams rooms", "teams"}),
+                   "we use microsoft teams rooms daily", "7:microsoft teams rooms");
+    EXPECT_MATCHES(QStringList({"microsoft", "microsoft teams rooms", "teams"}),
+                   "microsoft teams are here", "0:microsoft 10:teams");
+    // 重叠时取起点靠左的
+    EXPECT_MATCHES(QStringList({"会议", "议纪要"}), "会议纪要", "0:会议");
+    EXPECT_MATCHES(QStringList({"a b", "b c d", "c"}), "a b c d", "0:a b 4:c");
+    // 同一起点取最长，之后继续向右匹配
+    EXPECT_MATCHES(QStringList({"new", "new york", "york city", "city"}), "new york city", "0:new york 9:city");
+    EXPECT_MATCHES(QStringList({"ab", "abc", "abcd", "bc"}), "ab abc abcd abce", "0:ab 3:abc 7:abcd");
+}
+
+void testBoundariesAndCase()
+{
+    // 英文术语要求单词边界，不区分大小写
+    EXPECT_MATCHES(QStringList({"api"}), "API rapid apis api.", "0:API 15:api");
+    EXPECT_MATCHES(QStringList({"c++"}), "we use C++ daily", "7:C++");
+    // 中文不分词，不检查边界
+    EXPECT_MATCHES(QStringList({"会议", "会议纪要"}), "本次会议纪要如下，会议结束", "2:会议纪要 9:会议");
+    EXPECT_MATCHES(QStringList({"teams"}), "", "");
+}
+
+void testRenderHtml()
+{
+    QVector<GlossaryEntry> entries;
+    entries.append(GlossaryEntry{"azure", "Azure"});
+    entries.append(GlossaryEntry{"speech", QString()});
+    const auto automaton = GlossaryAutomaton::build(entries);
+    const QString html = automaton->renderHtml("azure speech <sdk>", "#f00");
+    const QString expected = "<span style=\"color:#f00;font-weight:bold\">Azure</span> "
+                             "<span style=\"color:#f00;font-weight:bold\">speech</span> &lt;sdk&gt;";
+    if (html != expected) {
+        std::fprintf(stderr, "renderHtml 输出 %s\n", qPrintable(html));
+        ++failures;
+    }
+
+    // 纯文本只做替换，不转义、不高亮
+    QString plain;
+    const QString withPlain = automaton->renderHtml("use azure speech <sdk>", "#f00", &plain);
+    if (plain != "use Azure speech <sdk>" || !withPlain.startsWith("use <span")) {
+        std::fprintf(stderr, "纯文本输出 %s\n", qPrintable(plain));
+        ++failures;
+    }
+
+    // 术语集合不变时复用状态机
+    QVector<GlossaryEntry> updated = entries;
+    updated[0].replacement = "AZURE";
+    const auto rebuilt = GlossaryAutomaton::build(updated, automaton.get());
+    if (!rebuilt->reusedTrie()) {
+        std::fprintf(stderr, "替换内容变化时没有复用状态机\n");
+        ++failures;
+    }
+}
+
+} // namespace
+
+int main()
+{
+    testLeftmostLongest();
+    testBoundariesAndCase();
+    testRenderHtml();
+    if (failures > 0) {
+        std::fprintf(stderr, "%d 项检查失败\n", failures);
+        return 1;
+    }
+    std::printf("glossarytest: 全部通过\n");
+    return 0;
+}
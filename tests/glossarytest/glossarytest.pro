@@ -0,0 +1,13 @@
+# 术语匹配测试：最左最长、单词边界、大小写和替换输出
+QT = core
+CONFIG += console c++17
+CONFIG -= app_bundle
+
+INCLUDEPATH += ../../src
+
+SOURCES += \
+    glossarytest.cpp \
+    ../../src/glossary.cpp
+
+HEADERS += \
+    ../../src/glossary.h
@@ -0,0 +1,131 @@
+// 识别结果队列测试：在引擎所在线程一次投递远多于队列容量（1024）的最终结果，
+// 投递必须立即返回，回到事件循环后全部按顺序分发；再从其他线程边投递边分发检查一遍。
+// 投递卡住时看门狗在 30 秒后让进程返回 1。
+
+#include "speechengine.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QVector>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::fprintf(stderr, "第 %d 行: 检查失败: %s\n", __LINE__, #condition); \
+            ++failures; \
+        } \
+    } while (0)
+
+// 只负责投递结果的引擎，不处理音频
+class BurstEngine : public SpeechEngine
+{
+public:
+    void initialize(const QString &, const QString &) override {}
+    void startRecognitionAndTranslation(const QString &, const QString &) override {}
+    void stopRecognitionAndTranslation() override {}
+    void processAudioData(const QByteArray &) override {}
+    void finishAudioInput() override {}
+
+    // 每条最终结果之前先投递一个部分结果，offsetMs 为序号
+    void burst(qint64 first, int count)
+    {
+        for (int i = 0; i < count; ++i) {
+            RecognitionEvent partial;
+            partial.text = QString("partial %1").arg(first + i);
+            postResult(std::move(partial));
+
+            RecognitionEvent final;
+            final.kind = RecognitionEvent::Final;
+            final.offsetMs = first + i;
+            final.text = QString("final %1").arg(first + i);
+            postResult(std::move(final));
+        }
+    }
+};
+
+bool waitForFinals(const QVector<qint64> &received, int expected, int timeoutMs)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (received.size() < expected && timer.elapsed() < timeoutMs) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+    }
+    return received.size() == expected;
+}
+
+bool inOrder(const QVector<qint64> &received)
+{
+    for (int i = 0; i < received.size(); ++i) {
+        if (received[i] != i) {
+            std::fprintf(stderr, "第 %d 个最终结果的序号是 %lld\n", i, static_cast<long long>(received[i]));
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    std::atomic<bool> done(false);
+    std::thread watchdog([&done]() {
+        for (int i = 0; i < 300 && !done.load(); ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        if (!done.load()) {
+            std::fprintf(stderr, "30 秒内没有完成，投递可能卡住了\n");
+            std::_Exit(1);
+        }
+    });
+    watchdog.detach();
+
+    BurstEngine engine;
+    QVector<qint64> received;
+    QObject::connect(&engine, &SpeechEngine::finalSegment, &app,
+                     [&received](qint64 offsetMs, qint64, const QString &, const QString &) {
+        received.append(offsetMs);
+    });
+
+    // 引擎自己的线程：3000 条最终结果，队列只有 1024 个位置，分发要等回到事件循环
+    engine.burst(0, 3000);
+    CHECK(received.isEmpty());
+    CHECK(engine.pendingResults() >= 3000);
+    CHECK(waitForFinals(received, 3000, 10000));
+    CHECK(inOrder(received));
+    CHECK(engine.pendingResults() == 0);
+
+    // 溢出表清空后队列恢复使用
+    engine.burst(3000, 1500);
+    CHECK(waitForFinals(received, 4500, 10000));
+    CHECK(inOrder(received));
+
+    // 其他线程投递，同时本线程在分发
+    std::thread producer([&engine]() {
+        for (int i = 0; i < 10; ++i) {
+            engine.burst(4500 + i * 1000, 1000);
+        }
+    });
+    const bool allReceived = waitForFinals(received, 14500, 20000);
+    producer.join();
+    CHECK(allReceived);
+    CHECK(inOrder(received));
+
+    done.store(true);
+    if (failures > 0) {
+        std::fprintf(stderr, "%d 项检查失败\n", failures);
+        return 1;
+    }
+    std::printf("resultqueuetest: 全部通过\n");
+    return 0;
+}
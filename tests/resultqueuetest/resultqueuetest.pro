@@ -0,0 +1,30 @@
+# 识别结果队列测试：队列满时引擎自己的线程和其他线程继续投递最终结果，检查不阻塞、不丢失、不乱序
+QT = core
+CONFIG += console c++17
+CONFIG -= app_bundle
+
+INCLUDEPATH += ../../src
+INCLUDEPATH += ../../third_party/azure_speech_sdk/include/cxx_api
+INCLUDEPATH += ../../third_party/azure_speech_sdk/include/c_api
+
+SOURCES += \
+    resultqueuetest.cpp \
+    ../../src/speechengine.cpp \
+    ../../src/localspeechengine.cpp \
+    ../../src/azurespeechapi.cpp \
+    ../../src/logger.cpp \
+    ../../src/flightrecorder.cpp \
+    ../../src/metrics.cpp \
+    ../../src/captionring.cpp \
+    ../../src/sessiontrace.cpp \
+    ../../src/memoryaccounting.cpp
+
+HEADERS += \
+    ../../src/speechengine.h \
+    ../../src/localspeechengine.h \
+    ../../src/azurespeechapi.h \
+    ../../src/lockfreequeue.h
+
+LIBS += -L$$PWD/../../third_party/azure_speech_sdk/lib \
+        -lMicrosoft.CognitiveServices.Speech.core
+unix:!macx: LIBS += -L$$PWD/../../third_party/azure_speech_sdk/lib/x64 -lrt
@@ -0,0 +1,330 @@
+// 静音切分和拼接测试：检查 splitOnSilence 的静音切点、硬切和重叠、最后一段的开放结尾，
+// 以及 stitchChunkSegments 在静音切点、硬切接缝、跨切点和零长度结果上的拼接规则；
+// 再用随机的语音时间线模拟各段识别，检查硬切处不丢句、不整句重复。全部通过时返回 0。
+//   g++ -std=c++17 -I../../src silencesplittertest.cpp ../../src/silencesplitter.cpp -o silencesplittertest
+
+#include "silencesplitter.h"
+#include <cstdio>
+#include <limits>
+#include <random>
+
+namespace {
+
+int failures = 0;
+
+#define CHECK_EQ(actual, expected) \
+    checkEqual(static_cast<long long>(actual), static_cast<long long>(expected), #actual, __LINE__)
+#define CHECK(condition) checkEqual((condition) ? 1 : 0, 1, #condition, __LINE__)
+
+void checkEqual(long long actual, long long expected, const char *what, int line)
+{
+    if (actual != expected) {
+        std::fprintf(stderr, "第 %d 行: %s = %lld，期望 %lld\n", line, what, actual, expected);
+        ++failures;
+    }
+}
+
+const float kSpeechRms = 3000;
+const int64_t kOpenEnd = std::numeric_limits<int64_t>::max();
+
+struct Segment {
+    int64_t offsetMs;
+    int64_t durationMs;
+    int id;                 // 对应的语音段，-1 表示识别器只看到了一部分
+};
+
+// 按毫秒区间构造帧能量：默认是语音，silences 中的区间为静音
+std::vector<float> makeFrames(int64_t durationMs, const std::vector<std::pair<int64_t, int64_t>> &silences,
+                              float silenceRms = 0)
+{
+    std::vector<float> frames(static_cast<size_t>(durationMs / kSplitFrameMs), kSpeechRms);
+    for (const auto &silence : silences) {
+        for (int64_t ms = silence.first; ms < silence.second; ms += kSplitFrameMs) {
+            frames[static_cast<size_t>(ms / kSplitFrameMs)] = silenceRms;
+        }
+    }
+    return frames;
+}
+
+SilenceSplitOptions makeOptions(int64_t targetMs, int64_t maxMs, int64_t overlapMs)
+{
+    SilenceSplitOptions options;
+    options.targetChunkMs = targetMs;
+    options.maxChunkMs = maxMs;
+    options.overlapMs = overlapMs;
+    options.minSilenceMs = 300;
+    options.silenceRms = 500;
+    return options;
+}
+
+// 各段自己的区间首尾相接，最后一段开放到无穷
+void checkTiling(const std::vector<AudioChunk> &chunks, int64_t durationMs, int line)
+{
+    bool ok = !chunks.empty() && chunks.front().ownStartMs == 0 && chunks.back().ownEndMs == kOpenEnd
+            && chunks.back().audioEndMs == durationMs;
+    for (size_t k = 0; ok && k < chunks.size(); ++k) {
+        ok = chunks[k].audioStartMs <= chunks[k].ownStartMs && chunks[k].audioStartMs >= 0
+                && (k + 1 == chunks.size() || (chunks[k].ownEndMs == chunks[k + 1].ownStartMs
+                                              && chunks[k].audioEndMs >= chunks[k].ownEndMs
+                                              && chunks[k].audioEndMs <= durationMs));
+    }
+    checkEqual(ok ? 1 : 0, 1, "各段首尾相接", line);
+}
+
+void testFrameEnergyMeter()
+{
+    FrameEnergyMeter meter;
+    std::vector<int16_t> samples(static_cast<size_t>(kSplitFrameSamples) * 2 + 40, 1000);
+    // 分两次送入，跨越帧边界
+    meter.add(samples.data(), 100);
+    meter.add(samples.data() + 100, samples.size() - 100);
+    CHECK_EQ(meter.frames().size(), 2);
+    meter.finish();
+    CHECK_EQ(meter.frames().size(), 3);
+    CHECK_EQ(meter.frames()[2], 1000);
+    CHECK_EQ(meter.totalSamples(), samples.size());
+    CHECK_EQ(meter.durationMs(), 22);
+}
+
+void testSilenceCuts()
+{
+    // 每段目标 60 秒、最长 80 秒；静音在 40 秒（短）和 55 秒（长），取范围内最长的
+    const int64_t durationMs = 150000;
+    const auto frames = makeFrames(durationMs, {{40000, 40400}, {55000, 56000}, {118000, 118500}});
+    double threshold = 0;
+    const auto chunks = splitOnSilence(frames, durationMs, makeOptions(60000, 80000, 3000), &threshold);
+    CHECK_EQ(threshold, 500);
+    CHECK_EQ(chunks.size(), 3);
+    checkTiling(chunks, durationMs, __LINE__);
+    // 切点在静音中点，静音切点处两段互不重叠
+    CHECK_EQ(chunks[0].ownEndMs, 55500);
+    CHECK(!chunks[0].forcedCut);
+    CHECK_EQ(chunks[0].audioEndMs, 55500);
+    CHECK_EQ(chunks[1].audioStartMs, 55500);
+    CHECK_EQ(chunks[1].ownEndMs, 118250);
+    CHECK_EQ(chunks[2].audioStartMs, 118250);
+}
+
+void testForcedCut()
+{
+    // 没有静音时在最安静的 100ms 窗口硬切，两侧各多送 overlapMs
+    const int64_t durationMs = 100000;
+    auto frames = makeFrames(durationMs, {});
+    for (int64_t ms = 47000; ms < 47100; ms += kSplitFrameMs) {
+        frames[static_cast<size_t>(ms / kSplitFrameMs)] = 800;     // 高于静音阈值，但最安静
+    }
+    const auto chunks = splitOnSilence(frames, durationMs, makeOptions(60000, 80000, 3000));
+    CHECK_EQ(chunks.size(), 2);
+    checkTiling(chunks, durationMs, __LINE__);
+    CHECK(chunks[0].forcedCut);
+    CHECK_EQ(chunks[0].ownEndMs, 47050);
+    CHECK_EQ(chunks[0].audioEndMs, 50050);
+    CHECK_EQ(chunks[1].audioStartMs, 44050);
+    CHECK_EQ(chunks[1].ownStartMs, 47050);
+
+    // 重叠不超出录音两端
+    const auto wide = splitOnSilence(makeFrames(85000, {}), 85000, makeOptions(2000, 84000, 10000));
+    CHECK_EQ(wide.size(), 2);
+    checkTiling(wide, 85000, __LINE__);
+    CHECK_EQ(wide[0].audioStartMs, 0);
+    CHECK(wide[0].audioEndMs <= 85000);
+    CHECK(wide[1].audioStartMs >= 0);
+
+    // 负的重叠按 0 处理
+    const auto none = splitOnSilence(makeFrames(durationMs, {}), durationMs, makeOptions(60000, 80000, -5));
+    CHECK(none[0].forcedCut);
+    CHECK_EQ(none[0].audioEndMs, none[0].ownEndMs);
+    CHECK_EQ(none[1].audioStartMs, none[1].ownStartMs);
+}
+
+void testShortRecording()
+{
+    // 不超过最大长度时只有一段，结尾开放
+    const auto chunks = splitOnSilence(makeFrames(80000, {}), 80000, makeOptions(60000, 80000, 3000));
+    CHECK_EQ(chunks.size(), 1);
+    checkTiling(chunks, 80000, __LINE__);
+    CHECK(!chunks[0].forcedCut);
+
+    const auto empty = splitOnSilence({}, 0, makeOptions(60000, 80000, 3000));
+    CHECK_EQ(empty.size(), 1);
+    CHECK_EQ(empty[0].audioEndMs, 0);
+}
+
+std::vector<AudioChunk> twoChunks(int64_t cutMs, int64_t overlapMs, int64_t durationMs)
+{
+    AudioChunk first;
+    first.ownEndMs = cutMs;
+    first.audioEndMs = cutMs + overlapMs;
+    first.forcedCut = overlapMs > 0;
+    AudioChunk second;
+    second.ownStartMs = cutMs;
+    second.ownEndMs = kOpenEnd;
+    second.audioStartMs = cutMs - overlapMs;
+    second.audioEndMs = durationMs;
+    return {first, second};
+}
+
+std::vector<int> ids(const std::vector<Segment> &segments)
+{
+    std::vector<int> result;
+    for (const Segment &segment : segments) {
+        result.push_back(segment.id);
+    }
+    return result;
+}
+
+void testStitchSilentSeam()
+{
+    // 静音切点：两段互不相交，结果原样拼接
+    const auto chunks = twoChunks(10000, 0, 20000);
+    const std::vector<std::vector<Segment>> segments = {
+        {{1000, 3000, 1}, {5000, 4500, 2}},
+        {{10500, 2000, 3}, {15000, 1000, 4}},
+    };
+    CHECK(ids(stitchChunkSegments(chunks, segments)) == std::vector<int>({1, 2, 3, 4}));
+}
+
+void testStitchForcedSeam()
+{
+    // 硬切在 10 秒，两侧各重叠 3 秒，第二段从 7 秒开始
+    const auto chunks = twoChunks(10000, 3000, 30000);
+
+    // 跨切点、中点在切点之前：由第一段保留，第二段中同一句（结束时间不晚于已保留的）去掉
+    std::vector<std::vector<Segment>> segments = {
+        {{2000, 3000, 1}, {8000, 3000, 2}},
+        {{7000, 500, -1}, {8000, 3000, 2}, {12000, 2000, 3}},
+    };
+    CHECK(ids(stitchChunkSegments(chunks, segments)) == std::vector<int>({1, 2, 3}));
+
+    // 中点在切点之后、开始于第二段音频之后：交给第二段，第一段截断的版本不保留
+    segments = {
+        {{2000, 3000, 1}, {9000, 4000, -1}},
+        {{9000, 5000, 2}, {15000, 1000, 3}},
+    };
+    CHECK(ids(stitchChunkSegments(chunks, segments)) == std::vector<int>({1, 2, 3}));
+
+    // 开始于第二段音频之前（第二段看不到开头）：即使中点在切点之后也由第一段保留
+    segments = {
+        {{6500, 8000, 1}},
+        {{7000, 7500, -1}, {15000, 1000, 2}},
+    };
+    CHECK(ids(stitchChunkSegments(chunks, segments)) == std::vector<int>({1, 2}));
+}
+
+void testStitchZeroLength()
+{
+    // 零长度的结果按开始时间判断：已覆盖范围内的丢弃，之后的保留
+    const auto chunks = twoChunks(10000, 3000, 30000);
+    const std::vector<std::vector<Segment>> segments = {
+        {{0, 0, 1}, {2000, 4000, 2}},
+        {{5000, 0, -1}, {5500, 0, -1}, {12000, 0, 3}},
+    };
+    CHECK(ids(stitchChunkSegments(chunks, segments)) == std::vector<int>({1, 2, 3}));
+}
+
+void testStitchOpenEnd()
+{
+    // 最后一段拥有之后的所有结果，包括结束时间超出录音长度的
+    const auto chunks = twoChunks(10000, 0, 20000);
+    const std::vector<std::vector<Segment>> segments = {
+        {{1000, 1000, 1}},
+        {{19000, 1500, 2}, {20100, 200, 3}},
+    };
+    CHECK(ids(stitchChunkSegments(chunks, segments)) == std::vector<int>({1, 2, 3}));
+
+    // 结果比段少（例如最后一段还没有结果）时按已有的拼接
+    const std::vector<std::vector<Segment>> partial = {{{1000, 1000, 1}}};
+    CHECK(ids(stitchChunkSegments(chunks, partial)) == std::vector<int>({1}));
+}
+
+// 随机时间线：语音段之间的停顿短于可切分的静音，迫使硬切。每段识别器完整报告
+// 完全落在本段音频中的语音段，只看到一部分的报告截断的结果。
+// 语音段不长于两倍重叠时，每句话至少完整保留一次，且不会完整保留两次
+void testRandomTimelines()
+{
+    for (int seed = 1; seed <= 8; ++seed) {
+        for (int64_t overlapMs : {2000, 3000, 5000}) {
+            std::mt19937 random(static_cast<unsigned>(seed));
+            std::uniform_int_distribution<int64_t> speech(500, 2 * overlapMs);
+            // 停顿都短于可切分的静音（300 ms），只有结尾的静音，各段之间全是硬切
+            std::uniform_int_distribution<int64_t> pause(50, 280);
+
+            std::vector<Segment> utterances;
+            std::vector<std::pair<int64_t, int64_t>> silences;
+            int64_t t = 0;
+            const int64_t durationMs = 600000;
+            while (true) {
+                const int64_t gap = pause(random) / kSplitFrameMs * kSplitFrameMs;
+                const int64_t length = speech(random) / kSplitFrameMs * kSplitFrameMs;
+                if (t + gap + length > durationMs) {
+                    break;
+                }
+                silences.push_back({t, t + gap});
+                utterances.push_back({t + gap, length, static_cast<int>(utterances.size())});
+                t += gap + length;
+            }
+            silences.push_back({t, durationMs});
+
+            const auto chunks = splitOnSilence(makeFrames(durationMs, silences), durationMs,
+                                               makeOptions(60000, 80000, overlapMs));
+            checkTiling(chunks, durationMs, __LINE__);
+            CHECK(chunks.size() > 2 && chunks[1].forcedCut);
+
+            std::vector<std::vector<Segment>> segments(chunks.size());
+            for (size_t k = 0; k < chunks.size(); ++k) {
+                for (const Segment &u : utterances) {
+                    const int64_t start = std::max(u.offsetMs, chunks[k].audioStartMs);
+                    const int64_t end = std::min(u.offsetMs + u.durationMs, chunks[k].audioEndMs);
+                    if (end <= start) {
+                        continue;
+                    }
+                    const bool whole = start == u.offsetMs && end == u.offsetMs + u.durationMs;
+                    segments[k].push_back({start, end - start, whole ? u.id : -1});
+                }
+            }
+
+            const std::vector<Segment> stitched = stitchChunkSegments(chunks, segments);
+            std::vector<int> kept(utterances.size(), 0);
+            bool ordered = true;
+            for (size_t i = 0; i < stitched.size(); ++i) {
+                if (stitched[i].id >= 0) {
+                    ++kept[static_cast<size_t>(stitched[i].id)];
+                }
+                ordered = ordered && (i == 0 || stitched[i - 1].offsetMs <= stitched[i].offsetMs);
+            }
+            int lost = 0;
+            int duplicated = 0;
+            for (int count : kept) {
+                lost += count == 0;
+                duplicated += count > 1;
+            }
+            if (lost > 0 || duplicated > 0 || !ordered) {
+                std::fprintf(stderr, "种子 %d，重叠 %lld ms：%zu 段，丢失 %d 句，重复 %d 句，%s\n",
+                             seed, static_cast<long long>(overlapMs), chunks.size(), lost, duplicated,
+                             ordered ? "按时间排列" : "顺序错乱");
+                ++failures;
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main()
+{
+    testFrameEnergyMeter();
+    testSilenceCuts();
+    testForcedCut();
+    testShortRecording();
+    testStitchSilentSeam();
+    testStitchForcedSeam();
+    testStitchZeroLength();
+    testStitchOpenEnd();
+    testRandomTimelines();
+    if (failures > 0) {
+        std::fprintf(stderr, "%d 项检查失败\n", failures);
+        return 1;
+    }
+    std::printf("silencesplittertest: 全部通过\n");
+    return 0;
+}
@@ -0,0 +1,13 @@
+# 静音切分和拼接测试（不依赖 Qt）：静音切点、硬切重叠、跨切点和零长度结果、最后一段的开放结尾
+TEMPLATE = app
+CONFIG += console c++17
+CONFIG -= qt app_bundle
+
+INCLUDEPATH += ../../src
+
+SOURCES += \
+    silencesplittertest.cpp \
+    ../../src/silencesplitter.cpp
+
+HEADERS += \
+    ../../src/silencesplitter.h
@@ -0,0 +1,234 @@
+// 字幕共享内存环的示例读取程序和延迟测试
+// 用法:
+//   captionfeed tail [名称]                       打印程序发布的实时字幕
+//   captionfeed bench [记录数] [读取进程数] [每秒条数]  测量发布到读取的延迟（微秒）
+
+#include "captionring.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char kEndMarker[] = "__end__";
+
+uint32_t processId()
+{
+#ifdef _WIN32
+    return static_cast<uint32_t>(GetCurrentProcessId());
+#else
+    return static_cast<uint32_t>(getpid());
+#endif
+}
+
+int runTail(const char *name)
+{
+    CaptionRingReader reader;
+    bool waiting = false;
+    CaptionRecord record;
+    for (;;) {
+        if (!reader.isOpen() || reader.writerPid() == 0) {
+            reader.close();
+            if (!reader.open(name, true)) {
+                if (!waiting) {
+                    std::fprintf(stderr, "等待程序开始发布字幕 (%s)...\n", name);
+                    waiting = true;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(500));
+                continue;
+            }
+            waiting = false;
+            std::fprintf(stderr, "已连接，写入进程 %u\n", reader.writerPid());
+        }
+
+        bool any = false;
+        while (reader.next(record)) {
+            any = true;
+            const bool isFinal = record.kind == static_cast<uint32_t>(CaptionKind::Final);
+            std::printf("%s #%llu %.*s | %.*s\n",
+                        isFinal ? "FINAL  " : "partial",
+                        static_cast<unsigned long long>(record.sequence),
+                        static_cast<int>(record.textLength), record.text(),
+                        static_cast<int>(record.translationLength), record.translation());
+        }
+        if (any) {
+            std::fflush(stdout);
+        } else {
+            // 字幕更新频率远低于 1ms，轮询开销可以忽略
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+// 读取进程：忙等读取，直到结束标记，输出延迟分布
+int runBenchReader(const char *name, int index)
+{
+    CaptionRingReader reader;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!reader.open(name)) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            std::fprintf(stderr, "读取进程 %d: 无法打开共享内存 %s\n", index, name);
+            return 1;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    std::vector<uint32_t> latencies;
+    latencies.reserve(1 << 20);
+    CaptionRecord record;
+    for (;;) {
+        if (!reader.next(record)) {
+            std::this_thread::yield();
+            continue;
+        }
+        const uint64_t now = captionRingNowUs();
+        if (record.textLength == sizeof(kEndMarker) - 1
+            && std::memcmp(record.text(), kEndMarker, record.textLength) == 0) {
+            break;
+        }
+        latencies.push_back(static_cast<uint32_t>(now - record.publishTimeUs));
+    }
+
+    if (latencies.empty()) {
+        std::printf("读取进程 %d: 没有收到记录\n", index);
+        return 1;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](double p) {
+        return latencies[std::min(latencies.size() - 1, static_cast<size_t>(p * latencies.size()))];
+    };
+    std::printf("读取进程 %d (pid %u): 收到 %zu 条，丢失 %llu 条，延迟 p50 %u us，p99 %u us，p99.9 %u us，最大 %u us\n",
+                index, processId(), latencies.size(),
+                static_cast<unsigned long long>(reader.dropped()),
+                percentile(0.50), percentile(0.99), percentile(0.999), latencies.back());
+    return 0;
+}
+
+#ifdef _WIN32
+typedef PROCESS_INFORMATION Child;
+
+bool spawnReader(const char *name, int index, Child &child)
+{
+    wchar_t self[MAX_PATH];
+    GetModuleFileNameW(NULL, self, MAX_PATH);
+    wchar_t wideName[256];
+    MultiByteToWideChar(CP_UTF8, 0, name, -1, wideName, 256);
+    std::wstring commandLine = L"\"" + std::wstring(self) + L"\" bench-reader " + wideName
+            + L" " + std::to_wstring(index);
+    STARTUPINFOW startup = {};
+    startup.cb = sizeof(startup);
+    return CreateProcessW(NULL, &commandLine[0], NULL, NULL, TRUE, 0, NULL, NULL, &startup, &child) != 0;
+}
+
+int waitReader(Child &child)
+{
+    WaitForSingleObject(child.hProcess, INFINITE);
+    DWORD exitCode = 1;
+    GetExitCodeProcess(child.hProcess, &exitCode);
+    CloseHandle(child.hProcess);
+    CloseHandle(child.hThread);
+    return static_cast<int>(exitCode);
+}
+#else
+typedef pid_t Child;
+
+bool spawnReader(const char *name, int index, Child &child)
+{
+    std::fflush(stdout);
+    child = fork();
+    if (child == 0) {
+        // 子进程自己按名称打开共享内存，与外部读取程序的路径相同
+        const int result = runBenchReader(name, index);
+        std::fflush(stdout);
+        std::_Exit(result);
+    }
+    return child > 0;
+}
+
+int waitReader(Child &child)
+{
+    int status = 0;
+    waitpid(child, &status, 0);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+}
+#endif
+
+int runBench(int records, int readers, int ratePerSecond)
+{
+    const std::string name = std::string(kCaptionRingDefaultName) + "Bench" + std::to_string(processId());
+    CaptionRingWriter writer;
+    if (!writer.create(name.c_str())) {
+        std::fprintf(stderr, "无法创建共享内存 %s\n", name.c_str());
+        return 1;
+    }
+
+    std::vector<Child> children(readers);
+    for (int i = 0; i < readers; ++i) {
+        if (!spawnReader(name.c_str(), i, children[i])) {
+            std::fprintf(stderr, "无法启动读取进程\n");
+            return 1;
+        }
+    }
+    // 等读取进程打开共享内存
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+    std::printf("发布 %d 条记录到 %d 个读取进程，每秒 %d 条\n", records, readers, ratePerSecond);
+    std::fflush(stdout);
+
+    const char text[] = "The quarterly roadmap review starts with the platform team";
+    const char translation[] = "季度路线图评审从平台团队开始";
+    const auto interval = std::chrono::nanoseconds(1000000000LL / std::max(1, ratePerSecond));
+    auto nextTime = std::chrono::steady_clock::now();
+    uint64_t publishNs = 0;
+    for (int i = 0; i < records; ++i) {
+        nextTime += interval;
+        // 按字幕的实际节奏发布：让出 CPU 而不是空转，单核机器上读取进程才能及时运行
+        std::this_thread::sleep_until(nextTime);
+        const auto before = std::chrono::steady_clock::now();
+        writer.publish(i % 8 == 7 ? CaptionKind::Final : CaptionKind::Partial,
+                       text, sizeof(text) - 1, translation, sizeof(translation) - 1, i * 100, 100);
+        publishNs += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - before).count());
+    }
+    writer.publish(CaptionKind::Final, kEndMarker, sizeof(kEndMarker) - 1, "", 0);
+    std::printf("写入方每条发布耗时 %.0f ns\n", records > 0 ? static_cast<double>(publishNs) / records : 0.0);
+    std::fflush(stdout);
+
+    int failed = 0;
+    for (Child &child : children) {
+        failed += waitReader(child) != 0 ? 1 : 0;
+    }
+    return failed > 0 ? 1 : 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const std::string command = argc > 1 ? argv[1] : "";
+    if (command == "tail") {
+        return runTail(argc > 2 ? argv[2] : kCaptionRingDefaultName);
+    }
+    if (command == "bench") {
+        const int records = argc > 2 ? std::atoi(argv[2]) : 5000;
+        const int readers = argc > 3 ? std::atoi(argv[3]) : 2;
+        const int rate = argc > 4 ? std::atoi(argv[4]) : 500;
+        return runBench(std::max(1, records), std::max(1, readers), rate);
+    }
+    if (command == "bench-reader" && argc > 3) {
+        return runBenchReader(argv[2], std::atoi(argv[3]));
+    }
+    std::fprintf(stderr, "用法:\n  %s tail [名称]\n  %s bench [记录数] [读取进程数] [每秒条数]\n", argv[0], argv[0]);
+    return 2;
+}
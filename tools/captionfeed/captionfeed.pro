@@ -0,0 +1,15 @@
+# 字幕共享内存环的示例读取程序和延迟测试（不依赖 Qt）
+TEMPLATE = app
+CONFIG += console c++17
+CONFIG -= qt app_bundle
+
+INCLUDEPATH += ../../src
+
+SOURCES += \
+    captionfeed.cpp \
+    ../../src/captionring.cpp
+
+HEADERS += \
+    ../../src/captionring.h
+
+unix:!macx: LIBS += -lrt
@@ -0,0 +1,82 @@
+// 解码崩溃时写出的 .flight 文件，按时间顺序打印事件
+// 用法: flightdecode crash_20250101_120000.flight
+
+#include "flightrecorder.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <vector>
+
+namespace {
+
+const char *typeName(uint16_t type)
+{
+    switch (static_cast<FlightEventType>(type)) {
+    case FlightEventType::Log:     return "LOG  ";
+    case FlightEventType::Error:   return "ERROR";
+    case FlightEventType::State:   return "STATE";
+    case FlightEventType::Counter: return "COUNT";
+    }
+    return "?    ";
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        std::fprintf(stderr, "用法: %s <文件.flight>\n", argv[0]);
+        return 2;
+    }
+
+    FILE *file = std::fopen(argv[1], "rb");
+    if (!file) {
+        std::fprintf(stderr, "无法打开文件: %s\n", argv[1]);
+        return 1;
+    }
+
+    FlightDumpHeader header;
+    if (std::fread(&header, sizeof(header), 1, file) != 1 || std::memcmp(header.magic, "MAFR", 4) != 0) {
+        std::fprintf(stderr, "不是飞行记录文件\n");
+        std::fclose(file);
+        return 1;
+    }
+    if (header.version != kFlightFormatVersion || header.recordSize != sizeof(FlightRecord)) {
+        std::fprintf(stderr, "不支持的格式版本 %u（记录大小 %u）\n", header.version, header.recordSize);
+        std::fclose(file);
+        return 1;
+    }
+
+    std::vector<FlightRecord> records(header.capacity);
+    size_t count = std::fread(records.data(), sizeof(FlightRecord), records.size(), file);
+    std::fclose(file);
+    records.resize(count);
+
+    records.erase(std::remove_if(records.begin(), records.end(),
+                                 [](const FlightRecord &r) { return r.sequence == 0; }),
+                  records.end());
+    std::sort(records.begin(), records.end(),
+              [](const FlightRecord &a, const FlightRecord &b) { return a.sequence < b.sequence; });
+
+    time_t start = static_cast<time_t>(header.startTimeUnixMs / 1000);
+    char startText[64];
+    std::strftime(startText, sizeof(startText), "%Y-%m-%d %H:%M:%S", std::localtime(&start));
+    std::printf("记录器启动于 %s，共写入 %llu 条事件，保留最近 %zu 条\n",
+                startText, static_cast<unsigned long long>(header.nextSequence), records.size());
+
+    for (const FlightRecord &r : records) {
+        const unsigned length = std::min<unsigned>(r.length, kFlightTextSize);
+        std::printf("#%-8llu +%12.6fs [T%-6u] %s %.*s",
+                    static_cast<unsigned long long>(r.sequence - 1),
+                    r.timestampUs / 1e6,
+                    r.threadId,
+                    typeName(r.type),
+                    static_cast<int>(length), r.text);
+        if (r.value != 0 || r.type == static_cast<uint16_t>(FlightEventType::Counter)) {
+            std::printf(" = %lld", static_cast<long long>(r.value));
+        }
+        std::printf("\n");
+    }
+    return 0;
+}
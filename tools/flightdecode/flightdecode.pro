@@ -0,0 +1,12 @@
+# 飞行记录解码工具（不依赖 Qt）
+TEMPLATE = app
+CONFIG += console c++17
+CONFIG -= qt app_bundle
+
+INCLUDEPATH += ../../src
+
+SOURCES += \
+    flightdecode.cpp
+
+HEADERS += \
+    ../../src/flightrecorder.h